@@ -45,6 +45,14 @@ enum ThumbnailSize {
     kLarge = 256,
 };
 
+// 缩略图任务的优先级，值越小越先执行
+enum class ThumbnailPriority : uint8_t {
+    kVisible,   // 视图中可见的文件
+    kPrefetch,   // 即将滚动到可见区域的文件
+    kBackground,   // 其他场景，如文件属性更新
+    kPriorityCount
+};
+
 enum ItemRoles {
     kItemDisplayRole = Qt::DisplayRole,
     kItemIconRole = Qt::DecorationRole,
@@ -202,6 +210,7 @@ Q_DECLARE_METATYPE(DFMBASE_NAMESPACE::Global::CreateFileType);
 Q_DECLARE_METATYPE(DFMBASE_NAMESPACE::Global::ViewMode);
 Q_DECLARE_METATYPE(DFMBASE_NAMESPACE::Global::ItemRoles);
 Q_DECLARE_METATYPE(DFMBASE_NAMESPACE::Global::ThumbnailSize);
+Q_DECLARE_METATYPE(DFMBASE_NAMESPACE::Global::ThumbnailPriority);
 Q_DECLARE_METATYPE(DFMBASE_NAMESPACE::Global::TransparentStatus);
 Q_DECLARE_METATYPE(DFMBASE_NAMESPACE::Global::TransparentStatus *)
 Q_DECLARE_METATYPE(QList<DFMBASE_NAMESPACE::Global::ItemRoles> *)
@@ -30,9 +30,7 @@ public:
 public Q_SLOTS:
     void cacheInfo(const QUrl url, const FileInfoPointer info);
     void removeCaches(const QList<QUrl> urls);
-    void updateInfoTime(const QUrl url);
     void dealRemoveInfo();
-    void removeInfosTime(const QList<QUrl> urls);
     void disconnectWatcher(const QMap<QUrl, FileInfoPointer> infos);
 
 private:
@@ -55,8 +53,6 @@ public:
 Q_SIGNALS:
     void cacheRemoveCaches(const QList<QUrl> &key);
     void cacheDisconnectWatcher(const QMap<QUrl, FileInfoPointer> infos);
-    void cacheUpdateInfoTime(const QUrl url);
-    void cacheRemoveInfosTime(const QList<QUrl> urls);
 
 private:
     explicit InfoCache(QObject *parent = nullptr);
@@ -68,9 +64,7 @@ private:
     void cacheInfo(const QUrl url, const FileInfoPointer info);
     void disconnectWatcher(const QMap<QUrl, FileInfoPointer> infos);
     void removeCaches(const QList<QUrl> urls);
-    void updateSortTimeWorker(const QUrl url);
     void timeRemoveCache();
-    void removeInfosTimeWorker(const QList<QUrl> urls);
 
 private Q_SLOTS:
     void fileAttributeChanged(const QUrl url);
@@ -8,9 +8,13 @@
 #include <dfm-framework/dfm_framework_global.h>
 #include <dfm-framework/event/eventhelper.h>
 #include <dfm-framework/event/invokehelper.h>
+#include <dfm-framework/event/eventtable.h>
 
 #include <QFuture>
 #include <QReadWriteLock>
+#include <QMutex>
+
+#include <atomic>
 
 DPF_BEGIN_NAMESPACE
 
@@ -38,11 +42,24 @@ class EventChannel
 public:
     using Connector = std::function<QVariant(const QVariantList &)>;
 
+    EventChannel() = default;
+    ~EventChannel();
+    Q_DISABLE_COPY(EventChannel)
+
     QVariant send();
     QVariant send(const QVariantList &params);
     template<class T, class... Args>
-    inline QVariant send(T param, Args &&... args)
+    [[gnu::hot]] inline QVariant send(T param, Args &&... args)
     {
+        // the receiver has the same signature, call it directly without QVariant
+        EventReaders::Guard guard(readers);
+        const Receiver *r = receiver.load(std::memory_order_acquire);
+        if (Q_LIKELY(r && r->signature && *r->signature == eventSignature<T, Args...>())) {
+            void *argv[] { static_cast<void *>(std::addressof(param)),
+                           const_cast<void *>(static_cast<const void *>(std::addressof(args)))... };
+            return r->invoker(argv);
+        }
+
         QVariantList ret;
         makeVariantList(&ret, param, std::forward<Args>(args)...);
         return send(ret);
@@ -64,15 +81,34 @@ public:
         static_assert(std::is_base_of<QObject, T>::value, "Template type T must be derived QObject");
         static_assert(!std::is_pointer<T>::value, "Receiver::bind's template type T must not be a pointer type");
 
-        QMutexLocker guard(&receiverMutex);
-        conn = [obj, method](const QVariantList &args) -> QVariant {
+        Receiver *r = new Receiver;
+        r->conn = [obj, method](const QVariantList &args) -> QVariant {
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args);
         };
+        r->signature = TypedEventHelper<decltype(method)>::signature();
+        r->invoker = TypedEventHelper<decltype(method)>::invoker(obj, method);
+        if (!r->invoker)
+            r->signature = nullptr;
+        setReceiver(r);
     }
 
 private:
-    Connector conn;
+    // the receiver is immutable after published, senders read it without lock
+    struct Receiver
+    {
+        Connector conn;
+        const std::type_info *signature { nullptr };
+        TypedInvoker invoker;
+    };
+
+    void setReceiver(Receiver *r);
+
+private:
+    std::atomic<const Receiver *> receiver { nullptr };
+    // replaced receivers may be used by other threads, release them when no one is sending
+    QList<const Receiver *> retiredReceivers;
+    EventReaders readers;
     QMutex receiverMutex;
 };
 
@@ -105,6 +141,7 @@ public:
             ChannelPtr Channel { new EventChannel };
             Channel->setReceiver(obj, method);
             channelMap.insert(type, Channel);
+            channelTable.setValue(type, Channel.data());
         }
         return true;
     }
@@ -124,12 +161,9 @@ public:
     [[gnu::hot]] inline QVariant push(EventType type, T param, Args &&... args)
     {
         threadEventAlert(type);
-        QReadLocker guard(&rwLock);
-        if (Q_LIKELY(channelMap.contains(type))) {
-            auto channel = channelMap.value(type);
-            guard.unlock();
+        EventReaders::Guard guard(readers);
+        if (auto channel = channelTable.value(type))
             return channel->send(param, std::forward<Args>(args)...);
-        }
         return QVariant();
     }
 
@@ -143,14 +177,9 @@ public:
     inline QVariant push(const EventType &type)
     {
         threadEventAlert(type);
-        QReadLocker guard(&rwLock);
-        if (Q_LIKELY(channelMap.contains(type))) {
-            auto channel = channelMap.value(type);
-            guard.unlock();
-            if (channel)
-                return channel->send();
-        }
-
+        EventReaders::Guard guard(readers);
+        if (auto channel = channelTable.value(type))
+            return channel->send();
         return QVariant();
     }
 
@@ -164,12 +193,9 @@ public:
     template<class T, class... Args>
     inline EventChannelFuture post(EventType type, T param, Args &&... args)
     {
-        QReadLocker guard(&rwLock);
-        if (Q_LIKELY(channelMap.contains(type))) {
-            auto channel { channelMap[type] };
-            guard.unlock();
+        EventReaders::Guard guard(readers);
+        if (auto channel = channelTable.value(type))
             return channel->asyncSend(param, std::forward<Args>(args)...);
-        }
         return EventChannelFuture(QFuture<QVariant>());
     }
 
@@ -181,12 +207,9 @@ public:
 
     inline EventChannelFuture post(const EventType &type)
     {
-        QReadLocker guard(&rwLock);
-        if (Q_LIKELY(channelMap.contains(type))) {
-            auto channel { channelMap[type] };
-            guard.unlock();
+        EventReaders::Guard guard(readers);
+        if (auto channel = channelTable.value(type))
             return channel->asyncSend();
-        }
         return EventChannelFuture(QFuture<QVariant>());
     }
 
@@ -195,7 +218,12 @@ private:
     using EventChannelMap = QMap<EventType, ChannelPtr>;
 
 private:
+    // channelMap is modified under rwLock, channelTable is its lock free index for push and post
     EventChannelMap channelMap;
+    EventTable<EventChannel> channelTable;
+    // disconnected channels may be used by other threads, release them when no one is pushing
+    QList<ChannelPtr> retiredChannels;
+    EventReaders readers;
     QReadWriteLock rwLock;
 };
 
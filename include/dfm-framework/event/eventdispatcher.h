@@ -8,11 +8,15 @@
 #include <dfm-framework/dfm_framework_global.h>
 #include <dfm-framework/event/eventhelper.h>
 #include <dfm-framework/event/invokehelper.h>
+#include <dfm-framework/event/eventtable.h>
 
 #include <QVariant>
 #include <QFuture>
 #include <QSharedPointer>
 #include <QReadWriteLock>
+#include <QMutex>
+
+#include <atomic>
 
 DPF_BEGIN_NAMESPACE
 
@@ -20,17 +24,51 @@ class EventDispatcher
 {
 public:
     using Listener = std::function<QVariant(const QVariantList &)>;
-    using HandlerList = QList<EventHandler<Listener>>;
-    using FilterList = QList<EventHandler<Listener>>;
+    struct DispatchListener
+    {
+        Listener listener;
+        const std::type_info *signature { nullptr };
+        TypedInvoker invoker;
+    };
+    using HandlerList = QList<EventHandler<DispatchListener>>;
+    using FilterList = QList<EventHandler<DispatchListener>>;
+
+    EventDispatcher() = default;
+    ~EventDispatcher();
+    Q_DISABLE_COPY(EventDispatcher)
 
     bool dispatch();
     bool dispatch(const QVariantList &params);
     template<class T, class... Args>
-    inline bool dispatch(T param, Args &&... args)
+    [[gnu::hot]] inline bool dispatch(T param, Args &&... args)
     {
-        QVariantList ret;
-        makeVariantList(&ret, param, std::forward<Args>(args)...);
-        return dispatch(ret);
+        EventReaders::Guard guard(readers);
+        const Listeners *current = listeners.load(std::memory_order_acquire);
+        if (!current)
+            return true;
+
+        // listeners with the same signature are called directly,
+        // the QVariantList is only made when some listener needs it
+        const std::type_info &signature = eventSignature<T, Args...>();
+        void *argv[] { static_cast<void *>(std::addressof(param)),
+                       const_cast<void *>(static_cast<const void *>(std::addressof(args)))... };
+        QVariantList params;
+        auto invoke = [&](const EventHandler<DispatchListener> &h) -> QVariant {
+            if (h.handler.signature && *h.handler.signature == signature)
+                return h.handler.invoker(argv);
+            if (params.isEmpty())
+                makeVariantList(&params, param, args...);
+            return h.handler.listener(params);
+        };
+
+        for (const auto &h : current->filters) {
+            if (invoke(h).toBool())
+                return false;
+        }
+        for (const auto &h : current->handlers)
+            invoke(h);
+
+        return true;
     }
 
     QFuture<bool> asyncDispatch();
@@ -54,7 +92,10 @@ public:
             return helper.invoke(args);
         };
 
-        handlerList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func });
+        QMutexLocker guard(&listenerMutex);
+        handlerList.push_back(EventHandler<DispatchListener> { obj, memberFunctionVoidCast(method),
+                                                               makeListener(func, obj, method) });
+        publishListeners();
     }
 
     template<class T, class Func>
@@ -64,6 +105,7 @@ public:
         static_assert(!std::is_pointer<T>::value, "Receiver::bind's template type T must not be a pointer type");
 
         bool ret { true };
+        QMutexLocker guard(&listenerMutex);
         for (auto handler : handlerList) {
             if (handler.compare(obj, method)) {
                 if (!handlerList.removeOne(handler)) {
@@ -72,6 +114,7 @@ public:
                 }
             }
         }
+        publishListeners();
 
         return ret;
     }
@@ -90,7 +133,11 @@ public:
             EventHelper<decltype(method)> helper = (EventHelper<decltype(method)>(obj, method));
             return helper.invoke(args).toBool();
         };
-        filterList.push_back(EventHandler<Listener> { obj, memberFunctionVoidCast(method), func });
+
+        QMutexLocker guard(&listenerMutex);
+        filterList.push_back(EventHandler<DispatchListener> { obj, memberFunctionVoidCast(method),
+                                                              makeListener(func, obj, method) });
+        publishListeners();
     }
 
     template<class T, class Func>
@@ -104,6 +151,7 @@ public:
         static_assert(std::is_same<bool, ReturnType<decltype(method)>>::value, "Template method's ReturnType must is bool");
 #endif
         bool ret { true };
+        QMutexLocker guard(&listenerMutex);
         for (auto handler : filterList) {
             if (handler.compare(obj, method)) {
                 if (!filterList.removeOne(handler)) {
@@ -112,13 +160,39 @@ public:
                 }
             }
         }
+        publishListeners();
 
         return ret;
     }
 
+private:
+    // snapshot of handlerList and filterList, dispatching reads it without lock
+    struct Listeners
+    {
+        HandlerList handlers;
+        FilterList filters;
+    };
+
+    template<class Func, class T, class Method>
+    static DispatchListener makeListener(Func func, T *obj, Method method)
+    {
+        DispatchListener listener { func, TypedEventHelper<Method>::signature(),
+                                    TypedEventHelper<Method>::invoker(obj, method) };
+        if (!listener.invoker)
+            listener.signature = nullptr;
+        return listener;
+    }
+
+    void publishListeners();
+
 private:
     HandlerList handlerList {};
     FilterList filterList {};
+    std::atomic<const Listeners *> listeners { nullptr };
+    // replaced snapshots may be used by other threads, release them when no one is dispatching
+    QList<const Listeners *> retiredListeners;
+    EventReaders readers;
+    QMutex listenerMutex;
 };
 
 class EventDispatcherManager
@@ -152,6 +226,7 @@ public:
             DispatcherPtr dispatcher { new EventDispatcher };
             dispatcher->append(obj, method);
             dispatcherMap.insert(type, dispatcher);
+            dispatcherTable.setValue(type, dispatcher.data());
         }
         return true;
     }
@@ -195,13 +270,9 @@ public:
                 return false;
         }
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher = dispatcherMap.value(type);
-            lk.unlock();
-            if (dispatcher)
-                return dispatcher->dispatch(param, std::forward<Args>(args)...);
-        }
+        EventReaders::Guard guard(readers);
+        if (auto dispatcher = dispatcherTable.value(type))
+            return dispatcher->dispatch(param, std::forward<Args>(args)...);
         return false;
     }
 
@@ -218,13 +289,9 @@ public:
         if (!globalFilterMap.isEmpty() && globalFiltered(type, QVariantList()))
             return false;
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher = dispatcherMap.value(type);
-            lk.unlock();
-            if (dispatcher)
-                return dispatcher->dispatch();
-        }
+        EventReaders::Guard guard(readers);
+        if (auto dispatcher = dispatcherTable.value(type))
+            return dispatcher->dispatch();
         return false;
     }
 
@@ -245,13 +312,9 @@ public:
                 return QFuture<bool>();
         }
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher { dispatcherMap[type] };
-            Q_ASSERT(dispatcher);
-            lk.unlock();
+        EventReaders::Guard guard(readers);
+        if (auto dispatcher = dispatcherTable.value(type))
             return dispatcher->asyncDispatch(param, std::forward<Args>(args)...);
-        }
         return QFuture<bool>();
     }
 
@@ -266,13 +329,9 @@ public:
         if (!globalFilterMap.isEmpty() && globalFiltered(type, QVariantList()))
             return QFuture<bool>();
 
-        QReadLocker lk(&rwLock);
-        if (Q_LIKELY(dispatcherMap.contains(type))) {
-            auto dispatcher { dispatcherMap[type] };
-            Q_ASSERT(dispatcher);
-            lk.unlock();
+        EventReaders::Guard guard(readers);
+        if (auto dispatcher = dispatcherTable.value(type))
             return dispatcher->asyncDispatch();
-        }
         return QFuture<bool>();
     }
 
@@ -306,6 +365,7 @@ public:
             DispatcherPtr dispatcher { new EventDispatcher };
             dispatcher->appendFilter(obj, method);
             dispatcherMap.insert(type, dispatcher);
+            dispatcherTable.setValue(type, dispatcher.data());
         }
         return true;
     }
@@ -340,7 +400,12 @@ private:
     using GlobalEventFilterMap = QMap<QObject *, GlobalFilter>;
 
 private:
+    // dispatcherMap is modified under rwLock, dispatcherTable is its lock free index for publishing
     EventDispatcherMap dispatcherMap;
+    EventTable<EventDispatcher> dispatcherTable;
+    // unsubscribed dispatchers may be used by other threads, release them when no one is publishing
+    QList<DispatcherPtr> retiredDispatchers;
+    EventReaders readers;
     GlobalEventFilterMap globalFilterMap;
     QReadWriteLock rwLock;
 };
@@ -15,6 +15,10 @@
 #include <QCoreApplication>
 
 #include <mutex>
+#include <tuple>
+#include <typeinfo>
+#include <type_traits>
+#include <utility>
 
 DPF_BEGIN_NAMESPACE
 
@@ -500,6 +504,67 @@ protected:
     Func f;
 };
 
+/*
+ * typed invoke, the arguments are passed as pointers without packing into QVariant
+ */
+using TypedInvoker = std::function<QVariant(void **)>;
+
+template<class... Args>
+inline const std::type_info &eventSignature()
+{
+    return typeid(std::tuple<typename std::decay<Args>::type...>);
+}
+
+template<class Handler>
+struct TypedEventHelper
+{
+    // unsupported method type, always use EventHelper
+    static const std::type_info *signature() { return nullptr; }
+    template<class T>
+    static TypedInvoker invoker(T *, Handler) { return {}; }
+};
+
+template<class Result, class T, class... Args>
+struct TypedEventHelper<Result (T::*)(Args...)>
+{
+    using Func = Result (T::*)(Args...);
+
+    // the arguments may point to the caller's variables,
+    // so only methods which take arguments by value or const reference can be invoked directly
+    static constexpr bool kSupported = ((!std::is_reference<Args>::value
+                                         || std::is_const<typename std::remove_reference<Args>::type>::value)
+                                        && ...);
+
+    static const std::type_info *signature()
+    {
+        if constexpr (kSupported)
+            return &eventSignature<Args...>();
+        return nullptr;
+    }
+
+    static TypedInvoker invoker(T *self, Func func)
+    {
+        if constexpr (kSupported) {
+            return [self, func](void **args) -> QVariant {
+                return invoke(self, func, args, std::index_sequence_for<Args...> {});
+            };
+        }
+        return {};
+    }
+
+private:
+    template<std::size_t... I>
+    static QVariant invoke(T *s, Func f, void **args, std::index_sequence<I...>)
+    {
+        Q_UNUSED(args)
+        QVariant ret = resultGenerator<Result>();
+        if (s)
+            emit(s->*f)(*static_cast<typename std::decay<Args>::type *>(args[I])...),
+                    ApplyReturnValue<Result>(ret.data());
+        return ret;
+    }
+};
+
 /*
  * cast member function to void *
  */
@@ -0,0 +1,117 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef EVENTTABLE_H
+#define EVENTTABLE_H
+
+#include <dfm-framework/dfm_framework_global.h>
+#include <dfm-framework/event/eventhelper.h>
+
+#include <array>
+#include <atomic>
+
+DPF_BEGIN_NAMESPACE
+
+/*
+ * Count of the threads which are reading lock free data.
+ * A writer replaces the data first, then the old data can be released if no reader is active,
+ * otherwise it is kept until a later write or destruction.
+ */
+class EventReaders
+{
+public:
+    class Guard
+    {
+    public:
+        explicit Guard(const EventReaders &r)
+            : readers(r)
+        {
+            readers.count.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+        ~Guard()
+        {
+            readers.count.fetch_sub(1, std::memory_order_release);
+        }
+        Q_DISABLE_COPY(Guard)
+
+    private:
+        const EventReaders &readers;
+    };
+
+    inline bool isIdle() const
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return count.load(std::memory_order_acquire) == 0;
+    }
+
+private:
+    mutable std::atomic<int> count { 0 };
+};
+
+/*
+ * Lookup table indexed by EventType, reading is lock free.
+ * The table is split into pages which are allocated when the first value is set,
+ * writing must be serialized by the caller, the values are owned by the caller
+ * and must stay alive as long as they may be read.
+ */
+template<class T>
+class EventTable
+{
+public:
+    EventTable()
+    {
+        for (auto &page : pages)
+            page.store(nullptr, std::memory_order_relaxed);
+    }
+
+    ~EventTable()
+    {
+        for (auto &page : pages)
+            delete page.load(std::memory_order_relaxed);
+    }
+
+    Q_DISABLE_COPY(EventTable)
+
+    [[gnu::hot]] inline T *value(EventType type) const
+    {
+        if (Q_UNLIKELY(!isValidEventType(type)))
+            return nullptr;
+
+        const Page *page = pages[static_cast<std::size_t>(type) >> kPageBits].load(std::memory_order_acquire);
+        if (!page)
+            return nullptr;
+        return (*page)[static_cast<std::size_t>(type) & kPageMask].load(std::memory_order_acquire);
+    }
+
+    inline void setValue(EventType type, T *value)
+    {
+        if (!isValidEventType(type))
+            return;
+
+        auto &slot = pages[static_cast<std::size_t>(type) >> kPageBits];
+        Page *page = slot.load(std::memory_order_relaxed);
+        if (!page) {
+            if (!value)
+                return;
+            page = new Page;
+            for (auto &item : *page)
+                item.store(nullptr, std::memory_order_relaxed);
+            slot.store(page, std::memory_order_release);
+        }
+        (*page)[static_cast<std::size_t>(type) & kPageMask].store(value, std::memory_order_release);
+    }
+
+private:
+    static constexpr std::size_t kPageBits { 8 };
+    static constexpr std::size_t kPageMask { (1 << kPageBits) - 1 };
+    static constexpr std::size_t kPageCount { (EventTypeScope::kCustomTop >> kPageBits) + 1 };
+
+    using Page = std::array<std::atomic<T *>, 1 << kPageBits>;
+    std::array<std::atomic<Page *>, kPageCount> pages;
+};
+
+DPF_END_NAMESPACE
+
+#endif   // EVENTTABLE_H
@@ -8,6 +8,8 @@
 #include <dfm-base/dfm_base_global.h>
 
 #include <QString>
+#include <QHash>
+#include <QMutex>
 #include <QtSql>
 
 DFMBASE_BEGIN_NAMESPACE
@@ -18,9 +20,15 @@ public:
     SqliteConnectionPoolPrivate();
     QString makeConnectionName(const QString &databaseName);
     QSqlDatabase createConnection(const QString &databaseName, const QString &connectionName);
+    void configureConnection(const QSqlDatabase &db);
+    void removeStatements(const QString &connectionName);
 
 public:
     QString connectionName;
+
+    // connection name -> (sql -> prepared query), a connection is only used by its own thread
+    QMutex statementMutex;
+    QHash<QString, QHash<QString, QSqlQuery>> statements;
 };
 
 DFMBASE_END_NAMESPACE
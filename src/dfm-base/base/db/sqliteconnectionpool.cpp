@@ -15,6 +15,13 @@ DFMBASE_USE_NAMESPACE
 
 static constexpr char kDatabaseType[] { "QSQLITE" };
 static constexpr char kTestSql[] { "SELECT 1" };
+static constexpr int kMaxCachedStatements { 64 };
+// WAL lets the readers work while a batch is written, NORMAL syncs only at checkpoints in WAL mode
+static constexpr const char *kConnectionPragmas[] {
+    "PRAGMA journal_mode=WAL",
+    "PRAGMA synchronous=NORMAL",
+    "PRAGMA mmap_size=67108864"
+};
 
 SqliteConnectionPoolPrivate::SqliteConnectionPoolPrivate()
 {
@@ -36,6 +43,7 @@ QSqlDatabase SqliteConnectionPoolPrivate::createConnection(const QString &databa
 
     if (db.open()) {
         qCInfo(logDFMBase).noquote() << QString("Connection created: %1, sn: %2").arg(connectionName).arg(++sn);
+        configureConnection(db);
         return db;
     } else {
         qCWarning(logDFMBase).noquote() << "Create connection error:" << db.lastError().text();
@@ -43,6 +51,21 @@ QSqlDatabase SqliteConnectionPoolPrivate::createConnection(const QString &databa
     }
 }
 
+void SqliteConnectionPoolPrivate::configureConnection(const QSqlDatabase &db)
+{
+    for (const char *pragma : kConnectionPragmas) {
+        QSqlQuery query(db);
+        if (!query.exec(pragma))
+            qCWarning(logDFMBase).noquote() << "Configure connection error:" << pragma << query.lastError().text();
+    }
+}
+
+void SqliteConnectionPoolPrivate::removeStatements(const QString &connectionName)
+{
+    QMutexLocker lk(&statementMutex);
+    statements.remove(connectionName);
+}
+
 SqliteConnectionPool::SqliteConnectionPool(QObject *parent)
     : QObject(parent), d(new SqliteConnectionPoolPrivate)
 {
@@ -72,14 +95,20 @@ QSqlDatabase SqliteConnectionPool::openConnection(const QString &databaseName)
                                                  .arg(kTestSql)
                                                  .arg(fullConnectionName);
         QSqlQuery query(kTestSql, existingDb);
-        if (query.lastError().type() != QSqlError::NoError && !existingDb.open()) {
-            qCCritical(logDFMBase).noquote() << "Open datatabase error:" << existingDb.lastError().text();
-            return QSqlDatabase();
+        if (query.lastError().type() != QSqlError::NoError) {
+            // the prepared statements are invalid after the connection is closed
+            d->removeStatements(fullConnectionName);
+            if (!existingDb.open()) {
+                qCCritical(logDFMBase).noquote() << "Open datatabase error:" << existingDb.lastError().text();
+                return QSqlDatabase();
+            }
+            d->configureConnection(existingDb);
         }
         return existingDb;
     } else {
         if (qApp != nullptr) {
-            QObject::connect(QThread::currentThread(), &QThread::finished, qApp, [fullConnectionName] {
+            QObject::connect(QThread::currentThread(), &QThread::finished, qApp, [this, fullConnectionName] {
+                d->removeStatements(fullConnectionName);
                 if (QSqlDatabase::contains(fullConnectionName)) {
                     QSqlDatabase::removeDatabase(fullConnectionName);
                     qCInfo(logDFMBase).noquote() << QString("Connection deleted: %1").arg(fullConnectionName);
@@ -90,3 +119,37 @@ QSqlDatabase SqliteConnectionPool::openConnection(const QString &databaseName)
         return d->createConnection(databaseName, fullConnectionName);
     }
 }
+
+/*!
+ * \brief SqliteConnectionPool::prepare
+ * prepare `sql` on the connection `db`, the prepared query is cached for the connection,
+ * so the statements executed repeatedly are compiled only once.
+ */
+bool SqliteConnectionPool::prepare(const QSqlDatabase &db, const QString &sql, QSqlQuery *query)
+{
+    Q_ASSERT(query);
+    const QString &connectionName { db.connectionName() };
+    {
+        QMutexLocker lk(&d->statementMutex);
+        auto iter = d->statements.constFind(connectionName);
+        if (iter != d->statements.cend() && iter->contains(sql)) {
+            *query = iter->value(sql);
+            return true;
+        }
+    }
+
+    QSqlQuery prepared(db);
+    if (!prepared.prepare(sql)) {
+        qCWarning(logDFMBase).noquote() << "SQL Prepare Error:" << prepared.lastError().text().trimmed();
+        *query = prepared;
+        return false;
+    }
+
+    QMutexLocker lk(&d->statementMutex);
+    auto &cached = d->statements[connectionName];
+    if (cached.size() >= kMaxCachedStatements)
+        cached.clear();
+    cached.insert(sql, prepared);
+    *query = prepared;
+    return true;
+}
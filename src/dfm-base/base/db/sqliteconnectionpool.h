@@ -21,6 +21,7 @@ class SqliteConnectionPool : public QObject
 public:
     static SqliteConnectionPool &instance();
     QSqlDatabase openConnection(const QString &databaseName);
+    bool prepare(const QSqlDatabase &db, const QString &sql, QSqlQuery *query);
 
 private:
     explicit SqliteConnectionPool(QObject *parent = nullptr);
@@ -10,6 +10,7 @@
 #include <dfm-base/base/db/sqlitequeryable.h>
 
 #include <QObject>
+#include <QSharedPointer>
 #include <QDebug>
 
 DFMBASE_BEGIN_NAMESPACE
@@ -123,6 +124,43 @@ public:
         return lastId;
     }
 
+    // Insert many entities in one transaction
+    template<typename T>
+    bool insertMany(const QList<QSharedPointer<T>> &entities, bool customPK = false)
+    {
+        static_assert(std::is_base_of<QObject, T>::value, "Template type T must be derived QObject");
+        const QStringList &fieldNames { SqliteHelper::fieldNames<T>() };
+        Q_ASSERT(!fieldNames.isEmpty());
+
+        QString fmtFields;
+        QString fmtValues;
+        QList<QMetaProperty> properties;
+        for (int i = customPK ? 0 : 1; i != fieldNames.size(); ++i) {
+            fmtFields += (fieldNames[i] + ",");
+            fmtValues += "?,";
+            properties.append(T::staticMetaObject.property(T::staticMetaObject.indexOfProperty(fieldNames[i].toLocal8Bit().data())));
+        }
+        fmtFields.chop(1);
+        fmtValues.chop(1);
+
+        QList<QVariantList> rows;
+        rows.reserve(entities.size());
+        for (const QSharedPointer<T> &entity : entities) {
+            Q_ASSERT(entity);
+            QVariantList row;
+            for (const QMetaProperty &property : properties) {
+                const QVariant &variant { property.read(entity.data()) };
+                // same as `insert`, the values of TEXT fields are stored as string
+                row.append(SqliteHelper::typeString(variant.type()).contains("TEXT") ? QVariant { variant.toString() } : variant);
+            }
+            rows.append(row);
+        }
+
+        return excuteBatch("INSERT INTO " + SqliteHelper::tableName<T>()
+                                   + "(" + fmtFields + ") VALUES (" + fmtValues + ");",
+                           rows);
+    }
+
     // U: Update
     template<typename T>
     bool update(const Expression::SetExpr &setExpr, const Expression::Expr &whereExpr)
@@ -133,6 +171,18 @@ public:
                       + " WHERE " + whereExpr.toString());
     }
 
+    // Update many rows in one transaction, each row holds the values of `setFields` followed by the values of `whereFields`
+    template<typename T>
+    bool updateMany(const QStringList &setFields, const QStringList &whereFields, const QList<QVariantList> &rows)
+    {
+        static_assert(std::is_base_of<QObject, T>::value, "Template type T must be derived QObject");
+        Q_ASSERT(!setFields.isEmpty() && !whereFields.isEmpty());
+        return excuteBatch("UPDATE " + SqliteHelper::tableName<T>()
+                                   + " SET " + setFields.join("=?,") + "=?"
+                                   + " WHERE " + whereFields.join("=? AND ") + "=?;",
+                           rows);
+    }
+
     // R: Query
     template<typename T>
     SqliteQueryable<T> query()
@@ -165,6 +215,22 @@ public:
                       + " WHERE " + whereExpr.toString() + ";");
     }
 
+    // Delete many rows in one transaction, each row holds the values of `whereFields`
+    template<typename T>
+    bool removeMany(const QStringList &whereFields, const QList<QVariantList> &rows)
+    {
+        static_assert(std::is_base_of<QObject, T>::value, "Template type T must be derived QObject");
+        Q_ASSERT(!whereFields.isEmpty());
+        return excuteBatch("DELETE FROM " + SqliteHelper::tableName<T>()
+                                   + " WHERE " + whereFields.join("=? AND ") + "=?;",
+                           rows);
+    }
+
+    inline bool excuteBatch(const QString &sql, const QList<QVariantList> &rows)
+    {
+        return SqliteHelper::excuteBatch(databaseName, sql, rows, &lastExcutedSql);
+    }
+
     inline bool excute(const QString &sql, std::function<void(QSqlQuery *)> fn = nullptr)
     {
         return SqliteHelper::excute(databaseName, sql, &lastExcutedSql, fn);
@@ -465,6 +465,50 @@ public:
 
         return ret;
     }
+
+    // execute the prepared `sql` once for each row of the bound values in one transaction,
+    // a savepoint is used so that it works inside of SqliteHandle::transaction too
+    static inline bool excuteBatch(const QString &databaseName, const QString &sql, const QList<QVariantList> &rows, QString *lastQuery = nullptr)
+    {
+        if (lastQuery) {
+            *lastQuery = sql;
+            qCInfo(logDFMBase).noquote() << "SQL Batch:" << sql << "rows:" << rows.size();
+        }
+        if (rows.isEmpty())
+            return true;
+
+        QSqlDatabase db { SqliteConnectionPool::instance().openConnection(databaseName) };
+        QSqlQuery query;
+        if (!SqliteConnectionPool::instance().prepare(db, sql, &query))
+            return false;
+
+        QSqlQuery savepoint { db };
+        if (!savepoint.exec("SAVEPOINT batch")) {
+            qCWarning(logDFMBase).noquote() << "SQL Error: " << savepoint.lastError().text().trimmed();
+            return false;
+        }
+
+        bool ret { true };
+        for (const QVariantList &row : rows) {
+            for (int i = 0; i != row.size(); ++i)
+                query.bindValue(i, row.at(i));
+            if (!query.exec()) {
+                qCWarning(logDFMBase).noquote() << "SQL Error: " << query.lastError().text().trimmed();
+                ret = false;
+                break;
+            }
+        }
+        query.finish();
+
+        if (!ret)
+            savepoint.exec("ROLLBACK TO batch");
+        if (!savepoint.exec("RELEASE batch")) {
+            qCWarning(logDFMBase).noquote() << "SQL Error: " << savepoint.lastError().text().trimmed();
+            ret = false;
+        }
+
+        return ret;
+    }
 };
 
 DFMBASE_END_NAMESPACE
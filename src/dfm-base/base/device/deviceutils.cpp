@@ -12,6 +12,7 @@
 #include <dfm-base/utils/universalutils.h>
 #include <dfm-base/utils/networkutils.h>
 #include <dfm-base/base/device/deviceproxymanager.h>
+#include <dfm-base/base/device/private/mountindex.h>
 #include <dfm-base/dbusservice/global_server_defines.h>
 
 #include <dfm-io/dfile.h>
@@ -25,7 +26,6 @@
 #include <QSettings>
 
 #include <libmount.h>
-#include <fstab.h>
 #include <sys/stat.h>
 
 using namespace dfmbase;
@@ -377,31 +377,7 @@ bool DeviceUtils::parseSmbInfo(const QString &smbPath, QString &host, QString &s
 
 QMap<QString, QString> DeviceUtils::fstabBindInfo()
 {
-    // TODO(perf) this costs times when first painting. most of the time is spent on function 'stat'
-    static QMutex mutex;
-    static QMap<QString, QString> table;
-    struct stat statInfo;
-    int result = stat("/etc/fstab", &statInfo);
-
-    QMutexLocker locker(&mutex);
-    if (0 == result) {
-        static quint32 lastModify = 0;
-        if (lastModify != statInfo.st_mtime) {
-            lastModify = static_cast<quint32>(statInfo.st_mtime);
-            table.clear();
-            struct fstab *fs;
-
-            setfsent();
-            while ((fs = getfsent()) != nullptr) {
-                QString mntops(fs->fs_mntops);
-                if (mntops.contains("bind"))
-                    table.insert(fs->fs_spec, fs->fs_file);
-            }
-            endfsent();
-        }
-    }
-
-    return table;
+    return MountIndex::instance()->bindInfo();
 }
 
 QString DeviceUtils::nameOfSystemDisk(const QVariantMap &datas)
@@ -610,12 +586,24 @@ bool DeviceUtils::isLowSpeedDevice(const QUrl &url)
     if (!url.isValid())
         return false;
 
-    const QString &path = url.toLocalFile();
-    static const QString lowSpeedMountpoint { "(^/run/user/\\d+/gvfs/|^/root/.gvfs/|^/media/[\\s\\S]*/smbmounts)" };
     // TODO(xust) /media/$USER/smbmounts might be changed in the future.
-    QRegularExpression re { lowSpeedMountpoint };
-    QRegularExpressionMatch match { re.match(path) };
-    return match.hasMatch();
+    static const QRegularExpression lowSpeedMountpoint { "(^/run/user/\\d+/gvfs/|^/root/.gvfs/|^/media/[\\s\\S]*/smbmounts)" };
+    return lowSpeedMountpoint.match(url.toLocalFile()).hasMatch();
+}
+
+/*!
+ * \brief DeviceUtils::isOnLowSpeedFileSystem: the file is on a network file system (cifs, nfs, sshfs, davfs...)
+ * by the fs type of its mount, or on a gvfs/smb mount point which isLowSpeedDevice reports.
+ * The thumbnails of these files follow the remote thumbnail setting.
+ * \param url
+ * \return
+ */
+bool DeviceUtils::isOnLowSpeedFileSystem(const QUrl &url)
+{
+    if (!url.isValid())
+        return false;
+
+    return MountIndex::instance()->isLowSpeed(url.toLocalFile()) || isLowSpeedDevice(url);
 }
 
 /*!
@@ -626,36 +614,9 @@ bool DeviceUtils::isLowSpeedDevice(const QUrl &url)
  */
 QString DeviceUtils::getLongestMountRootPath(const QString &filePath)
 {
-    libmnt_table *tab { mnt_new_table() };
-    libmnt_iter *iter { mnt_new_iter(MNT_ITER_BACKWARD) };
-
-    FinallyUtil release([&] {
-        if (tab) mnt_free_table(tab);
-        if (iter) mnt_free_iter(iter);
-    });
-
-    int ret = mnt_table_parse_mtab(tab, nullptr);
-    if (ret != 0)
-        return "/";
-
-    QStringList mpts;
-    libmnt_fs *fs = nullptr;
-    while (mnt_table_next_fs(tab, iter, &fs) == 0) {
-        if (!fs)
-            continue;
-
-        const QString &target = mnt_fs_get_target(fs);
-        mpts.append(target == "/" ? "/" : target + "/");
-    }
-    std::sort(mpts.begin(), mpts.end(), [](const QString &a, const QString &b) { return a.length() > b.length(); });
-
-    QString path = filePath;
-    if (!path.endsWith("/"))
-        path.append("/");
-
-    auto found = std::find_if(mpts.cbegin(), mpts.cend(), [path](const QString &mpt) { return path.startsWith(mpt); });
-    return found != mpts.cend() ? *found : "/";
+    return MountIndex::instance()->mountRoot(filePath);
 }
+
 QString DeviceUtils::fileSystemType(const QUrl &url)
 {
     return DFMIO::DFMUtils::fsTypeFromUrl(url);
@@ -688,28 +649,7 @@ QString DeviceUtils::bindPathTransform(const QString &path, bool toDevice)
     if (!path.startsWith("/") || path == "/")
         return path;
 
-    const QMap<QString, QString> &table = DeviceUtils::fstabBindInfo();
-    if (table.isEmpty())
-        return path;
-
-    QString bindPath(path);
-    if (toDevice) {
-        for (const auto &mntPoint : table.values()) {
-            if (path.startsWith(mntPoint)) {
-                bindPath.replace(mntPoint, table.key(mntPoint));
-                break;
-            }
-        }
-    } else {
-        for (const auto &device : table.keys()) {
-            if (path.startsWith(device)) {
-                bindPath.replace(device, table[device]);
-                break;
-            }
-        }
-    }
-
-    return bindPath;
+    return MountIndex::instance()->bindPathTransform(path, toDevice);
 }
 
 bool DeviceUtils::isSystemDisk(const QVariantHash &devInfo)
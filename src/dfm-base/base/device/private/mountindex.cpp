@@ -0,0 +1,310 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "mountindex.h"
+
+#include <dfm-base/utils/finallyutil.h>
+
+#include <QDebug>
+
+#include <cerrno>
+#include <cstring>
+
+#include <libmount.h>
+#include <fstab.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+using namespace dfmbase;
+
+static constexpr char kMountInfoPath[] { "/proc/self/mountinfo" };
+
+MountTable::MountTable(const QVector<MountPoint> &mountPoints, const QMap<QString, QString> &fstabBinds)
+    : mounts(mountPoints), binds(fstabBinds)
+{
+    // the later mounted one covers the former on the same target
+    for (int i = 0; i < mounts.count(); ++i)
+        mountTrie.insert(mounts.at(i).target, i);
+
+    for (auto iter = binds.cbegin(); iter != binds.cend(); ++iter) {
+        bindSourceTrie.insert(iter.key(), bindPairs.count());
+        bindTargetTrie.insert(iter.value(), bindPairs.count());
+        bindPairs.append({ iter.key(), iter.value() });
+    }
+}
+
+const MountTable::MountPoint *MountTable::findMount(const QString &path) const
+{
+    int index = mountTrie.find(path);
+    return index >= 0 ? &mounts.at(index) : nullptr;
+}
+/*!
+ * \brief MountTable::bindPathTransform
+ * replace the longest matched bind prefix of `path`, only whole path components are matched,
+ * so `/homework` is not treated as a child of `/home`.
+ */
+QString MountTable::bindPathTransform(const QString &path, bool toDevice) const
+{
+    int length = 0;
+    int index = (toDevice ? bindTargetTrie : bindSourceTrie).find(path, &length);
+    if (index < 0)
+        return path;
+
+    QString prefix = toDevice ? bindPairs.at(index).first : bindPairs.at(index).second;
+    if (prefix.endsWith('/'))
+        prefix.chop(1);
+
+    const QString &bindPath = prefix + path.midRef(length);
+    return bindPath.isEmpty() ? QString("/") : bindPath;
+}
+
+const QMap<QString, QString> &MountTable::bindInfo() const
+{
+    return binds;
+}
+
+bool MountTable::isLowSpeedFileSystem(const QString &fsType)
+{
+    static const QStringList kLowSpeedTypes { "cifs", "smb3", "smbfs", "nfs", "nfs4",
+                                              "fuse.gvfsd-fuse", "fuse.sshfs", "fuse.curlftpfs", "davfs" };
+    return kLowSpeedTypes.contains(fsType);
+}
+
+void MountTable::PrefixTrie::insert(const QString &path, int value)
+{
+    int node = 0;
+    for (const QStringRef &part : path.splitRef('/', QString::SkipEmptyParts)) {
+        int next = -1;
+        for (const auto &child : nodes.at(node).children) {
+            if (child.first == part) {
+                next = child.second;
+                break;
+            }
+        }
+
+        if (next < 0) {
+            next = nodes.count();
+            nodes[node].children.append({ part.toString(), next });
+            nodes.append(Node());
+        }
+        node = next;
+    }
+    nodes[node].value = value;
+}
+/*!
+ * \brief MountTable::PrefixTrie::find
+ * \param path
+ * \param matchedLength: the length of the matched prefix in `path`
+ * \return the value of the longest matched prefix, -1 if nothing matched
+ */
+int MountTable::PrefixTrie::find(const QString &path, int *matchedLength) const
+{
+    int node = 0;
+    int found = nodes.at(0).value;
+    int length = 0;
+    for (const QStringRef &part : path.splitRef('/', QString::SkipEmptyParts)) {
+        int next = -1;
+        for (const auto &child : nodes.at(node).children) {
+            if (child.first == part) {
+                next = child.second;
+                break;
+            }
+        }
+
+        if (next < 0)
+            break;
+
+        node = next;
+        if (nodes.at(node).value >= 0) {
+            found = nodes.at(node).value;
+            length = part.position() + part.length();
+        }
+    }
+
+    if (matchedLength)
+        *matchedLength = length;
+    return found;
+}
+
+MountIndex *MountIndex::instance()
+{
+    static MountIndex ins;
+    return &ins;
+}
+
+/*!
+ * \brief MountIndex::mountRoot
+ * \return the mount point which `path` belongs to, ends with '/'
+ */
+QString MountIndex::mountRoot(const QString &path) const
+{
+    ReadGuard guard(this);
+    auto mpt = guard.table()->findMount(path);
+    if (!mpt || mpt->target == "/")
+        return "/";
+    return mpt->target + "/";
+}
+
+MountTable::MountPoint MountIndex::mountPoint(const QString &path) const
+{
+    ReadGuard guard(this);
+    auto mpt = guard.table()->findMount(path);
+    return mpt ? *mpt : MountTable::MountPoint();
+}
+
+bool MountIndex::isLowSpeed(const QString &path) const
+{
+    ReadGuard guard(this);
+    auto mpt = guard.table()->findMount(path);
+    return mpt && mpt->lowSpeed;
+}
+
+QString MountIndex::bindPathTransform(const QString &path, bool toDevice) const
+{
+    ReadGuard guard(this);
+    return guard.table()->bindPathTransform(path, toDevice);
+}
+
+QMap<QString, QString> MountIndex::bindInfo() const
+{
+    ReadGuard guard(this);
+    return guard.table()->bindInfo();
+}
+
+void MountIndex::refresh()
+{
+    publish(loadTable());
+}
+
+MountIndex::MountIndex()
+{
+    // open mountinfo before loading, so the changes during loading are reported
+    mountInfoFd = ::open(kMountInfoPath, O_RDONLY | O_CLOEXEC);
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+
+    publish(loadTable());
+
+    if (mountInfoFd < 0 || wakeFd < 0) {
+        qCWarning(logDFMBase) << "mount index: cannot watch" << kMountInfoPath << ", the index will not be refreshed";
+        return;
+    }
+    watcher = std::thread(&MountIndex::watch, this);
+}
+
+MountIndex::~MountIndex()
+{
+    if (watcher.joinable()) {
+        quint64 value = 1;
+        ssize_t ret = ::write(wakeFd, &value, sizeof(value));
+        Q_UNUSED(ret)
+        watcher.join();
+    }
+
+    if (mountInfoFd >= 0)
+        ::close(mountInfoFd);
+    if (wakeFd >= 0)
+        ::close(wakeFd);
+
+    delete current.load();
+    qDeleteAll(retired);
+}
+
+MountIndex::ReadGuard::ReadGuard(const MountIndex *index)
+    : index(index)
+{
+    // the counter must be visible before loading the table, see MountIndex::publish
+    index->readers.fetch_add(1);
+    current = index->current.load();
+}
+
+MountIndex::ReadGuard::~ReadGuard()
+{
+    index->readers.fetch_sub(1);
+}
+
+const MountTable *MountIndex::ReadGuard::table() const
+{
+    return current;
+}
+
+MountTable *MountIndex::loadTable()
+{
+    QVector<MountTable::MountPoint> mounts;
+    libmnt_table *tab { mnt_new_table() };
+    libmnt_iter *iter { mnt_new_iter(MNT_ITER_FORWARD) };
+    FinallyUtil release([&] {
+        if (tab) mnt_free_table(tab);
+        if (iter) mnt_free_iter(iter);
+    });
+
+    if (tab && iter && mnt_table_parse_mtab(tab, nullptr) == 0) {
+        libmnt_fs *fs = nullptr;
+        while (mnt_table_next_fs(tab, iter, &fs) == 0) {
+            if (!fs)
+                continue;
+
+            MountTable::MountPoint mpt;
+            mpt.target = mnt_fs_get_target(fs);
+            mpt.source = mnt_fs_get_source(fs);
+            mpt.fsType = mnt_fs_get_fstype(fs);
+            mpt.lowSpeed = MountTable::isLowSpeedFileSystem(mpt.fsType);
+            mounts.append(mpt);
+        }
+    } else {
+        qCWarning(logDFMBase) << "mount index: invalid mnt_table_parse_mtab call";
+    }
+
+    // bind mounts in fstab are mounted at boot, so reload it with the mount table
+    QMap<QString, QString> binds;
+    struct fstab *fs;
+    setfsent();
+    while ((fs = getfsent()) != nullptr) {
+        QString mntops(fs->fs_mntops);
+        if (mntops.contains("bind"))
+            binds.insert(fs->fs_spec, fs->fs_file);
+    }
+    endfsent();
+
+    return new MountTable(mounts, binds);
+}
+/*!
+ * \brief MountIndex::publish
+ * replace the current table, the replaced ones are released when no reader is active.
+ * a reader increases the counter before loading the table, so if the counter is zero after
+ * the exchange, the later readers can only see the new table.
+ */
+void MountIndex::publish(MountTable *table)
+{
+    QMutexLocker locker(&writeMutex);
+    const MountTable *old = current.exchange(table);
+    if (old)
+        retired.append(old);
+
+    if (readers.load() == 0) {
+        qDeleteAll(retired);
+        retired.clear();
+    }
+}
+
+void MountIndex::watch()
+{
+    pollfd fds[2] { { mountInfoFd, POLLPRI, 0 }, { wakeFd, POLLIN, 0 } };
+    while (true) {
+        int ret = ::poll(fds, 2, -1);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            qCWarning(logDFMBase) << "mount index: poll mountinfo failed:" << strerror(errno);
+            return;
+        }
+
+        if (fds[1].revents & POLLIN)
+            return;
+
+        if (fds[0].revents & (POLLPRI | POLLERR))
+            refresh();
+    }
+}
@@ -0,0 +1,120 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef MOUNTINDEX_H
+#define MOUNTINDEX_H
+
+#include <dfm-base/dfm_base_global.h>
+
+#include <QString>
+#include <QVector>
+#include <QMap>
+#include <QMutex>
+
+#include <atomic>
+#include <thread>
+
+namespace dfmbase {
+
+/*!
+ * \brief The MountTable class
+ * an immutable snapshot of the mount topology, mount points and the bind mappings of /etc/fstab
+ * are stored in tries keyed by path components, so the longest prefix is found in one walk.
+ */
+class MountTable
+{
+public:
+    struct MountPoint
+    {
+        QString target;
+        QString source;
+        QString fsType;
+        bool lowSpeed { false };
+    };
+
+    MountTable(const QVector<MountPoint> &mountPoints, const QMap<QString, QString> &fstabBinds);
+
+    const MountPoint *findMount(const QString &path) const;
+    QString bindPathTransform(const QString &path, bool toDevice) const;
+    const QMap<QString, QString> &bindInfo() const;
+
+    static bool isLowSpeedFileSystem(const QString &fsType);
+
+private:
+    class PrefixTrie
+    {
+    public:
+        void insert(const QString &path, int value);
+        int find(const QString &path, int *matchedLength = nullptr) const;
+
+    private:
+        struct Node
+        {
+            QVector<QPair<QString, int>> children;
+            int value { -1 };
+        };
+        QVector<Node> nodes { 1 };
+    };
+
+    QVector<MountPoint> mounts;
+    PrefixTrie mountTrie;
+    QMap<QString, QString> binds;
+    QVector<QPair<QString, QString>> bindPairs;
+    PrefixTrie bindSourceTrie;
+    PrefixTrie bindTargetTrie;
+};
+
+/*!
+ * \brief The MountIndex class
+ * process-wide mount index, rebuilt in a watcher thread when /proc/self/mountinfo reports
+ * a change through POLLPRI. Lookups do not take any lock, replaced tables are released
+ * after all of the readers left.
+ */
+class MountIndex
+{
+public:
+    static MountIndex *instance();
+
+    QString mountRoot(const QString &path) const;
+    MountTable::MountPoint mountPoint(const QString &path) const;
+    bool isLowSpeed(const QString &path) const;
+    QString bindPathTransform(const QString &path, bool toDevice) const;
+    QMap<QString, QString> bindInfo() const;
+
+    void refresh();
+
+private:
+    MountIndex();
+    ~MountIndex();
+
+    class ReadGuard
+    {
+    public:
+        explicit ReadGuard(const MountIndex *index);
+        ~ReadGuard();
+        const MountTable *table() const;
+
+    private:
+        const MountIndex *index;
+        const MountTable *current;
+    };
+
+    static MountTable *loadTable();
+    void publish(MountTable *table);
+    void watch();
+
+private:
+    std::atomic<const MountTable *> current { nullptr };
+    mutable std::atomic<int> readers { 0 };
+    QMutex writeMutex;
+    QVector<const MountTable *> retired;
+
+    int mountInfoFd { -1 };
+    int wakeFd { -1 };
+    std::thread watcher;
+};
+
+}   // namespace dfmbase
+
+#endif   // MOUNTINDEX_H
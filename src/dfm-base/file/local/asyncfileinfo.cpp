@@ -95,8 +95,7 @@ void AsyncFileInfo::refresh()
 
 void AsyncFileInfo::cacheAttribute(DFileInfo::AttributeID id, const QVariant &value)
 {
-    QWriteLocker locker(&d->lock);
-    d->cacheAsyncAttributes.insert(static_cast<FileInfo::FileInfoAttributeID>(id), value);
+    d->cacheAsyncAttributes.set(static_cast<FileInfo::FileInfoAttributeID>(id), value);
 }
 
 QString AsyncFileInfo::nameOf(const NameInfoType type) const
@@ -1008,7 +1007,6 @@ QVariant AsyncFileInfoPrivate::attribute(DFileInfo::AttributeID key, bool *ok) c
 
 QVariant AsyncFileInfoPrivate::asyncAttribute(FileInfo::FileInfoAttributeID key) const
 {
-    QReadLocker lk(&const_cast<AsyncFileInfoPrivate *>(this)->lock);
     return cacheAsyncAttributes.value(key);
 }
 
@@ -1076,11 +1074,8 @@ FileInfo::FileType AsyncFileInfoPrivate::fileType() const
 int AsyncFileInfoPrivate::cacheAllAttributes()
 {
     assert(qApp->thread() != QThread::currentThread());
-    QMap<FileInfo::FileInfoAttributeID, QVariant> tmp, cacheTmp;
-    {
-        QReadLocker lk(&lock);
-        cacheTmp = cacheAsyncAttributes;
-    }
+    QMap<FileInfo::FileInfoAttributeID, QVariant> tmp;
+    const bool firstCache = cacheAsyncAttributes.isEmpty();
     {
         QWriteLocker lk(&changesLock);
         changesAttributes.clear();
@@ -1166,13 +1161,12 @@ int AsyncFileInfoPrivate::cacheAllAttributes()
         QWriteLocker rlk(&iconLock);
         fileIcon = QIcon();
     }
-    if (cacheTmp.isEmpty()) {
+    if (firstCache) {
         {
-            QWriteLocker lk(&lock);
             QVariant hid = cacheAsyncAttributes.value(FileInfo::FileInfoAttributeID::kStandardIsHidden);
-            cacheAsyncAttributes = tmp;
             if (notInit && hid.isValid())
-                cacheAsyncAttributes.insert(FileInfo::FileInfoAttributeID::kStandardIsHidden, hid);
+                tmp.insert(FileInfo::FileInfoAttributeID::kStandardIsHidden, hid);
+            cacheAsyncAttributes.assign(tmp);
         }
         // kMimeTypeName
         fileMimeTypeAsync();
@@ -1199,11 +1193,7 @@ int AsyncFileInfoPrivate::cacheAllAttributes()
 
 bool AsyncFileInfoPrivate::inserAsyncAttribute(const FileInfo::FileInfoAttributeID id, const QVariant &value)
 {
-    QWriteLocker lk(&lock);
-    if (cacheAsyncAttributes.value(id) == value || !value.isValid())
-        return false;
-    cacheAsyncAttributes.insert(id, value);
-    return true;
+    return cacheAsyncAttributes.insert(id, value);
 }
 
 void AsyncFileInfoPrivate::fileMimeTypeAsync(QMimeDatabase::MatchMode mode)
@@ -1219,7 +1209,7 @@ void AsyncFileInfoPrivate::fileMimeTypeAsync(QMimeDatabase::MatchMode mode)
 
 void AsyncFileInfoPrivate::updateThumbnail(const QUrl &url)
 {
-    ThumbnailFactory::instance()->joinThumbnailJob(url, Global::kLarge);
+    ThumbnailFactory::instance()->joinThumbnailJob(url, Global::kLarge, Global::ThumbnailPriority::kBackground);
 }
 
 QIcon AsyncFileInfoPrivate::updateIcon()
@@ -1263,7 +1253,6 @@ void AsyncFileInfoPrivate::updateMediaInfo(const DFileInfo::MediaType type, cons
 
 bool AsyncFileInfoPrivate::hasAsyncAttribute(FileInfo::FileInfoAttributeID key)
 {
-    QReadLocker lk(&lock);
     return cacheAsyncAttributes.contains(key);
 }
 
@@ -0,0 +1,367 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fileattributestore.h"
+
+#include <dfm-io/dfile.h>
+
+#include <QThread>
+
+USING_IO_NAMESPACE
+using namespace dfmbase;
+
+FileAttributeStore::FileAttributeStore()
+{
+    for (int i = 0; i < kNumberSlotCount; ++i) {
+        numbers[i].store(0, std::memory_order_relaxed);
+        codes[i].store(kAbsent, std::memory_order_relaxed);
+    }
+}
+/*!
+ * \brief FileAttributeStore::value 获取属性值
+ * \param id 属性id
+ * \return 属性不存在时返回无效的QVariant
+ */
+QVariant FileAttributeStore::value(const AttributeID id) const
+{
+    const int numberSlot = numberSlotOf(id);
+    if (numberSlot >= 0) {
+        quint64 bits { 0 };
+        const quint8 code = readNumber(numberSlot, &bits);
+        if (code != kOverflow)
+            return decode(code, bits);
+    }
+
+    QReadLocker lk(&lock);
+    return valueLocked(id);
+}
+
+bool FileAttributeStore::contains(const AttributeID id) const
+{
+    const int numberSlot = numberSlotOf(id);
+    if (numberSlot >= 0)
+        return codes[numberSlot].load(std::memory_order_acquire) != kAbsent;
+
+    QReadLocker lk(&lock);
+    const int stringSlot = stringSlotOf(id);
+    if (stringSlot >= 0 && (stringMask & (1 << stringSlot)))
+        return true;
+
+    return otherIndexOf(id) >= 0;
+}
+
+bool FileAttributeStore::isEmpty() const
+{
+    QReadLocker lk(&lock);
+    if (stringMask != 0 || !others.isEmpty())
+        return false;
+
+    for (const auto &code : codes) {
+        if (code.load(std::memory_order_relaxed) != kAbsent)
+            return false;
+    }
+    return true;
+}
+/*!
+ * \brief FileAttributeStore::insert 插入属性值，无效值或者与现有值相同时不插入
+ * \param id 属性id
+ * \param value 属性值
+ * \return 属性值是否发生了改变
+ */
+bool FileAttributeStore::insert(const AttributeID id, const QVariant &value)
+{
+    if (!value.isValid())
+        return false;
+
+    QWriteLocker lk(&lock);
+    if (valueLocked(id) == value)
+        return false;
+
+    beginWrite();
+    setLocked(id, value);
+    endWrite();
+    return true;
+}
+
+void FileAttributeStore::set(const AttributeID id, const QVariant &value)
+{
+    QWriteLocker lk(&lock);
+    beginWrite();
+    setLocked(id, value);
+    endWrite();
+}
+/*!
+ * \brief FileAttributeStore::assign 用attributes替换所有的属性
+ * \param attributes 新的属性
+ */
+void FileAttributeStore::assign(const QMap<AttributeID, QVariant> &attributes)
+{
+    QWriteLocker lk(&lock);
+    beginWrite();
+    clearLocked();
+    for (auto it = attributes.cbegin(); it != attributes.cend(); ++it)
+        setLocked(it.key(), it.value());
+    endWrite();
+}
+
+void FileAttributeStore::clear()
+{
+    QWriteLocker lk(&lock);
+    beginWrite();
+    clearLocked();
+    endWrite();
+}
+
+int FileAttributeStore::numberSlotOf(const AttributeID id)
+{
+    switch (id) {
+    case AttributeID::kStandardIsHidden:
+        return 0;
+    case AttributeID::kStandardIsSymlink:
+        return 1;
+    case AttributeID::kStandardSize:
+        return 2;
+    case AttributeID::kStandardFileExists:
+        return 3;
+    case AttributeID::kStandardIsLocalDevice:
+        return 4;
+    case AttributeID::kStandardIsCdRomDevice:   // 与kStandardFileType的值相同
+        return 5;
+    case AttributeID::kAccessCanRead:
+        return 6;
+    case AttributeID::kAccessCanWrite:
+        return 7;
+    case AttributeID::kAccessCanExecute:
+        return 8;
+    case AttributeID::kAccessCanDelete:
+        return 9;
+    case AttributeID::kAccessCanTrash:
+        return 10;
+    case AttributeID::kAccessCanRename:
+        return 11;
+    case AttributeID::kAccessPermissions:
+        return 12;
+    case AttributeID::kTimeModified:
+        return 13;
+    case AttributeID::kTimeModifiedUsec:
+        return 14;
+    case AttributeID::kTimeAccess:
+        return 15;
+    case AttributeID::kTimeAccessUsec:
+        return 16;
+    case AttributeID::kTimeChanged:
+        return 17;
+    case AttributeID::kTimeChangedUsec:
+        return 18;
+    case AttributeID::kTimeCreated:
+        return 19;
+    case AttributeID::kTimeCreatedUsec:
+        return 20;
+    case AttributeID::kUnixInode:
+        return 21;
+    case AttributeID::kUnixMode:
+        return 22;
+    case AttributeID::kUnixUID:
+        return 23;
+    case AttributeID::kUnixGID:
+        return 24;
+    case AttributeID::kStandardIsFile:
+        return 25;
+    case AttributeID::kStandardIsDir:
+        return 26;
+    default:
+        return -1;
+    }
+}
+
+int FileAttributeStore::stringSlotOf(const AttributeID id)
+{
+    switch (id) {
+    case AttributeID::kStandardName:
+        return 0;
+    case AttributeID::kStandardDisplayName:
+        return 1;
+    case AttributeID::kStandardContentType:
+        return 2;
+    case AttributeID::kStandardSymlinkTarget:
+        return 3;
+    case AttributeID::kOwnerUser:
+        return 4;
+    case AttributeID::kOwnerGroup:
+        return 5;
+    case AttributeID::kStandardFilePath:
+        return 6;
+    case AttributeID::kStandardParentPath:
+        return 7;
+    case AttributeID::kStandardCompleteSuffix:
+        return 8;
+    case AttributeID::kStandardCompleteBaseName:
+        return 9;
+    case AttributeID::kStandardIcon:
+        return 10;
+    default:
+        return -1;
+    }
+}
+
+FileAttributeStore::ValueCode FileAttributeStore::encode(const QVariant &value, quint64 *bits)
+{
+    const int type = value.userType();
+    switch (type) {
+    case QMetaType::Bool:
+        *bits = value.toBool() ? 1 : 0;
+        return kBool;
+    case QMetaType::Int:
+        *bits = static_cast<quint64>(static_cast<qint64>(value.toInt()));
+        return kInt;
+    case QMetaType::UInt:
+        *bits = value.toUInt();
+        return kUInt;
+    case QMetaType::LongLong:
+        *bits = static_cast<quint64>(value.toLongLong());
+        return kLongLong;
+    case QMetaType::ULongLong:
+        *bits = value.toULongLong();
+        return kULongLong;
+    default:
+        break;
+    }
+
+    if (type == qMetaTypeId<FileInfo::FileType>()) {
+        *bits = static_cast<quint64>(value.value<FileInfo::FileType>());
+        return kFileType;
+    }
+    if (type == qMetaTypeId<DFile::Permissions>()) {
+        *bits = static_cast<quint64>(static_cast<int>(value.value<DFile::Permissions>()));
+        return kPermissions;
+    }
+
+    *bits = 0;
+    return kOverflow;
+}
+
+QVariant FileAttributeStore::decode(const quint8 code, const quint64 bits)
+{
+    switch (code) {
+    case kBool:
+        return QVariant(bits != 0);
+    case kInt:
+        return QVariant(static_cast<int>(static_cast<qint64>(bits)));
+    case kUInt:
+        return QVariant(static_cast<uint>(bits));
+    case kLongLong:
+        return QVariant(static_cast<qlonglong>(bits));
+    case kULongLong:
+        return QVariant(static_cast<qulonglong>(bits));
+    case kFileType:
+        return QVariant::fromValue(static_cast<FileInfo::FileType>(bits));
+    case kPermissions:
+        return QVariant::fromValue(DFile::Permissions(static_cast<int>(bits)));
+    default:
+        return QVariant();
+    }
+}
+
+void FileAttributeStore::beginWrite()
+{
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void FileAttributeStore::endWrite()
+{
+    sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+QVariant FileAttributeStore::valueLocked(const AttributeID id) const
+{
+    const int numberSlot = numberSlotOf(id);
+    if (numberSlot >= 0) {
+        const quint8 code = codes[numberSlot].load(std::memory_order_relaxed);
+        if (code != kOverflow)
+            return decode(code, numbers[numberSlot].load(std::memory_order_relaxed));
+    }
+
+    const int stringSlot = stringSlotOf(id);
+    if (stringSlot >= 0 && (stringMask & (1 << stringSlot)))
+        return strings[stringSlot];
+
+    const int index = otherIndexOf(id);
+    return index >= 0 ? others.at(index).second : QVariant();
+}
+/*!
+ * \brief FileAttributeStore::setLocked 设置属性值，调用者需持有写锁并处于beginWrite和endWrite之间
+ */
+void FileAttributeStore::setLocked(const AttributeID id, const QVariant &value)
+{
+    const int index = otherIndexOf(id);
+    if (index >= 0)
+        others.remove(index);
+
+    const int numberSlot = numberSlotOf(id);
+    if (numberSlot >= 0) {
+        quint64 bits { 0 };
+        const ValueCode code = encode(value, &bits);
+        if (code == kOverflow)
+            others.append({ id, value });
+        numbers[numberSlot].store(bits, std::memory_order_relaxed);
+        codes[numberSlot].store(code, std::memory_order_relaxed);
+        return;
+    }
+
+    const int stringSlot = stringSlotOf(id);
+    if (stringSlot >= 0) {
+        if (value.userType() == QMetaType::QString) {
+            strings[stringSlot] = value.toString();
+            stringMask |= static_cast<quint16>(1 << stringSlot);
+            return;
+        }
+        strings[stringSlot].clear();
+        stringMask &= static_cast<quint16>(~(1 << stringSlot));
+    }
+
+    others.append({ id, value });
+}
+
+void FileAttributeStore::clearLocked()
+{
+    for (int i = 0; i < kNumberSlotCount; ++i) {
+        numbers[i].store(0, std::memory_order_relaxed);
+        codes[i].store(kAbsent, std::memory_order_relaxed);
+    }
+    for (auto &str : strings)
+        str.clear();
+    stringMask = 0;
+    others.clear();
+}
+/*!
+ * \brief FileAttributeStore::readNumber 以seqlock的方式读取数值属性，写入过程中读到的数据会被丢弃重读
+ * \param slot 数值属性的位置
+ * \param bits 数值
+ * \return 数值的类型
+ */
+quint8 FileAttributeStore::readNumber(const int slot, quint64 *bits) const
+{
+    forever {
+        const quint32 begin = sequence.load(std::memory_order_acquire);
+        if (begin & 1) {
+            QThread::yieldCurrentThread();
+            continue;
+        }
+
+        const quint8 code = codes[slot].load(std::memory_order_relaxed);
+        *bits = numbers[slot].load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == begin)
+            return code;
+    }
+}
+
+int FileAttributeStore::otherIndexOf(const AttributeID id) const
+{
+    for (int i = 0; i < others.size(); ++i) {
+        if (others.at(i).first == id)
+            return i;
+    }
+    return -1;
+}
@@ -0,0 +1,88 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FILEATTRIBUTESTORE_H
+#define FILEATTRIBUTESTORE_H
+
+#include <dfm-base/dfm_base_global.h>
+#include <dfm-base/interfaces/fileinfo.h>
+
+#include <QReadWriteLock>
+#include <QVariant>
+#include <QVector>
+#include <QPair>
+#include <QMap>
+
+#include <array>
+#include <atomic>
+
+namespace dfmbase {
+
+/*!
+ * \brief The FileAttributeStore class 文件信息属性的紧凑存储
+ *
+ * 常用的数值属性（大小、时间、权限、类型标记等）以定长数组保存，读取走seqlock不加锁；
+ * 常用的字符串属性（名称、路径、类型等）以QString数组保存，只在读写时加读写锁；
+ * 其余少见的属性才用QVariant保存在一个小的顺序表中。
+ * 接口与QMap<FileInfoAttributeID, QVariant>保持一致，取出的QVariant与存入时类型相同。
+ */
+class FileAttributeStore
+{
+    Q_DISABLE_COPY(FileAttributeStore)
+
+public:
+    using AttributeID = FileInfo::FileInfoAttributeID;
+
+    FileAttributeStore();
+
+    QVariant value(const AttributeID id) const;
+    bool contains(const AttributeID id) const;
+    bool isEmpty() const;
+    bool insert(const AttributeID id, const QVariant &value);
+    void set(const AttributeID id, const QVariant &value);
+    void assign(const QMap<AttributeID, QVariant> &attributes);
+    void clear();
+
+    static int numberSlotOf(const AttributeID id);
+    static int stringSlotOf(const AttributeID id);
+
+private:
+    enum ValueCode : quint8 {
+        kAbsent = 0,
+        kOverflow,   // 类型不是数值，保存在others中
+        kBool,
+        kInt,
+        kUInt,
+        kLongLong,
+        kULongLong,
+        kFileType,
+        kPermissions,
+    };
+
+    static constexpr int kNumberSlotCount { 27 };
+    static constexpr int kStringSlotCount { 11 };
+
+    static ValueCode encode(const QVariant &value, quint64 *bits);
+    static QVariant decode(const quint8 code, const quint64 bits);
+
+    void beginWrite();
+    void endWrite();
+    QVariant valueLocked(const AttributeID id) const;
+    void setLocked(const AttributeID id, const QVariant &value);
+    void clearLocked();
+    quint8 readNumber(const int slot, quint64 *bits) const;
+    int otherIndexOf(const AttributeID id) const;
+
+private:
+    mutable QReadWriteLock lock;   // 保护strings和others，同时串行化所有写操作
+    std::atomic<quint32> sequence { 0 };   // 数值属性的seqlock序号，奇数表示正在写
+    std::array<std::atomic<quint64>, kNumberSlotCount> numbers;
+    std::array<std::atomic<quint8>, kNumberSlotCount> codes;
+    std::array<QString, kStringSlotCount> strings;
+    quint16 stringMask { 0 };
+    QVector<QPair<AttributeID, QVariant>> others;
+};
+}
+
+#endif   // FILEATTRIBUTESTORE_H
@@ -48,6 +48,7 @@ public:
     QSharedPointer<InfoDataFuture> mediaFuture { nullptr };
     InfoHelperUeserDataPointer fileMimeTypeFuture { nullptr };
     QMap<DFMIO::DFileInfo::AttributeID, QVariant> cacheAttributes;
+    std::atomic_bool hasCacheAttributes { false };
 
 public:
     explicit SyncFileInfoPrivate(SyncFileInfo *qq);
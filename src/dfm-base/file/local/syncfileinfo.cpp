@@ -125,6 +125,7 @@ void SyncFileInfo::refresh()
     d->mimeType = QMimeType();
     d->mimeTypeMode = QMimeDatabase::MatchDefault;
     d->cacheAttributes.clear();
+    d->hasCacheAttributes = false;
     d->fileIcon = QIcon();
 }
 
@@ -132,6 +133,7 @@ void SyncFileInfo::cacheAttribute(DFileInfo::AttributeID id, const QVariant &val
 {
     QWriteLocker locker(&d->lock);
     d->cacheAttributes.insert(id, value);
+    d->hasCacheAttributes = true;
 }
 
 QString SyncFileInfo::nameOf(const NameInfoType type) const
@@ -548,7 +550,7 @@ void SyncFileInfo::updateAttributes(const QList<FileInfo::FileInfoAttributeID> &
     // 更新缩略图
     if (typeAll.contains(FileInfoAttributeID::kThumbnailIcon)) {
         typeAll.removeOne(FileInfoAttributeID::kThumbnailIcon);
-        ThumbnailFactory::instance()->joinThumbnailJob(url, Global::kLarge);
+        ThumbnailFactory::instance()->joinThumbnailJob(url, Global::kLarge, Global::ThumbnailPriority::kBackground);
     }
 
     // 更新filetype
@@ -997,7 +999,8 @@ QVariant SyncFileInfoPrivate::attribute(DFileInfo::AttributeID key, bool *ok) co
 {
     auto tmp = dfmFileInfo;
     if (tmp) {
-        {
+        // 绝大多数文件没有缓存的属性，此时不需要加锁查询
+        if (hasCacheAttributes) {
             QReadLocker locker(&const_cast<SyncFileInfoPrivate *>(this)->lock);
             if (cacheAttributes.count(key) > 0) {
                 if (ok)
@@ -4,61 +4,110 @@
 
 #include "chinese2pinyin.h"
 
-#include <QHash>
-#include <QTextStream>
-#include <QFile>
+#include <array>
 
 namespace Pinyin {
 
-static QHash<uint, QString> dict = {};
+namespace {
+
+struct Syllable {
+    char text[8];
+};
+
+struct DictEntry {
+    char16_t code;
+    Syllable pinyin;
+};
+
+// generated from qrc/chinese2pinyin/pinyin.dict at build time
+constexpr DictEntry kDictEntries[] = {
+#include "pinyindict.inc"
+};
+
+// the dictionary covers the CJK Unified Ideographs (with Extension A) and the CJK Compatibility Ideographs
+constexpr char16_t kUnifiedFirst = 0x3400;
+constexpr char16_t kUnifiedLast = 0x9fff;
+constexpr char16_t kCompatibilityFirst = 0xf900;
+constexpr char16_t kCompatibilityLast = 0xfaff;
+constexpr int kUnifiedCount = kUnifiedLast - kUnifiedFirst + 1;
+constexpr int kTableSize = kUnifiedCount + kCompatibilityLast - kCompatibilityFirst + 1;
+
+constexpr int tableIndex(char16_t code) {
+    if (code >= kUnifiedFirst && code <= kUnifiedLast)
+        return code - kUnifiedFirst;
+    if (code >= kCompatibilityFirst && code <= kCompatibilityLast)
+        return kUnifiedCount + code - kCompatibilityFirst;
+    return -1;
+}
 
-const char kDictFile[] = ":/misc/pinyin.dict";
+constexpr std::array<Syllable, kTableSize> makeTable() {
+    std::array<Syllable, kTableSize> table {};
+    for (const DictEntry &entry : kDictEntries)
+        table[static_cast<size_t>(tableIndex(entry.code))] = entry.pinyin;
+    return table;
+}
 
-void InitDict() {
-    if (!dict.isEmpty()) {
-        return;
+constexpr bool isDictCovered() {
+    for (const DictEntry &entry : kDictEntries) {
+        if (tableIndex(entry.code) < 0)
+            return false;
     }
+    return true;
+}
 
-    dict.reserve(25333);
-
-    QFile file(kDictFile);
-
-    if (!file.open(QIODevice::ReadOnly))
-        return;
-
-    QByteArray content = file.readAll();
-
-    file.close();
-
-    QTextStream stream(&content, QIODevice::ReadOnly);
+static_assert(isDictCovered(), "pinyin.dict has characters out of the ranges of the table");
 
-    while (!stream.atEnd()) {
-        const QString line = stream.readLine();
-        const QStringList items = line.split(QChar(':'));
+// the direct indexed table, read only and built by the compiler, so there is nothing to initialize
+constexpr std::array<Syllable, kTableSize> kTable = makeTable();
 
-        if (items.size() == 2) {
-            dict.insert(static_cast<uint>(items[0].toInt(nullptr, 16)), items[1]);
-        }
-    }
+inline const char *pinyinOf(ushort code) {
+    const int index = tableIndex(static_cast<char16_t>(code));
+    if (index < 0 || kTable[static_cast<size_t>(index)].text[0] == '\0')
+        return nullptr;
+    return kTable[static_cast<size_t>(index)].text;
 }
 
-QString Chinese2Pinyin(const QString& words) {
-    InitDict();
+}  // namespace
 
+QString Chinese2Pinyin(const QString& words) {
     QString result;
+    Chinese2Pinyin(words, &result);
+    return result;
+}
 
-    for (int i = 0; i < words.length(); ++i) {
-        const uint key = words.at(i).unicode();
-        auto find_result = dict.find(key);
-
-        if (find_result != dict.end()) {
-            result.append(find_result.value());
+void Chinese2Pinyin(const QString& words, QString *result) {
+    const ushort *codes = words.utf16();
+    const int length = words.length();
+
+    // the names without chinese are shared rather than copied
+    int resultLength = 0;
+    bool hasPinyin = false;
+    for (int i = 0; i < length; ++i) {
+        const char *pinyin = pinyinOf(codes[i]);
+        if (pinyin) {
+            hasPinyin = true;
+            resultLength += static_cast<int>(qstrlen(pinyin));
         } else {
-            result.append(words.at(i));
+            ++resultLength;
         }
     }
 
-    return result;
+    if (!hasPinyin) {
+        *result = words;
+        return;
+    }
+
+    result->resize(resultLength);
+    QChar *out = result->data();
+    for (int i = 0; i < length; ++i) {
+        const char *pinyin = pinyinOf(codes[i]);
+        if (!pinyin) {
+            *out++ = QChar(codes[i]);
+            continue;
+        }
+        while (*pinyin)
+            *out++ = QLatin1Char(*pinyin++);
+    }
 }
 
 }  // namespace Pinyin end
@@ -9,6 +9,8 @@
 
 namespace Pinyin {
 QString Chinese2Pinyin(const QString& words);
+// for transliterating many names, `result` is reused and not reallocated while it is large enough
+void Chinese2Pinyin(const QString& words, QString *result);
 };
 
 #endif  // CHINESE_2_PINYIN_H
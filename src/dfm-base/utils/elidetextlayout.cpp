@@ -10,12 +10,129 @@
 #include <QTextDocument>
 #include <QTextLayout>
 #include <QTextBlock>
+#include <QGlyphRun>
+#include <QFontDatabase>
+#include <QGuiApplication>
+#include <QScreen>
+#include <QThread>
+#include <QCache>
+#include <QMutex>
+#include <QtConcurrent>
 #include <QDebug>
 
 #include <dfm-base/dfm_base_global.h>
 
+#include <climits>
+#include <cmath>
+
 using namespace dfmbase;
 
+static constexpr int kLayoutCacheSize { 4096 };   // layouts, about the items of a few screens of every view
+
+struct ElideTextLayout::LayoutLines
+{
+    QList<QRectF> rects;   // relative to the top left of the layout rect
+    QStringList texts;
+    QList<qreal> widths;
+    QList<QList<QGlyphRun>> glyphRuns;   // the glyph runs are bound to the font engines of the gui thread
+};
+
+namespace {
+struct LayoutKey
+{
+    QString text;
+    QString font;
+    qreal width;
+    int lineLimit;
+    int elideMode;
+    int lineHeight;
+    uint alignment;
+    uint wrapMode;
+    int direction;
+};
+
+bool operator==(const LayoutKey &a, const LayoutKey &b)
+{
+    return a.text == b.text && a.font == b.font && a.width == b.width
+            && a.lineLimit == b.lineLimit && a.elideMode == b.elideMode && a.lineHeight == b.lineHeight
+            && a.alignment == b.alignment && a.wrapMode == b.wrapMode && a.direction == b.direction;
+}
+
+uint qHash(const LayoutKey &key, uint seed = 0)
+{
+    return ::qHash(key.text, seed) ^ ::qHash(key.font) ^ ::qHash(qRound(key.width * 64))
+            ^ ::qHash((key.lineLimit << 8) | (key.elideMode << 4) | key.direction) ^ ::qHash(key.lineHeight)
+            ^ ::qHash((key.alignment << 8) | key.wrapMode);
+}
+
+bool isGuiThread()
+{
+    return qApp && QThread::currentThread() == qApp->thread();
+}
+
+class LayoutCache
+{
+public:
+    static LayoutCache *instance()
+    {
+        static LayoutCache cache;
+        return &cache;
+    }
+
+    bool find(const LayoutKey &key, ElideTextLayout::LayoutLines *lines)
+    {
+        QMutexLocker lk(&mutex);
+        if (auto cached = layouts.object(key)) {
+            *lines = *cached;
+            return true;
+        }
+        return false;
+    }
+
+    // the layouts made before a clear are dropped
+    void insert(const LayoutKey &key, const ElideTextLayout::LayoutLines &lines, quint64 generation)
+    {
+        QMutexLocker lk(&mutex);
+        if (generation == currentGeneration)
+            layouts.insert(key, new ElideTextLayout::LayoutLines(lines));
+    }
+
+    quint64 generation()
+    {
+        QMutexLocker lk(&mutex);
+        return currentGeneration;
+    }
+
+    void clear()
+    {
+        QMutexLocker lk(&mutex);
+        layouts.clear();
+        ++currentGeneration;
+    }
+
+private:
+    LayoutCache()
+        : layouts(kLayoutCacheSize)
+    {
+        if (!qGuiApp)
+            return;
+
+        // the lines depend on the metrics of the fonts, which change with the font and the dpi
+        QObject::connect(qGuiApp, &QGuiApplication::fontChanged, qGuiApp, [this] { clear(); });
+        auto watchScreen = [this](QScreen *screen) {
+            QObject::connect(screen, &QScreen::logicalDotsPerInchChanged, qGuiApp, [this] { clear(); });
+        };
+        for (QScreen *screen : qGuiApp->screens())
+            watchScreen(screen);
+        QObject::connect(qGuiApp, &QGuiApplication::screenAdded, qGuiApp, watchScreen);
+    }
+
+    QMutex mutex;
+    QCache<LayoutKey, ElideTextLayout::LayoutLines> layouts;
+    quint64 currentGeneration { 0 };
+};
+}
+
 ElideTextLayout::ElideTextLayout(const QString &text)
     : document(new QTextDocument)
 {
@@ -46,6 +163,80 @@ QString ElideTextLayout::text() const
 }
 
 QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background, QStringList *textLines)
+{
+    // the objects inserted into the document are not in the key
+    if (!cacheable)
+        return layoutDocument(rect, elideMode, painter, background, textLines, nullptr);
+
+    const LayoutKey key { text(), attribute<QFont>(kFont).key(), rect.width(), lineLimit(rect.height()), elideMode,
+                          attribute<int>(kLineHeight), attribute<uint>(kAlignment), attribute<uint>(kWrapMode),
+                          static_cast<int>(attribute<Qt::LayoutDirection>(kTextDirection)) };
+    LayoutCache *cache = LayoutCache::instance();
+    const quint64 generation = cache->generation();
+
+    LayoutLines lines;
+    if (!cache->find(key, &lines)) {
+        layoutDocument(QRectF(QPointF(0, 0), rect.size()), elideMode, nullptr, Qt::NoBrush, nullptr, &lines);
+        cache->insert(key, lines, generation);
+    } else if (painter && lines.glyphRuns.size() != lines.texts.size()) {
+        // prefetched in a thread of the pool, only the lines are known
+        shapeLines(&lines);
+        if (isGuiThread())
+            cache->insert(key, lines, generation);
+    }
+
+    QList<QRectF> ret;
+    QRectF lastLineRect;
+    const QPointF &offset = rect.topLeft();
+    for (int i = 0; i < lines.rects.size(); ++i) {
+        const QRectF &lRect = lines.rects.at(i).translated(offset);
+        ret.append(lRect);
+
+        if (painter) {
+            // draw background
+            if (background.style() != Qt::NoBrush) {
+                lastLineRect = drawLineBackground(painter, lRect, lastLineRect, background);
+            }
+
+            // draw text line
+            for (const QGlyphRun &run : lines.glyphRuns.value(i))
+                painter->drawGlyphRun(offset, run);
+        }
+    }
+
+    if (textLines)
+        textLines->append(lines.texts);
+
+    return ret;
+}
+
+void ElideTextLayout::prefetch(const QStringList &texts, const QSizeF &size, Qt::TextElideMode elideMode) const
+{
+    if (!cacheable || texts.isEmpty() || !QFontDatabase::supportsThreadedFontRendering())
+        return;
+
+    // created in the gui thread to watch the font and the screens
+    LayoutCache::instance();
+
+    const auto &attrs = attributes;
+    QtConcurrent::run([texts, size, elideMode, attrs]() {
+        ElideTextLayout layout;
+        layout.attributes = attrs;
+        const QRectF rect(QPointF(0, 0), size);
+        for (const QString &text : texts) {
+            layout.setText(text);
+            layout.layout(rect, elideMode);
+        }
+    });
+}
+
+void ElideTextLayout::clearCache()
+{
+    LayoutCache::instance()->clear();
+}
+
+QList<QRectF> ElideTextLayout::layoutDocument(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background,
+                                              QStringList *textLines, LayoutLines *record)
 {
     QList<QRectF> ret;
     QTextLayout *lay = document->firstBlock().layout();
@@ -58,20 +249,30 @@ QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elid
     int textLineHeight = attribute<int>(kLineHeight);
     QSizeF size = rect.size();
     QPointF offset = rect.topLeft();
-    qreal curHeight = 0;
+    const int maxLines = lineLimit(size.height());
+    int lineCount = 0;
+    const bool recordGlyphRuns = record && isGuiThread();
 
     // for draw background.
     QRectF lastLineRect;
     QString elideText;
     QString curText = text();
-    auto processLine = [this, &ret, painter, &lastLineRect, background, textLineHeight, &curText, textLines](QTextLine &line) {
+    auto processLine = [this, &ret, painter, &lastLineRect, background, textLineHeight, &curText, textLines, record, recordGlyphRuns](QTextLine &line, qreal lineWidth) {
         QRectF lRect = line.naturalTextRect();
         lRect.setHeight(textLineHeight);
 
         ret.append(lRect);
-        if (textLines) {
+        if (textLines || record) {
             const auto &t = curText.mid(line.textStart(), line.textLength());
-            textLines->append(t);
+            if (textLines)
+                textLines->append(t);
+            if (record) {
+                record->rects.append(lRect);
+                record->texts.append(t);
+                record->widths.append(lineWidth);
+                if (recordGlyphRuns)
+                    record->glyphRuns.append(line.glyphRuns());
+            }
         }
 
         // draw
@@ -90,12 +291,12 @@ QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elid
         lay->beginLayout();
         QTextLine line = lay->createLine();
         while (line.isValid()) {
-            curHeight += textLineHeight;
+            ++lineCount;
             line.setLineWidth(size.width());
             line.setPosition(offset);
 
             // check next line is out or not.
-            if (curHeight + textLineHeight > size.height()) {
+            if (lineCount >= maxLines) {
                 auto nextLine = lay->createLine();
                 if (nextLine.isValid()) {
                     // elide current line.
@@ -107,7 +308,7 @@ QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elid
                 // next line is empty.
             }
 
-            processLine(line);
+            processLine(line, size.width());
 
             // next line
             line = lay->createLine();
@@ -136,13 +337,48 @@ QList<QRectF> ElideTextLayout::layout(const QRectF &rect, Qt::TextElideMode elid
         line.setLineWidth(size.width() - 1);
         line.setPosition(offset);
 
-        processLine(line);
+        processLine(line, size.width() - 1);
         newlay.endLayout();
     }
 
     return ret;
 }
 
+void ElideTextLayout::shapeLines(LayoutLines *lines)
+{
+    // the lines are known, each of them is shaped alone like the elided line
+    lines->glyphRuns.clear();
+    for (int i = 0; i < lines->texts.size(); ++i) {
+        QTextLayout lay;
+        initLayoutOption(&lay);
+        QTextOption opt = lay.textOption();
+        opt.setWrapMode(QTextOption::NoWrap);
+        lay.setTextOption(opt);
+        lay.setText(lines->texts.at(i));
+
+        lay.beginLayout();
+        QTextLine line = lay.createLine();
+        if (line.isValid()) {
+            line.setLineWidth(lines->widths.at(i));
+            line.setPosition(QPointF(0, lines->rects.at(i).top()));
+            lines->glyphRuns.append(line.glyphRuns());
+        } else {
+            lines->glyphRuns.append(QList<QGlyphRun>());
+        }
+        lay.endLayout();
+    }
+}
+
+int ElideTextLayout::lineLimit(qreal height) const
+{
+    // the last line is elided when the one after it is out of the height
+    const int lineHeight = attribute<int>(kLineHeight);
+    if (lineHeight <= 0)
+        return INT_MAX;
+
+    return qMax(1, static_cast<int>(qMin(std::floor(height / lineHeight), static_cast<qreal>(INT_MAX))));
+}
+
 QRectF ElideTextLayout::drawLineBackground(QPainter *painter, const QRectF &curLineRect, QRectF lastLineRect, const QBrush &brush) const
 {
     const qreal backgroundRadius = attribute<qreal>(kBackgroundRadius);
@@ -6,6 +6,7 @@
 #define ELIDETEXTLAYOUT_H
 
 #include <QString>
+#include <QStringList>
 #include <QBrush>
 #include <QVariant>
 
@@ -15,6 +16,12 @@ class QTextLayout;
 
 namespace dfmbase {
 
+/*!
+ * \brief The ElideTextLayout class lays out a text in the lines of a rect and elides the last line.
+ * The lines and their glyph runs are kept in a cache shared by all the layouts, keyed by the text,
+ * the font, the rect and the attributes, so painting an item again does not shape its text again.
+ * The layouts whose document is changed through documentHandle() are not cached.
+ */
 class ElideTextLayout
 {
 public:
@@ -32,8 +39,12 @@ public:
     void setText(const QString &text);
     QString text() const;
     QList<QRectF> layout(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter = nullptr, const QBrush &background = Qt::NoBrush, QStringList *textLines = nullptr);
+    // lay out `texts` with the attributes of this layout in a thread of the global pool to fill the cache
+    void prefetch(const QStringList &texts, const QSizeF &size, Qt::TextElideMode elideMode) const;
+    static void clearCache();
 public:
     inline QTextDocument *documentHandle() {
+        cacheable = false;
         return document;
     }
 
@@ -46,12 +57,19 @@ public:
         return attributes.value(attr).value<T>();
     }
 
+    struct LayoutLines;
+
 protected:
     QRectF drawLineBackground(QPainter *painter, const QRectF &curLineRect, QRectF lastLineRect, const QBrush &brush) const;
     virtual void initLayoutOption(QTextLayout *lay);
+    QList<QRectF> layoutDocument(const QRectF &rect, Qt::TextElideMode elideMode, QPainter *painter, const QBrush &background,
+                                 QStringList *textLines, LayoutLines *record);
+    void shapeLines(LayoutLines *lines);
+    int lineLimit(qreal height) const;
 protected:
     QTextDocument *document = nullptr;
     QMap<Attribute, QVariant> attributes;
+    bool cacheable = true;
 };
 }
 
@@ -13,6 +13,7 @@
 
 #include <dfm-io/dfmio_utils.h>
 
+#include <QFile>
 #include <QMutex>
 #include <QQueue>
 #include <QTimer>
@@ -21,13 +22,33 @@
 #include <QElapsedTimer>
 #include <QDebug>
 
+#include <algorithm>
+#include <thread>
+
 #include <fts.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/sysmacros.h>
 #include <dirent.h>
 
 namespace dfmbase {
 
 static constexpr uint16_t kSizeChangeinterval { 200 };
+static constexpr int kMaxLocalThreads { 8 };
+static constexpr int kLocalFlushInterval { 128 };   // entries between two flushes of the counter of a thread
+static constexpr unsigned int kLocalStatxMask { STATX_TYPE | STATX_MODE | STATX_NLINK | STATX_INO | STATX_SIZE };
+
+struct FileStatisticsJobPrivate::LocalCounter
+{
+    qint64 totalSize { 0 };
+    qint64 totalProgressSize { 0 };
+    int filesCount { 0 };
+    int directoryCount { 0 };
+    int entries { 0 };
+    QList<QUrl> allFiles;
+};
 
 FileStatisticsJobPrivate::FileStatisticsJobPrivate(FileStatisticsJob *qq)
     : QObject(nullptr), q(qq), notifyDataTimer(nullptr)
@@ -136,7 +157,7 @@ void FileStatisticsJobPrivate::processFile(const QUrl &url, const bool followLin
             }
 
             const auto &symLinkTargetUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kSymLinkTarget));
-            if (sizeInfo->allFiles.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
+            if (countedUrls.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
                 return;
             }
             fileStatistics << symLinkTargetUrl;
@@ -172,7 +193,7 @@ void FileStatisticsJobPrivate::processFile(const QUrl &url, const bool followLin
             auto isSyslink = info->isAttributes(OptInfoType::kIsSymLink);
             if (isSyslink) {
                 const auto &symLinkTargetUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kSymLinkTarget));
-                if (sizeInfo->allFiles.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
+                if (countedUrls.contains(symLinkTargetUrl) || fileStatistics.contains(symLinkTargetUrl)) {
                     return;
                 }
                 fileStatistics << symLinkTargetUrl;
@@ -279,11 +300,276 @@ bool FileStatisticsJobPrivate::checkInode(const FileInfoPointer info)
             }
             return false;
         }
-        inodelist.append(fileInode);
+        inodelist.insert(fileInode);
     }
     return true;
 }
 
+bool FileStatisticsJobPrivate::canStatisticsLocally() const
+{
+    // the single depth statistics only reads one directory, there is nothing to spread over the threads
+    if (fileHints.testFlag(FileStatisticsJob::kSingleDepth))
+        return false;
+
+    return std::all_of(sourceUrlList.cbegin(), sourceUrlList.cend(), [](const QUrl &url) {
+        return url.isLocalFile();
+    });
+}
+
+void FileStatisticsJobPrivate::statisticsLocalFiles()
+{
+    Q_EMIT q->dataNotify(0, 0, 0);
+
+    localStopped = false;
+    localBusyWorkers = 0;
+    localDirs.clear();
+    localInodes.clear();
+
+    LocalCounter counter;
+    for (const QUrl &url : sourceUrlList) {
+        if (countedUrls.contains(url))
+            continue;
+        countedUrls << url;
+        sizeInfo->allFiles << url;
+
+        const QByteArray &path = QFile::encodeName(url.toLocalFile());
+        if (fileHints.testFlag(FileStatisticsJob::kExcludeSourceFile))
+            queueLocalSource(path);
+        else
+            processLocalEntry(AT_FDCWD, 0, QByteArray(), path.constData(), &counter);
+    }
+    flushLocalCounter(&counter);
+
+    std::vector<std::thread> workers;
+    const int threadCount = qBound(1, QThread::idealThreadCount(), kMaxLocalThreads);
+    for (int i = 1; i < threadCount; ++i)
+        workers.emplace_back(&FileStatisticsJobPrivate::runLocalWorker, this);
+    runLocalWorker();
+    for (std::thread &worker : workers)
+        worker.join();
+}
+
+void FileStatisticsJobPrivate::runLocalWorker()
+{
+    LocalCounter counter;
+    while (true) {
+        QByteArray path;
+        {
+            std::unique_lock<std::mutex> lk(localMutex);
+            localCondition.wait(lk, [this] {
+                return localStopped || !localDirs.empty() || localBusyWorkers == 0;
+            });
+            if (localStopped || localDirs.empty())
+                break;
+
+            // go deep first, so the queue holds the directories of one branch rather than of the whole tree
+            path = localDirs.back();
+            localDirs.pop_back();
+            ++localBusyWorkers;
+        }
+
+        readLocalDir(path, &counter);
+
+        std::lock_guard<std::mutex> lk(localMutex);
+        if (--localBusyWorkers == 0 && localDirs.empty())
+            localCondition.notify_all();
+    }
+    flushLocalCounter(&counter);
+}
+
+void FileStatisticsJobPrivate::readLocalDir(const QByteArray &path, LocalCounter *counter)
+{
+    const int fd = open(path.constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0)
+        return;
+
+    struct stat st;
+    DIR *dir = fstat(fd, &st) == 0 ? fdopendir(fd) : nullptr;
+    if (!dir) {
+        close(fd);
+        return;
+    }
+
+    while (struct dirent *entry = readdir(dir)) {
+        const char *name = entry->d_name;
+        if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+            continue;
+
+        processLocalEntry(fd, st.st_dev, path, name, counter);
+
+        if (++counter->entries >= kLocalFlushInterval) {
+            flushLocalCounter(counter);
+            if (!stateCheck()) {
+                std::lock_guard<std::mutex> lk(localMutex);
+                localStopped = true;
+                localCondition.notify_all();
+            }
+        }
+        if (localStopped)
+            break;
+    }
+    closedir(dir);
+}
+
+void FileStatisticsJobPrivate::processLocalEntry(int dirFd, dev_t dirDevice, const QByteArray &path,
+                                                 const char *name, LocalCounter *counter)
+{
+    const QByteArray &filePath = path.isEmpty() ? QByteArray(name) : path + '/' + name;
+    if (!path.isEmpty())
+        counter->allFiles << QUrl::fromLocalFile(QFile::decodeName(filePath));
+
+    struct statx st;
+    if (statx(dirFd, name, AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, kLocalStatxMask, &st) != 0)
+        return;
+
+    const dev_t device = makedev(st.stx_dev_major, st.stx_dev_minor);
+    const bool isSymLink = S_ISLNK(st.stx_mode);
+
+    // the type and the size of a symlink are the ones of its target
+    struct statx target = st;
+    bool hasTarget = true;
+    if (isSymLink)
+        hasTarget = statx(dirFd, name, AT_STATX_DONT_SYNC, kLocalStatxMask, &target) == 0;
+    const dev_t targetDevice = makedev(target.stx_dev_major, target.stx_dev_minor);
+
+    if (!S_ISDIR(st.stx_mode) && st.stx_nlink > 1 && !visitLocalInode(device, st.stx_ino)) {
+        ++counter->filesCount;
+        return;
+    }
+
+    if (hasTarget && S_ISDIR(target.stx_mode)) {
+        // fix bug 30548 ,以为有些文件大小为0,文件夹为空，size也为零，重新计算显示大小
+        counter->totalProgressSize += FileUtils::getMemoryPageSize();
+        if (isSymLink && fileHints.testFlag(FileStatisticsJob::kNoFollowSymlink)) {
+            ++counter->directoryCount;
+            return;
+        }
+
+        // a directory reached by both its path and symlinks is only counted once
+        if (!visitLocalInode(targetDevice, target.stx_ino))
+            return;
+        ++counter->directoryCount;
+
+        // the sources are not skipped even if they are the mount points of avfsd or proc
+        if (!path.isEmpty() && targetDevice != dirDevice && isSkippedMountPoint(filePath))
+            return;
+
+        queueLocalDir(filePath);
+        return;
+    }
+
+    ++counter->filesCount;
+    if (isSymLink && hasTarget && !visitLocalInode(targetDevice, target.stx_ino))
+        return;
+
+    if (skipPath.contains(QFile::decodeName(filePath)))
+        return;
+    if (isSymLink) {
+        char linkTarget[PATH_MAX];
+        const ssize_t length = readlinkat(dirFd, name, linkTarget, sizeof(linkTarget) - 1);
+        if (length > 0 && skipPath.contains(QFile::decodeName(QByteArray(linkTarget, static_cast<int>(length)))))
+            return;
+    }
+
+    FileInfo::FileType type = FileInfo::FileType::kUnknown;
+    if (hasTarget) {
+        switch (target.stx_mode & S_IFMT) {
+        case S_IFCHR:
+            type = FileInfo::FileType::kCharDevice;
+            break;
+        case S_IFBLK:
+            type = FileInfo::FileType::kBlockDevice;
+            break;
+        case S_IFIFO:
+            type = FileInfo::FileType::kFIFOFile;
+            break;
+        case S_IFSOCK:
+            type = FileInfo::FileType::kSocketFile;
+            break;
+        case S_IFREG:
+            type = FileInfo::FileType::kRegularFile;
+            break;
+        default:
+            break;
+        }
+    }
+    if (!checkFileType(type))
+        return;
+
+    const qint64 size = static_cast<qint64>(target.stx_size);
+    if (size > 0)
+        counter->totalSize += size;
+    counter->totalProgressSize += (size <= 0 || isSymLink) ? FileUtils::getMemoryPageSize() : size;
+}
+
+void FileStatisticsJobPrivate::queueLocalSource(const QByteArray &path)
+{
+    struct statx st;
+    if (statx(AT_FDCWD, path.constData(), AT_SYMLINK_NOFOLLOW | AT_STATX_DONT_SYNC, kLocalStatxMask, &st) != 0)
+        return;
+
+    if (S_ISLNK(st.stx_mode)) {
+        if (fileHints.testFlag(FileStatisticsJob::kNoFollowSymlink)
+            || statx(AT_FDCWD, path.constData(), AT_STATX_DONT_SYNC, kLocalStatxMask, &st) != 0)
+            return;
+    }
+
+    if (S_ISDIR(st.stx_mode) && visitLocalInode(makedev(st.stx_dev_major, st.stx_dev_minor), st.stx_ino))
+        queueLocalDir(path);
+}
+
+void FileStatisticsJobPrivate::queueLocalDir(const QByteArray &path)
+{
+    {
+        std::lock_guard<std::mutex> lk(localMutex);
+        localDirs.push_back(path);
+    }
+    localCondition.notify_one();
+}
+
+bool FileStatisticsJobPrivate::visitLocalInode(dev_t device, quint64 inode)
+{
+    QMutexLocker lk(&localInodeMutex);
+    const auto &key = qMakePair(static_cast<quint64>(device), inode);
+    if (localInodes.contains(key))
+        return false;
+    localInodes.insert(key);
+    return true;
+}
+
+bool FileStatisticsJobPrivate::isSkippedMountPoint(const QByteArray &path) const
+{
+    if (fileHints & (FileStatisticsJob::kDontSkipAVFSDStorage | FileStatisticsJob::kDontSkipPROCStorage))
+        return false;
+
+    QStorageInfo si(QFile::decodeName(path));
+    if (si.rootPath() != QFile::decodeName(path))
+        return false;
+
+    return si.device() == "proc" || si.device() == "avfsd";
+}
+
+void FileStatisticsJobPrivate::flushLocalCounter(LocalCounter *counter)
+{
+    totalSize += counter->totalSize;
+    totalProgressSize += counter->totalProgressSize;
+    filesCount += counter->filesCount;
+    directoryCount += counter->directoryCount;
+
+    if (!counter->allFiles.isEmpty()) {
+        QMutexLocker lk(&allFilesMutex);
+        sizeInfo->allFiles.append(counter->allFiles);
+    }
+
+    if (counter->totalSize > 0) {
+        std::unique_lock<std::mutex> lk(sizeChangedMutex, std::try_to_lock);
+        if (lk.owns_lock())
+            emitSizeChanged();
+    }
+
+    *counter = LocalCounter();
+}
+
 FileStatisticsJob::FileStatisticsJob(QObject *parent)
     : QThread(parent), d(new FileStatisticsJobPrivate(this))
 {
@@ -397,9 +683,16 @@ void FileStatisticsJob::run()
     d->filesCount = 0;
     d->directoryCount = 0;
     d->inodelist.clear();
+    d->countedUrls.clear();
     d->sizeInfo.reset(new FileUtils::FilesSizeInfo());
     if (d->sourceUrlList.isEmpty())
         return;
+    if (d->canStatisticsLocally()) {
+        d->statisticsLocalFiles();
+        setSizeInfo();
+        d->setState(kStoppedState);
+        return;
+    }
     statistcsOtherFileSystem();
 }
 
@@ -426,10 +719,11 @@ void FileStatisticsJob::statistcsOtherFileSystem()
                 return;
             }
             // The files counted are not counted
-            if (d->sizeInfo->allFiles.contains(url))
+            if (d->countedUrls.contains(url))
                 continue;
 
             d->sizeInfo->allFiles << url;
+            d->countedUrls << url;
             FileInfoPointer info = InfoFactory::create<FileInfo>(url, Global::CreateFileInfoType::kCreateFileInfoSync);
 
             if (!info) {
@@ -453,7 +747,7 @@ void FileStatisticsJob::statistcsOtherFileSystem()
 
                 const auto &symLinkTargetUrl = QUrl::fromLocalFile(info->pathOf(PathInfoType::kSymLinkTarget));
                 // The files counted are not counted
-                if (d->fileStatistics.contains(symLinkTargetUrl) || d->sizeInfo->allFiles.contains(symLinkTargetUrl))
+                if (d->fileStatistics.contains(symLinkTargetUrl) || d->countedUrls.contains(symLinkTargetUrl))
                     continue;
 
                 info = InfoFactory::create<FileInfo>(symLinkTargetUrl, Global::CreateFileInfoType::kCreateFileInfoSync);
@@ -476,6 +770,7 @@ void FileStatisticsJob::statistcsOtherFileSystem()
             d->fileHints = d->fileHints | kDontSkipAVFSDStorage | kDontSkipPROCStorage;
             d->processFile(url, followLink, directory_queue);
             d->sizeInfo->allFiles << url;
+            d->countedUrls << url;
             d->fileHints = save_file_hints;
 
             if (!d->stateCheck()) {
@@ -506,11 +801,12 @@ void FileStatisticsJob::statistcsOtherFileSystem()
         while (d->iterator->hasNext()) {
             QUrl url = d->iterator->next();
             // The files counted are not counted
-            if (d->sizeInfo->allFiles.contains(url))
+            if (d->countedUrls.contains(url))
                 continue;
 
             d->processFile(url, followLink, directory_queue);
             d->sizeInfo->allFiles << url;
+            d->countedUrls << url;
 
             if (!d->stateCheck()) {
                 d->setState(kStoppedState);
@@ -9,8 +9,12 @@
 
 #include <QtConcurrent>
 
-// cache file total count
-static constexpr int kCacheFileinfoCount = 20000;
+// cache memory budget of all shards
+static constexpr qint64 kCacheByteBudget = (64 * 1024 * 1024);
+// estimated memory of one fileinfo with the dfm-io file info and the cached attributes, not include the strings of the path
+static constexpr qint64 kCacheInfoEstimatedCost = 3 * 1024;
+// copies of the path held by one fileinfo: the url, the cached path and the display name attributes
+static constexpr int kCachePathCopies = 3;
 // rotation training time
 static constexpr int kRotationTrainingTime = (60 * 1000);
 // remove cache time limit
@@ -27,6 +31,38 @@ InfoCachePrivate::~InfoCachePrivate()
     cacheWorkerStoped = true;
 }
 
+CacheShard &InfoCachePrivate::shardOf(const QUrl &url)
+{
+    return shards[qHash(url) % kCacheShardCount];
+}
+
+qint64 InfoCachePrivate::entryCost(const QUrl &url)
+{
+    return kCacheInfoEstimatedCost + static_cast<qint64>(sizeof(CacheEntry))
+            + kCachePathCopies * url.path().size() * static_cast<qint64>(sizeof(QChar));
+}
+/*!
+ * \brief evictOverBudget 淘汰分片中最久未访问的缓存，直到内存占用不超过分片的预算，调用者需持有分片的锁
+ *
+ * \param CacheShard 缓存分片
+ *
+ * \return 被淘汰的fileinfo，用于断开监视器
+ */
+QMap<QUrl, FileInfoPointer> InfoCachePrivate::evictOverBudget(CacheShard &shard)
+{
+    static constexpr qint64 kShardBudget = kCacheByteBudget / kCacheShardCount;
+
+    QMap<QUrl, FileInfoPointer> evicted;
+    while (shard.cost > kShardBudget && !shard.lru.empty()) {
+        auto &entry = shard.lru.back();
+        shard.cost -= entry.cost;
+        shard.index.remove(entry.url);
+        evicted.insert(entry.url, entry.info);
+        shard.lru.pop_back();
+    }
+    return evicted;
+}
+
 InfoCache::InfoCache(QObject *parent)
     : QObject(parent), d(new InfoCachePrivate(this))
 {
@@ -132,15 +168,10 @@ void InfoCache::cacheInfo(const QUrl url, const FileInfoPointer info)
     if (!info || d->cacheWorkerStoped)
         return;
 
+    CacheShard &shard = d->shardOf(url);
     {
-        QReadLocker rlk(&d->mianLock);
-        if (d->mainCache.contains(url))
-            return;
-    }
-
-    {
-        QReadLocker rlk(&d->copyLock);
-        if (d->copyCache.contains(url))
+        QMutexLocker lk(&shard.lock);
+        if (shard.index.contains(url))
             return;
     }
 
@@ -169,40 +200,18 @@ void InfoCache::cacheInfo(const QUrl url, const FileInfoPointer info)
     }
 
 
-    // 插入到主和副的所有缓存中
-    d->status = kCacheCopy;
-    {
-        QWriteLocker wlk(&d->mianLock);
-        d->mainCache.insert(url, info);
-    }
-    d->status = kCacheMain;
+    // 插入到分片链表头部，超出内存预算时从尾部淘汰
+    QMap<QUrl, FileInfoPointer> evicted;
     {
-        QWriteLocker wlk(&d->copyLock);
-        d->copyCache.insert(url, info);
+        QMutexLocker lk(&shard.lock);
+        const qint64 cost = InfoCachePrivate::entryCost(url);
+        shard.lru.push_front(CacheEntry { url, info, cost, QDateTime::currentMSecsSinceEpoch() });
+        shard.index.insert(url, shard.lru.begin());
+        shard.cost += cost;
+        evicted = d->evictOverBudget(shard);
     }
-    // 使用线程处理加入时间序列问题
-    emit cacheUpdateInfoTime(url);
-}
-/*!
- * \brief insertSortTime 处理当前文件的移除时间
- *
- * \param qint64 文件info的当前时间
- *
- * \param QString 文件的url
- *
- * \return
- */
-void InfoCache::updateSortTimeWorker(const QUrl url)
-{
-    Q_D(InfoCache);
-    if (d->cacheWorkerStoped)
-        return;
-    auto time = QDateTime::currentMSecsSinceEpoch();
-    auto key = QString::number(time) + QString("-") + url.toString();
-    if (d->urlTimeSortMap.contains(url))
-        d->timeToUrlMap.remove(d->urlTimeSortMap.value(url));
-    d->timeToUrlMap.insert(key, url);
-    d->urlTimeSortMap.insert(url, key);
+    if (!evicted.isEmpty())
+        emit cacheDisconnectWatcher(evicted);
 }
 
 void InfoCache::stop()
@@ -225,33 +234,24 @@ void InfoCache::removeCaches(const QList<QUrl> urls)
     if (d->cacheWorkerStoped || urls.size() <= 0)
         return;
 
-    // 读取主缓存，插入到
-    d->status = kCacheCopy;
     QMap<QUrl, FileInfoPointer> infos;
-    {
-        QWriteLocker wlk(&d->mianLock);
-        for (const auto &url : urls) {
-            auto info = d->mainCache.take(url);
-            if (info)
-                infos.insert(url, d->mainCache.take(url));
-        }
+    for (const auto &url : urls) {
+        CacheShard &shard = d->shardOf(url);
+        QMutexLocker lk(&shard.lock);
+        auto it = shard.index.find(url);
+        if (it == shard.index.end())
+            continue;
+        auto node = it.value();
+        shard.cost -= node->cost;
+        infos.insert(url, node->info);
+        shard.lru.erase(node);
+        shard.index.erase(it);
     }
     if (d->cacheWorkerStoped)
         return;
     // 断开监视器监视
     if (infos.size() > 0)
         emit cacheDisconnectWatcher(infos);
-    // 移除时间队列
-    emit cacheRemoveInfosTime(urls);
-
-    // 设置读取主缓存和插入到主缓存中
-    d->status = kCacheMain;
-    {
-        QWriteLocker wlk(&d->copyLock);
-        for (const auto &url : urls) {
-            d->copyCache.remove(url);
-        }
-    }
 }
 /*!
  * \brief getCacheInfo 获取文件
@@ -263,22 +263,18 @@ void InfoCache::removeCaches(const QList<QUrl> urls)
 FileInfoPointer InfoCache::getCacheInfo(const QUrl &url)
 {
     Q_D(InfoCache);
-    // 要异步线程重置计时器 todo 开辟一个可控制的线程来处理时间排序的问题
-    // 读取副缓存和临时缓存返回
-    FileInfoPointer info(nullptr);
-    if (d->status == kCacheMain) {   // 可以读取主缓存返回
-        QReadLocker wlk(&d->mianLock);
-        info = d->mainCache.value(url);
-    } else {
-        QReadLocker wlk(&d->copyLock);
-        info = d->copyCache.value(url);
-    }
-    // 异步线程或者信号更新时间
-    // 使用线程处理加入时间序列问题
-    if (info)
-        emit cacheUpdateInfoTime(url);
-
-    return info;
+    // 命中后把节点移动到链表头部，同步完成访问时间的更新
+    CacheShard &shard = d->shardOf(url);
+    QMutexLocker lk(&shard.lock);
+    auto it = shard.index.constFind(url);
+    if (it == shard.index.constEnd())
+        return nullptr;
+
+    auto node = it.value();
+    node->lastAccess = QDateTime::currentMSecsSinceEpoch();
+    if (node != shard.lru.begin())
+        shard.lru.splice(shard.lru.begin(), shard.lru, node);
+    return node->info;
 }
 /*!
  * \brief refreshFileInfo 刷新缓存fileinfo
@@ -301,36 +297,25 @@ void InfoCache::refreshFileInfo(const QUrl &url)
 void InfoCache::timeRemoveCache()
 {
     Q_D(InfoCache);
-    // 取出哪些url的时间超出了u
-    qint64 delCount = d->urlTimeSortMap.size() < kCacheFileinfoCount ? 0 : d->urlTimeSortMap.size() - kCacheFileinfoCount;
-    QList<QUrl> delList;
-    foreach (const auto time, d->timeToUrlMap.uniqueKeys()) {
+    // 链表尾部是最久未访问的，只需要从尾部向前取出超时的记录
+    const qint64 expired = QDateTime::currentMSecsSinceEpoch() - kCacheRemoveTime;
+    QMap<QUrl, FileInfoPointer> infos;
+    for (auto &shard : d->shards) {
         if (d->cacheWorkerStoped)
             return;
 
-        if (time < QString::number(QDateTime::currentDateTime().toMSecsSinceEpoch() - kCacheRemoveTime)) {
-            delList.append(d->timeToUrlMap.values(time));
-            continue;
-        }
-
-        if (delList.size() >= delCount) {
-            break;
+        QMutexLocker lk(&shard.lock);
+        while (!shard.lru.empty() && shard.lru.back().lastAccess < expired) {
+            auto &entry = shard.lru.back();
+            shard.cost -= entry.cost;
+            shard.index.remove(entry.url);
+            infos.insert(entry.url, entry.info);
+            shard.lru.pop_back();
         }
-
-        delList.append(d->timeToUrlMap.values(time));
     }
-    // 发送异步消息 告诉移除线程创建移除线程移除，考虑是否是使用线程一直还是使用临时线程（使用临时线程）
-    if (delList.size() > 0 && !d->cacheWorkerStoped)
-        emit cacheRemoveCaches(delList);
-}
 
-void InfoCache::removeInfosTimeWorker(const QList<QUrl> urls)
-{
-    for (auto url : urls) {
-        if (d->urlTimeSortMap.contains(url)) {
-            d->timeToUrlMap.remove(d->urlTimeSortMap.take(url));
-        }
-    }
+    if (infos.size() > 0 && !d->cacheWorkerStoped)
+        emit cacheDisconnectWatcher(infos);
 }
 
 void InfoCache::fileAttributeChanged(const QUrl url)
@@ -359,24 +344,12 @@ void CacheWorker::removeCaches(const QList<QUrl> urls)
     InfoCache::instance().removeCaches(urls);
 }
 
-void CacheWorker::updateInfoTime(const QUrl url)
-{
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
-    InfoCache::instance().updateSortTimeWorker(url);
-}
-
 void CacheWorker::dealRemoveInfo()
 {
     Q_ASSERT(qApp->thread() != QThread::currentThread());
     InfoCache::instance().timeRemoveCache();
 }
 
-void CacheWorker::removeInfosTime(const QList<QUrl> urls)
-{
-    Q_ASSERT(qApp->thread() != QThread::currentThread());
-    InfoCache::instance().removeInfosTimeWorker(urls);
-}
-
 void CacheWorker::disconnectWatcher(const QMap<QUrl, FileInfoPointer> infos)
 {
     Q_ASSERT(qApp->thread() != QThread::currentThread());
@@ -425,7 +398,6 @@ void InfoCacheController::init()
     connect(this, &InfoCacheController::cacheFileInfo, worker.data(), &CacheWorker::cacheInfo, Qt::QueuedConnection);
     connect(this, &InfoCacheController::removeCacheFileInfo, worker.data(), &CacheWorker::removeCaches, Qt::QueuedConnection);
     connect(&InfoCache::instance(), &InfoCache::cacheRemoveCaches, worker.data(), &CacheWorker::removeCaches, Qt::QueuedConnection);
-    connect(&InfoCache::instance(), &InfoCache::cacheRemoveInfosTime, worker.data(), &CacheWorker::removeInfosTime, Qt::QueuedConnection);
     connect(&InfoCache::instance(), &InfoCache::cacheDisconnectWatcher, worker.data(), &CacheWorker::disconnectWatcher, Qt::QueuedConnection);
 
     worker->moveToThread(thread.data());
@@ -9,8 +9,16 @@
 #include <dfm-base/interfaces/abstractdiriterator.h>
 
 #include <QObject>
+#include <QSet>
+#include <QMutex>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
 
 #include <fts.h>
+#include <sys/types.h>
 
 namespace dfmbase {
 class FileStatisticsJobPrivate : public QObject
@@ -30,6 +38,19 @@ public:
     bool checkFileType(const FileInfo::FileType &fileType);
     bool checkInode(const FileInfoPointer info);
 
+    // the files of the local filesystems are counted by a pool of threads with statx
+    struct LocalCounter;
+    bool canStatisticsLocally() const;
+    void statisticsLocalFiles();
+    void runLocalWorker();
+    void readLocalDir(const QByteArray &path, LocalCounter *counter);
+    void processLocalEntry(int dirFd, dev_t dirDevice, const QByteArray &path, const char *name, LocalCounter *counter);
+    void queueLocalSource(const QByteArray &path);
+    void queueLocalDir(const QByteArray &path);
+    bool visitLocalInode(dev_t device, quint64 inode);
+    bool isSkippedMountPoint(const QByteArray &path) const;
+    void flushLocalCounter(LocalCounter *counter);
+
     FileStatisticsJob *q;
     QTimer *notifyDataTimer;
 
@@ -45,11 +66,22 @@ public:
     QAtomicInt filesCount { 0 };
     QAtomicInt directoryCount { 0 };
     SizeInfoPointer sizeInfo { nullptr };
-    QList<QUrl> fileStatistics;
+    QSet<QUrl> fileStatistics;
+    QSet<QUrl> countedUrls;   // the urls in sizeInfo->allFiles
     QList<QString> skipPath;
-    QList<quint64> inodelist;
+    QSet<quint64> inodelist;
     AbstractDirIteratorPointer iterator { nullptr };
     std::atomic_bool iteratorCanStop { false };
+
+    std::mutex localMutex;
+    std::condition_variable localCondition;
+    std::deque<QByteArray> localDirs;
+    int localBusyWorkers { 0 };
+    std::atomic_bool localStopped { false };
+    QMutex localInodeMutex;
+    QSet<QPair<quint64, quint64>> localInodes;   // (device, inode) of the directories, the hard links and the targets of the symlinks
+    QMutex allFilesMutex;
+    std::mutex sizeChangedMutex;
 };
 }
 #endif // FILESTATISSTICSJOB_P_H
@@ -7,16 +7,35 @@
 
 #include <dfm-base/utils/infocache.h>
 
-#include <QReadWriteLock>
 #include <QMutex>
 #include <QTimer>
-#include <QMap>
+#include <QHash>
+
+#include <array>
+#include <list>
 
 namespace dfmbase {
-enum CacheInfoStatus : uint8_t {
-    kCacheMain = 0,   // 1.正常状态 插入(同时插入主和副缓存hash)， 读取主缓存hash， 删除主缓存hash
-    kCacheCopy,
+// 缓存分片个数，按url的hash分片，降低锁竞争
+inline constexpr int kCacheShardCount = 16;
+
+// 一条缓存记录，链表头部是最近访问的，尾部是最久未访问的
+struct CacheEntry
+{
+    QUrl url;
+    FileInfoPointer info;
+    qint64 cost { 0 };   // 估算的内存占用
+    qint64 lastAccess { 0 };   // 最后访问时间（ms）
 };
+
+// 一个LRU分片：hash定位节点，链表splice完成O(1)的访问更新和淘汰
+struct CacheShard
+{
+    QMutex lock;
+    std::list<CacheEntry> lru;
+    QHash<QUrl, std::list<CacheEntry>::iterator> index;
+    qint64 cost { 0 };
+};
+
 class InfoCachePrivate
 {
     friend class InfoCache;
@@ -24,21 +43,17 @@ class InfoCachePrivate
     InfoCache *const q;
     DThreadList<QString> disableCahceSchemes;
 
-    QAtomicInt status { kCacheMain };   // 当前状态缓存的状态
-    QHash<QUrl, FileInfoPointer> mainCache;   // 主信息缓存
-    QHash<QUrl, FileInfoPointer> copyCache;   // 副信息缓存
-    QReadWriteLock mianLock;
-    QReadWriteLock copyLock;
-
-    // 时间排序url,利用map的有序性，来处理时间到了要移除的url
-    QMap<QUrl, QString> urlTimeSortMap;
-    QMap<QString, QUrl> timeToUrlMap;
+    std::array<CacheShard, kCacheShardCount> shards;
 
     std::atomic_bool cacheWorkerStoped { false };
 
 public:
     explicit InfoCachePrivate(InfoCache *qq);
     virtual ~InfoCachePrivate();
+
+    CacheShard &shardOf(const QUrl &url);
+    static qint64 entryCost(const QUrl &url);
+    QMap<QUrl, FileInfoPointer> evictOverBudget(CacheShard &shard);
 };
 }
 
@@ -0,0 +1,346 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "jpegthumbnailreader.h"
+
+#include <QTransform>
+#include <QDebug>
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+
+extern "C" {
+#include <jpeglib.h>
+}
+
+using namespace dfmbase;
+
+namespace {
+
+constexpr uchar kMarkerPrefix { 0xFF };
+constexpr uchar kMarkerSOI { 0xD8 };
+constexpr uchar kMarkerEOI { 0xD9 };
+constexpr uchar kMarkerSOS { 0xDA };
+constexpr uchar kMarkerAPP1 { 0xE1 };
+
+constexpr quint16 kTagOrientation { 0x0112 };
+constexpr quint16 kTagThumbnailOffset { 0x0201 };
+constexpr quint16 kTagThumbnailLength { 0x0202 };
+constexpr quint16 kTypeShort { 3 };
+
+// 内嵌缩略图和原图的宽高比相差超过2%时，缩略图可能带有黑边，不使用
+constexpr qreal kAspectTolerance { 0.02 };
+
+struct JpegErrorManager
+{
+    jpeg_error_mgr pub;
+    jmp_buf jump;
+};
+
+void jpegErrorExit(j_common_ptr cinfo)
+{
+    auto err = reinterpret_cast<JpegErrorManager *>(cinfo->err);
+    longjmp(err->jump, 1);
+}
+
+void jpegOutputMessage(j_common_ptr)
+{
+}
+
+bool isSOFMarker(uchar marker)
+{
+    // SOF0 - SOF15，不包括DHT(C4)、JPG(C8)和DAC(CC)
+    return marker >= 0xC0 && marker <= 0xCF && marker != 0xC4 && marker != 0xC8 && marker != 0xCC;
+}
+
+}   // namespace
+
+JpegThumbnailReader::JpegThumbnailReader(const QString &filePath)
+    : file(filePath)
+{
+}
+
+JpegThumbnailReader::~JpegThumbnailReader()
+{
+    if (data)
+        file.unmap(const_cast<uchar *>(data));
+}
+/*!
+ * \brief JpegThumbnailReader::open 映射文件并解析图片尺寸和EXIF
+ * \return 不是JPEG文件或者文件损坏时返回false
+ */
+bool JpegThumbnailReader::open()
+{
+    if (data)
+        return imageSize.isValid();
+
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    dataSize = file.size();
+    data = dataSize > 4 ? file.map(0, dataSize) : nullptr;
+    if (!data)
+        return false;
+
+    parseHeaders();
+    return imageSize.isValid();
+}
+
+QSize JpegThumbnailReader::size() const
+{
+    return imageSize;
+}
+
+int JpegThumbnailReader::orientation() const
+{
+    return exifOrientation;
+}
+
+QImage JpegThumbnailReader::exifThumbnail() const
+{
+    if (!data || thumbnailOffset < 0)
+        return {};
+
+    return QImage::fromData(data + thumbnailOffset, static_cast<int>(thumbnailLength), "JPEG");
+}
+/*!
+ * \brief JpegThumbnailReader::read 生成缩略图
+ * \param size 缩略图的最大边长
+ * \return 已经按照EXIF方向旋转的缩略图，失败时返回空，调用者需要使用通用的方式生成
+ */
+QImage JpegThumbnailReader::read(int size)
+{
+    if (!open())
+        return {};
+
+    QImage img;
+    const QImage &thumbnail = exifThumbnail();
+    if (!thumbnail.isNull() && qMax(thumbnail.width(), thumbnail.height()) >= size) {
+        const qreal imageArea = static_cast<qreal>(imageSize.width()) * thumbnail.height();
+        const qreal diff = qAbs(imageArea - static_cast<qreal>(thumbnail.width()) * imageSize.height());
+        if (diff <= imageArea * kAspectTolerance)
+            img = thumbnail;
+    }
+
+    if (img.isNull())
+        img = decodeScaled(size);
+
+    if (img.isNull())
+        return {};
+
+    if (img.width() > size || img.height() > size)
+        img = img.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+
+    return applyOrientation(img, exifOrientation);
+}
+
+QImage JpegThumbnailReader::applyOrientation(const QImage &img, int orientation)
+{
+    switch (orientation) {
+    case 2:   // mirror horizontal
+        return img.mirrored(true, false);
+    case 3:   // rotate 180
+        return img.mirrored(true, true);
+    case 4:   // mirror vertical
+        return img.mirrored(false, true);
+    case 5:   // mirror horizontal and rotate 270 CW
+        return img.mirrored(true, false).transformed(QTransform().rotate(270));
+    case 6:   // rotate 90 CW
+        return img.transformed(QTransform().rotate(90));
+    case 7:   // mirror horizontal and rotate 90 CW
+        return img.mirrored(true, false).transformed(QTransform().rotate(90));
+    case 8:   // rotate 270 CW
+        return img.transformed(QTransform().rotate(270));
+    default:
+        return img;
+    }
+}
+/*!
+ * \brief JpegThumbnailReader::parseHeaders 遍历SOS之前的marker，读取SOF中的尺寸和APP1中的EXIF
+ */
+void JpegThumbnailReader::parseHeaders()
+{
+    if (data[0] != kMarkerPrefix || data[1] != kMarkerSOI)
+        return;
+
+    bool exifParsed = false;
+    qint64 pos = 2;
+    while (pos + 4 <= dataSize) {
+        if (data[pos] != kMarkerPrefix)
+            return;
+
+        const uchar marker = data[pos + 1];
+        if (marker == kMarkerPrefix) {   // fill bytes
+            ++pos;
+            continue;
+        }
+
+        pos += 2;
+        if (marker == kMarkerEOI || marker == kMarkerSOS)
+            return;
+        if (marker == kMarkerSOI || marker == 0x01 || (marker >= 0xD0 && marker <= 0xD7))   // no length
+            continue;
+
+        const int length = (data[pos] << 8) | data[pos + 1];
+        if (length < 2 || pos + length > dataSize)
+            return;
+
+        const uchar *segment = data + pos + 2;
+        const int segmentLength = length - 2;
+        if (marker == kMarkerAPP1 && !exifParsed && segmentLength > 6 && memcmp(segment, "Exif\0\0", 6) == 0) {
+            exifParsed = true;
+            parseExif(segment + 6, segmentLength - 6);
+        } else if (isSOFMarker(marker) && segmentLength >= 5) {
+            const int height = (segment[1] << 8) | segment[2];
+            const int width = (segment[3] << 8) | segment[4];
+            imageSize = QSize(width, height);
+        }
+
+        pos += length;
+    }
+}
+/*!
+ * \brief JpegThumbnailReader::parseExif 解析TIFF结构，IFD0中读取方向，IFD1中读取内嵌缩略图的位置
+ * \param tiff TIFF头的地址
+ * \param length EXIF数据的长度
+ */
+void JpegThumbnailReader::parseExif(const uchar *tiff, int length)
+{
+    if (length < 8)
+        return;
+
+    bool littleEndian = false;
+    if (tiff[0] == 'I' && tiff[1] == 'I')
+        littleEndian = true;
+    else if (tiff[0] != 'M' || tiff[1] != 'M')
+        return;
+
+    // 偏移来自文件内容，在qint64中比较，避免0xFFFFFFFF这样的偏移回绕后通过检查
+    auto inRange = [length](qint64 offset, qint64 size) {
+        return offset >= 0 && offset + size <= length;
+    };
+    auto u16 = [&](quint32 offset) -> quint32 {
+        if (!inRange(offset, 2))
+            return 0;
+        return littleEndian ? (tiff[offset] | (tiff[offset + 1] << 8))
+                            : ((tiff[offset] << 8) | tiff[offset + 1]);
+    };
+    auto u32 = [&](quint32 offset) -> quint32 {
+        if (!inRange(offset, 4))
+            return 0;
+        return littleEndian ? (u16(offset) | (u16(offset + 2) << 16))
+                            : ((u16(offset) << 16) | u16(offset + 2));
+    };
+    // 遍历IFD中的条目，返回下一个IFD的位置
+    auto readIfd = [&](quint32 offset, const std::function<void(quint32, quint32, quint32)> &onEntry) -> quint32 {
+        if (offset < 8 || !inRange(offset, 2))
+            return 0;
+
+        const quint32 count = u16(offset);
+        const qint64 end = static_cast<qint64>(offset) + 2 + static_cast<qint64>(count) * 12;
+        if (!inRange(end, 4))
+            return 0;
+
+        for (quint32 i = 0; i < count; ++i) {
+            const quint32 entry = offset + 2 + i * 12;
+            onEntry(u16(entry), u16(entry + 2), entry + 8);
+        }
+        return u32(static_cast<quint32>(end));
+    };
+
+    if (u16(2) != 42)
+        return;
+
+    const quint32 ifd1 = readIfd(u32(4), [&](quint32 tag, quint32 type, quint32 value) {
+        if (tag == kTagOrientation && type == kTypeShort) {
+            const int orientation = static_cast<int>(u16(value));
+            if (orientation >= 1 && orientation <= 8)
+                exifOrientation = orientation;
+        }
+    });
+
+    quint32 offset = 0;
+    quint32 thumbLength = 0;
+    readIfd(ifd1, [&](quint32 tag, quint32, quint32 value) {
+        if (tag == kTagThumbnailOffset)
+            offset = u32(value);
+        else if (tag == kTagThumbnailLength)
+            thumbLength = u32(value);
+    });
+
+    if (offset > 0 && thumbLength > 0 && static_cast<quint64>(offset) + thumbLength <= static_cast<quint64>(length)) {
+        thumbnailOffset = (tiff - data) + offset;
+        thumbnailLength = thumbLength;
+    }
+}
+/*!
+ * \brief JpegThumbnailReader::decodeScaled 使用DCT缩放解码，输出的最大边长不小于size
+ * CMYK的图片需要额外处理，返回空交给QImageReader解码
+ */
+QImage JpegThumbnailReader::decodeScaled(int size) const
+{
+    // 解码出错时libjpeg会longjmp回decompress，image不能是setjmp所在函数的局部变量
+    QImage image;
+    if (!decompress(size, &image))
+        return QImage();
+    return image;
+}
+/*!
+ * \brief JpegThumbnailReader::decompress 解码到image，setjmp之后只有不需要析构的局部变量
+ */
+bool JpegThumbnailReader::decompress(int size, QImage *image) const
+{
+    jpeg_decompress_struct cinfo;
+    JpegErrorManager err;
+    cinfo.err = jpeg_std_error(&err.pub);
+    err.pub.error_exit = jpegErrorExit;
+    err.pub.output_message = jpegOutputMessage;
+
+    if (setjmp(err.jump)) {
+        jpeg_destroy_decompress(&cinfo);
+        *image = QImage();
+        qCWarning(logDFMBase) << "thumbnail: decode jpeg failed: " << file.fileName();
+        return false;
+    }
+
+    jpeg_create_decompress(&cinfo);
+    jpeg_mem_src(&cinfo, const_cast<uchar *>(data), static_cast<unsigned long>(dataSize));
+    if (jpeg_read_header(&cinfo, TRUE) != JPEG_HEADER_OK
+        || cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    const unsigned int longest = qMax(cinfo.image_width, cinfo.image_height);
+    cinfo.scale_num = 1;
+    cinfo.scale_denom = 1;
+    for (unsigned int denom : { 8u, 4u, 2u }) {
+        if (longest / denom >= static_cast<unsigned int>(size)) {
+            cinfo.scale_denom = denom;
+            break;
+        }
+    }
+    cinfo.dct_method = JDCT_IFAST;
+    cinfo.do_fancy_upsampling = FALSE;
+    cinfo.out_color_space = cinfo.num_components == 1 ? JCS_GRAYSCALE : JCS_RGB;
+
+    jpeg_start_decompress(&cinfo);
+    *image = QImage(static_cast<int>(cinfo.output_width), static_cast<int>(cinfo.output_height),
+                    cinfo.output_components == 1 ? QImage::Format_Grayscale8 : QImage::Format_RGB888);
+    if (image->isNull()) {
+        jpeg_destroy_decompress(&cinfo);
+        return false;
+    }
+
+    while (cinfo.output_scanline < cinfo.output_height) {
+        JSAMPROW row = image->scanLine(static_cast<int>(cinfo.output_scanline));
+        jpeg_read_scanlines(&cinfo, &row, 1);
+    }
+
+    jpeg_finish_decompress(&cinfo);
+    jpeg_destroy_decompress(&cinfo);
+    return true;
+}
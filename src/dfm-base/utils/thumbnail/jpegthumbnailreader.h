@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef JPEGTHUMBNAILREADER_H
+#define JPEGTHUMBNAILREADER_H
+
+#include <dfm-base/dfm_base_global.h>
+
+#include <QFile>
+#include <QImage>
+
+namespace dfmbase {
+
+/*!
+ * \brief The JpegThumbnailReader class 快速生成JPEG的缩略图
+ *
+ * 先解析EXIF，内嵌的缩略图足够大并且宽高比一致时直接使用；
+ * 否则用libjpeg的DCT缩放(1/2, 1/4, 1/8)直接解码到接近目标的尺寸，不需要解码完整的图片，
+ * 最后用Qt的平滑缩放(SSE/NEON优化)缩放到目标尺寸，并按照EXIF中的方向旋转。
+ */
+class JpegThumbnailReader
+{
+public:
+    explicit JpegThumbnailReader(const QString &filePath);
+    ~JpegThumbnailReader();
+
+    bool open();
+    QSize size() const;
+    int orientation() const;
+    QImage exifThumbnail() const;
+    QImage read(int size);
+
+    static QImage applyOrientation(const QImage &img, int orientation);
+
+private:
+    void parseHeaders();
+    void parseExif(const uchar *data, int length);
+    QImage decodeScaled(int size) const;
+    bool decompress(int size, QImage *image) const;
+
+private:
+    QFile file;
+    const uchar *data { nullptr };
+    qint64 dataSize { 0 };
+    QSize imageSize;
+    int exifOrientation { 1 };
+    qint64 thumbnailOffset { -1 };
+    qint64 thumbnailLength { 0 };
+};
+
+}   // namespace dfmbase
+
+#endif   // JPEGTHUMBNAILREADER_H
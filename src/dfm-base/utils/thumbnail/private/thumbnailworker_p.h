@@ -11,31 +11,63 @@
 #include <dfm-base/utils/thumbnail/thumbnailhelper.h>
 #include <dfm-base/mimetype/dmimedatabase.h>
 
-#include <QFuture>
-#include <QTimer>
+#include <QThreadPool>
+#include <QMutex>
 
 namespace dfmbase {
 
 class ThumbnailWorkerPrivate
 {
 public:
+    // 按照生成缩略图的开销给文件分类，开销大的类型限制同时执行的数量
+    enum class TaskKind : uint8_t {
+        kUnknown,
+        kImage,
+        kDocument,
+        kVideo,
+        kKindCount
+    };
+
+    struct ThumbnailTask
+    {
+        QUrl url;
+        DFMGLOBAL_NAMESPACE::ThumbnailSize size { DFMGLOBAL_NAMESPACE::kLarge };
+        DFMGLOBAL_NAMESPACE::ThumbnailPriority priority { DFMGLOBAL_NAMESPACE::ThumbnailPriority::kVisible };
+        TaskKind kind { TaskKind::kUnknown };
+        QString mimeName;
+        int checkCount { 0 };
+    };
+
     explicit ThumbnailWorkerPrivate(ThumbnailWorker *qq);
-    QString createThumbnail(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
-    bool checkFileStable(const QUrl &url);
-    void startDelayWork();
 
-    QUrl setCheckCount(const QUrl &url, int count);
-    int checkCount(const QUrl &url);
-    QUrl clearCheckCount(const QUrl &url);
+    void enqueueTask(const ThumbnailTask &task, bool atHead = false);
+    bool removeTask(const QUrl &url);
+    void startLoops();
+    void runTasks();
+    bool takeTask(ThumbnailTask *task);
+    bool acquireSlot(const ThumbnailTask &task);
+    void releaseSlot(TaskKind kind);
+    int kindLimit(TaskKind kind) const;
+    TaskKind kindOf(const QString &mimeName) const;
+
+    QString createThumbnail(const ThumbnailTask &task, ThumbnailHelper *helper,
+                            const QMap<QString, ThumbnailWorker::ThumbnailCreator> &creators);
+    bool checkFileStable(const QUrl &url);
+    void delayTask(const ThumbnailTask &task);
 
     ThumbnailWorker *q { nullptr };
-    DMimeDatabase mimeDb;
-    QMap<QString, ThumbnailWorker::ThumbnailCreator> creators;
-    QUrl originalUrl;
-    ThumbnailHelper thumbHelper;
     std::atomic_bool isStoped = false;
-    QTimer *delayTimer { nullptr };
-    ThumbnailWorker::ThumbnailTaskMap delayTaskMap;
+
+    // 以下数据都由mutex保护
+    QMutex mutex;
+    QMap<QString, ThumbnailWorker::ThumbnailCreator> creators;
+    QList<ThumbnailTask> lanes[static_cast<int>(DFMGLOBAL_NAMESPACE::ThumbnailPriority::kPriorityCount)];
+    QHash<QUrl, DFMGLOBAL_NAMESPACE::ThumbnailPriority> queuedTasks;
+    int runningKinds[static_cast<int>(TaskKind::kKindCount)] {};
+    int runningLoops { 0 };
+
+    // 放在最后，析构时先等待线程池中的任务退出
+    QThreadPool pool;
 };
 
 }   // namespace dfmbase
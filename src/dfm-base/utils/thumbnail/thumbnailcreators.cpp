@@ -4,6 +4,7 @@
 
 #include "thumbnailcreators.h"
 #include "thumbnailhelper.h"
+#include "jpegthumbnailreader.h"
 
 #include <dfm-base/utils/fileutils.h>
 #include <dfm-base/mimetype/dmimedatabase.h>
@@ -18,6 +19,7 @@
 #include <QPen>
 #include <QPainter>
 #include <QImageReader>
+#include <QMutex>
 #include <QDebug>
 
 // use original poppler api
@@ -33,6 +35,10 @@ DFMGLOBAL_USE_NAMESPACE
 
 QImage ThumbnailCreators::defaultThumbnailCreator(const QString &filePath, ThumbnailSize size)
 {
+    // DThumbnailProvider是单例，不能在多个线程中同时使用
+    static QMutex providerMutex;
+    QMutexLocker lk(&providerMutex);
+
     QFileInfo qInf(filePath);
     auto sz = static_cast<DTK_GUI_NAMESPACE::DThumbnailProvider::Size>(size);
     QString thumbPath = DTK_GUI_NAMESPACE::DThumbnailProvider::instance()->createThumbnail(qInf, sz);
@@ -95,6 +101,8 @@ QImage ThumbnailCreators::videoThumbnailCreatorLib(const QString &filePath, Thum
     Q_UNUSED(size)
 
     static QLibrary lib("libimageviewer.so");
+    static QMutex libMutex;
+    QMutexLocker lk(&libMutex);
     QImage img;
 
     if (lib.isLoaded() || lib.load()) {
@@ -170,8 +178,8 @@ QImage ThumbnailCreators::imageThumbnailCreator(const QString &filePath, Thumbna
     //! QImageReader构造时不传format参数，让其自行判断
     //! fix bug #53200 QImageReader构造时不传format参数，会造成没有读取不了真实的文件 类型比如将png图标后缀修改为jpg，读取的类型不对
 
-    QString mimeType = DMimeDatabase().mimeTypeForFile(QUrl::fromLocalFile(filePath), QMimeDatabase::MatchContent).name();
-    const QString &suffix = mimeType.replace("image/", "");
+    const QString &mimeType = DMimeDatabase().mimeTypeForFile(QUrl::fromLocalFile(filePath), QMimeDatabase::MatchContent).name();
+    const QString &suffix = QString(mimeType).replace("image/", "");
 
     QImageReader reader(filePath, suffix.toLatin1());
     if (!reader.canRead()) {
@@ -190,8 +198,7 @@ QImage ThumbnailCreators::imageThumbnailCreator(const QString &filePath, Thumbna
         return {};
     }
 
-    const QString &defaultMime = DMimeDatabase().mimeTypeForFile(QUrl::fromLocalFile(filePath)).name();
-    if (imageSize.width() > size || imageSize.height() > size || defaultMime == DFMGLOBAL_NAMESPACE::Mime::kTypeImageSvgXml)
+    if (imageSize.width() > size || imageSize.height() > size || mimeType == DFMGLOBAL_NAMESPACE::Mime::kTypeImageSvgXml)
         reader.setScaledSize(reader.size().scaled(size, size, Qt::KeepAspectRatio));
 
     reader.setAutoTransform(true);
@@ -206,6 +213,17 @@ QImage ThumbnailCreators::imageThumbnailCreator(const QString &filePath, Thumbna
     return image;
 }
 
+QImage ThumbnailCreators::jpegThumbnailCreator(const QString &filePath, ThumbnailSize size)
+{
+    // 优先使用EXIF内嵌的缩略图和DCT缩放解码，不支持的文件(CMYK、扩展名错误等)使用通用的方式
+    JpegThumbnailReader reader(filePath);
+    const QImage &image = reader.read(size);
+    if (!image.isNull())
+        return image;
+
+    return imageThumbnailCreator(filePath, size);
+}
+
 QImage ThumbnailCreators::djvuThumbnailCreator(const QString &filePath, ThumbnailSize size)
 {
     QImage img = defaultThumbnailCreator(filePath, size);
@@ -5,6 +5,7 @@
 #include "thumbnailfactory.h"
 #include "thumbnailcreators.h"
 #include "thumbnailhelper.h"
+#include "thumbnailstore.h"
 
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/utils/universalutils.h>
@@ -16,12 +17,8 @@
 using namespace dfmbase;
 DFMGLOBAL_USE_NAMESPACE
 
-static constexpr int kMaxCountLimit { 50 };
-static constexpr int kPushInterval { 100 };   // ms
-
 ThumbnailFactory::ThumbnailFactory(QObject *parent)
     : QObject(parent),
-      thread(new QThread),
       worker(new ThumbnailWorker)
 {
     registerThumbnailCreator(Mime::kTypeImageVDjvu, ThumbnailCreators::djvuThumbnailCreator);
@@ -29,6 +26,7 @@ ThumbnailFactory::ThumbnailFactory(QObject *parent)
     registerThumbnailCreator(Mime::kTypeTextPlain, ThumbnailCreators::textThumbnailCreator);
     registerThumbnailCreator(Mime::kTypeAppPdf, ThumbnailCreators::pdfThumbnailCreator);
     registerThumbnailCreator(Mime::kTypeAppVRRMedia, ThumbnailCreators::videoThumbnailCreatorFfmpeg);
+    registerThumbnailCreator(Mime::kTypeImageJpeg, ThumbnailCreators::jpegThumbnailCreator);
     registerThumbnailCreator("image/*", ThumbnailCreators::imageThumbnailCreator);
     registerThumbnailCreator("audio/*", ThumbnailCreators::audioThumbnailCreator);
     registerThumbnailCreator("video/*", ThumbnailCreators::videoThumbnailCreator);
@@ -38,71 +36,57 @@ ThumbnailFactory::ThumbnailFactory(QObject *parent)
 
 ThumbnailFactory::~ThumbnailFactory()
 {
-    if (thread->isRunning())
-        onAboutToQuit();
+    onAboutToQuit();
 }
 
 void ThumbnailFactory::init()
 {
     Q_ASSERT(qApp->thread() == QThread::currentThread());
 
-    taskPushTimer.setSingleShot(true);
-    taskPushTimer.setInterval(kPushInterval);
-    connect(&taskPushTimer, &QTimer::timeout, this, &ThumbnailFactory::pushTask);
-    connect(this, &ThumbnailFactory::thumbnailJob, this, &ThumbnailFactory::doJoinThumbnailJob, Qt::QueuedConnection);
     connect(qApp, &QGuiApplication::aboutToQuit, this, &ThumbnailFactory::onAboutToQuit);
 
-    connect(this, &ThumbnailFactory::addTask, worker.data(), &ThumbnailWorker::onTaskAdded, Qt::QueuedConnection);
+    // the worker lives in the main thread, the thumbnails are created in its thread pool
     connect(worker.data(), &ThumbnailWorker::thumbnailCreateFinished, this, &ThumbnailFactory::produceFinished, Qt::QueuedConnection);
     connect(worker.data(), &ThumbnailWorker::thumbnailCreateFailed, this, &ThumbnailFactory::produceFailed, Qt::QueuedConnection);
 
-    worker->moveToThread(thread.data());
-    thread->start();
+    // import the thumbnails in ~/.cache/thumbnails at the first time when the packed store is enabled
+    if (ThumbnailStore::isEnabled())
+        ThumbnailStore::instance()->startImport();
 }
-
-void ThumbnailFactory::joinThumbnailJob(const QUrl &url, ThumbnailSize size)
+/*!
+ * \brief ThumbnailFactory::joinThumbnailJob 添加缩略图任务，可以在任意线程调用
+ * \param url 文件
+ * \param size 缩略图大小
+ * \param priority 优先级，视图中可见的文件使用kVisible，即将可见的使用kPrefetch，其他场景使用kBackground
+ */
+void ThumbnailFactory::joinThumbnailJob(const QUrl &url, ThumbnailSize size, ThumbnailPriority priority)
 {
-    if (QThread::currentThread() != qApp->thread()) {
-        emit thumbnailJob(url, size);
+    if (FileUtils::containsCopyingFileUrl(url))
         return;
-    }
-    doJoinThumbnailJob(url, size);
-}
 
-bool ThumbnailFactory::registerThumbnailCreator(const QString &mimeType, ThumbnailCreator creator)
+    worker->addTask(url, size, priority);
+}
+/*!
+ * \brief ThumbnailFactory::rescheduleThumbnailJobs 视图滚动后调整还在排队的任务，取消已经不可见的任务
+ * \return 被取消的任务，调用者需要清除这些文件的缩略图标记，再次可见时重新请求
+ */
+QList<QUrl> ThumbnailFactory::rescheduleThumbnailJobs(const QUrl &dirUrl, const QList<QUrl> &visibleUrls, const QList<QUrl> &prefetchUrls)
 {
-    Q_ASSERT(creator);
-    return worker->registerCreator(mimeType, creator);
+    return worker->rescheduleTasks(dirUrl, visibleUrls, prefetchUrls);
 }
 
-void ThumbnailFactory::onAboutToQuit()
+QList<QUrl> ThumbnailFactory::cancelThumbnailJobs(const QList<QUrl> &urls)
 {
-    worker->stop();
-    thread->quit();
-    thread->wait(3000);
+    return worker->cancelTasks(urls);
 }
 
-void ThumbnailFactory::pushTask()
+bool ThumbnailFactory::registerThumbnailCreator(const QString &mimeType, ThumbnailCreator creator)
 {
-    auto map = std::move(taskMap);
-    emit addTask(map);
+    Q_ASSERT(creator);
+    return worker->registerCreator(mimeType, creator);
 }
 
-void ThumbnailFactory::doJoinThumbnailJob(const QUrl &url, ThumbnailSize size)
+void ThumbnailFactory::onAboutToQuit()
 {
-    if (FileUtils::containsCopyingFileUrl(url))
-        return;
-
-    if (taskMap.contains(url))
-        return;
-
-    if (taskMap.isEmpty())
-        taskPushTimer.start();
-
-
-    taskMap.insert(url, size);
-    if (taskMap.size() < kMaxCountLimit)
-        return;
-
-    pushTask();
+    worker->stop();
 }
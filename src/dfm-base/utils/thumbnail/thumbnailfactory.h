@@ -25,7 +25,10 @@ public:
         return &ins;
     }
 
-    void joinThumbnailJob(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
+    void joinThumbnailJob(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size,
+                          DFMGLOBAL_NAMESPACE::ThumbnailPriority priority = DFMGLOBAL_NAMESPACE::ThumbnailPriority::kVisible);
+    QList<QUrl> rescheduleThumbnailJobs(const QUrl &dirUrl, const QList<QUrl> &visibleUrls, const QList<QUrl> &prefetchUrls);
+    QList<QUrl> cancelThumbnailJobs(const QList<QUrl> &urls);
     using ThumbnailCreator = std::function<QImage(const QString &, DFMGLOBAL_NAMESPACE::ThumbnailSize)>;
     bool registerThumbnailCreator(const QString &mimeType, ThumbnailCreator creator);
 
@@ -33,12 +36,8 @@ Q_SIGNALS:
     void produceFinished(const QUrl &src, const QString &thumb);
     void produceFailed(const QUrl &src);
 
-    void addTask(const ThumbnailWorker::ThumbnailTaskMap &taskMap);
-    void thumbnailJob(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
 private Q_SLOTS:
     void onAboutToQuit();
-    void pushTask();
-    void doJoinThumbnailJob(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
 
 protected:
     explicit ThumbnailFactory(QObject *parent = nullptr);
@@ -46,10 +45,7 @@ protected:
     void init();
 
 private:
-    ThumbnailWorker::ThumbnailTaskMap taskMap;
-    QSharedPointer<QThread> thread { nullptr };
     QSharedPointer<ThumbnailWorker> worker { nullptr };
-    QTimer taskPushTimer;
 };
 }   // namespace dfmbase
 
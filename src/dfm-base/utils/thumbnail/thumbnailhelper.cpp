@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "thumbnailhelper.h"
+#include "thumbnailstore.h"
 
 #include <dfm-base/base/standardpaths.h>
 #include <dfm-base/base/schemefactory.h>
@@ -11,6 +12,7 @@
 #include <dfm-base/file/local/localfilehandler.h>
 #include <dfm-base/utils/fileutils.h>
 #include <dfm-base/base/device/deviceproxymanager.h>
+#include <dfm-base/base/device/deviceutils.h>
 #include <dfm-base/base/configs/dconfig/dconfigmanager.h>
 
 #include <dfm-io/dfmio_utils.h>
@@ -130,6 +132,12 @@ QString ThumbnailHelper::saveThumbnail(const QUrl &url, const QImage &img, Thumb
     if (!info)
         return "";
 
+    if (ThumbnailStore::isEnabled()) {
+        const QString &thumbnail = ThumbnailStore::instance()->insert(info->pathOf(PathInfoType::kAbsoluteFilePath), img, size);
+        if (!thumbnail.isEmpty())
+            return thumbnail;
+    }
+
     QImage tmpImg = img;
     const QString &fileUrl = url.toString(QUrl::FullyEncoded);
     const QString &thumbnailName = ThumbnailHelper::dataToMd5Hex(fileUrl.toLocal8Bit()) + kFormat;
@@ -166,6 +174,16 @@ QImage ThumbnailHelper::thumbnailImage(const QUrl &fileUrl, ThumbnailSize size)
         return img;
     }
 
+    const bool storeEnabled = ThumbnailStore::isEnabled();
+    if (storeEnabled) {
+        QString thumbnail;
+        QImage img = ThumbnailStore::instance()->image(filePath, size, &thumbnail);
+        if (!img.isNull()) {
+            img.setText(QT_STRINGIFY(Thumb::Path), thumbnail);
+            return img;
+        }
+    }
+
     const QString thumbnailName = dataToMd5Hex((QUrl::fromLocalFile(filePath).toString(QUrl::FullyEncoded)).toLocal8Bit()) + kFormat;
     QString thumbnail = DFMIO::DFMUtils::buildFilePath(sizeToFilePath(size).toStdString().c_str(), thumbnailName.toStdString().c_str(), nullptr);
     if (!DFMIO::DFile(thumbnail).exists())
@@ -185,9 +203,33 @@ QImage ThumbnailHelper::thumbnailImage(const QUrl &fileUrl, ThumbnailSize size)
         return {};
     }
 
+    // 已经存在的缩略图导入到打包存储中，下次直接从存储中读取
+    if (storeEnabled && !image.isNull()) {
+        const QString &storePath = ThumbnailStore::instance()->insert(filePath, image, size);
+        if (!storePath.isEmpty()) {
+            image.setText(QT_STRINGIFY(Thumb::Path), storePath);
+            return image;
+        }
+    }
+
     image.setText(QT_STRINGIFY(Thumb::Path), thumbnail);
     return image;
 }
+/*!
+ * \brief ThumbnailHelper::thumbnailIcon 根据缩略图路径创建图标，需要在主线程中调用
+ * \param thumbnail 缩略图文件路径或者打包存储中的引用
+ */
+QIcon ThumbnailHelper::thumbnailIcon(const QString &thumbnail)
+{
+    if (!ThumbnailStore::isStorePath(thumbnail))
+        return QIcon(thumbnail);
+
+    const QImage &img = ThumbnailStore::instance()->image(thumbnail);
+    if (img.isNull())
+        return QIcon();
+
+    return QIcon(QPixmap::fromImage(img));
+}
 
 void ThumbnailHelper::setSizeLimit(const QMimeType &mime, qint64 size)
 {
@@ -235,7 +277,8 @@ bool ThumbnailHelper::checkThumbEnable(const QUrl &url)
     bool enable{ true };
     if (FileUtils::isMtpFile(fileUrl)) { // 是否是mtpfile
         enable = DConfigManager::instance()->value("org.deepin.dde.file-manager.preview", "mtpThumbnailEnable", true).toBool();
-    } else if (DevProxyMng->isFileOfProtocolMounts(fileUrl.path())) { // 是否是协议设备
+    } else if (DevProxyMng->isFileOfProtocolMounts(fileUrl.path())
+               || DeviceUtils::isOnLowSpeedFileSystem(fileUrl)) {   // 是否是协议设备或者网络文件系统(nfs, cifs...)
         enable = Application::instance()->genericAttribute(Application::kShowThunmbnailInRemote).toBool();
     }
 
@@ -0,0 +1,724 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "thumbnailstore.h"
+
+#include <dfm-base/base/standardpaths.h>
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <QtConcurrent>
+#include <QImageReader>
+#include <QDirIterator>
+#include <QDir>
+
+#include <algorithm>
+#include <cstring>
+#include <sys/file.h>
+#include <sys/stat.h>
+
+using namespace dfmbase;
+DFMGLOBAL_USE_NAMESPACE
+
+namespace {
+
+constexpr char kConfName[] { "org.deepin.dde.file-manager.preview" };
+constexpr char kStoreEnableKey[] { "thumbnailStoreEnable" };
+constexpr char kStoreSizeLimitKey[] { "thumbnailStoreSizeLimit" };   // MB
+constexpr int kDefaultSizeLimit { 512 };
+
+constexpr char kSegmentMagic[8] { 'D', 'F', 'M', 'T', 'H', 'M', 'B', '\0' };
+constexpr quint32 kSegmentVersion { 1 };
+constexpr quint32 kRecordMagic { 0x424d4854 };   // "THMB"
+constexpr char kSegmentSuffix[] { ".seg" };
+constexpr char kImportedMarker[] { ".imported" };
+constexpr qint64 kMaxSegmentSize { 64 * 1024 * 1024 };
+// 超过这个大小的缩略图用zlib压缩，小图直接保存ARGB32数据
+constexpr qint64 kRawLimit { 64 * 1024 };
+
+enum RecordFormat : quint32 {
+    kFormatRaw = 0,
+    kFormatZlib = 1,
+};
+
+struct SegmentHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 reserved;
+};
+
+struct RecordHeader
+{
+    quint32 magic;
+    quint32 format;
+    quint64 device;
+    quint64 inode;
+    qint64 mtime;   // 源文件的修改时间，单位ns
+    qint64 size;
+    quint32 thumbSize;
+    quint32 width;
+    quint32 height;
+    quint32 bytesPerLine;
+    quint32 payloadSize;
+    quint32 reserved;
+};
+
+static_assert(sizeof(SegmentHeader) == 16, "segment header layout changed");
+static_assert(sizeof(RecordHeader) == 64, "record header layout changed");
+
+// 记录按8字节对齐，保证mmap后可以直接读取记录头
+qint64 alignedSize(qint64 size)
+{
+    return (size + 7) & ~qint64(7);
+}
+
+}   // namespace
+
+namespace dfmbase {
+uint qHash(const ThumbnailStore::StoreKey &key, uint seed)
+{
+    return ::qHash(key.inode, seed) ^ ::qHash(key.mtime, seed) ^ ::qHash(key.device ^ (quint64(key.thumbSize) << 32), seed);
+}
+}   // namespace dfmbase
+
+ThumbnailStore *ThumbnailStore::instance()
+{
+    static ThumbnailStore ins;
+    return &ins;
+}
+
+bool ThumbnailStore::isEnabled()
+{
+    return DConfigManager::instance()->value(kConfName, kStoreEnableKey, false).toBool();
+}
+
+bool ThumbnailStore::isStorePath(const QString &thumbnail)
+{
+    return thumbnail.startsWith(kPathPrefix);
+}
+
+ThumbnailStore::ThumbnailStore(const QString &storeDir)
+    : dir(storeDir)
+{
+    if (dir.isEmpty())
+        dir = QString("%1/%2").arg(StandardPaths::location(StandardPaths::kCachePath), "thumbnailstore");
+
+    const int sizeLimit = DConfigManager::instance()->value(kConfName, kStoreSizeLimitKey, kDefaultSizeLimit).toInt();
+    limit = static_cast<qint64>(sizeLimit > 0 ? sizeLimit : kDefaultSizeLimit) * 1024 * 1024;
+}
+
+ThumbnailStore::~ThumbnailStore()
+{
+    stopped = true;
+    importFuture.waitForFinished();
+    compactFuture.waitForFinished();
+
+    QMutexLocker lk(&mutex);
+    for (int id : segments.keys())
+        closeSegment(id, false);
+}
+/*!
+ * \brief ThumbnailStore::image 读取文件的缩略图
+ * \param filePath 源文件
+ * \param size 缩略图尺寸
+ * \param thumbnail 缩略图的引用路径
+ * \return 缓存中没有或者源文件已经修改时返回空
+ */
+QImage ThumbnailStore::image(const QString &filePath, ThumbnailSize size, QString *thumbnail)
+{
+    StoreKey key;
+    if (!makeKey(filePath, size, &key))
+        return {};
+
+    QImage img;
+    {
+        QMutexLocker lk(&mutex);
+        load();
+        img = readImage(key);
+    }
+
+    if (!img.isNull() && thumbnail)
+        *thumbnail = keyToPath(key);
+    return img;
+}
+
+QImage ThumbnailStore::image(const QString &thumbnail)
+{
+    StoreKey key;
+    if (!pathToKey(thumbnail, &key))
+        return {};
+
+    QMutexLocker lk(&mutex);
+    load();
+    return readImage(key);
+}
+/*!
+ * \brief ThumbnailStore::insert 保存文件的缩略图
+ * \param filePath 源文件
+ * \param img 缩略图
+ * \param size 缩略图尺寸
+ * \return 缩略图的引用路径，失败时返回空
+ */
+QString ThumbnailStore::insert(const QString &filePath, const QImage &img, ThumbnailSize size)
+{
+    StoreKey key;
+    if (img.isNull() || !makeKey(filePath, size, &key))
+        return "";
+
+    const QImage &argb = img.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    const int bytesPerLine = argb.width() * 4;
+    QByteArray payload;
+    payload.resize(bytesPerLine * argb.height());
+    for (int y = 0; y < argb.height(); ++y)
+        memcpy(payload.data() + y * bytesPerLine, argb.constScanLine(y), static_cast<size_t>(bytesPerLine));
+
+    RecordHeader header {};
+    header.magic = kRecordMagic;
+    header.format = kFormatRaw;
+    if (payload.size() > kRawLimit) {
+        payload = qCompress(payload, 1);
+        header.format = kFormatZlib;
+    }
+    header.device = key.device;
+    header.inode = key.inode;
+    header.mtime = key.mtime;
+    header.size = key.size;
+    header.thumbSize = key.thumbSize;
+    header.width = static_cast<quint32>(argb.width());
+    header.height = static_cast<quint32>(argb.height());
+    header.bytesPerLine = static_cast<quint32>(bytesPerLine);
+    header.payloadSize = static_cast<quint32>(payload.size());
+
+    QByteArray record(reinterpret_cast<const char *>(&header), sizeof(header));
+    record.append(payload);
+    record.append(QByteArray(static_cast<int>(alignedSize(record.size()) - record.size()), '\0'));
+
+    {
+        QMutexLocker lk(&mutex);
+        load();
+        if (!appendRecord(key, record))
+            return "";
+        evict();
+    }
+
+    return keyToPath(key);
+}
+/*!
+ * \brief ThumbnailStore::startImport 在线程池中导入已有的缩略图，析构时等待导入结束
+ */
+void ThumbnailStore::startImport()
+{
+    QMutexLocker lk(&mutex);
+    if (importFuture.isRunning())
+        return;
+
+    importFuture = QtConcurrent::run([this] { importFreedesktopCache(); });
+}
+/*!
+ * \brief ThumbnailStore::importFreedesktopCache 导入~/.cache/thumbnails下已有的缩略图，只执行一次
+ * 缩略图中记录的修改时间和源文件一致时才导入，缓存容量用完后停止
+ */
+void ThumbnailStore::importFreedesktopCache()
+{
+    const QString &marker = QString("%1/%2").arg(storeDir(), kImportedMarker);
+    if (QFile::exists(marker))
+        return;
+
+    const QList<QPair<StandardPaths::StandardLocation, ThumbnailSize>> thumbnailDirs {
+        { StandardPaths::kThumbnailLargePath, kLarge },
+        { StandardPaths::kThumbnailNormalPath, kNormal },
+        { StandardPaths::kThumbnailSmallPath, kSmall }
+    };
+
+    int count = 0;
+    for (const auto &thumbnailDir : thumbnailDirs) {
+        QDirIterator iter(StandardPaths::location(thumbnailDir.first), { "*.png" }, QDir::Files);
+        while (iter.hasNext() && usedSize() < sizeLimit() && !stopped) {
+            QImageReader reader(iter.next(), "png");
+            QString uri = reader.text("Thumb::URI");
+            if (uri.isEmpty())
+                uri = reader.text(QT_STRINGIFY(Thumb::URL));
+
+            const QString &filePath = QUrl(uri).toLocalFile();
+            struct stat st;
+            if (filePath.isEmpty() || ::stat(QFile::encodeName(filePath).constData(), &st) != 0)
+                continue;
+
+            if (static_cast<qint64>(st.st_mtime) != reader.text(QT_STRINGIFY(Thumb::MTime)).toLongLong())
+                continue;
+
+            const QImage &img = reader.read();
+            if (!img.isNull() && !insert(filePath, img, thumbnailDir.second).isEmpty())
+                ++count;
+        }
+    }
+
+    qCInfo(logDFMBase) << "thumbnail: import thumbnails to store, count: " << count;
+    // 中途退出时下次启动继续导入
+    if (stopped)
+        return;
+
+    QDir().mkpath(storeDir());
+    QFile file(marker);
+    file.open(QIODevice::WriteOnly);
+}
+/*!
+ * \brief ThumbnailStore::compact 将失效数据超过一半的段文件中的有效缩略图复制到当前段文件，然后删除旧的段文件
+ * 每次只在复制一条记录时加锁，不会长时间阻塞读取
+ */
+void ThumbnailStore::compact()
+{
+    QList<int> ids;
+    {
+        QMutexLocker lk(&mutex);
+        load();
+        const int activeId = segments.isEmpty() ? 0 : segments.lastKey();
+        for (auto iter = segments.cbegin(); iter != segments.cend(); ++iter) {
+            if (iter.key() != activeId && iter->liveSize * 2 < iter->size)
+                ids.append(iter.key());
+        }
+    }
+
+    for (int id : ids) {
+        QList<StoreKey> keys;
+        {
+            QMutexLocker lk(&mutex);
+            // 其他进程正在写入的段文件不能删除
+            auto segment = segments.find(id);
+            if (segment == segments.end() || !lockSegment(&segment.value()))
+                continue;
+
+            for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter) {
+                if (iter->segment == id)
+                    keys.append(iter.key());
+            }
+        }
+
+        for (const StoreKey &key : keys) {
+            QMutexLocker lk(&mutex);
+            auto iter = entries.find(key);
+            if (iter == entries.end() || iter->segment != id)
+                continue;
+
+            const uchar *data = recordData(iter.value());
+            if (!data)
+                continue;
+
+            const quint64 lastAccess = iter->lastAccess;
+            const QByteArray record(reinterpret_cast<const char *>(data), static_cast<int>(iter->recordSize));
+            if (appendRecord(key, record))
+                entries[key].lastAccess = lastAccess;
+        }
+
+        QMutexLocker lk(&mutex);
+        closeSegment(id, true);
+    }
+}
+
+void ThumbnailStore::setSizeLimit(qint64 bytes)
+{
+    QMutexLocker lk(&mutex);
+    limit = bytes;
+    evict();
+}
+
+qint64 ThumbnailStore::sizeLimit() const
+{
+    QMutexLocker lk(&mutex);
+    return limit;
+}
+
+qint64 ThumbnailStore::usedSize() const
+{
+    QMutexLocker lk(&mutex);
+    return liveSize;
+}
+
+QString ThumbnailStore::storeDir() const
+{
+    return dir;
+}
+
+bool ThumbnailStore::makeKey(const QString &filePath, ThumbnailSize size, StoreKey *key)
+{
+    struct stat st;
+    if (filePath.isEmpty() || ::stat(QFile::encodeName(filePath).constData(), &st) != 0)
+        return false;
+
+    key->device = static_cast<quint64>(st.st_dev);
+    key->inode = static_cast<quint64>(st.st_ino);
+    key->mtime = st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+    key->size = st.st_size;
+    key->thumbSize = static_cast<quint32>(size);
+    return true;
+}
+
+QString ThumbnailStore::keyToPath(const StoreKey &key)
+{
+    return QString("%1%2_%3_%4_%5_%6").arg(kPathPrefix).arg(key.device).arg(key.inode).arg(key.mtime).arg(key.size).arg(key.thumbSize);
+}
+
+bool ThumbnailStore::pathToKey(const QString &thumbnail, StoreKey *key)
+{
+    if (!isStorePath(thumbnail))
+        return false;
+
+    const auto &fields = thumbnail.mid(static_cast<int>(strlen(kPathPrefix))).split('_');
+    if (fields.count() != 5)
+        return false;
+
+    bool ok[5] {};
+    key->device = fields.at(0).toULongLong(&ok[0]);
+    key->inode = fields.at(1).toULongLong(&ok[1]);
+    key->mtime = fields.at(2).toLongLong(&ok[2]);
+    key->size = fields.at(3).toLongLong(&ok[3]);
+    key->thumbSize = fields.at(4).toUInt(&ok[4]);
+    return std::all_of(std::begin(ok), std::end(ok), [](bool v) { return v; });
+}
+/*!
+ * \brief ThumbnailStore::load 第一次使用时读取所有段文件建立索引，调用时需要持有mutex
+ */
+void ThumbnailStore::load()
+{
+    if (loaded)
+        return;
+
+    loaded = true;
+    QDir().mkpath(dir);
+
+    QList<int> ids;
+    const auto &names = QDir(dir).entryList({ QString("*%1").arg(kSegmentSuffix) }, QDir::Files);
+    for (const QString &name : names) {
+        bool ok = false;
+        const int id = name.left(name.length() - static_cast<int>(strlen(kSegmentSuffix))).toInt(&ok);
+        if (ok && id > 0)
+            ids.append(id);
+    }
+
+    std::sort(ids.begin(), ids.end());
+    for (int id : ids)
+        loadSegment(id);
+
+    evict();
+}
+/*!
+ * \brief ThumbnailStore::loadSegment 扫描段文件中的记录，后写入的记录覆盖先写入的。
+ * 异常退出时段文件末尾可能有写了一半的记录，截断到最后一条完整的记录
+ */
+void ThumbnailStore::loadSegment(int id)
+{
+    const QString &path = segmentPath(id);
+    QFile *file = new QFile(path);
+    if (!file->open(QIODevice::ReadWrite)) {
+        delete file;
+        return;
+    }
+
+    // 其他进程刚创建的段文件还没有写入文件头
+    if (file->size() < static_cast<qint64>(sizeof(SegmentHeader))) {
+        if (flock(file->handle(), LOCK_EX | LOCK_NB) == 0)
+            file->remove();
+        delete file;
+        return;
+    }
+
+    Segment segment;
+    segment.file = file;
+    segment.size = file->size();
+    segment.data = file->map(0, segment.size);
+    segment.mappedSize = segment.data ? segment.size : 0;
+
+    const auto segmentHeader = reinterpret_cast<const SegmentHeader *>(segment.data);
+    if (!segment.data || memcmp(segmentHeader->magic, kSegmentMagic, sizeof(kSegmentMagic)) != 0
+        || segmentHeader->version != kSegmentVersion) {
+        qCWarning(logDFMBase) << "thumbnail: the store segment is broken, remove it: " << path;
+        segments.insert(id, segment);
+        closeSegment(id, true);
+        return;
+    }
+
+    segments.insert(id, segment);
+    qint64 offset = sizeof(SegmentHeader);
+    while (offset + static_cast<qint64>(sizeof(RecordHeader)) <= segment.size) {
+        const auto header = reinterpret_cast<const RecordHeader *>(segment.data + offset);
+        const qint64 recordSize = alignedSize(static_cast<qint64>(sizeof(RecordHeader)) + header->payloadSize);
+        if (header->magic != kRecordMagic || header->format > kFormatZlib || offset + recordSize > segment.size)
+            break;
+
+        StoreKey key;
+        key.device = header->device;
+        key.inode = header->inode;
+        key.mtime = header->mtime;
+        key.size = header->size;
+        key.thumbSize = header->thumbSize;
+
+        auto iter = entries.find(key);
+        if (iter != entries.end())
+            removeEntry(iter);
+
+        StoreEntry entry;
+        entry.segment = id;
+        entry.offset = offset;
+        entry.recordSize = recordSize;
+        entry.lastAccess = ++accessCounter;
+        entries.insert(key, entry);
+        segments[id].liveSize += recordSize;
+        liveSize += recordSize;
+
+        offset += recordSize;
+    }
+
+    // 其他进程正在追加的记录不完整，只有拿到文件锁时才截断
+    Segment &seg = segments[id];
+    if (offset < segment.size && !lockSegment(&seg)) {
+        seg.size = offset;
+    } else if (offset < segment.size) {
+        qCWarning(logDFMBase) << "thumbnail: truncate the store segment " << path << " from " << segment.size << " to " << offset;
+        seg.file->unmap(seg.data);
+        seg.file->resize(offset);
+        seg.size = offset;
+        seg.data = seg.file->map(0, offset);
+        seg.mappedSize = seg.data ? offset : 0;
+    }
+}
+/*!
+ * \brief ThumbnailStore::readImage 从段文件中读取缩略图，调用时需要持有mutex
+ */
+QImage ThumbnailStore::readImage(const StoreKey &key)
+{
+    auto iter = entries.find(key);
+    if (iter == entries.end())
+        return {};
+
+    const uchar *data = recordData(iter.value());
+    if (!data)
+        return {};
+
+    // 段文件被覆盖或者损坏时，记录头和索引不一致，不能当作这个文件的缩略图
+    const auto header = reinterpret_cast<const RecordHeader *>(data);
+    if (header->magic != kRecordMagic || header->device != key.device || header->inode != key.inode
+        || header->mtime != key.mtime || header->size != key.size || header->thumbSize != key.thumbSize
+        || static_cast<qint64>(sizeof(RecordHeader)) + header->payloadSize > iter->recordSize) {
+        qCWarning(logDFMBase) << "thumbnail: the record in store does not match the key, segment: " << iter->segment << " offset: " << iter->offset;
+        removeEntry(iter);
+        return {};
+    }
+
+    iter->lastAccess = ++accessCounter;
+    const uchar *payload = data + sizeof(RecordHeader);
+    const qint64 pixelSize = static_cast<qint64>(header->bytesPerLine) * header->height;
+
+    QByteArray unpacked;
+    if (header->format == kFormatZlib) {
+        unpacked = qUncompress(payload, static_cast<int>(header->payloadSize));
+        payload = reinterpret_cast<const uchar *>(unpacked.constData());
+        if (unpacked.size() != pixelSize)
+            payload = nullptr;
+    } else if (header->payloadSize != pixelSize) {
+        payload = nullptr;
+    }
+
+    QImage img(static_cast<int>(header->width), static_cast<int>(header->height), QImage::Format_ARGB32_Premultiplied);
+    if (!payload || img.isNull() || header->bytesPerLine != header->width * 4) {
+        qCWarning(logDFMBase) << "thumbnail: the record in store is broken, segment: " << iter->segment << " offset: " << iter->offset;
+        removeEntry(iter);
+        return {};
+    }
+
+    for (int y = 0; y < img.height(); ++y)
+        memcpy(img.scanLine(y), payload + y * header->bytesPerLine, header->bytesPerLine);
+
+    return img;
+}
+/*!
+ * \brief ThumbnailStore::appendRecord 将记录追加到当前段文件，调用时需要持有mutex
+ */
+bool ThumbnailStore::appendRecord(const StoreKey &key, const QByteArray &record)
+{
+    Segment *segment = activeSegment();
+    if (!segment)
+        return false;
+
+    const int id = segments.lastKey();
+    if (!segment->file->seek(segment->size) || segment->file->write(record) != record.size() || !segment->file->flush()) {
+        qCWarning(logDFMBase) << "thumbnail: write the store segment failed: " << segment->file->errorString();
+        segment->file->resize(segment->size);
+        return false;
+    }
+
+    auto iter = entries.find(key);
+    if (iter != entries.end())
+        removeEntry(iter);
+
+    StoreEntry entry;
+    entry.segment = id;
+    entry.offset = segment->size;
+    entry.recordSize = record.size();
+    entry.lastAccess = ++accessCounter;
+    entries.insert(key, entry);
+
+    segment->size += record.size();
+    segment->liveSize += record.size();
+    liveSize += record.size();
+    return true;
+}
+/*!
+ * \brief ThumbnailStore::recordData 返回记录在mmap中的地址，追加写入后需要重新映射，调用时需要持有mutex
+ */
+const uchar *ThumbnailStore::recordData(const StoreEntry &entry)
+{
+    auto iter = segments.find(entry.segment);
+    if (iter == segments.end())
+        return nullptr;
+
+    if (entry.offset + entry.recordSize > iter->mappedSize) {
+        if (iter->data)
+            iter->file->unmap(iter->data);
+        iter->data = iter->file->map(0, iter->size);
+        iter->mappedSize = iter->data ? iter->size : 0;
+    }
+
+    if (!iter->data || entry.offset + entry.recordSize > iter->mappedSize)
+        return nullptr;
+
+    return iter->data + entry.offset;
+}
+/*!
+ * \brief ThumbnailStore::activeSegment 返回用于追加写入的段文件，超过kMaxSegmentSize时新建一个，调用时需要持有mutex
+ */
+ThumbnailStore::Segment *ThumbnailStore::activeSegment()
+{
+    if (!segments.isEmpty() && segments.last().size < kMaxSegmentSize && lockSegment(&segments.last()))
+        return &segments.last();
+
+    // 其他进程创建的段文件不会被覆盖
+    int id = segments.isEmpty() ? 1 : segments.lastKey() + 1;
+    QDir().mkpath(dir);
+    QFile *file = nullptr;
+    for (;; ++id) {
+        file = new QFile(segmentPath(id));
+        if (file->open(QIODevice::ReadWrite | QIODevice::NewOnly))
+            break;
+
+        const bool exists = file->exists();
+        if (!exists)
+            qCWarning(logDFMBase) << "thumbnail: create the store segment failed: " << file->errorString();
+        delete file;
+        if (!exists)
+            return nullptr;
+    }
+
+    Segment segment;
+    segment.file = file;
+    if (!lockSegment(&segment)) {
+        delete file;
+        return nullptr;
+    }
+
+    SegmentHeader header {};
+    memcpy(header.magic, kSegmentMagic, sizeof(kSegmentMagic));
+    header.version = kSegmentVersion;
+    file->write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file->flush();
+
+    segment.size = sizeof(header);
+    segments.insert(id, segment);
+    return &segments.last();
+}
+/*!
+ * \brief ThumbnailStore::lockSegment 获取段文件的排他锁，其他进程持有锁或者在加载之后追加过记录时返回false
+ */
+bool ThumbnailStore::lockSegment(Segment *segment)
+{
+    if (segment->locked)
+        return true;
+
+    if (flock(segment->file->handle(), LOCK_EX | LOCK_NB) != 0)
+        return false;
+
+    // 其他进程追加的记录不在索引中，不在它后面继续写入
+    if (segment->size > 0 && segment->file->size() != segment->size) {
+        flock(segment->file->handle(), LOCK_UN);
+        return false;
+    }
+
+    segment->locked = true;
+    return true;
+}
+
+void ThumbnailStore::removeEntry(QHash<StoreKey, StoreEntry>::iterator iter)
+{
+    auto segment = segments.find(iter->segment);
+    if (segment != segments.end())
+        segment->liveSize -= iter->recordSize;
+    liveSize -= iter->recordSize;
+    entries.erase(iter);
+}
+/*!
+ * \brief ThumbnailStore::evict 超过容量时淘汰最近最少使用的缩略图，直到低于容量的90%，调用时需要持有mutex
+ */
+void ThumbnailStore::evict()
+{
+    if (liveSize <= limit)
+        return;
+
+    QVector<QPair<quint64, StoreKey>> accesses;
+    accesses.reserve(entries.count());
+    for (auto iter = entries.cbegin(); iter != entries.cend(); ++iter)
+        accesses.append({ iter->lastAccess, iter.key() });
+    std::sort(accesses.begin(), accesses.end(), [](const QPair<quint64, StoreKey> &a, const QPair<quint64, StoreKey> &b) {
+        return a.first < b.first;
+    });
+
+    const qint64 target = limit / 10 * 9;
+    for (const auto &access : accesses) {
+        if (liveSize <= target)
+            break;
+        removeEntry(entries.find(access.second));
+    }
+
+    startCompact();
+}
+
+void ThumbnailStore::closeSegment(int id, bool remove)
+{
+    auto iter = segments.find(id);
+    if (iter == segments.end())
+        return;
+
+    if (remove) {
+        for (auto entry = entries.begin(); entry != entries.end();) {
+            if (entry->segment == id) {
+                liveSize -= entry->recordSize;
+                entry = entries.erase(entry);
+            } else {
+                ++entry;
+            }
+        }
+    }
+
+    if (iter->data)
+        iter->file->unmap(iter->data);
+    iter->file->close();
+    if (remove)
+        iter->file->remove();
+    delete iter->file;
+    segments.erase(iter);
+}
+
+void ThumbnailStore::startCompact()
+{
+    if (compacting.exchange(true))
+        return;
+
+    compactFuture = QtConcurrent::run([this] {
+        compact();
+        compacting = false;
+    });
+}
+
+QString ThumbnailStore::segmentPath(int id) const
+{
+    return QString("%1/%2%3").arg(dir).arg(id).arg(kSegmentSuffix);
+}
@@ -0,0 +1,126 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef THUMBNAILSTORE_H
+#define THUMBNAILSTORE_H
+
+#include <dfm-base/dfm_base_global.h>
+#include <dfm-base/dfm_global_defines.h>
+
+#include <QImage>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QFile>
+#include <QFuture>
+
+#include <atomic>
+
+namespace dfmbase {
+
+/*!
+ * \brief The ThumbnailStore class 打包存储的缩略图缓存
+ *
+ * 缩略图以预先缩放好的ARGB32数据追加写入到段文件中，较大的缩略图用zlib压缩，段文件通过mmap读取。
+ * 内存中的索引以源文件的(设备号, inode, 修改时间, 大小)和缩略图尺寸作为key，读取时不需要计算md5和打开文件。
+ * 缓存超过容量时按照最近最少使用淘汰，失效数据超过一半的段文件在后台压缩。
+ * 多个进程共用缓存目录，进程只向自己持有flock的段文件追加写入，其他进程正在写入的段文件不会被截断或者压缩。
+ * 缩略图的路径使用kPathPrefix开头的引用，通过ThumbnailHelper::thumbnailIcon创建图标。
+ */
+class ThumbnailStore
+{
+public:
+    static constexpr char kPathPrefix[] { "thumbnailstore:" };
+
+    static ThumbnailStore *instance();
+    static bool isEnabled();
+    static bool isStorePath(const QString &thumbnail);
+
+    QImage image(const QString &filePath, DFMGLOBAL_NAMESPACE::ThumbnailSize size, QString *thumbnail = nullptr);
+    QImage image(const QString &thumbnail);
+    QString insert(const QString &filePath, const QImage &img, DFMGLOBAL_NAMESPACE::ThumbnailSize size);
+
+    void startImport();
+    void importFreedesktopCache();
+    void compact();
+
+    void setSizeLimit(qint64 bytes);
+    qint64 sizeLimit() const;
+    qint64 usedSize() const;
+    QString storeDir() const;
+
+protected:
+    explicit ThumbnailStore(const QString &dir = QString());
+    ~ThumbnailStore();
+
+private:
+    struct StoreKey
+    {
+        quint64 device { 0 };
+        quint64 inode { 0 };
+        qint64 mtime { 0 };
+        qint64 size { 0 };
+        quint32 thumbSize { 0 };
+
+        bool operator==(const StoreKey &other) const
+        {
+            return device == other.device && inode == other.inode && mtime == other.mtime
+                    && size == other.size && thumbSize == other.thumbSize;
+        }
+    };
+    friend uint qHash(const StoreKey &key, uint seed);
+
+    struct StoreEntry
+    {
+        int segment { 0 };
+        qint64 offset { 0 };
+        qint64 recordSize { 0 };
+        quint64 lastAccess { 0 };
+    };
+
+    struct Segment
+    {
+        QFile *file { nullptr };
+        uchar *data { nullptr };
+        qint64 mappedSize { 0 };
+        qint64 size { 0 };
+        qint64 liveSize { 0 };
+        bool locked { false };   // 持有文件锁的段文件只由当前进程追加写入
+    };
+
+    static bool makeKey(const QString &filePath, DFMGLOBAL_NAMESPACE::ThumbnailSize size, StoreKey *key);
+    static QString keyToPath(const StoreKey &key);
+    static bool pathToKey(const QString &thumbnail, StoreKey *key);
+
+    void load();
+    void loadSegment(int id);
+    QImage readImage(const StoreKey &key);
+    bool appendRecord(const StoreKey &key, const QByteArray &record);
+    const uchar *recordData(const StoreEntry &entry);
+    Segment *activeSegment();
+    static bool lockSegment(Segment *segment);
+    void removeEntry(QHash<StoreKey, StoreEntry>::iterator iter);
+    void evict();
+    void closeSegment(int id, bool remove);
+    void startCompact();
+    QString segmentPath(int id) const;
+
+private:
+    QString dir;
+    mutable QMutex mutex;
+    bool loaded { false };
+    QHash<StoreKey, StoreEntry> entries;
+    QMap<int, Segment> segments;
+    qint64 liveSize { 0 };
+    qint64 limit { 0 };
+    quint64 accessCounter { 0 };
+    std::atomic_bool compacting { false };
+    std::atomic_bool stopped { false };
+    QFuture<void> compactFuture;
+    QFuture<void> importFuture;
+};
+
+}   // namespace dfmbase
+
+#endif   // THUMBNAILSTORE_H
@@ -15,40 +15,236 @@
 #include <QDebug>
 
 using namespace dfmbase;
+DFMGLOBAL_USE_NAMESPACE
+
+static constexpr int kMaxCheckCount { 10 };
+static constexpr int kCheckInterval { 2000 };   // ms
 
 ThumbnailWorkerPrivate::ThumbnailWorkerPrivate(ThumbnailWorker *qq)
     : q(qq)
 {
-    thumbHelper.initSizeLimit();
+    pool.setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+}
+/*!
+ * \brief ThumbnailWorkerPrivate::enqueueTask 将任务加入对应优先级的队列，调用时需要持有mutex
+ * 同一个文件只保留一个任务，再次请求时只会提升任务的优先级
+ * \param task 任务
+ * \param atHead 是否插入到队列头部
+ */
+void ThumbnailWorkerPrivate::enqueueTask(const ThumbnailTask &task, bool atHead)
+{
+    auto iter = queuedTasks.find(task.url);
+    if (iter != queuedTasks.end()) {
+        if (iter.value() <= task.priority)
+            return;
+        removeTask(task.url);
+    }
+
+    auto &lane = lanes[static_cast<int>(task.priority)];
+    if (atHead)
+        lane.prepend(task);
+    else
+        lane.append(task);
+    queuedTasks.insert(task.url, task.priority);
+}
+/*!
+ * \brief ThumbnailWorkerPrivate::removeTask 将任务从队列中移除，调用时需要持有mutex
+ * \param url 文件
+ * \return 任务在队列中并且已经移除时返回true
+ */
+bool ThumbnailWorkerPrivate::removeTask(const QUrl &url)
+{
+    auto iter = queuedTasks.find(url);
+    if (iter == queuedTasks.end())
+        return false;
+
+    auto &lane = lanes[static_cast<int>(iter.value())];
+    queuedTasks.erase(iter);
+    for (int i = 0; i < lane.count(); ++i) {
+        if (lane.at(i).url == url) {
+            lane.removeAt(i);
+            return true;
+        }
+    }
+
+    return false;
+}
+/*!
+ * \brief ThumbnailWorkerPrivate::startLoops 按照待执行的任务数启动线程池中的任务循环，调用时需要持有mutex
+ */
+void ThumbnailWorkerPrivate::startLoops()
+{
+    const int count = qMin(pool.maxThreadCount(), queuedTasks.count());
+    while (runningLoops < count) {
+        ++runningLoops;
+        QtConcurrent::run(&pool, [this] { runTasks(); });
+    }
+}
+/*!
+ * \brief ThumbnailWorkerPrivate::runTasks 线程池中的任务循环，没有可以执行的任务时退出
+ * DMimeDatabase和ThumbnailHelper内部有缓存，不是线程安全的，每个循环使用自己的对象
+ */
+void ThumbnailWorkerPrivate::runTasks()
+{
+    ThumbnailHelper helper;
+    helper.initSizeLimit();
+    DMimeDatabase mimeDb;
+    QMap<QString, ThumbnailWorker::ThumbnailCreator> creatorMap;
+    {
+        QMutexLocker lk(&mutex);
+        creatorMap = creators;
+    }
+
+    ThumbnailTask task;
+    while (takeTask(&task)) {
+        // 第一次执行时先检查缓存，然后按照mime type分类
+        if (task.kind == TaskKind::kUnknown) {
+            if (!helper.checkThumbEnable(task.url))
+                continue;
+
+            const auto &img = ThumbnailHelper::thumbnailImage(task.url, task.size);
+            if (!img.isNull()) {
+                Q_EMIT q->thumbnailCreateFinished(task.url, img.text(QT_STRINGIFY(Thumb::Path)));
+                continue;
+            }
+
+            task.mimeName = mimeDb.mimeTypeForUrl(task.url).name();
+            task.kind = kindOf(task.mimeName);
+            if (!acquireSlot(task))
+                continue;
+        }
+
+        // check whether the file is stable
+        // if not, rejoin the queue and create thumbnail later
+        if (checkFileStable(task.url)) {
+            const auto &thumbnailPath = createThumbnail(task, &helper, creatorMap);
+            if (!thumbnailPath.isEmpty())
+                Q_EMIT q->thumbnailCreateFinished(task.url, thumbnailPath);
+            else
+                Q_EMIT q->thumbnailCreateFailed(task.url);
+        } else if (++task.checkCount <= kMaxCheckCount) {   // 超过10次，放弃生成
+            delayTask(task);
+        }
+
+        releaseSlot(task.kind);
+    }
+}
+/*!
+ * \brief ThumbnailWorkerPrivate::takeTask 按照优先级取出第一个可以执行的任务
+ * 已经分类的任务会同时占用该类型的执行数量，类型的执行数量已满时跳过该任务
+ * \param task 取出的任务
+ * \return 没有可以执行的任务时返回false，任务循环需要退出
+ */
+bool ThumbnailWorkerPrivate::takeTask(ThumbnailTask *task)
+{
+    QMutexLocker lk(&mutex);
+    if (!isStoped) {
+        for (auto &lane : lanes) {
+            for (int i = 0; i < lane.count(); ++i) {
+                const auto kind = lane.at(i).kind;
+                if (kind != TaskKind::kUnknown && runningKinds[static_cast<int>(kind)] >= kindLimit(kind))
+                    continue;
+
+                *task = lane.takeAt(i);
+                queuedTasks.remove(task->url);
+                if (kind != TaskKind::kUnknown)
+                    ++runningKinds[static_cast<int>(kind)];
+                return true;
+            }
+        }
+    }
+
+    --runningLoops;
+    return false;
+}
+/*!
+ * \brief ThumbnailWorkerPrivate::acquireSlot 占用任务类型的执行数量
+ * 执行数量已满时任务放回队列头部，等待同类型的任务完成后再执行
+ * \param task 已经分类的任务
+ * \return 是否可以执行
+ */
+bool ThumbnailWorkerPrivate::acquireSlot(const ThumbnailTask &task)
+{
+    QMutexLocker lk(&mutex);
+    auto &running = runningKinds[static_cast<int>(task.kind)];
+    if (running < kindLimit(task.kind)) {
+        ++running;
+        return true;
+    }
+
+    if (!isStoped)
+        enqueueTask(task, true);
+    return false;
+}
+
+void ThumbnailWorkerPrivate::releaseSlot(TaskKind kind)
+{
+    QMutexLocker lk(&mutex);
+    --runningKinds[static_cast<int>(kind)];
+}
+/*!
+ * \brief ThumbnailWorkerPrivate::kindLimit 每种类型同时执行的任务数
+ * 视频需要启动ffmpeg子进程，文档需要渲染页面，限制它们的数量，避免占满线程池导致图片的缩略图迟迟不能生成
+ */
+int ThumbnailWorkerPrivate::kindLimit(TaskKind kind) const
+{
+    const int threadCount = pool.maxThreadCount();
+    switch (kind) {
+    case TaskKind::kVideo:
+        return qMax(1, threadCount / 4);
+    case TaskKind::kDocument:
+        return qMax(1, threadCount / 2);
+    default:
+        return threadCount;
+    }
 }
 
-QString ThumbnailWorkerPrivate::createThumbnail(const QUrl &url, Global::ThumbnailSize size)
+ThumbnailWorkerPrivate::TaskKind ThumbnailWorkerPrivate::kindOf(const QString &mimeName) const
 {
+    if (mimeName.startsWith("video/")
+        || mimeName == Mime::kTypeAppVRRMedia
+        || mimeName == Mime::kTypeAppVMAsf
+        || mimeName == Mime::kTypeAppMxf)
+        return TaskKind::kVideo;
+
+    if (mimeName == Mime::kTypeImageVDjvu || mimeName == Mime::kTypeImageVDMultipage)
+        return TaskKind::kDocument;
+
+    if (mimeName.startsWith("image/") || mimeName.startsWith("audio/"))
+        return TaskKind::kImage;
+
+    return TaskKind::kDocument;
+}
+
+QString ThumbnailWorkerPrivate::createThumbnail(const ThumbnailTask &task, ThumbnailHelper *helper,
+                                                const QMap<QString, ThumbnailWorker::ThumbnailCreator> &creatorMap)
+{
+    const QUrl &url = task.url;
+    const auto size = task.size;
     auto info = InfoFactory::create<FileInfo>(url);
     if (!info)
         return "";
 
-    if (!thumbHelper.canGenerateThumbnail(url)) {
+    if (!helper->canGenerateThumbnail(url)) {
         qCDebug(logDFMBase) << "thumbnail: the file does not support generate thumbnails: " << url;
         return "";
     }
 
     const auto &absoluteFilePath = info->pathOf(PathInfoType::kAbsoluteFilePath);
     // if the file is in thumb dirs, just return the file itself
-    if (thumbHelper.defaultThumbnailDirs().contains(info->pathOf(PathInfoType::kAbsolutePath)))
+    if (ThumbnailHelper::defaultThumbnailDirs().contains(info->pathOf(PathInfoType::kAbsolutePath)))
         return absoluteFilePath;
 
     QImage img;
-    const auto &mime = mimeDb.mimeTypeForUrl(url);
-    const auto &mimeName = mime.name();
+    const auto &mimeName = task.mimeName;
 
-    if (creators.contains(mimeName)) {   // accularate match
-        img = creators.value(mimeName)(absoluteFilePath, size);
+    if (creatorMap.contains(mimeName)) {   // accularate match
+        img = creatorMap.value(mimeName)(absoluteFilePath, size);
     } else {   // pattern match
-        for (auto &mimeRegx : creators.keys()) {
+        for (auto &mimeRegx : creatorMap.keys()) {
             QRegularExpression regx(mimeRegx);
             if (mimeName.contains(regx)) {
-                img = creators.value(mimeRegx)(absoluteFilePath, size);
+                img = creatorMap.value(mimeRegx)(absoluteFilePath, size);
                 break;
             }
         }
@@ -66,7 +262,7 @@ QString ThumbnailWorkerPrivate::createThumbnail(const QUrl &url, Global::Thumbna
     if (img.height() > size || img.width() > size)
         img = img.scaled({ size, size }, Qt::KeepAspectRatio);
 
-    return thumbHelper.saveThumbnail(url, img, size);
+    return helper->saveThumbnail(url, img, size);
 }
 
 bool ThumbnailWorkerPrivate::checkFileStable(const QUrl &url)
@@ -85,50 +281,22 @@ bool ThumbnailWorkerPrivate::checkFileStable(const QUrl &url)
 
     return true;
 }
-
-void ThumbnailWorkerPrivate::startDelayWork()
-{
-    if (!delayTimer) {
-        delayTimer = new QTimer(q);
-        delayTimer->setInterval(2 * 1000);
-        delayTimer->setSingleShot(true);
-        q->connect(delayTimer, &QTimer::timeout, q, [this] { q->onTaskAdded(delayTaskMap); }, Qt::QueuedConnection);
-    }
-
-    delayTimer->start();
-}
-
-QUrl ThumbnailWorkerPrivate::setCheckCount(const QUrl &url, int count)
-{
-    QUrl tmpUrl(url);
-    QUrlQuery query(url.query());
-    query.removeQueryItem("checkCount");
-    query.addQueryItem("checkCount", QString::number(count));
-    tmpUrl.setQuery(query);
-
-    return tmpUrl;
-}
-
-int ThumbnailWorkerPrivate::checkCount(const QUrl &url)
-{
-    if (!url.hasQuery())
-        return 0;
-
-    QUrlQuery query(url.query());
-    return query.queryItemValue("checkCount").toInt();
-}
-
-QUrl ThumbnailWorkerPrivate::clearCheckCount(const QUrl &url)
+/*!
+ * \brief ThumbnailWorkerPrivate::delayTask 文件还在变化，延迟一段时间后重新加入队列
+ * 线程池中的线程没有事件循环，定时器需要在worker所在的线程中启动
+ */
+void ThumbnailWorkerPrivate::delayTask(const ThumbnailTask &task)
 {
-    if (!url.hasQuery())
-        return url;
-
-    QUrl tmpUrl(url);
-    QUrlQuery query(url.query());
-    query.removeQueryItem("checkCount");
-    tmpUrl.setQuery(query);
+    QMetaObject::invokeMethod(q, [this, task] {
+        QTimer::singleShot(kCheckInterval, q, [this, task] {
+            if (isStoped)
+                return;
 
-    return tmpUrl;
+            QMutexLocker lk(&mutex);
+            enqueueTask(task);
+            startLoops();
+        });
+    }, Qt::QueuedConnection);
 }
 
 ThumbnailWorker::ThumbnailWorker(QObject *parent)
@@ -139,12 +307,14 @@ ThumbnailWorker::ThumbnailWorker(QObject *parent)
 
 ThumbnailWorker::~ThumbnailWorker()
 {
+    stop();
 }
 
 bool ThumbnailWorker::registerCreator(const QString &mimeType, ThumbnailWorker::ThumbnailCreator creator)
 {
     Q_ASSERT(creator);
 
+    QMutexLocker lk(&d->mutex);
     if (d->creators.contains(mimeType)) {
         qCWarning(logDFMBase) << "register failed, the mime type has already been registered." << mimeType;
         return false;
@@ -157,58 +327,107 @@ bool ThumbnailWorker::registerCreator(const QString &mimeType, ThumbnailWorker::
 void ThumbnailWorker::stop()
 {
     d->isStoped = true;
-}
+    {
+        QMutexLocker lk(&d->mutex);
+        for (auto &lane : d->lanes)
+            lane.clear();
+        d->queuedTasks.clear();
+    }
 
-void ThumbnailWorker::onTaskAdded(const ThumbnailTaskMap &taskMap)
+    // 等待正在生成的缩略图完成
+    d->pool.waitForDone(3000);
+}
+/*!
+ * \brief ThumbnailWorker::addTask 添加缩略图任务，可以在任意线程调用
+ * \param url 文件
+ * \param size 缩略图大小
+ * \param priority 优先级，任务已经在队列中时只会提升优先级
+ */
+void ThumbnailWorker::addTask(const QUrl &url, ThumbnailSize size, ThumbnailPriority priority)
 {
     if (d->isStoped)
         return;
 
-    QMapIterator<QUrl, Global::ThumbnailSize> iter(taskMap);
-    while (iter.hasNext()) {
-        iter.next();
-        QUrl fileUrl = d->originalUrl = iter.key();
-        if (!d->thumbHelper.checkThumbEnable(fileUrl))
-            continue;
-
-        const auto &img = d->thumbHelper.thumbnailImage(fileUrl, iter.value());
-        if (!img.isNull()) {
-            Q_EMIT thumbnailCreateFinished(iter.key(), img.text(QT_STRINGIFY(Thumb::Path)));
-            continue;
-        }
+    ThumbnailWorkerPrivate::ThumbnailTask task;
+    task.url = url;
+    task.size = size;
+    task.priority = priority;
 
-        createThumbnail(fileUrl, iter.value());
-    }
+    QMutexLocker lk(&d->mutex);
+    d->enqueueTask(task);
+    d->startLoops();
 }
-
-void ThumbnailWorker::createThumbnail(const QUrl &url, Global::ThumbnailSize size)
+/*!
+ * \brief ThumbnailWorker::rescheduleTasks 按照视图的可见区域调整dirUrl下还在排队的任务
+ * 可见的文件按照传入的顺序排到最前面，预取的文件降为kPrefetch，其余的可见和预取任务被取消，
+ * kBackground的任务不会被取消
+ * \param dirUrl 视图的根目录
+ * \param visibleUrls 可见的文件
+ * \param prefetchUrls 即将可见的文件
+ * \return 被取消的任务
+ */
+QList<QUrl> ThumbnailWorker::rescheduleTasks(const QUrl &dirUrl, const QList<QUrl> &visibleUrls, const QList<QUrl> &prefetchUrls)
 {
-    // check whether the file is stable
-    // if not, rejoin the event queue and create thumbnail later
-    if (!d->checkFileStable(url)) {
-        if (!d->delayTaskMap.contains(d->originalUrl)) {
-            d->originalUrl = d->setCheckCount(d->originalUrl, 1);
-        } else {
-            d->delayTaskMap.remove(d->originalUrl);
-            // 超过10次，放弃生成
-            auto count = d->checkCount(d->originalUrl);
-            if (++count > 10)
-                return;
+    QList<QUrl> canceledUrls;
+    QHash<QUrl, ThumbnailWorkerPrivate::ThumbnailTask> matchedTasks;
+    const auto &visibleSet = visibleUrls.toSet();
+    const auto &prefetchSet = prefetchUrls.toSet();
+
+    QMutexLocker lk(&d->mutex);
+    for (auto &lane : d->lanes) {
+        for (int i = lane.count() - 1; i >= 0; --i) {
+            const auto &task = lane.at(i);
+            if (visibleSet.contains(task.url) || prefetchSet.contains(task.url)) {
+                matchedTasks.insert(task.url, task);
+            } else if (task.priority == ThumbnailPriority::kBackground || !dirUrl.isParentOf(task.url)) {
+                continue;
+            } else {
+                canceledUrls.append(task.url);
+            }
 
-            d->originalUrl = d->setCheckCount(d->originalUrl, count);
+            d->queuedTasks.remove(task.url);
+            lane.removeAt(i);
         }
+    }
 
-        d->delayTaskMap.insert(d->originalUrl, size);
-        d->startDelayWork();
-        return;
-    } else if (d->originalUrl.hasQuery()) {
-        d->originalUrl = d->clearCheckCount(d->originalUrl);
+    auto requeue = [&](const QList<QUrl> &urls, ThumbnailPriority priority) {
+        for (const auto &url : urls) {
+            auto iter = matchedTasks.find(url);
+            if (iter == matchedTasks.end())
+                continue;
+
+            iter->priority = priority;
+            d->enqueueTask(iter.value());
+            matchedTasks.erase(iter);
+        }
+    };
+    requeue(visibleUrls, ThumbnailPriority::kVisible);
+    requeue(prefetchUrls, ThumbnailPriority::kPrefetch);
+
+    return canceledUrls;
+}
+/*!
+ * \brief ThumbnailWorker::cancelTasks 取消还在排队的任务，正在执行的任务不能取消
+ * \return 被取消的任务
+ */
+QList<QUrl> ThumbnailWorker::cancelTasks(const QList<QUrl> &urls)
+{
+    QList<QUrl> canceledUrls;
+
+    QMutexLocker lk(&d->mutex);
+    for (const auto &url : urls) {
+        if (d->removeTask(url))
+            canceledUrls.append(url);
     }
 
-    // create thumbnail
-    const auto &thumbnailPath = d->createThumbnail(url, size);
-    if (!thumbnailPath.isEmpty())
-        Q_EMIT thumbnailCreateFinished(d->originalUrl, thumbnailPath);
-    else
-        Q_EMIT thumbnailCreateFailed(d->originalUrl);
+    return canceledUrls;
+}
+
+void ThumbnailWorker::onTaskAdded(const ThumbnailTaskMap &taskMap)
+{
+    QMapIterator<QUrl, Global::ThumbnailSize> iter(taskMap);
+    while (iter.hasNext()) {
+        iter.next();
+        addTask(iter.key(), iter.value());
+    }
 }
@@ -28,6 +28,11 @@ public:
     bool registerCreator(const QString &mimeType, ThumbnailCreator creator);
     void stop();
 
+    void addTask(const QUrl &url, DFMGLOBAL_NAMESPACE::ThumbnailSize size,
+                 DFMGLOBAL_NAMESPACE::ThumbnailPriority priority = DFMGLOBAL_NAMESPACE::ThumbnailPriority::kVisible);
+    QList<QUrl> rescheduleTasks(const QUrl &dirUrl, const QList<QUrl> &visibleUrls, const QList<QUrl> &prefetchUrls);
+    QList<QUrl> cancelTasks(const QList<QUrl> &urls);
+
 public Q_SLOTS:
     void onTaskAdded(const ThumbnailTaskMap &taskMap);
 
@@ -35,9 +40,6 @@ Q_SIGNALS:
     void thumbnailCreateFinished(const QUrl &url, const QString &thumbnail);
     void thumbnailCreateFailed(const QUrl &url);
 
-private:
-    void createThumbnail(const QUrl &url, Global::ThumbnailSize size);
-
 private:
     QScopedPointer<ThumbnailWorkerPrivate> d;
 };
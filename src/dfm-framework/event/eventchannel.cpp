@@ -53,17 +53,30 @@ QVariant EventChannelFuture::result() const
  * \brief
  */
 
+EventChannel::~EventChannel()
+{
+    delete receiver.load(std::memory_order_relaxed);
+    qDeleteAll(retiredReceivers);
+}
+
 QVariant EventChannel::send()
 {
+    EventReaders::Guard guard(readers);
+    const Receiver *r = receiver.load(std::memory_order_acquire);
+    if (r && r->signature && *r->signature == eventSignature<>())
+        return r->invoker(nullptr);
+
     return send(QVariantList());
 }
 
 QVariant EventChannel::send(const QVariantList &params)
 {
-    if (!conn)
+    EventReaders::Guard guard(readers);
+    const Receiver *r = receiver.load(std::memory_order_acquire);
+    if (!r || !r->conn)
         return QVariant();
 
-    return conn(params);
+    return r->conn(params);
 }
 
 EventChannelFuture EventChannel::asyncSend()
@@ -78,6 +91,18 @@ EventChannelFuture EventChannel::asyncSend(const QVariantList &params)
     }));
 }
 
+void EventChannel::setReceiver(EventChannel::Receiver *r)
+{
+    QMutexLocker guard(&receiverMutex);
+    const Receiver *old = receiver.exchange(r, std::memory_order_acq_rel);
+    if (old)
+        retiredReceivers.append(old);
+    if (readers.isIdle()) {
+        qDeleteAll(retiredReceivers);
+        retiredReceivers.clear();
+    }
+}
+
 bool EventChannelManager::disconnect(const QString &space, const QString &topic)
 {
     Q_ASSERT(topic.startsWith(kSlotStrategePrefix));
@@ -87,8 +112,13 @@ bool EventChannelManager::disconnect(const QString &space, const QString &topic)
 bool EventChannelManager::disconnect(const EventType &type)
 {
     QWriteLocker guard(&rwLock);
-    if (channelMap.contains(type))
-        return channelMap.remove(type) > 0;
+    if (channelMap.contains(type)) {
+        channelTable.setValue(type, nullptr);
+        retiredChannels.append(channelMap.take(type));
+        if (readers.isIdle())
+            retiredChannels.clear();
+        return true;
+    }
 
     return false;
 }
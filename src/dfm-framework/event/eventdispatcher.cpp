@@ -10,21 +10,52 @@
 
 DPF_USE_NAMESPACE
 
+EventDispatcher::~EventDispatcher()
+{
+    delete listeners.load(std::memory_order_relaxed);
+    qDeleteAll(retiredListeners);
+}
+
 bool EventDispatcher::dispatch()
 {
-    return dispatch(QVariantList());
+    EventReaders::Guard guard(readers);
+    const Listeners *current = listeners.load(std::memory_order_acquire);
+    if (!current)
+        return true;
+
+    const std::type_info &signature = eventSignature<>();
+    auto invoke = [&signature](const EventHandler<DispatchListener> &h) -> QVariant {
+        if (h.handler.signature && *h.handler.signature == signature)
+            return h.handler.invoker(nullptr);
+        return h.handler.listener(QVariantList());
+    };
+
+    if (std::any_of(current->filters.cbegin(), current->filters.cend(), [&invoke](const EventHandler<DispatchListener> &h) {
+            return invoke(h).toBool();
+        })) {
+        return false;
+    }
+
+    std::for_each(current->handlers.cbegin(), current->handlers.cend(), invoke);
+
+    return true;
 }
 
 bool EventDispatcher::dispatch(const QVariantList &params)
 {
-    if (std::any_of(filterList.begin(), filterList.end(), [params](const EventHandler<Listener> &h) {
-            return h.handler(params).toBool();
+    EventReaders::Guard guard(readers);
+    const Listeners *current = listeners.load(std::memory_order_acquire);
+    if (!current)
+        return true;
+
+    if (std::any_of(current->filters.cbegin(), current->filters.cend(), [&params](const EventHandler<DispatchListener> &h) {
+            return h.handler.listener(params).toBool();
         })) {
         return false;
     }
 
-    std::for_each(handlerList.begin(), handlerList.end(), [params](const EventHandler<Listener> &h) {
-        h.handler(params);
+    std::for_each(current->handlers.cbegin(), current->handlers.cend(), [&params](const EventHandler<DispatchListener> &h) {
+        h.handler.listener(params);
     });
 
     return true;
@@ -42,6 +73,21 @@ QFuture<bool> EventDispatcher::asyncDispatch(const QVariantList &params)
     }));
 }
 
+/*!
+ * \brief EventDispatcher::publishListeners publish a new snapshot of the listeners,
+ * the caller must hold listenerMutex
+ */
+void EventDispatcher::publishListeners()
+{
+    const Listeners *old = listeners.exchange(new Listeners { handlerList, filterList }, std::memory_order_acq_rel);
+    if (old)
+        retiredListeners.append(old);
+    if (readers.isIdle()) {
+        qDeleteAll(retiredListeners);
+        retiredListeners.clear();
+    }
+}
+
 bool EventDispatcherManager::installGlobalEventFilter(QObject *obj, EventDispatcherManager::GlobalFilter filter)
 {
     Q_ASSERT(obj);
@@ -85,8 +131,13 @@ bool EventDispatcherManager::unsubscribe(const QString &space, const QString &to
 bool EventDispatcherManager::unsubscribe(EventType type)
 {
     QWriteLocker guard(&rwLock);
-    if (dispatcherMap.contains(type))
-        return dispatcherMap.remove(type) > 0;
+    if (dispatcherMap.contains(type)) {
+        dispatcherTable.setValue(type, nullptr);
+        retiredDispatchers.append(dispatcherMap.take(type));
+        if (readers.isIdle())
+            retiredDispatchers.clear();
+        return true;
+    }
 
     return false;
 }
@@ -3,16 +3,24 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "dodeletefilesworker.h"
+#include "fileoperations/fileoperationutils/fileoperationsutils.h"
+#include "fileoperations/fileoperationutils/localdeleteengine.h"
+
 #include <dfm-base/base/schemefactory.h>
+#include <dfm-base/utils/fileutils.h>
 
 #include <QUrl>
 #include <QDebug>
+#include <QFile>
+#include <QThread>
 
 DPFILEOPERATIONS_USE_NAMESPACE
 DoDeleteFilesWorker::DoDeleteFilesWorker(QObject *parent)
     : AbstractWorker(parent)
 {
     jobType = AbstractJobHandler::JobType::kDeleteType;
+    // the local files are deleted by LocalDeleteEngine which walks the trees itself
+    recordAllFiles = false;
 }
 
 DoDeleteFilesWorker::~DoDeleteFilesWorker()
@@ -53,16 +61,57 @@ bool DoDeleteFilesWorker::deleteAllFiles()
     // sources file list is checked
     // delete files on can't remove device
     if (isSourceFileLocal) {
-        return deleteFilesOnCanNotRemoveDevice();
+        return deleteFilesOnLocalDevice();
     }
     return deleteFilesOnOtherDevice();
 }
+/*!
+ * \brief DoDeleteFilesWorker::deleteFilesOnLocalDevice Delete files on local devices by LocalDeleteEngine,
+ * the files left by the engine are deleted one by one again, where the errors are handled
+ * \return delete file success
+ */
+bool DoDeleteFilesWorker::deleteFilesOnLocalDevice()
+{
+    LocalDeleteEngine engine(&deleteFilesCount, threadCount);
+    auto engineStateCheck = [this]() {
+        while (currentState == AbstractJobHandler::JobState::kPauseState)
+            QThread::msleep(10);
+        return !isStopped();
+    };
+
+    QList<QUrl> leftUrls;
+    for (const QUrl &url : sourceUrls) {
+        if (!stateCheck())
+            return false;
+
+        emitCurrentTaskNotify(url, QUrl());
+        if (engine.deleteTree(QFile::encodeName(url.toLocalFile()), engineStateCheck)) {
+            completeSourceFiles.append(url);
+            FileUtils::notifyFileChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType::kFileDeleted, url);
+        } else {
+            leftUrls.append(url);
+        }
+    }
+
+    if (leftUrls.isEmpty())
+        return true;
+    if (!stateCheck())
+        return false;
+
+    fmWarning() << "delete the files left by the local delete engine one by one:" << leftUrls;
+    allFilesList = FileOperationsUtils::statisticsFilesSize(leftUrls, true)->allFiles;
+    deleteFilesCount = 0;
+    return deleteFilesOnCanNotRemoveDevice();
+}
 /*!
  * \brief DoDeleteFilesWorker::deleteFilesOnCanNotRemoveDevice Delete files on non removable devices
  * \return delete file success
  */
 bool DoDeleteFilesWorker::deleteFilesOnCanNotRemoveDevice()
 {
+    if (allFilesList.isEmpty())
+        return true;
+
     AbstractJobHandler::SupportAction action { AbstractJobHandler::SupportAction::kNoAction };
     for (QList<QUrl>::iterator it = --allFilesList.end(); it != --allFilesList.begin(); --it) {
         if (!stateCheck())
@@ -31,6 +31,7 @@ protected:
 
 protected:
     bool deleteAllFiles();
+    bool deleteFilesOnLocalDevice();
     bool deleteFilesOnCanNotRemoveDevice();
     bool deleteFilesOnOtherDevice();
     bool deleteFileOnOtherDevice(const QUrl &url);
@@ -202,7 +202,9 @@ bool AbstractWorker::statisticsFilesSize()
         supportDfmioCopy = DeviceUtils::supportDfmioCopyDevice(this->targetUrl)
                 || DeviceUtils::supportDfmioCopyDevice(firstUrl);
         supportSetPermission = DeviceUtils::supportSetPermissionsDevice(this->targetUrl);
+        workData->isTargetLowSpeed = DeviceUtils::isLowSpeedDevice(this->targetUrl);
     }
+    workData->isSourceLowSpeed = DeviceUtils::isLowSpeedDevice(firstUrl);
     // 判读源文件所在设备位置，执行异步或者同统计源文件大小
     isSourceFileLocal = FileOperationsUtils::isFileOnDisk(firstUrl);
 
@@ -212,7 +214,7 @@ bool AbstractWorker::statisticsFilesSize()
     }
 
     if (isSourceFileLocal) {
-        const SizeInfoPointer &fileSizeInfo = FileOperationsUtils::statisticsFilesSize(sourceUrls, true);
+        const SizeInfoPointer &fileSizeInfo = FileOperationsUtils::statisticsFilesSize(sourceUrls, recordAllFiles);
         allFilesList = fileSizeInfo->allFiles;
         sourceFilesTotalSize = fileSizeInfo->totalSize;
         workData->dirSize = fileSizeInfo->dirSize;
@@ -266,6 +268,9 @@ bool AbstractWorker::initArgs()
     completeTargetFiles.clear();
     completeCustomInfos.clear();
     bigFileSize = FileOperationsUtils::bigFileSize();
+    workData->kernelCopy = FileOperationsUtils::kernelCopy();
+    workData->integrityCheckMode = FileOperationsUtils::integrityCheckMode();
+    workData->copyEngine = FileOperationsUtils::copyEngine();
 
     return true;
 }
@@ -342,6 +347,8 @@ void AbstractWorker::emitProgressChangedNotify(const qint64 &writSize)
     } else if (AbstractJobHandler::JobType::kMoveToTrashType == jobType
                || AbstractJobHandler::JobType::kRestoreType == jobType) {
         info->insert(AbstractJobHandler::NotifyInfoKey::kTotalSizeKey, QVariant::fromValue(qint64(sourceUrls.count())));
+    } else if (!recordAllFiles && allFilesList.isEmpty()) {
+        info->insert(AbstractJobHandler::NotifyInfoKey::kTotalSizeKey, QVariant::fromValue(qint64(sourceFilesCount)));
     } else {
         info->insert(AbstractJobHandler::NotifyInfoKey::kTotalSizeKey, QVariant::fromValue(qint64(allFilesList.count())));
     }
@@ -166,6 +166,7 @@ public:
     QVariantList completeCustomInfos;
     QList<FileInfoPointer> precompleteTargetFileInfo;   // list prepare complete target file info
     bool isSourceFileLocal { false };   // source file on local device
+    bool recordAllFiles { true };   // record all files(contains children) to allFilesList when the source file is local
     bool isTargetFileLocal { false };   // target file on local device
     bool supportSetPermission { true };    // source file on mtp
     bool supportDfmioCopy { true };    // source file on mtp
@@ -0,0 +1,113 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "copybufferpool.h"
+
+#include <QMutexLocker>
+
+#include <stdlib.h>
+
+static constexpr qint64 kMinBufferCapacity { 4096 };
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+CopyBufferPool::CopyBufferPool(const qint64 maxIdleSize)
+    : maxIdleBufferSize(maxIdleSize)
+{
+}
+
+CopyBufferPool::~CopyBufferPool()
+{
+    clear();
+}
+
+/*!
+ * \brief CopyBufferPool::acquire Take an idle buffer or allocate a new one
+ * \param size Size needed by the caller
+ * \param capacity Output parameter: real capacity of the buffer, pass it back to release
+ * \return page aligned buffer, nullptr if out of memory
+ */
+char *CopyBufferPool::acquire(const qint64 size, qint64 *capacity)
+{
+    const qint64 bufferCapacity = roundCapacity(size);
+    if (capacity)
+        *capacity = bufferCapacity;
+
+    {
+        QMutexLocker lk(&mutex);
+        auto it = idleBuffers.find(bufferCapacity);
+        if (it != idleBuffers.end() && !it->isEmpty()) {
+            idleBufferSize -= bufferCapacity;
+            return it->takeLast();
+        }
+    }
+
+    return static_cast<char *>(aligned_alloc(kMinBufferCapacity, static_cast<size_t>(bufferCapacity)));
+}
+
+void CopyBufferPool::release(char *buffer, const qint64 capacity)
+{
+    if (!buffer)
+        return;
+
+    {
+        QMutexLocker lk(&mutex);
+        if (idleBufferSize + capacity <= maxIdleBufferSize) {
+            idleBuffers[capacity].append(buffer);
+            idleBufferSize += capacity;
+            return;
+        }
+    }
+
+    free(buffer);
+}
+
+void CopyBufferPool::clear()
+{
+    QMutexLocker lk(&mutex);
+    for (const auto &buffers : idleBuffers) {
+        for (char *buffer : buffers)
+            free(buffer);
+    }
+    idleBuffers.clear();
+    idleBufferSize = 0;
+}
+
+qint64 CopyBufferPool::idleSize() const
+{
+    QMutexLocker lk(&mutex);
+    return idleBufferSize;
+}
+
+qint64 CopyBufferPool::roundCapacity(const qint64 size)
+{
+    qint64 capacity = kMinBufferCapacity;
+    while (capacity < size)
+        capacity <<= 1;
+    return capacity;
+}
+
+CopyBuffer::CopyBuffer(CopyBufferPool *pool, const qint64 size)
+    : pool(pool)
+{
+    buffer = pool->acquire(size, &bufferCapacity);
+}
+
+CopyBuffer::~CopyBuffer()
+{
+    pool->release(buffer, bufferCapacity);
+}
+
+/*!
+ * \brief CopyBuffer::reserve Make the buffer at least size bytes, the content is not kept
+ * \param size Size needed by the caller
+ */
+void CopyBuffer::reserve(const qint64 size)
+{
+    if (size <= bufferCapacity && buffer)
+        return;
+
+    pool->release(buffer, bufferCapacity);
+    buffer = pool->acquire(size, &bufferCapacity);
+}
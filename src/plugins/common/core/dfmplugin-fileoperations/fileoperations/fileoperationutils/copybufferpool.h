@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef COPYBUFFERPOOL_H
+#define COPYBUFFERPOOL_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QMutex>
+#include <QMap>
+#include <QList>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+/*!
+ * \brief The CopyBufferPool class keeps the page aligned buffers of the copy workers,
+ * so that copying many files does not allocate and free a buffer for every file.
+ * Buffers are grouped by capacity (a power of two), the idle memory is limited by maxIdleSize.
+ */
+class CopyBufferPool
+{
+    Q_DISABLE_COPY(CopyBufferPool)
+public:
+    explicit CopyBufferPool(const qint64 maxIdleSize = 64 * 1024 * 1024);
+    ~CopyBufferPool();
+
+    char *acquire(const qint64 size, qint64 *capacity);
+    void release(char *buffer, const qint64 capacity);
+    void clear();
+    qint64 idleSize() const;
+
+    static qint64 roundCapacity(const qint64 size);
+
+private:
+    mutable QMutex mutex;
+    QMap<qint64, QList<char *>> idleBuffers;   // capacity -> idle buffers
+    qint64 idleBufferSize { 0 };
+    qint64 maxIdleBufferSize { 0 };
+};
+
+/*!
+ * \brief The CopyBuffer class borrows a buffer from the CopyBufferPool and gives it back when destroyed
+ */
+class CopyBuffer
+{
+    Q_DISABLE_COPY(CopyBuffer)
+public:
+    CopyBuffer(CopyBufferPool *pool, const qint64 size);
+    ~CopyBuffer();
+
+    inline char *data() const { return buffer; }
+    inline qint64 capacity() const { return bufferCapacity; }
+    void reserve(const qint64 size);
+
+private:
+    CopyBufferPool *pool { nullptr };
+    char *buffer { nullptr };
+    qint64 bufferCapacity { 0 };
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // COPYBUFFERPOOL_H
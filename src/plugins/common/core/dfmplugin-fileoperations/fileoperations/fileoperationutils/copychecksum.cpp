@@ -0,0 +1,130 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "copychecksum.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__)
+#    include <nmmintrin.h>
+#endif
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+namespace {
+// reflected Castagnoli polynomial
+constexpr quint32 kCrc32cPoly { 0x82F63B78 };
+
+constexpr std::array<quint32, 256> makeCrc32cTable()
+{
+    std::array<quint32, 256> table {};
+    for (quint32 i = 0; i < 256; ++i) {
+        quint32 crc = i;
+        for (int bit = 0; bit < 8; ++bit)
+            crc = (crc & 1) ? (crc >> 1) ^ kCrc32cPoly : crc >> 1;
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr std::array<quint32, 256> kCrc32cTable { makeCrc32cTable() };
+
+quint32 crc32cSoftware(quint32 crc, const uchar *data, size_t size)
+{
+    while (size--)
+        crc = kCrc32cTable[(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) quint32 crc32cHardware(quint32 crc, const uchar *data, size_t size)
+{
+    while (size > 0 && (reinterpret_cast<quintptr>(data) & 7)) {
+        crc = _mm_crc32_u8(crc, *data++);
+        --size;
+    }
+
+    quint64 crc64 = crc;
+    while (size >= 8) {
+        quint64 word;
+        memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += 8;
+        size -= 8;
+    }
+    crc = static_cast<quint32>(crc64);
+
+    while (size--)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+
+bool hasHardwareCrc32c()
+{
+    static const bool support = __builtin_cpu_supports("sse4.2");
+    return support;
+}
+#endif
+}   // namespace
+
+CopyCheckSum::CopyCheckSum(const qint64 fileSize, const int sampleCount)
+    : fileSize(fileSize), sampleCount(fileSize > 0 ? qMax(sampleCount, 1) : 0)
+{
+}
+
+/*!
+ * \brief CopyCheckSum::update Add the data written at offset to the checksum, the blocks must be
+ * passed in file order
+ * \param offset Offset of the data in the target file
+ * \param data Data written
+ * \param size Size of the data
+ */
+void CopyCheckSum::update(const qint64 offset, const char *data, const qint64 size)
+{
+    if (size <= 0)
+        return;
+
+    checkSum = crc32c(checkSum, data, static_cast<size_t>(size));
+
+    const qint64 blockEnd = offset + size;
+    if (sampleIndex >= sampleCount || nextSamplePoint() >= blockEnd)
+        return;
+
+    Sample sample;
+    sample.offset = offset;
+    sample.size = size;
+    sample.checkSum = crc32c(0, data, static_cast<size_t>(size));
+    sampleList.append(sample);
+
+    // skip the sample points covered by this block
+    while (sampleIndex < sampleCount && nextSamplePoint() < blockEnd)
+        ++sampleIndex;
+}
+
+/*!
+ * \brief CopyCheckSum::crc32c Castagnoli crc32, uses the sse4.2 instruction when the cpu supports it
+ * \param crc The crc of the previous data, 0 for the first block
+ * \param data Data
+ * \param size Size of the data
+ * \return crc of all data
+ */
+quint32 CopyCheckSum::crc32c(quint32 crc, const char *data, size_t size)
+{
+    const uchar *bytes = reinterpret_cast<const uchar *>(data);
+    crc = ~crc;
+#if defined(__x86_64__)
+    if (hasHardwareCrc32c())
+        return ~crc32cHardware(crc, bytes, size);
+#endif
+    return ~crc32cSoftware(crc, bytes, size);
+}
+
+qint64 CopyCheckSum::nextSamplePoint() const
+{
+    // the last sample point is the last byte of the file
+    if (sampleIndex == sampleCount - 1)
+        return fileSize - 1;
+    return fileSize / sampleCount * sampleIndex;
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef COPYCHECKSUM_H
+#define COPYCHECKSUM_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QList>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+/*!
+ * \brief The CopyCheckSum class computes the crc32c of the data written to the target file while it is copied.
+ * It also keeps the checksum of the blocks covering a few evenly spaced sample points, so that
+ * the target can be verified by reading back only these blocks.
+ */
+class CopyCheckSum
+{
+public:
+    struct Sample
+    {
+        qint64 offset { 0 };
+        qint64 size { 0 };
+        quint32 checkSum { 0 };
+    };
+
+    explicit CopyCheckSum(const qint64 fileSize, const int sampleCount = 16);
+
+    void update(const qint64 offset, const char *data, const qint64 size);
+    inline quint32 value() const { return checkSum; }
+    inline const QList<Sample> &samples() const { return sampleList; }
+
+    static quint32 crc32c(quint32 crc, const char *data, size_t size);
+
+private:
+    qint64 nextSamplePoint() const;
+
+private:
+    qint64 fileSize { 0 };
+    int sampleCount { 0 };
+    int sampleIndex { 0 };
+    quint32 checkSum { 0 };
+    QList<Sample> sampleList;
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // COPYCHECKSUM_H
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "docopyfileworker.h"
+#include "fileoperationsutils.h"
 
 #include <dfm-base/utils/fileutils.h>
 #include <dfm-base/base/device/deviceutils.h>
@@ -11,6 +12,7 @@
 
 #include <QDebug>
 #include <QTime>
+#include <QElapsedTimer>
 #include <QWaitCondition>
 #include <QMutex>
 #include <QThread>
@@ -18,8 +20,18 @@
 #include <fcntl.h>
 #include <zlib.h>
 #include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <unistd.h>
 
 static const quint32 kMaxBufferLength { 1024 * 1024 * 1 };
+static const quint32 kMaxKernelCopyLength { 1024 * 1024 * 16 };
+
+// errors of copy_file_range/sendfile that only mean this way of copying is not available here
+static bool isKernelCopyUnsupported(const int errorCode)
+{
+    return errorCode == 0 || errorCode == ENOSYS || errorCode == EXDEV || errorCode == EINVAL
+            || errorCode == EOPNOTSUPP || errorCode == ENOTSUP || errorCode == EBADF;
+}
 
 DPFILEOPERATIONS_USE_NAMESPACE
 USING_IO_NAMESPACE
@@ -75,6 +87,22 @@ void DoCopyFileWorker::doFileCopy(FileInfoPointer fromInfo, FileInfoPointer toIn
     workData->completeFileCount++;
 }
 
+void DoCopyFileWorker::doFileCopyBatch(const QList<CopyFilePair> files)
+{
+    if (files.isEmpty() || isStopped())
+        return;
+
+    emit currentTask(files.first().first->urlOf(UrlInfoType::kUrl), files.first().second->urlOf(UrlInfoType::kUrl));
+    IoUringCopyEngine engine(workData);
+    const QList<int> &failedFiles = engine.copyFiles(files, [this] { return stateCheck(); });
+    // the files failed in the engine are copied again here, where errors are reported to the user
+    for (int index : failedFiles) {
+        if (isStopped())
+            return;
+        doFileCopy(files.at(index).first, files.at(index).second);
+    }
+}
+
 void DoCopyFileWorker::doMemcpyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, char *dest, char *source, size_t size)
 {
     size_t copySize = size;
@@ -122,6 +150,53 @@ void DoCopyFileWorker::doMemcpyLocalBigFile(const FileInfoPointer fromInfo, cons
     }
 }
 
+void DoCopyFileWorker::doKernelCopyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo,
+                                                int fromFd, int toFd, off_t offset, size_t size)
+{
+    size_t copySize = size;
+    loff_t fromOffset = offset;
+    loff_t toOffset = offset;
+    while (copySize > 0 && !isStopped()) {
+        if (Q_UNLIKELY(!stateCheck())) {
+            break;
+        }
+        const size_t everyCopySize = copySize >= kMaxKernelCopyLength ? kMaxKernelCopyLength : copySize;
+
+        AbstractJobHandler::SupportAction action { AbstractJobHandler::SupportAction::kNoAction };
+        ssize_t sizeCopied = 0;
+
+        do {
+            action = AbstractJobHandler::SupportAction::kNoAction;
+            sizeCopied = copy_file_range(fromFd, &fromOffset, toFd, &toOffset, everyCopySize, 0);
+            if (sizeCopied <= 0) {
+                const QString &lastError = sizeCopied < 0 ? QString(strerror(errno)) : QString();
+                fmWarning() << "file copy_file_range error, url from: " << fromInfo->urlOf(UrlInfoType::kUrl)
+                            << " url to: " << toInfo->urlOf(UrlInfoType::kUrl)
+                            << " error code: " << errno << " error msg: " << lastError;
+
+                action = doHandleErrorAndWait(fromInfo->urlOf(UrlInfoType::kUrl), toInfo->urlOf(UrlInfoType::kUrl),
+                                              AbstractJobHandler::JobErrorType::kWriteError,
+                                              true, lastError);
+            }
+        } while (action == AbstractJobHandler::SupportAction::kRetryAction && !isStopped());
+
+        checkRetry();
+
+        if (!actionOperating(action, static_cast<qint64>(copySize), nullptr)) {
+            if (action == AbstractJobHandler::SupportAction::kSkipAction)
+                emit skipCopyLocalBigFile(fromInfo->urlOf(UrlInfoType::kUrl));
+            return;
+        }
+
+        copySize -= static_cast<size_t>(sizeCopied);
+
+        if (memcpySkipUrl.isValid() && memcpySkipUrl == fromInfo->urlOf(UrlInfoType::kUrl))
+            return;
+
+        workData->currentWriteSize += static_cast<int64_t>(sizeCopied);
+    }
+}
+
 bool DoCopyFileWorker::doDfmioFileCopy(FileInfoPointer fromInfo, FileInfoPointer toInfo, bool *skip)
 {
     assert(!fromInfo.isNull());
@@ -209,6 +284,16 @@ bool DoCopyFileWorker::doCopyFilePractically(const FileInfoPointer fromInfo, con
         return false;
     // emit current task url
     emit currentTask(fromInfo->urlOf(UrlInfoType::kUrl), toInfo->urlOf(UrlInfoType::kUrl));
+    // let the kernel copy the file, the buffer loop is only used when it is not supported
+    const KernelCopyResult kernelCopyResult = doKernelCopyFile(fromInfo, toInfo, skip);
+    if (kernelCopyResult == KernelCopyResult::kFailed)
+        return false;
+    if (kernelCopyResult == KernelCopyResult::kCopied) {
+        setTargetPermissions(fromInfo, toInfo);
+        toInfo->refresh();
+        FileUtils::notifyFileChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType::kFileAdded, toInfo->urlOf(UrlInfoType::kUrl));
+        return true;
+    }
     // read ahead source file
     readAheadSourceFile(fromInfo);
     // 创建文件的divice
@@ -235,31 +320,37 @@ bool DoCopyFileWorker::doCopyFilePractically(const FileInfoPointer fromInfo, con
     int toFd = -1;
     if (workData->exBlockSyncEveryWrite)
         toFd = open(toInfo->urlOf(UrlInfoType::kUrl).path().toUtf8().toStdString().data(), O_RDONLY);
-    qint64 blockSize = fromInfo->size() > kMaxBufferLength ? kMaxBufferLength : fromInfo->size();
-    char *data = new char[static_cast<uint>(blockSize + 1)];
+    // the block size starts from the size fitting the devices and grows while the copy is sequential
+    const qint64 maxBlockSize = workData->maxCopyBlockSize();
+    qint64 blockSize = qMin(fromInfo->size(), workData->copyBlockSize());
+    CopyBuffer buffer(&workData->bufferPool, blockSize);
+    const bool integrityChecking = workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking);
+    const bool fullReadBack = workData->integrityCheckMode == WorkerData::IntegrityCheckMode::kFullReadBack;
     uLong sourceCheckSum = adler32(0L, nullptr, 0);
+    CopyCheckSum copyCheckSum(fromInfo->size());
     qint64 sizeRead = 0;
+    qint64 copiedSize = 0;
 
     do {
-        if (!doReadFile(fromInfo, toInfo, fromDevice, data, blockSize, sizeRead, skip)) {
-            delete[] data;
-            data = nullptr;
+        if (!buffer.data() || !doReadFile(fromInfo, toInfo, fromDevice, buffer.data(), blockSize, sizeRead, skip)) {
             if (toFd > 0)
                 close(toFd);
             return false;
         }
 
-        if (!doWriteFile(fromInfo, toInfo, toDevice, data, sizeRead, skip)) {
-            delete[] data;
-            data = nullptr;
+        if (!doWriteFile(fromInfo, toInfo, toDevice, buffer.data(), sizeRead, skip)) {
             if (toFd > 0)
                 close(toFd);
             return false;
         }
 
-        if (Q_LIKELY(workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))) {
-            sourceCheckSum = adler32(sourceCheckSum, reinterpret_cast<Bytef *>(data), static_cast<uInt>(sizeRead));
+        if (Q_UNLIKELY(integrityChecking)) {
+            if (fullReadBack)
+                sourceCheckSum = adler32(sourceCheckSum, reinterpret_cast<Bytef *>(buffer.data()), static_cast<uInt>(sizeRead));
+            else
+                copyCheckSum.update(copiedSize, buffer.data(), sizeRead);
         }
+        copiedSize += sizeRead;
 
         // 执行同步策略
         if (workData->exBlockSyncEveryWrite && toFd > 0)
@@ -267,11 +358,13 @@ bool DoCopyFileWorker::doCopyFilePractically(const FileInfoPointer fromInfo, con
 
         toInfo->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardSize, toDevice->size());
 
+        if (sizeRead == blockSize && blockSize < maxBlockSize
+            && fromInfo->size() - fromDevice->pos() > blockSize) {
+            blockSize = qMin(blockSize * 2, maxBlockSize);
+            buffer.reserve(blockSize);
+        }
     } while (fromDevice->pos() != fromInfo->size());
 
-    delete[] data;
-    data = nullptr;
-
     // 执行同步策略
     if (workData->exBlockSyncEveryWrite && toFd > 0)
         syncfs(toFd);
@@ -286,7 +379,8 @@ bool DoCopyFileWorker::doCopyFilePractically(const FileInfoPointer fromInfo, con
 
     // 校验文件完整性
     if (skip)
-        *skip = verifyFileIntegrity(blockSize, sourceCheckSum, fromInfo, toInfo, toDevice);
+        *skip = fullReadBack ? verifyFileIntegrity(blockSize, sourceCheckSum, fromInfo, toInfo, toDevice)
+                             : verifyFileIntegrityByReadBack(copyCheckSum, fromInfo, toInfo);
     toInfo->refresh();
 
     if (skip && *skip)
@@ -375,6 +469,121 @@ void DoCopyFileWorker::readAheadSourceFile(const FileInfoPointer &fileInfo)
         close(fromfd);
     }
 }
+/*!
+ * \brief DoCopyFileWorker::canKernelCopy Whether the file can be copied by the kernel
+ * \param fromInfo File information of source file
+ * \param toInfo File information of target file
+ * \return true if both files are local and no user space processing of the data is needed
+ */
+bool DoCopyFileWorker::canKernelCopy(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo)
+{
+    if (!workData->kernelCopy || fromInfo->size() <= 0)
+        return false;
+
+    // integrity checking and the vfat/cifs sync policy need the data in user space
+    if (workData->needSyncEveryRW || workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))
+        return false;
+
+    return fromInfo->urlOf(UrlInfoType::kUrl).isLocalFile() && toInfo->urlOf(UrlInfoType::kUrl).isLocalFile();
+}
+
+/*!
+ * \brief DoCopyFileWorker::doKernelCopyFile Copy the file by reflink, then by copy_file_range, then by sendfile
+ * \param fromInfo File information of source file
+ * \param toInfo File information of target file
+ * \param skip Output parameter: whether skip
+ * \return kCopied if the whole file is copied, kUnsupported if the caller has to copy it by the buffer loop,
+ * kFailed if the copy is stopped, skipped or cancelled
+ */
+DoCopyFileWorker::KernelCopyResult DoCopyFileWorker::doKernelCopyFile(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo, bool *skip)
+{
+    if (!canKernelCopy(fromInfo, toInfo))
+        return KernelCopyResult::kUnsupported;
+
+    const std::string &fromPath = fromInfo->urlOf(UrlInfoType::kUrl).path().toStdString();
+    const std::string &toPath = toInfo->urlOf(UrlInfoType::kUrl).path().toStdString();
+    int fromFd = open(fromPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fromFd < 0)
+        return KernelCopyResult::kUnsupported;
+    int toFd = open(toPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+    if (toFd < 0) {
+        close(fromFd);
+        return KernelCopyResult::kUnsupported;
+    }
+
+    const qint64 fileSize = fromInfo->size();
+    KernelCopyResult result { KernelCopyResult::kCopied };
+    if (FileOperationsUtils::reflinkFile(fromFd, toFd)) {
+        workData->currentWriteSize += fileSize;
+    } else {
+        qint64 copiedSize = 0;
+        bool useSendfile = false;
+        while (copiedSize < fileSize) {
+            if (Q_UNLIKELY(!stateCheck())) {
+                result = KernelCopyResult::kFailed;
+                break;
+            }
+
+            const size_t blockSize = static_cast<size_t>(qMin<qint64>(kMaxKernelCopyLength, fileSize - copiedSize));
+            const ssize_t sizeCopied = useSendfile ? sendfile(toFd, fromFd, nullptr, blockSize)
+                                                   : copy_file_range(fromFd, nullptr, toFd, nullptr, blockSize, 0);
+            if (Q_LIKELY(sizeCopied > 0)) {
+                copiedSize += sizeCopied;
+                workData->currentWriteSize += sizeCopied;
+                // 执行同步策略
+                if (workData->exBlockSyncEveryWrite)
+                    syncfs(toFd);
+                checkRetry();
+                continue;
+            }
+
+            // nothing has been written yet, try the next way of copying
+            const int errorCode = sizeCopied < 0 ? errno : 0;
+            if (copiedSize == 0 && isKernelCopyUnsupported(errorCode)) {
+                if (!useSendfile) {
+                    useSendfile = true;
+                    continue;
+                }
+                result = KernelCopyResult::kUnsupported;
+                break;
+            }
+
+            // copied nothing before the end of the source file, it has been changed or removed
+            AbstractJobHandler::JobErrorType errorType { AbstractJobHandler::JobErrorType::kWriteError };
+            if (errorCode == 0)
+                errorType = fromInfo->exists() ? AbstractJobHandler::JobErrorType::kReadError
+                                               : AbstractJobHandler::JobErrorType::kNonexistenceError;
+            const QString &errorMsg = errorCode == 0 ? QString() : QString(strerror(errorCode));
+            fmWarning() << "kernel copy error, url from: " << fromInfo->urlOf(UrlInfoType::kUrl)
+                        << " url to: " << toInfo->urlOf(UrlInfoType::kUrl) << " copied size: " << copiedSize
+                        << " error code: " << errorCode << " error msg: " << errorMsg;
+
+            const AbstractJobHandler::SupportAction action = doHandleErrorAndWait(fromInfo->urlOf(UrlInfoType::kUrl),
+                                                                                  toInfo->urlOf(UrlInfoType::kUrl),
+                                                                                  errorType, errorCode != 0, errorMsg);
+            if (action == AbstractJobHandler::SupportAction::kRetryAction && !isStopped())
+                continue;
+
+            checkRetry();
+            actionOperating(action, fileSize - copiedSize, skip);
+            result = KernelCopyResult::kFailed;
+            break;
+        }
+    }
+
+    // 执行同步策略
+    if (result == KernelCopyResult::kCopied && workData->exBlockSyncEveryWrite)
+        syncfs(toFd);
+
+    close(fromFd);
+    close(toFd);
+
+    if (result == KernelCopyResult::kCopied)
+        toInfo->cacheAttribute(DFMIO::DFileInfo::AttributeID::kStandardSize, fileSize);
+
+    return result;
+}
+
 /*!
  * \brief FileOperateBaseWorker::createFileDevice Device to create the file
  * \param fromUrl URL of the source file
@@ -663,7 +872,10 @@ bool DoCopyFileWorker::verifyFileIntegrity(const qint64 &blockSize, const ulong
 {
     if (!workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))
         return true;
-    char *data = new char[static_cast<uint>(blockSize + 1)];
+    CopyBuffer buffer(&workData->bufferPool, blockSize);
+    char *data = buffer.data();
+    if (!data)
+        return false;
     QTime t;
     ulong targetCheckSum = adler32(0L, nullptr, 0);
     Q_FOREVER {
@@ -689,13 +901,9 @@ bool DoCopyFileWorker::verifyFileIntegrity(const qint64 &blockSize, const ulong
 
         targetCheckSum = adler32(targetCheckSum, reinterpret_cast<Bytef *>(data), static_cast<uInt>(size));
 
-        if (Q_UNLIKELY(!stateCheck())) {
-            delete[] data;
-            data = nullptr;
+        if (Q_UNLIKELY(!stateCheck()))
             return false;
-        }
     }
-    delete[] data;
 
     fmDebug("Time spent of integrity check of the file: %d", t.elapsed());
 
@@ -711,6 +919,115 @@ bool DoCopyFileWorker::verifyFileIntegrity(const qint64 &blockSize, const ulong
     return true;
 }
 
+/*!
+ * \brief DoCopyFileWorker::verifyFileIntegrityByReadBack Sync the target file to the device and compare the
+ * checksum computed while copying with the data read back. The page cache is bypassed by O_DIRECT, or dropped
+ * when the file system does not support O_DIRECT. Only the sampled blocks are read back in kSampledReadBack mode.
+ * \param checkSum Checksum of the data written to the target file
+ * \param fromInfo File information of source file
+ * \param toInfo File information of target file
+ * \return whether the file passed the check or the error is skipped
+ */
+bool DoCopyFileWorker::verifyFileIntegrityByReadBack(const CopyCheckSum &checkSum,
+                                                     const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo)
+{
+    if (!workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))
+        return true;
+
+    QElapsedTimer t;
+    t.start();
+    const std::string &toPath = toInfo->urlOf(UrlInfoType::kUrl).path().toStdString();
+    int toFd = open(toPath.c_str(), O_RDONLY | O_DIRECT | O_CLOEXEC);
+    const bool directIO = toFd >= 0;
+    if (!directIO)
+        toFd = open(toPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (toFd < 0) {
+        AbstractJobHandler::SupportAction actionForOpen = doHandleErrorAndWait(fromInfo->urlOf(UrlInfoType::kUrl),
+                                                                               toInfo->urlOf(UrlInfoType::kUrl),
+                                                                               AbstractJobHandler::JobErrorType::kIntegrityCheckingError,
+                                                                               true, strerror(errno));
+        checkRetry();
+        return actionForOpen == AbstractJobHandler::SupportAction::kSkipAction;
+    }
+
+    // the data must be on the device, not only in the page cache, before it is read back
+    fdatasync(toFd);
+    if (!directIO)
+        posix_fadvise(toFd, 0, 0, POSIX_FADV_DONTNEED);
+
+    bool verified = true;
+    quint32 targetCheckSum = 0;
+    if (workData->integrityCheckMode == WorkerData::IntegrityCheckMode::kSampledReadBack) {
+        for (const auto &sample : checkSum.samples()) {
+            if (!readBackCheckSum(toFd, sample.offset, sample.size, &targetCheckSum)
+                || targetCheckSum != sample.checkSum) {
+                verified = false;
+                break;
+            }
+        }
+    } else {
+        verified = readBackCheckSum(toFd, 0, fromInfo->size(), &targetCheckSum)
+                && targetCheckSum == checkSum.value();
+    }
+    close(toFd);
+
+    if (isStopped())
+        return false;
+
+    fmDebug() << "Time spent of integrity check of the file: " << t.elapsed() << " direct io: " << directIO;
+
+    if (!verified) {
+        fmWarning("Failed on file integrity checking, source file: 0x%x, target file: 0x%x", checkSum.value(), targetCheckSum);
+        AbstractJobHandler::SupportAction actionForCheck = doHandleErrorAndWait(fromInfo->urlOf(UrlInfoType::kUrl),
+                                                                                toInfo->urlOf(UrlInfoType::kUrl),
+                                                                                AbstractJobHandler::JobErrorType::kIntegrityCheckingError,
+                                                                                true);
+        return actionForCheck == AbstractJobHandler::SupportAction::kSkipAction;
+    }
+
+    return true;
+}
+
+/*!
+ * \brief DoCopyFileWorker::readBackCheckSum Read a range of the file and compute its crc32c, the reads are
+ * aligned to the page size so that they work on fds opened with O_DIRECT
+ * \param fd File descriptor of the target file
+ * \param offset Offset of the range
+ * \param size Size of the range
+ * \param checkSum Output parameter: crc32c of the range
+ * \return false if the range can not be read completely
+ */
+bool DoCopyFileWorker::readBackCheckSum(const int fd, const qint64 offset, const qint64 size, quint32 *checkSum)
+{
+    static constexpr qint64 kDirectIOAlignment { 4096 };
+    const qint64 chunkSize = workData->maxCopyBlockSize();
+    CopyBuffer buffer(&workData->bufferPool, chunkSize);
+    if (!buffer.data())
+        return false;
+
+    quint32 crc = 0;
+    qint64 pos = offset & ~(kDirectIOAlignment - 1);
+    qint64 headSize = offset - pos;
+    qint64 surplusSize = size;
+    while (surplusSize > 0) {
+        if (Q_UNLIKELY(!stateCheck()))
+            return false;
+
+        const ssize_t readSize = pread(fd, buffer.data(), static_cast<size_t>(chunkSize), pos);
+        if (readSize <= headSize)
+            return false;
+
+        const qint64 dataSize = qMin<qint64>(readSize - headSize, surplusSize);
+        crc = CopyCheckSum::crc32c(crc, buffer.data() + headSize, static_cast<size_t>(dataSize));
+        surplusSize -= dataSize;
+        pos += readSize;
+        headSize = 0;
+    }
+
+    *checkSum = crc;
+    return true;
+}
+
 void DoCopyFileWorker::checkRetry()
 {
     if (!workData->signalThread && retry && !isStopped()) {
@@ -7,6 +7,8 @@
 
 #include "dfmplugin_fileoperations_global.h"
 #include "workerdata.h"
+#include "copychecksum.h"
+#include "iouringcopyengine.h"
 
 #include <dfm-base/interfaces/fileinfo.h>
 #include <dfm-base/interfaces/abstractjobhandler.h>
@@ -34,6 +36,12 @@ public:
         kStoped,
     };
 
+    enum class KernelCopyResult : uint8_t {
+        kCopied,   // the kernel copied the whole file
+        kUnsupported,   // not supported here, copy by the buffer loop
+        kFailed,   // stopped, skipped or cancelled
+    };
+
     struct ProgressData {
         QUrl copyFile;
         QSharedPointer<WorkerData> data{ nullptr };
@@ -53,8 +61,13 @@ public:
                                bool *skip);
     // small file copy
     void doFileCopy(FileInfoPointer fromInfo, FileInfoPointer toInfo);
+    // small files copy by io_uring
+    void doFileCopyBatch(const QList<CopyFilePair> files);
     // big file copy in system device
     void doMemcpyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, char *dest, char *source, size_t size);
+    // big file copy by copy_file_range in system device
+    void doKernelCopyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo,
+                                  int fromFd, int toFd, off_t offset, size_t size);
     // copy file by dfmio
     bool doDfmioFileCopy(FileInfoPointer fromInfo, FileInfoPointer toInfo, bool *skip);
 signals:
@@ -77,6 +90,8 @@ private:   // file copy
                                                            const QString &errorMsg = QString());
 
     void readAheadSourceFile(const FileInfoPointer &fileInfo);
+    bool canKernelCopy(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo);
+    KernelCopyResult doKernelCopyFile(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo, bool *skip);
     bool createFileDevices(const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo,
                            QSharedPointer<DFMIO::DFile> &fromeFile, QSharedPointer<DFMIO::DFile> &toFile,
                            bool *skip);
@@ -101,6 +116,9 @@ private:   // file copy
     bool verifyFileIntegrity(const qint64 &blockSize, const ulong &sourceCheckSum,
                              const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo,
                              QSharedPointer<DFMIO::DFile> &toFile);
+    bool verifyFileIntegrityByReadBack(const CopyCheckSum &checkSum,
+                                       const FileInfoPointer &fromInfo, const FileInfoPointer &toInfo);
+    bool readBackCheckSum(const int fd, const qint64 offset, const qint64 size, quint32 *checkSum);
     void checkRetry();
     bool isStopped();
     void syncBlockFile(const FileInfoPointer toInfo);
@@ -27,6 +27,9 @@
 #include <sys/stat.h>
 #include <sys/mman.h>
 
+static const quint32 kKernelCopyProbeLength { 1024 * 1024 * 1 };
+static const int kSmallFileBatchCount { 512 };
+
 DPFILEOPERATIONS_USE_NAMESPACE
 USING_IO_NAMESPACE
 
@@ -737,6 +740,7 @@ bool FileOperateBaseWorker::checkAndCopyDir(const FileInfoPointer &fromInfo, con
 
 void FileOperateBaseWorker::waitThreadPoolOver()
 {
+    flushSmallFileBatch();
     // wait all thread start
     if (!isStopped() && threadPool) {
         QThread::msleep(10);
@@ -858,6 +862,13 @@ bool FileOperateBaseWorker::doCopyLocalFile(const FileInfoPointer fromInfo, cons
     if (!stateCheck())
         return false;
 
+    if (workData->copyEngine == WorkerData::CopyEngine::kIoUring && fromInfo->size() <= IoUringCopyEngine::kMaxFileSize) {
+        smallFileBatch.append(qMakePair(fromInfo, toInfo));
+        if (smallFileBatch.size() >= kSmallFileBatchCount)
+            flushSmallFileBatch();
+        return true;
+    }
+
     QtConcurrent::run(threadPool.data(), threadCopyWorker[threadCopyFileCount % threadCount].data(),
                       static_cast<void (DoCopyFileWorker::*)(const FileInfoPointer, const FileInfoPointer)>(&DoCopyFileWorker::doFileCopy),
                       fromInfo, toInfo);
@@ -866,6 +877,19 @@ bool FileOperateBaseWorker::doCopyLocalFile(const FileInfoPointer fromInfo, cons
     return true;
 }
 
+void FileOperateBaseWorker::flushSmallFileBatch()
+{
+    if (smallFileBatch.isEmpty() || !threadPool)
+        return;
+
+    if (!isStopped())
+        QtConcurrent::run(threadPool.data(), threadCopyWorker[threadCopyFileCount % threadCount].data(),
+                          &DoCopyFileWorker::doFileCopyBatch, smallFileBatch);
+
+    threadCopyFileCount++;
+    smallFileBatch.clear();
+}
+
 bool FileOperateBaseWorker::doCopyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, bool *skip)
 {
     waitThreadPoolOver();
@@ -884,6 +908,13 @@ bool FileOperateBaseWorker::doCopyLocalBigFile(const FileInfoPointer fromInfo, c
         close(toFd);
         return false;
     }
+    // reflink or copy_file_range in other thread
+    if (doCopyLocalBigFileByKernel(fromInfo, toInfo, fromFd, toFd)) {
+        close(fromFd);
+        close(toFd);
+        setTargetPermissions(fromInfo, toInfo);
+        return true;
+    }
     // mmap file
     auto fromPoint = doCopyLocalBigFileMap(fromInfo, toInfo, fromFd, PROT_READ, skip);
     if (!fromPoint) {
@@ -983,6 +1014,62 @@ void FileOperateBaseWorker::memcpyLocalBigFile(const FileInfoPointer fromInfo, c
     }
 }
 
+/*!
+ * \brief FileOperateBaseWorker::doCopyLocalBigFileByKernel Copy the big file by reflink or by copy_file_range
+ * \param fromInfo File information of source file
+ * \param toInfo File information of target file
+ * \param fromFd fd of the source file
+ * \param toFd fd of the target file, already resized to the size of the source file
+ * \return false if the kernel can not copy the file and it has to be copied by mmap
+ */
+bool FileOperateBaseWorker::doCopyLocalBigFileByKernel(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, int fromFd, int toFd)
+{
+    if (!workData->kernelCopy || workData->jobFlags.testFlag(AbstractJobHandler::JobFlag::kCopyIntegrityChecking))
+        return false;
+
+    if (FileOperationsUtils::reflinkFile(fromFd, toFd)) {
+        workData->currentWriteSize += fromInfo->size();
+        return true;
+    }
+
+    // copy_file_range is not supported by every kernel and file system, probe it by the first block
+    loff_t fromOffset = 0;
+    loff_t toOffset = 0;
+    const size_t probeSize = static_cast<size_t>(qMin<qint64>(kKernelCopyProbeLength, fromInfo->size()));
+    const ssize_t sizeCopied = copy_file_range(fromFd, &fromOffset, toFd, &toOffset, probeSize, 0);
+    if (sizeCopied <= 0) {
+        fmDebug() << "copy_file_range is not supported, copy by mmap, url: " << fromInfo->urlOf(UrlInfoType::kUrl)
+                  << " error msg: " << strerror(errno);
+        return false;
+    }
+    workData->currentWriteSize += sizeCopied;
+
+    kernelCopyLocalBigFile(fromInfo, toInfo, fromFd, toFd, sizeCopied);
+    waitThreadPoolOver();
+    return true;
+}
+
+void FileOperateBaseWorker::kernelCopyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo,
+                                                   int fromFd, int toFd, const qint64 startOffset)
+{
+    const qint64 copySize = fromInfo->size() - startOffset;
+    auto offset = copySize / threadCount;
+    off_t fromStart = startOffset;
+    for (int i = 0; i < threadCount; i++) {
+        const qint64 size = (i == (threadCount - 1) ? copySize - (threadCount - 1) * offset : offset);
+        if (size <= 0)
+            continue;
+
+        QtConcurrent::run(threadPool.data(), threadCopyWorker[i].data(),
+                          static_cast<void (DoCopyFileWorker::*)(const FileInfoPointer fromInfo,
+                                                                 const FileInfoPointer toInfo,
+                                                                 int fromFd, int toFd, off_t offset, size_t size)>(&DoCopyFileWorker::doKernelCopyLocalBigFile),
+                          fromInfo, toInfo, fromFd, toFd, fromStart, static_cast<size_t>(size));
+
+        fromStart += offset;
+    }
+}
+
 void FileOperateBaseWorker::doCopyLocalBigFileClear(const size_t size,
                                                     const int fromFd, const int toFd, char *fromPoint, char *toPoint)
 {
@@ -96,6 +96,7 @@ private:
                              bool *skip, bool isCountSize = false);
     QUrl createNewTargetUrl(const FileInfoPointer &toInfo, const QString &fileName);
     bool doCopyLocalFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo);
+    void flushSmallFileBatch();
     bool doCopyOtherFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, bool *skip);
     bool doCopyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, bool *skip);
 
@@ -103,6 +104,8 @@ private:   // do copy local big file
     bool doCopyLocalBigFileResize(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, int toFd, bool *skip);
     char *doCopyLocalBigFileMap(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, int fd, const int per, bool *skip);
     void memcpyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, char *fromPoint, char *toPoint);
+    bool doCopyLocalBigFileByKernel(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, int fromFd, int toFd);
+    void kernelCopyLocalBigFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, int fromFd, int toFd, const qint64 startOffset);
     void doCopyLocalBigFileClear(const size_t size, const int fromFd,
                                  const int toFd, char *fromPoint, char *toPoint);
     int doOpenFile(const FileInfoPointer fromInfo, const FileInfoPointer toInfo, const bool isTo,
@@ -135,6 +138,7 @@ protected:
     QList<QUrl> syncFiles;
 
     std::atomic_int threadCopyFileCount { 0 };
+    QList<CopyFilePair> smallFileBatch;   // small files waiting to be copied by io_uring
     QList<FileInfoPointer> cutAndDeleteFiles;
 };
 DPFILEOPERATIONS_END_NAMESPACE
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "fileoperationsutils.h"
+#include "iouringcopyengine.h"
 #include <dfm-base/base/urlroute.h>
 #include <dfm-base/utils/fileutils.h>
 #include <dfm-base/base/configs/dconfig/dconfigmanager.h>
@@ -23,6 +24,8 @@ extern "C" {
 #include <fts.h>
 #include <unistd.h>
 #include <sys/utsname.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 
 DPFILEOPERATIONS_USE_NAMESPACE
 DFMBASE_USE_NAMESPACE
@@ -31,6 +34,9 @@ QSet<QString> FileOperationsUtils::fileNameUsing = {};
 inline constexpr char kFileOperations[] { "org.deepin.dde.file-manager.operations" };
 inline constexpr char kFileBigSize[] { "file.operation.bigfilesize" };
 inline constexpr char kBlockEverySync[] { "file.operation.blockeverysync" };
+inline constexpr char kKernelCopy[] { "file.operation.kernelcopy" };
+inline constexpr char kIntegrityCheckMode[] { "file.operation.integritycheckmode" };
+inline constexpr char kCopyEngine[] { "file.operation.copyengine" };
 QMutex FileOperationsUtils::mutex;
 
 /*!
@@ -108,18 +114,20 @@ void FileOperationsUtils::statisticFilesSize(const QUrl &url,
         if (ent == nullptr) {
             break;
         }
-        const QUrl &curUrl = QUrl::fromLocalFile(ent->fts_path);
-        if (urlCounted.contains(curUrl))
-            continue;
-        urlCounted.insert(curUrl);
-
         unsigned short flag = ent->fts_info;
 
-        const auto &fileSize = ent->fts_statp->st_size;
-
         // url record
-        if (isRecordUrl && flag != FTS_DP)
-            sizeInfo->allFiles.append(curUrl);
+        if (isRecordUrl) {
+            const QUrl &curUrl = QUrl::fromLocalFile(ent->fts_path);
+            if (urlCounted.contains(curUrl))
+                continue;
+            urlCounted.insert(curUrl);
+
+            if (flag != FTS_DP)
+                sizeInfo->allFiles.append(curUrl);
+        }
+
+        const auto &fileSize = ent->fts_statp->st_size;
 
         // file counted
         if (flag == FTS_F || flag == FTS_SL || flag == FTS_SLNONE)
@@ -167,3 +175,40 @@ bool FileOperationsUtils::blockSync()
     bool sync = DConfigManager::instance()->value(kFileOperations, kBlockEverySync).toBool();
     return sync;
 }
+
+bool FileOperationsUtils::kernelCopy()
+{
+    return DConfigManager::instance()->value(kFileOperations, kKernelCopy, true).toBool();
+}
+
+WorkerData::IntegrityCheckMode FileOperationsUtils::integrityCheckMode()
+{
+    const QString &mode = DConfigManager::instance()->value(kFileOperations, kIntegrityCheckMode, "sampled").toString();
+    if (mode == "full")
+        return WorkerData::IntegrityCheckMode::kFullReadBack;
+    if (mode == "direct")
+        return WorkerData::IntegrityCheckMode::kDirectReadBack;
+    return WorkerData::IntegrityCheckMode::kSampledReadBack;
+}
+
+WorkerData::CopyEngine FileOperationsUtils::copyEngine()
+{
+    const QString &engine = DConfigManager::instance()->value(kFileOperations, kCopyEngine, "thread").toString();
+    if (engine == "iouring" && IoUringCopyEngine::isSupported())
+        return WorkerData::CopyEngine::kIoUring;
+    return WorkerData::CopyEngine::kThreadPool;
+}
+
+/*!
+ * \brief FileOperationsUtils::reflinkFile Make the target file share the data blocks of the source file (btrfs, xfs, ...)
+ * \param fromFd fd of the source file, opened for reading
+ * \param toFd fd of the target file, opened for writing
+ * \return true if the whole file has been cloned, false if the file system does not support it
+ */
+bool FileOperationsUtils::reflinkFile(const int fromFd, const int toFd)
+{
+    if (fromFd < 0 || toFd < 0)
+        return false;
+
+    return ioctl(toFd, FICLONE, fromFd) == 0;
+}
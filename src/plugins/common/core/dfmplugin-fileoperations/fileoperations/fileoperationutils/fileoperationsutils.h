@@ -6,6 +6,7 @@
 #define FILEOPERATIONSUTILS_H
 
 #include "dfmplugin_fileoperations_global.h"
+#include "workerdata.h"
 #include <dfm-base/utils/fileutils.h>
 
 #include <QSharedPointer>
@@ -66,6 +67,7 @@ class FileOperationsUtils
     friend class DoCleanTrashFilesWorker;
     friend class DoRestoreTrashFilesWorker;
     friend class FileOperateBaseWorker;
+    friend class DoCopyFileWorker;
 
 private:
     static SizeInfoPointer statisticsFilesSize(const QList<QUrl> &files, const bool &isRecordUrl = false);
@@ -75,6 +77,10 @@ private:
     static bool isFileOnDisk(const QUrl &url);
     static qint64 bigFileSize();
     static bool blockSync();
+    static bool kernelCopy();
+    static WorkerData::IntegrityCheckMode integrityCheckMode();
+    static WorkerData::CopyEngine copyEngine();
+    static bool reflinkFile(const int fromFd, const int toFd);
 
 private:
     static QSet<QString> fileNameUsing;
@@ -0,0 +1,582 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "iouringcopyengine.h"
+
+#include <dfm-base/utils/fileutils.h>
+#include <dfm-base/base/device/deviceutils.h>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+#if __has_include(<linux/io_uring.h>)
+#    include <linux/io_uring.h>
+// openat, statx, read, write and close requests need the kernel headers of linux 5.6
+#    ifdef IORING_FEAT_RW_CUR_POS
+#        define DFM_IO_URING_COPY
+#    endif
+#endif
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+
+#ifdef DFM_IO_URING_COPY
+/*!
+ * \brief The IoUring class is a minimal io_uring submission/completion ring on top of the raw syscalls
+ */
+class IoUring
+{
+public:
+    IoUring() = default;
+    ~IoUring()
+    {
+        if (sqPtr && sqPtr != MAP_FAILED)
+            munmap(sqPtr, sqMapSize);
+        if (cqPtr && cqPtr != MAP_FAILED && cqPtr != sqPtr)
+            munmap(cqPtr, cqMapSize);
+        if (sqes && sqes != MAP_FAILED)
+            munmap(sqes, sqesMapSize);
+        if (ringFd >= 0)
+            close(ringFd);
+    }
+
+    bool init(const unsigned entries)
+    {
+        io_uring_params params;
+        memset(&params, 0, sizeof(params));
+        ringFd = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ringFd < 0)
+            return false;
+
+        sqMapSize = params.sq_off.array + params.sq_entries * sizeof(__u32);
+        cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        const bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap)
+            sqMapSize = cqMapSize = qMax(sqMapSize, cqMapSize);
+
+        sqPtr = mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQ_RING);
+        if (sqPtr == MAP_FAILED)
+            return false;
+        cqPtr = singleMap ? sqPtr : mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_CQ_RING);
+        if (cqPtr == MAP_FAILED)
+            return false;
+        sqesMapSize = params.sq_entries * sizeof(io_uring_sqe);
+        sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqesMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ringFd, IORING_OFF_SQES));
+        if (sqes == MAP_FAILED)
+            return false;
+
+        char *sq = static_cast<char *>(sqPtr);
+        sqHead = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+        sqTail = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+        sqMask = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+        sqArray = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+        sqEntries = params.sq_entries;
+        char *cq = static_cast<char *>(cqPtr);
+        cqHead = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+        cqTail = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+        cqMask = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+        cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+        sqeTail = *sqTail;
+        return true;
+    }
+
+    bool supportOps(const QList<int> &ops)
+    {
+        const size_t probeSize = sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op);
+        QScopedPointer<char, QScopedPointerArrayDeleter<char>> buffer(new char[probeSize]);
+        memset(buffer.data(), 0, probeSize);
+        io_uring_probe *probe = reinterpret_cast<io_uring_probe *>(buffer.data());
+        if (syscall(__NR_io_uring_register, ringFd, IORING_REGISTER_PROBE, probe, 256) < 0)
+            return false;
+
+        for (int op : ops) {
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED))
+                return false;
+        }
+        return true;
+    }
+
+    inline unsigned entries() const { return sqEntries; }
+
+    // the queued requests are submitted when the submission queue is full,
+    // nullptr is returned if the kernel does not consume them
+    io_uring_sqe *getSqe()
+    {
+        if (sqeTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries) {
+            if (submitAndWait(0) < 0 || sqeTail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= sqEntries)
+                return nullptr;
+        }
+
+        const unsigned index = sqeTail & sqMask;
+        sqArray[index] = index;
+        ++sqeTail;
+        io_uring_sqe *sqe = &sqes[index];
+        memset(sqe, 0, sizeof(io_uring_sqe));
+        return sqe;
+    }
+
+    int submitAndWait(const unsigned waitCount)
+    {
+        const unsigned toSubmit = sqeTail - *sqTail;
+        __atomic_store_n(sqTail, sqeTail, __ATOMIC_RELEASE);
+        int ret = 0;
+        do {
+            ret = static_cast<int>(syscall(__NR_io_uring_enter, ringFd, toSubmit, waitCount,
+                                           waitCount > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0));
+        } while (ret < 0 && errno == EINTR);
+        return ret;
+    }
+
+    io_uring_cqe *peekCqe()
+    {
+        const unsigned head = *cqHead;
+        if (head == __atomic_load_n(cqTail, __ATOMIC_ACQUIRE))
+            return nullptr;
+        return &cqes[head & cqMask];
+    }
+
+    void cqeSeen()
+    {
+        __atomic_store_n(cqHead, *cqHead + 1, __ATOMIC_RELEASE);
+    }
+
+private:
+    int ringFd { -1 };
+    void *sqPtr { nullptr };
+    void *cqPtr { nullptr };
+    size_t sqMapSize { 0 };
+    size_t cqMapSize { 0 };
+    size_t sqesMapSize { 0 };
+    io_uring_sqe *sqes { nullptr };
+    io_uring_cqe *cqes { nullptr };
+    unsigned *sqHead { nullptr };
+    unsigned *sqTail { nullptr };
+    unsigned *sqArray { nullptr };
+    unsigned sqMask { 0 };
+    unsigned sqEntries { 0 };
+    unsigned sqeTail { 0 };
+    unsigned *cqHead { nullptr };
+    unsigned *cqTail { nullptr };
+    unsigned cqMask { 0 };
+};
+#else
+class IoUring
+{
+};
+#endif
+
+struct IoUringCopyEngine::FileTask
+{
+    int index { -1 };
+    std::string fromPath;
+    std::string toPath;
+    int fromFd { -1 };
+    int toFd { -1 };
+    struct statx fromStat {};
+    char *buffer { nullptr };
+    qint64 bufferCapacity { 0 };
+    qint64 readSize { 0 };
+    qint64 writeSize { 0 };
+    bool failed { false };
+};
+
+DPFILEOPERATIONS_END_NAMESPACE
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+#ifdef DFM_IO_URING_COPY
+namespace {
+enum RequestType : quint64 {
+    kOpenSource,
+    kOpenTarget,
+    kStatSource,
+    kRead,
+    kWrite,
+    kClose,
+};
+
+inline quint64 requestData(const int index, const RequestType type)
+{
+    return (static_cast<quint64>(index) << 3) | type;
+}
+}   // namespace
+#endif
+
+IoUringCopyEngine::IoUringCopyEngine(const QSharedPointer<WorkerData> &data, const unsigned queueDepth)
+    : workData(data), queueDepth(queueDepth)
+{
+#ifdef DFM_IO_URING_COPY
+    ring.reset(new IoUring);
+    if (!ring->init(queueDepth))
+        ring.reset();
+#endif
+}
+
+IoUringCopyEngine::~IoUringCopyEngine()
+{
+}
+
+/*!
+ * \brief IoUringCopyEngine::isSupported Whether the kernel supports every io_uring request used by the engine
+ * \return true if the engine can be used
+ */
+bool IoUringCopyEngine::isSupported()
+{
+#ifdef DFM_IO_URING_COPY
+    static const bool support = [] {
+        IoUring probeRing;
+        return probeRing.init(4)
+                && probeRing.supportOps({ IORING_OP_OPENAT, IORING_OP_STATX, IORING_OP_READ,
+                                          IORING_OP_WRITE, IORING_OP_CLOSE });
+    }();
+    return support;
+#else
+    return false;
+#endif
+}
+
+bool IoUringCopyEngine::isValid() const
+{
+    return !ring.isNull();
+}
+
+/*!
+ * \brief IoUringCopyEngine::copyFiles Copy the files window by window
+ * \param files Source and target file information
+ * \param stateCheck Block while the job is paused, return false when it is stopped
+ * \return indexes of the files which have not been copied and must be copied by the normal path
+ */
+QList<int> IoUringCopyEngine::copyFiles(const QList<CopyFilePair> &files, const std::function<bool()> &stateCheck)
+{
+    QList<int> failedFiles;
+    if (!isValid()) {
+        for (int i = 0; i < files.size(); ++i)
+            failedFiles.append(i);
+        return failedFiles;
+    }
+
+#ifdef DFM_IO_URING_COPY
+    // three requests (openat source, openat target, statx) are submitted for every file of a window
+    const int windowSize = qMax(1, static_cast<int>(ring->entries() / 3));
+    for (int start = 0; start < files.size(); start += windowSize) {
+        QVector<FileTask> tasks;
+        const int end = qMin(files.size(), start + windowSize);
+        tasks.reserve(end - start);
+        for (int i = start; i < end; ++i) {
+            FileTask task;
+            task.index = i;
+            task.fromPath = files.at(i).first->urlOf(UrlInfoType::kUrl).path().toStdString();
+            task.toPath = files.at(i).second->urlOf(UrlInfoType::kUrl).path().toStdString();
+            tasks.append(task);
+        }
+
+        const bool ok = copyWindow(tasks, stateCheck);
+        for (auto &task : tasks) {
+            if (task.buffer)
+                workData->bufferPool.release(task.buffer, task.bufferCapacity);
+            if (!ok || task.failed) {
+                // the normal path copies the file again and counts its size again
+                workData->currentWriteSize -= task.writeSize;
+                failedFiles.append(task.index);
+                continue;
+            }
+            workData->completeFileCount++;
+            FileUtils::notifyFileChangeManual(DFMBASE_NAMESPACE::Global::FileNotifyType::kFileAdded,
+                                              files.at(task.index).second->urlOf(UrlInfoType::kUrl));
+        }
+
+        if (!ok) {
+            for (int i = end; i < files.size(); ++i)
+                failedFiles.append(i);
+            break;
+        }
+    }
+#endif
+
+    return failedFiles;
+}
+
+bool IoUringCopyEngine::copyWindow(QVector<FileTask> &tasks, const std::function<bool()> &stateCheck)
+{
+    if (!stateCheck())
+        return false;
+
+    bool ok = openFiles(tasks) && readFiles(tasks, stateCheck) && writeFiles(tasks, stateCheck);
+    if (ok)
+        setTargetAttributes(tasks);
+    closeFiles(tasks);
+    return ok;
+}
+
+bool IoUringCopyEngine::openFiles(QVector<FileTask> &tasks)
+{
+#ifdef DFM_IO_URING_COPY
+    int requestCount = 0;
+    for (int i = 0; i < tasks.size(); ++i) {
+        FileTask &task = tasks[i];
+        io_uring_sqe *sqe = ring->getSqe();
+        if (!sqe) {
+            // the file is copied by the normal path
+            task.failed = true;
+            continue;
+        }
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<quint64>(task.fromPath.c_str());
+        sqe->open_flags = O_RDONLY | O_CLOEXEC;
+        sqe->user_data = requestData(i, kOpenSource);
+        ++requestCount;
+
+        sqe = ring->getSqe();
+        if (!sqe) {
+            task.failed = true;
+            continue;
+        }
+        sqe->opcode = IORING_OP_OPENAT;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<quint64>(task.toPath.c_str());
+        sqe->len = 0666;
+        sqe->open_flags = O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC;
+        sqe->user_data = requestData(i, kOpenTarget);
+        ++requestCount;
+
+        sqe = ring->getSqe();
+        if (!sqe) {
+            task.failed = true;
+            continue;
+        }
+        sqe->opcode = IORING_OP_STATX;
+        sqe->fd = AT_FDCWD;
+        sqe->addr = reinterpret_cast<quint64>(task.fromPath.c_str());
+        sqe->len = STATX_MODE | STATX_SIZE | STATX_ATIME | STATX_MTIME;
+        sqe->off = reinterpret_cast<quint64>(&task.fromStat);
+        sqe->statx_flags = AT_SYMLINK_NOFOLLOW;
+        sqe->user_data = requestData(i, kStatSource);
+        ++requestCount;
+    }
+
+    return waitCompletions(requestCount, [&tasks](quint64 data, int res) {
+        FileTask &task = tasks[static_cast<int>(data >> 3)];
+        if (res < 0) {
+            task.failed = true;
+            return;
+        }
+        switch (data & 7) {
+        case kOpenSource:
+            task.fromFd = res;
+            break;
+        case kOpenTarget:
+            task.toFd = res;
+            break;
+        default:
+            break;
+        }
+    });
+#else
+    Q_UNUSED(tasks)
+    return false;
+#endif
+}
+
+bool IoUringCopyEngine::readFiles(QVector<FileTask> &tasks, const std::function<bool()> &stateCheck)
+{
+#ifdef DFM_IO_URING_COPY
+    for (auto &task : tasks) {
+        if (task.failed)
+            continue;
+        // the file has been changed since the copy planned, let the normal path handle it
+        if (static_cast<qint64>(task.fromStat.stx_size) > kMaxFileSize || !S_ISREG(task.fromStat.stx_mode)) {
+            task.failed = true;
+            continue;
+        }
+        if (task.fromStat.stx_size == 0)
+            continue;
+        task.buffer = workData->bufferPool.acquire(static_cast<qint64>(task.fromStat.stx_size), &task.bufferCapacity);
+        if (!task.buffer)
+            task.failed = true;
+    }
+
+    // short reads are submitted again until every file is read completely
+    Q_FOREVER {
+        if (!stateCheck())
+            return false;
+
+        int requestCount = 0;
+        for (int i = 0; i < tasks.size(); ++i) {
+            FileTask &task = tasks[i];
+            const qint64 fileSize = static_cast<qint64>(task.fromStat.stx_size);
+            if (task.failed || task.readSize >= fileSize)
+                continue;
+            io_uring_sqe *sqe = ring->getSqe();
+            if (!sqe) {
+                task.failed = true;
+                continue;
+            }
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = task.fromFd;
+            sqe->addr = reinterpret_cast<quint64>(task.buffer + task.readSize);
+            sqe->len = static_cast<quint32>(fileSize - task.readSize);
+            sqe->off = static_cast<quint64>(task.readSize);
+            sqe->user_data = requestData(i, kRead);
+            ++requestCount;
+        }
+        if (requestCount == 0)
+            return true;
+
+        const bool ok = waitCompletions(requestCount, [&tasks](quint64 data, int res) {
+            FileTask &task = tasks[static_cast<int>(data >> 3)];
+            // the file has been truncated while reading it
+            if (res <= 0)
+                task.failed = true;
+            else
+                task.readSize += res;
+        });
+        if (!ok)
+            return false;
+    }
+#else
+    Q_UNUSED(tasks)
+    Q_UNUSED(stateCheck)
+    return false;
+#endif
+}
+
+bool IoUringCopyEngine::writeFiles(QVector<FileTask> &tasks, const std::function<bool()> &stateCheck)
+{
+#ifdef DFM_IO_URING_COPY
+    Q_FOREVER {
+        if (!stateCheck())
+            return false;
+
+        int requestCount = 0;
+        for (int i = 0; i < tasks.size(); ++i) {
+            FileTask &task = tasks[i];
+            if (task.failed || task.writeSize >= task.readSize)
+                continue;
+            io_uring_sqe *sqe = ring->getSqe();
+            if (!sqe) {
+                task.failed = true;
+                continue;
+            }
+            sqe->opcode = IORING_OP_WRITE;
+            sqe->fd = task.toFd;
+            sqe->addr = reinterpret_cast<quint64>(task.buffer + task.writeSize);
+            sqe->len = static_cast<quint32>(task.readSize - task.writeSize);
+            sqe->off = static_cast<quint64>(task.writeSize);
+            sqe->user_data = requestData(i, kWrite);
+            ++requestCount;
+        }
+        if (requestCount == 0)
+            return true;
+
+        const bool ok = waitCompletions(requestCount, [this, &tasks](quint64 data, int res) {
+            FileTask &task = tasks[static_cast<int>(data >> 3)];
+            if (res <= 0) {
+                task.failed = true;
+                return;
+            }
+            task.writeSize += res;
+            workData->currentWriteSize += res;
+        });
+        if (!ok)
+            return false;
+    }
+#else
+    Q_UNUSED(tasks)
+    Q_UNUSED(stateCheck)
+    return false;
+#endif
+}
+
+void IoUringCopyEngine::setTargetAttributes(QVector<FileTask> &tasks)
+{
+#ifdef DFM_IO_URING_COPY
+    for (auto &task : tasks) {
+        if (task.failed)
+            continue;
+        if (task.readSize == 0)
+            workData->zeroOrlinkOrDirWriteSize += FileUtils::getMemoryPageSize();
+        if (!DeviceUtils::supportSetPermissionsDevice(QUrl::fromLocalFile(QString::fromStdString(task.toPath))))
+            continue;
+
+        const timespec times[2] { { task.fromStat.stx_atime.tv_sec, task.fromStat.stx_atime.tv_nsec },
+                                  { task.fromStat.stx_mtime.tv_sec, task.fromStat.stx_mtime.tv_nsec } };
+        futimens(task.toFd, times);
+        // 权限为0000时，源文件已经被删除，无需修改新建的文件的权限为0000
+        const mode_t mode = task.fromStat.stx_mode & 07777;
+        if (mode != 0)
+            fchmod(task.toFd, mode);
+    }
+#else
+    Q_UNUSED(tasks)
+#endif
+}
+
+void IoUringCopyEngine::closeFiles(QVector<FileTask> &tasks)
+{
+#ifdef DFM_IO_URING_COPY
+    int requestCount = 0;
+    for (int i = 0; i < tasks.size(); ++i) {
+        for (int fd : { tasks[i].fromFd, tasks[i].toFd }) {
+            if (fd < 0)
+                continue;
+            io_uring_sqe *sqe = ring->getSqe();
+            if (!sqe) {
+                ::close(fd);
+                continue;
+            }
+            sqe->opcode = IORING_OP_CLOSE;
+            sqe->fd = fd;
+            sqe->user_data = requestData(i, kClose);
+            ++requestCount;
+        }
+        tasks[i].fromFd = -1;
+        tasks[i].toFd = -1;
+    }
+    waitCompletions(requestCount, [](quint64, int) {});
+#else
+    Q_UNUSED(tasks)
+#endif
+}
+
+/*!
+ * \brief IoUringCopyEngine::waitCompletions Submit the queued requests and handle their completions
+ * \param count Count of the queued requests
+ * \param handler Called with the user data and the result of every completion
+ * \return false if the ring failed
+ */
+bool IoUringCopyEngine::waitCompletions(int count, const std::function<void(quint64, int)> &handler)
+{
+#ifdef DFM_IO_URING_COPY
+    if (count <= 0)
+        return true;
+
+    if (ring->submitAndWait(static_cast<unsigned>(count)) < 0) {
+        fmWarning() << "io_uring submit failed, error msg: " << strerror(errno);
+        return false;
+    }
+
+    while (count > 0) {
+        io_uring_cqe *cqe = ring->peekCqe();
+        if (!cqe) {
+            if (ring->submitAndWait(1) < 0) {
+                fmWarning() << "io_uring wait failed, error msg: " << strerror(errno);
+                return false;
+            }
+            continue;
+        }
+        handler(cqe->user_data, cqe->res);
+        ring->cqeSeen();
+        --count;
+    }
+    return true;
+#else
+    Q_UNUSED(count)
+    Q_UNUSED(handler)
+    return false;
+#endif
+}
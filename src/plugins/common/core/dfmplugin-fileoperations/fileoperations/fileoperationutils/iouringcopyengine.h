@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef IOURINGCOPYENGINE_H
+#define IOURINGCOPYENGINE_H
+
+#include "dfmplugin_fileoperations_global.h"
+#include "workerdata.h"
+
+#include <dfm-base/interfaces/fileinfo.h>
+
+#include <QSharedPointer>
+#include <QScopedPointer>
+#include <QList>
+#include <QPair>
+#include <QVector>
+
+#include <functional>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+DFMBASE_USE_NAMESPACE
+using CopyFilePair = QPair<FileInfoPointer, FileInfoPointer>;
+
+class IoUring;
+/*!
+ * \brief The IoUringCopyEngine class copies many small local files through one io_uring.
+ * The openat/statx, read, write and close requests of a window of files are submitted together,
+ * so the throughput depends on the queue depth and not on the number of copy threads.
+ * Files failing in the engine are returned to the caller, which copies them by the normal
+ * path where the error dialogs, skip and retry are handled.
+ */
+class IoUringCopyEngine
+{
+    Q_DISABLE_COPY(IoUringCopyEngine)
+public:
+    static constexpr qint64 kMaxFileSize { 1024 * 1024 };   // bigger files are copied by the normal path
+
+    explicit IoUringCopyEngine(const QSharedPointer<WorkerData> &data, const unsigned queueDepth = 256);
+    ~IoUringCopyEngine();
+
+    static bool isSupported();
+    bool isValid() const;
+    QList<int> copyFiles(const QList<CopyFilePair> &files, const std::function<bool()> &stateCheck);
+
+private:
+    struct FileTask;
+    bool copyWindow(QVector<FileTask> &tasks, const std::function<bool()> &stateCheck);
+    bool openFiles(QVector<FileTask> &tasks);
+    bool readFiles(QVector<FileTask> &tasks, const std::function<bool()> &stateCheck);
+    bool writeFiles(QVector<FileTask> &tasks, const std::function<bool()> &stateCheck);
+    void setTargetAttributes(QVector<FileTask> &tasks);
+    void closeFiles(QVector<FileTask> &tasks);
+    bool waitCompletions(int count, const std::function<void(quint64, int)> &handler);
+
+private:
+    QSharedPointer<WorkerData> workData { nullptr };
+    QScopedPointer<IoUring> ring;
+    unsigned queueDepth { 0 };
+};
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // IOURINGCOPYENGINE_H
@@ -0,0 +1,327 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "localdeleteengine.h"
+
+#include <QDebug>
+
+#include <thread>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+
+static constexpr int kDirentBufferSize { 64 * 1024 };
+static constexpr int kStateCheckInterval { 256 };   // entries between two state checks
+static constexpr int kMaxLoggedErrors { 20 };
+static constexpr int kMaxRescans { 2 };
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+
+namespace {
+struct LinuxDirent64
+{
+    ino64_t d_ino;
+    off64_t d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+}
+
+struct LocalDeleteEngine::DirTask
+{
+    QByteArray name;   // the full path of the root
+    DirTask *parent { nullptr };
+    int fd { -1 };   // kept open while the sub directories use it
+    std::atomic_int pending { 1 };   // the reading of the directory and its unfinished sub directories
+    std::atomic_bool failed { false };
+    int rescans { 0 };
+};
+
+struct LocalDeleteEngine::TaskQueue
+{
+    std::mutex mutex;
+    std::deque<DirTask *> tasks;
+};
+
+LocalDeleteEngine::LocalDeleteEngine(QAtomicInteger<qint64> *deletedCount, const int threadCount)
+    : deletedCount(deletedCount), threadCount(qMax(1, threadCount))
+{
+    for (int i = 0; i < this->threadCount; ++i)
+        queues.emplace_back(new TaskQueue);
+}
+
+LocalDeleteEngine::~LocalDeleteEngine()
+{
+}
+
+/*!
+ * \brief LocalDeleteEngine::deleteTree delete `path` and everything below it
+ * \return true if `path` is deleted, false if something is left because of an error or stop
+ */
+bool LocalDeleteEngine::deleteTree(const QByteArray &path, const std::function<bool()> &stateCheck)
+{
+    struct stat st;
+    if (lstat(path.constData(), &st) != 0) {
+        logError(path, errno);
+        return false;
+    }
+
+    if (!S_ISDIR(st.st_mode)) {
+        if (unlink(path.constData()) != 0) {
+            logError(path, errno);
+            return false;
+        }
+        if (deletedCount)
+            deletedCount->fetchAndAddRelaxed(1);
+        return true;
+    }
+
+    this->stateCheck = stateCheck;
+    rootDevice = st.st_dev;
+    rootDeleted = false;
+    stopped = false;
+
+    DirTask *root = new DirTask;
+    root->name = path;
+    push(0, root);
+
+    std::vector<std::thread> threads;
+    for (int i = 1; i < threadCount; ++i)
+        threads.emplace_back(&LocalDeleteEngine::run, this, i);
+    run(0);
+    for (std::thread &thread : threads)
+        thread.join();
+
+    return rootDeleted;
+}
+
+void LocalDeleteEngine::run(const int index)
+{
+    while (true) {
+        if (DirTask *task = take(index)) {
+            deleteDir(index, task);
+            // the tasks of the sub directories are pushed before this one is finished
+            if (--unfinishedTasks == 0) {
+                std::lock_guard<std::mutex> lk(idleMutex);
+                idleCondition.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lk(idleMutex);
+        idleCondition.wait(lk, [this] { return unfinishedTasks == 0 || queuedTasks > 0; });
+        if (unfinishedTasks == 0)
+            return;
+    }
+}
+
+void LocalDeleteEngine::push(const int index, DirTask *task)
+{
+    ++unfinishedTasks;
+    {
+        std::lock_guard<std::mutex> lk(queues[index]->mutex);
+        queues[index]->tasks.push_back(task);
+    }
+    {
+        std::lock_guard<std::mutex> lk(idleMutex);
+        ++queuedTasks;
+    }
+    idleCondition.notify_one();
+}
+
+LocalDeleteEngine::DirTask *LocalDeleteEngine::take(const int index)
+{
+    // the own queue is used as a stack to go deep first, the others are stolen from the oldest
+    for (int i = 0; i < threadCount; ++i) {
+        TaskQueue *queue = queues[(index + i) % threadCount].get();
+        std::lock_guard<std::mutex> lk(queue->mutex);
+        if (queue->tasks.empty())
+            continue;
+
+        DirTask *task = nullptr;
+        if (i == 0) {
+            task = queue->tasks.back();
+            queue->tasks.pop_back();
+        } else {
+            task = queue->tasks.front();
+            queue->tasks.pop_front();
+        }
+        --queuedTasks;
+        return task;
+    }
+    return nullptr;
+}
+
+void LocalDeleteEngine::deleteDir(const int index, DirTask *task)
+{
+    if (stopped) {
+        task->failed = true;
+        finishDir(index, task);
+        return;
+    }
+
+    const int fd = openDir(task);
+    struct stat st;
+    if (fd < 0 || fstat(fd, &st) != 0) {
+        logError(taskPath(task), errno);
+        closeDir(task);
+        task->failed = true;
+        finishDir(index, task);
+        return;
+    }
+
+    // do not go into the other filesystems mounted in the tree
+    if (st.st_dev != rootDevice) {
+        logError(taskPath(task), EXDEV);
+        closeDir(task);
+        task->failed = true;
+        finishDir(index, task);
+        return;
+    }
+
+    alignas(LinuxDirent64) char buffer[kDirentBufferSize];
+    qint64 deleted = 0;
+    int checked = 0;
+    int children = 0;
+    while (!stopped) {
+        const long size = syscall(SYS_getdents64, fd, buffer, kDirentBufferSize);
+        if (size <= 0) {
+            if (size < 0) {
+                logError(taskPath(task), errno);
+                task->failed = true;
+            }
+            break;
+        }
+
+        for (long offset = 0; offset < size;) {
+            auto entry = reinterpret_cast<LinuxDirent64 *>(buffer + offset);
+            offset += entry->d_reclen;
+            ++checked;
+
+            const char *name = entry->d_name;
+            if (name[0] == '.' && (name[1] == '\0' || (name[1] == '.' && name[2] == '\0')))
+                continue;
+
+            bool isDir = entry->d_type == DT_DIR;
+            if (entry->d_type == DT_UNKNOWN) {
+                struct stat entryStat;
+                isDir = fstatat(fd, name, &entryStat, AT_SYMLINK_NOFOLLOW) == 0 && S_ISDIR(entryStat.st_mode);
+            }
+
+            if (!isDir) {
+                if (unlinkat(fd, name, 0) == 0) {
+                    ++deleted;
+                    continue;
+                }
+                if (errno != EISDIR) {
+                    logError(taskPath(task, name), errno);
+                    task->failed = true;
+                    continue;
+                }
+            }
+
+            DirTask *child = new DirTask;
+            child->name = name;
+            child->parent = task;
+            ++task->pending;
+            ++children;
+            push(index, child);
+        }
+
+        if (checked >= kStateCheckInterval) {
+            checked = 0;
+            if (deletedCount) {
+                deletedCount->fetchAndAddRelaxed(deleted);
+                deleted = 0;
+            }
+            if (stateCheck && !stateCheck())
+                stopped = true;
+        }
+    }
+    // the fd is kept only for the sub directories
+    if (children == 0)
+        closeDir(task);
+
+    if (deletedCount && deleted > 0)
+        deletedCount->fetchAndAddRelaxed(deleted);
+    if (stopped)
+        task->failed = true;
+
+    finishDir(index, task);
+}
+
+void LocalDeleteEngine::finishDir(const int index, DirTask *task)
+{
+    while (task) {
+        if (--task->pending > 0)
+            return;
+
+        closeDir(task);
+        DirTask *parent = task->parent;
+        bool deleted = !task->failed && !stopped;
+        if (deleted) {
+            const int ret = parent ? unlinkat(parent->fd, task->name.constData(), AT_REMOVEDIR)
+                                   : rmdir(task->name.constData());
+            if (ret != 0) {
+                // the entries created while reading the directory are deleted by reading it again
+                if (errno == ENOTEMPTY && task->rescans < kMaxRescans) {
+                    ++task->rescans;
+                    task->pending = 1;
+                    push(index, task);
+                    return;
+                }
+                logError(taskPath(task), errno);
+                deleted = false;
+            }
+        }
+
+        if (!parent)
+            rootDeleted = deleted;
+        else if (!deleted)
+            parent->failed = true;
+
+        delete task;
+        task = parent;
+    }
+}
+
+int LocalDeleteEngine::openDir(DirTask *task)
+{
+    // the parent is not finished before its children, so its fd is still open, a rescan opens the directory again
+    static constexpr int kFlags { O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC };
+    task->fd = task->parent ? openat(task->parent->fd, task->name.constData(), kFlags)
+                            : open(task->name.constData(), kFlags);
+    return task->fd;
+}
+
+void LocalDeleteEngine::closeDir(DirTask *task)
+{
+    if (task->fd >= 0) {
+        close(task->fd);
+        task->fd = -1;
+    }
+}
+
+QByteArray LocalDeleteEngine::taskPath(const DirTask *task, const char *name) const
+{
+    QByteArray path = task->name;
+    for (const DirTask *parent = task->parent; parent; parent = parent->parent)
+        path.prepend(parent->name + "/");
+    if (name)
+        path.append("/").append(name);
+    return path;
+}
+
+void LocalDeleteEngine::logError(const QByteArray &path, const int error)
+{
+    if (loggedErrors++ < kMaxLoggedErrors)
+        fmWarning() << "local delete engine failed:" << path << strerror(error);
+}
+
+DPFILEOPERATIONS_END_NAMESPACE
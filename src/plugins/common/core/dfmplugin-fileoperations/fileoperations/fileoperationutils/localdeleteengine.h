@@ -0,0 +1,75 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LOCALDELETEENGINE_H
+#define LOCALDELETEENGINE_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QByteArray>
+#include <QAtomicInteger>
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <sys/types.h>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+
+/*!
+ * \brief The LocalDeleteEngine class deletes trees of files on local filesystems.
+ * Every directory is read with getdents64 on its fd and its entries are removed by unlinkat,
+ * the sub directories are spread over a work-stealing pool of threads and a directory is removed
+ * after all of its children. The sub directories are opened and removed by their names relative to
+ * the fd of the parent, which is held until the children are finished, so no path is resolved twice. Nothing is reported for the entries failing to delete, they are left
+ * in the tree for the caller, which deletes them again by the normal path where the errors are handled.
+ */
+class LocalDeleteEngine
+{
+    Q_DISABLE_COPY(LocalDeleteEngine)
+public:
+    explicit LocalDeleteEngine(QAtomicInteger<qint64> *deletedCount, const int threadCount);
+    ~LocalDeleteEngine();
+
+    // `stateCheck` is called in the threads of the pool, it returns false to stop deleting
+    bool deleteTree(const QByteArray &path, const std::function<bool()> &stateCheck);
+
+private:
+    struct DirTask;
+    struct TaskQueue;
+
+    void run(const int index);
+    void push(const int index, DirTask *task);
+    DirTask *take(const int index);
+    void deleteDir(const int index, DirTask *task);
+    void finishDir(const int index, DirTask *task);
+    int openDir(DirTask *task);
+    void closeDir(DirTask *task);
+    QByteArray taskPath(const DirTask *task, const char *name = nullptr) const;
+    void logError(const QByteArray &path, const int error);
+
+private:
+    QAtomicInteger<qint64> *deletedCount { nullptr };
+    int threadCount { 1 };
+    std::function<bool()> stateCheck;
+    dev_t rootDevice { 0 };
+    bool rootDeleted { false };
+
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::atomic_int queuedTasks { 0 };
+    std::atomic_int unfinishedTasks { 0 };
+    std::atomic_bool stopped { false };
+    std::atomic_int loggedErrors { 0 };
+    std::mutex idleMutex;
+    std::condition_variable idleCondition;
+};
+
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // LOCALDELETEENGINE_H
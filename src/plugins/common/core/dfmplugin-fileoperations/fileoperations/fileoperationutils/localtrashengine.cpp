@@ -0,0 +1,212 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "localtrashengine.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+static constexpr char kTrashInfoSuffix[] { ".trashinfo" };
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+
+namespace {
+// the same as g_uri_escape_string(path, "/", FALSE) used by gio for the Path key
+QByteArray escapePath(const QByteArray &path)
+{
+    static constexpr char kHex[] { "0123456789ABCDEF" };
+
+    QByteArray escaped;
+    escaped.reserve(path.size());
+    for (const char c : path) {
+        const uchar ch = static_cast<uchar>(c);
+        if ((ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9')
+            || ch == '-' || ch == '.' || ch == '_' || ch == '~' || ch == '/') {
+            escaped.append(c);
+        } else {
+            escaped.append('%');
+            escaped.append(kHex[ch >> 4]);
+            escaped.append(kHex[ch & 0xf]);
+        }
+    }
+    return escaped;
+}
+}
+
+LocalTrashEngine::LocalTrashEngine(const QString &filesPath, const QString &infoPath)
+{
+    // the trash directories are created on demand like gio does
+    for (const QString &path : { filesPath, infoPath }) {
+        if (!QDir(path).exists() && QDir().mkpath(path))
+            QFile::setPermissions(path, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+    }
+
+    filesFd = open(QFile::encodeName(filesPath).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    infoFd = open(QFile::encodeName(infoPath).constData(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+
+    struct stat filesStat, infoStat;
+    if (filesFd < 0 || infoFd < 0 || fstat(filesFd, &filesStat) != 0 || fstat(infoFd, &infoStat) != 0
+        || filesStat.st_dev != infoStat.st_dev) {
+        fmWarning() << "local trash engine is not available for:" << filesPath << infoPath;
+        if (filesFd >= 0)
+            close(filesFd);
+        if (infoFd >= 0)
+            close(infoFd);
+        filesFd = infoFd = -1;
+        return;
+    }
+    trashDevice = filesStat.st_dev;
+}
+
+LocalTrashEngine::~LocalTrashEngine()
+{
+    if (filesFd >= 0)
+        close(filesFd);
+    if (infoFd >= 0)
+        close(infoFd);
+}
+
+bool LocalTrashEngine::isValid() const
+{
+    return filesFd >= 0 && infoFd >= 0;
+}
+
+bool LocalTrashEngine::canTrash(const QUrl &url) const
+{
+    if (!isValid() || !url.isLocalFile())
+        return false;
+
+    struct stat st;
+    return lstat(QFile::encodeName(url.toLocalFile()).constData(), &st) == 0 && st.st_dev == trashDevice;
+}
+
+QString LocalTrashEngine::trashFiles(const QList<QUrl> &urls, QList<QUrl> *trashedUrls)
+{
+    if (!isValid())
+        return QString();
+    loadNames();
+
+    const time_t startTime = time(nullptr);
+    struct tm localTime;
+    char deletionDate[32] {};
+    localtime_r(&startTime, &localTime);
+    strftime(deletionDate, sizeof(deletionDate), "%Y-%m-%dT%H:%M:%S", &localTime);
+
+    // reserve the names by the info files first, so the trash never holds a file without its info
+    QList<QPair<QUrl, QByteArray>> reservedFiles;
+    for (const QUrl &url : urls) {
+        const QString &localPath = QDir::cleanPath(url.toLocalFile());
+        const QByteArray &baseName = QFile::encodeName(localPath.mid(localPath.lastIndexOf('/') + 1));
+        if (baseName.isEmpty())
+            continue;
+
+        const QByteArray &content = "[Trash Info]\nPath=" + escapePath(QFile::encodeName(localPath))
+                + "\nDeletionDate=" + deletionDate + "\n";
+        QByteArray name;
+        if (createInfoFile(baseName, content, &name))
+            reservedFiles.append(qMakePair(url, name));
+    }
+    if (reservedFiles.isEmpty())
+        return QString();
+
+    if (fsync(infoFd) != 0)
+        fmWarning() << "local trash engine failed to sync the info directory:" << strerror(errno);
+
+    for (const auto &file : reservedFiles) {
+        const QByteArray &path = QFile::encodeName(QDir::cleanPath(file.first.toLocalFile()));
+        if (renameat2(AT_FDCWD, path.constData(), filesFd, file.second.constData(), RENAME_NOREPLACE) == 0) {
+            trashedUrls->append(file.first);
+            continue;
+        }
+
+        fmWarning() << "local trash engine failed to trash:" << path << strerror(errno);
+        unlinkat(infoFd, (file.second + kTrashInfoSuffix).constData(), 0);
+    }
+
+    return QString("%1-%2").arg(startTime).arg(time(nullptr));
+}
+
+void LocalTrashEngine::loadNames()
+{
+    if (namesLoaded)
+        return;
+    namesLoaded = true;
+
+    // the files without info are counted too, RENAME_NOREPLACE would fail on them
+    for (const int fd : { filesFd, infoFd }) {
+        const int dirFd = dup(fd);
+        DIR *dir = dirFd >= 0 ? fdopendir(dirFd) : nullptr;
+        if (!dir) {
+            if (dirFd >= 0)
+                close(dirFd);
+            continue;
+        }
+
+        rewinddir(dir);
+        while (struct dirent *entry = readdir(dir)) {
+            QByteArray name(entry->d_name);
+            if (fd == infoFd) {
+                if (!name.endsWith(kTrashInfoSuffix))
+                    continue;
+                name.chop(static_cast<int>(strlen(kTrashInfoSuffix)));
+            }
+            usedNames.insert(name);
+        }
+        closedir(dir);
+    }
+}
+
+QByteArray LocalTrashEngine::uniqueName(const QByteArray &baseName)
+{
+    // the same names as gio: "name.ext", "name.2.ext", "name.3.ext"...
+    const int dot = baseName.indexOf('.');
+    int &id = nextIds[baseName];
+    while (true) {
+        ++id;
+        QByteArray name = baseName;
+        if (id > 1)
+            name = dot >= 0 ? baseName.left(dot) + '.' + QByteArray::number(id) + baseName.mid(dot)
+                            : baseName + '.' + QByteArray::number(id);
+        if (usedNames.contains(name))
+            continue;
+
+        usedNames.insert(name);
+        return name;
+    }
+}
+
+bool LocalTrashEngine::createInfoFile(const QByteArray &baseName, const QByteArray &content, QByteArray *name)
+{
+    while (true) {
+        *name = uniqueName(baseName);
+        const int fd = openat(infoFd, (*name + kTrashInfoSuffix).constData(),
+                              O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0666);
+        if (fd < 0) {
+            // the name is taken by someone else since the names are loaded
+            if (errno == EEXIST)
+                continue;
+            fmWarning() << "local trash engine failed to create the info of:" << baseName << strerror(errno);
+            return false;
+        }
+
+        const bool ok = write(fd, content.constData(), static_cast<size_t>(content.size())) == content.size();
+        close(fd);
+        if (!ok) {
+            unlinkat(infoFd, (*name + kTrashInfoSuffix).constData(), 0);
+            return false;
+        }
+        return true;
+    }
+}
+
+DPFILEOPERATIONS_END_NAMESPACE
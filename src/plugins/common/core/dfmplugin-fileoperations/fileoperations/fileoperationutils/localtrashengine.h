@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef LOCALTRASHENGINE_H
+#define LOCALTRASHENGINE_H
+
+#include "dfmplugin_fileoperations_global.h"
+
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+
+#include <sys/types.h>
+
+DPFILEOPERATIONS_BEGIN_NAMESPACE
+
+/*!
+ * \brief The LocalTrashEngine class moves files into the home trash in batches.
+ * It only handles the files on the same filesystem as the trash: the unique names of a batch are
+ * computed against the names read from the trash once, the .trashinfo files of the batch are
+ * written with a single fsync of the info directory, and the files are renamed into the trash by
+ * renameat2(RENAME_NOREPLACE). The layout is the one of the freedesktop trash written by gio.
+ */
+class LocalTrashEngine
+{
+    Q_DISABLE_COPY(LocalTrashEngine)
+public:
+    explicit LocalTrashEngine(const QString &filesPath, const QString &infoPath);
+    ~LocalTrashEngine();
+
+    bool isValid() const;
+    bool canTrash(const QUrl &url) const;
+
+    // returns the deletion time range of the batch as "start-end", which is kept in the user info
+    // of the trashed urls to restore them; the urls failed to trash are not in `trashedUrls`
+    QString trashFiles(const QList<QUrl> &urls, QList<QUrl> *trashedUrls);
+
+private:
+    void loadNames();
+    QByteArray uniqueName(const QByteArray &baseName);
+    bool createInfoFile(const QByteArray &baseName, const QByteArray &content, QByteArray *name);
+
+private:
+    int filesFd { -1 };
+    int infoFd { -1 };
+    dev_t trashDevice { 0 };
+    bool namesLoaded { false };
+    QSet<QByteArray> usedNames;   // the names in the trash and the ones reserved by this engine
+    QHash<QByteArray, int> nextIds;   // base name -> the next id to try in uniqueName
+};
+
+DPFILEOPERATIONS_END_NAMESPACE
+
+#endif   // LOCALTRASHENGINE_H
@@ -4,7 +4,42 @@
 
 #include "workerdata.h"
 
+static constexpr qint64 kLowSpeedCopyBlockSize { 256 * 1024 };
+static constexpr qint64 kLowSpeedMaxCopyBlockSize { 2 * 1024 * 1024 };
+static constexpr qint64 kCopyBlockSize { 1024 * 1024 };
+static constexpr qint64 kExternalMaxCopyBlockSize { 8 * 1024 * 1024 };
+static constexpr qint64 kMaxCopyBlockSize { 16 * 1024 * 1024 };
+
 DPFILEOPERATIONS_USE_NAMESPACE
 WorkerData::WorkerData()
 {
 }
+
+/*!
+ * \brief WorkerData::copyBlockSize The first block size of a file copy, picked by the source and target devices
+ * \return block size
+ */
+qint64 WorkerData::copyBlockSize() const
+{
+    // every request to a network mount is slow, small blocks keep progress, pause and stop responsive
+    if (isSourceLowSpeed || isTargetLowSpeed)
+        return kLowSpeedCopyBlockSize;
+
+    return kCopyBlockSize;
+}
+
+/*!
+ * \brief WorkerData::maxCopyBlockSize The block size of a sequential copy grows up to this size
+ * \return max block size
+ */
+qint64 WorkerData::maxCopyBlockSize() const
+{
+    if (isSourceLowSpeed || isTargetLowSpeed)
+        return kLowSpeedMaxCopyBlockSize;
+
+    // usb sticks and vfat devices may sync after every write, bigger blocks mean fewer syncs
+    if (isBlockDevice || isFsTypeVfat)
+        return kExternalMaxCopyBlockSize;
+
+    return kMaxCopyBlockSize;
+}
@@ -5,6 +5,7 @@
 #ifndef WORKERDATA_H
 #define WORKERDATA_H
 #include "dfmplugin_fileoperations_global.h"
+#include "copybufferpool.h"
 #include <dfm-base/interfaces/abstractjobhandler.h>
 #include <dfm-base/interfaces/fileinfo.h>
 #include <dfm-base/utils/threadcontainer.h>
@@ -19,6 +20,12 @@ DFMBASE_USE_NAMESPACE
 class WorkerData
 {
 public:
+    enum class IntegrityCheckMode : uint8_t {
+        kFullReadBack,   // read the whole target file again after the copy (adler32)
+        kDirectReadBack,   // crc32c while copying, read the whole target file back bypassing the page cache
+        kSampledReadBack,   // crc32c while copying, sync and read back sampled blocks of the target file
+    };
+
     struct BlockFileCopyInfo
     {
         bool closeflag;
@@ -46,8 +53,16 @@ public:
         }
     };
 
+    enum class CopyEngine : uint8_t {
+        kThreadPool,   // small files are copied one by one in the thread pool
+        kIoUring,   // small files are copied in batches through io_uring
+    };
+
     WorkerData();
 
+    qint64 copyBlockSize() const;
+    qint64 maxCopyBlockSize() const;
+
     quint16 dirSize { 0 };   // size of dir
     AbstractJobHandler::JobFlags jobFlags { AbstractJobHandler::JobFlag::kNoHint };   // job flag
     QMap<AbstractJobHandler::JobErrorType, AbstractJobHandler::SupportAction> errorOfAction;
@@ -55,6 +70,11 @@ public:
     std::atomic_bool exBlockSyncEveryWrite { false };
     std::atomic_bool isFsTypeVfat { false };
     std::atomic_bool isBlockDevice { false };
+    std::atomic_bool isSourceLowSpeed { false };   // source file on gvfs/smb mount
+    std::atomic_bool isTargetLowSpeed { false };   // target file on gvfs/smb mount
+    std::atomic<IntegrityCheckMode> integrityCheckMode { IntegrityCheckMode::kFullReadBack };
+    std::atomic<CopyEngine> copyEngine { CopyEngine::kThreadPool };
+    std::atomic_bool kernelCopy { false };   // let the kernel copy local files (reflink, copy_file_range, sendfile)
     std::atomic_int64_t currentWriteSize { 0 };
     QAtomicInteger<qint64> zeroOrlinkOrDirWriteSize { 0 };   // The copy size is 0. The write statistics size of the linked file and directory
     QAtomicInteger<qint64> blockRenameWriteSize { 0 };   // The copy size is 0. The write statistics size of the linked file and directory
@@ -63,6 +83,7 @@ public:
     std::atomic_bool signalThread { true };
     DThreadMap<QUrl, qint64> everyFileWriteSize;
     DThreadList<QSharedPointer<DPFILEOPERATIONS_NAMESPACE::WorkerData::BlockFileCopyInfo>> blockCopyInfoQueue;
+    CopyBufferPool bufferPool;   // copy buffers shared by all copy workers of the job
 };
 DPFILEOPERATIONS_END_NAMESPACE
 using BlockFileCopyInfoPointer = QSharedPointer<DPFILEOPERATIONS_NAMESPACE::WorkerData::BlockFileCopyInfo>;
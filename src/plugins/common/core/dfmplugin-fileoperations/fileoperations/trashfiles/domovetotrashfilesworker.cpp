@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "domovetotrashfilesworker.h"
+#include "fileoperations/fileoperationutils/localtrashengine.h"
 
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/base/standardpaths.h>
@@ -21,6 +22,8 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
+static constexpr int kLocalTrashBatchSize { 1000 };
+
 USING_IO_NAMESPACE
 DPFILEOPERATIONS_USE_NAMESPACE
 DoMoveToTrashFilesWorker::DoMoveToTrashFilesWorker(QObject *parent)
@@ -72,18 +75,15 @@ bool DoMoveToTrashFilesWorker::doMoveToTrash()
 {
     bool result = false;
     DFMBASE_NAMESPACE::LocalFileHandler fileHandler;
-    static QString homeTrashFileDir = dfmbase::StandardPaths::location(StandardPaths::StandardLocation::kTrashLocalFilesPath);
+    QSet<QUrl> trashedUrls;
+    if (!doMoveToTrashOnLocalDevice(&trashedUrls))
+        return false;
+
     // 总大小使用源文件个数
     for (const auto &url : sourceUrls) {
-        QUrl urlSource = url;
-        if (!fstabMap.empty()) {
-            for (const auto &device : fstabMap.keys()) {
-                if (urlSource.path().startsWith(device)) {
-                    urlSource.setPath(urlSource.path().replace(0, device.size(), fstabMap[device]));
-                    break;
-                }
-            }
-        }
+        const QUrl &urlSource = bindSourceUrl(url);
+        if (trashedUrls.contains(urlSource))
+            continue;
 
         if (!stateCheck())
             return false;
@@ -155,6 +155,71 @@ bool DoMoveToTrashFilesWorker::doMoveToTrash()
     return true;
 }
 
+/*!
+ * \brief DoMoveToTrashFilesWorker::doMoveToTrashOnLocalDevice move the files on the same filesystem as
+ * the home trash by LocalTrashEngine in batches, the files failed to move are left to doMoveToTrash,
+ * where they are moved one by one and the errors are handled
+ * \param trashedUrls Output parameters, the urls moved to trash
+ * \return false if the job is stopped
+ */
+bool DoMoveToTrashFilesWorker::doMoveToTrashOnLocalDevice(QSet<QUrl> *trashedUrls)
+{
+    LocalTrashEngine engine(StandardPaths::location(StandardPaths::StandardLocation::kTrashLocalFilesPath),
+                            StandardPaths::location(StandardPaths::StandardLocation::kTrashLocalInfoPath));
+    if (!engine.isValid())
+        return true;
+
+    QList<QUrl> batch;
+    auto trashBatch = [&]() {
+        if (batch.isEmpty())
+            return stateCheck();
+
+        emitCurrentTaskNotify(batch.first(), targetUrl);
+        QList<QUrl> trashed;
+        const QString &trashTime = engine.trashFiles(batch, &trashed);
+        for (const QUrl &url : trashed) {
+            QUrl trashUrl = url;
+            trashUrl.setUserInfo(trashTime);
+            completeTargetFiles.append(trashUrl);
+            completeSourceFiles.append(url);
+            trashedUrls->insert(url);
+        }
+        completeFilesCount += trashed.count();
+        emitProgressChangedNotify(completeFilesCount);
+        batch.clear();
+        return stateCheck();
+    };
+
+    for (const auto &url : sourceUrls) {
+        const QUrl &urlSource = bindSourceUrl(url);
+        if (FileUtils::isTrashFile(urlSource) || !engine.canTrash(urlSource))
+            continue;
+
+        batch.append(urlSource);
+        if (batch.count() >= kLocalTrashBatchSize && !trashBatch())
+            return false;
+    }
+
+    return trashBatch();
+}
+
+/*!
+ * \brief DoMoveToTrashFilesWorker::bindSourceUrl translate the source url in the bind mounts of fstab
+ * \param url the source file url
+ * \return the url of the source file
+ */
+QUrl DoMoveToTrashFilesWorker::bindSourceUrl(const QUrl &url) const
+{
+    QUrl urlSource = url;
+    for (auto it = fstabMap.cbegin(); it != fstabMap.cend(); ++it) {
+        if (urlSource.path().startsWith(it.key())) {
+            urlSource.setPath(urlSource.path().replace(0, it.key().size(), it.value()));
+            break;
+        }
+    }
+    return urlSource;
+}
+
 /*!
  * \brief DoMoveToTrashFilesWorker::isCanMoveToTrash loop to check the source file can move to trash
  * \param url the source file url
@@ -12,6 +12,7 @@
 #include <dfm-base/interfaces/fileinfo.h>
 
 #include <QObject>
+#include <QSet>
 
 #include <dfm-io/dfile.h>
 
@@ -35,7 +36,9 @@ protected:
 
 protected:
     bool doMoveToTrash();
+    bool doMoveToTrashOnLocalDevice(QSet<QUrl> *trashedUrls);
     bool isCanMoveToTrash(const QUrl &url, bool *result);
+    QUrl bindSourceUrl(const QUrl &url) const;
 
 private:
     FileInfoPointer targetFileInfo { nullptr };   // target file information
@@ -11,6 +11,9 @@
 #include <QColor>
 #include <QDebug>
 #include <QSet>
+#include <QtAlgorithms>
+
+#include <algorithm>
 
 DPTAG_USE_NAMESPACE
 
@@ -76,6 +79,122 @@ FileTagCachePrivate::~FileTagCachePrivate()
 {
 }
 
+int FileTagCachePrivate::internTag(const QString &name)
+{
+    auto iter = tagIds.constFind(name);
+    if (iter != tagIds.cend())
+        return iter.value();
+
+    int id = -1;
+    if (!freeIds.isEmpty()) {
+        id = freeIds.takeLast();
+        tagNames[id] = name;
+        tagColors[id] = QColor();
+    } else {
+        id = tagNames.size();
+        tagNames.append(name);
+        tagColors.append(QColor());
+        tagRanks.append(0);
+    }
+
+    tagIds.insert(name, id);
+    updateRanks();
+    return id;
+}
+
+void FileTagCachePrivate::releaseTag(int id)
+{
+    for (auto iter = fileTags.begin(); iter != fileTags.end();) {
+        clearTag(&iter.value(), id);
+        if (isEmpty(iter.value()))
+            iter = fileTags.erase(iter);
+        else
+            ++iter;
+    }
+
+    tagIds.remove(tagNames.at(id));
+    tagNames[id].clear();
+    tagColors[id] = QColor();
+    freeIds.append(id);
+}
+
+void FileTagCachePrivate::renameTag(int id, const QString &newName)
+{
+    const int newId = tagIds.value(newName, -1);
+    if (newId == id)
+        return;
+
+    if (newId < 0) {
+        tagIds.remove(tagNames.at(id));
+        tagIds.insert(newName, id);
+        tagNames[id] = newName;
+        updateRanks();
+        return;
+    }
+
+    // merge into the existing tag
+    for (auto iter = fileTags.begin(); iter != fileTags.end(); ++iter) {
+        if (hasTag(iter.value(), id))
+            setTag(&iter.value(), newId);
+    }
+    if (!tagColors.at(newId).isValid())
+        tagColors[newId] = tagColors.at(id);
+    releaseTag(id);
+}
+
+void FileTagCachePrivate::updateRanks()
+{
+    QVector<int> ids;
+    for (int id = 0; id != tagNames.size(); ++id) {
+        if (!tagNames.at(id).isEmpty())
+            ids.append(id);
+    }
+    std::sort(ids.begin(), ids.end(), [this](int lhs, int rhs) {
+        return tagNames.at(lhs) < tagNames.at(rhs);
+    });
+    for (int i = 0; i != ids.size(); ++i)
+        tagRanks[ids.at(i)] = i;
+}
+
+QVector<int> FileTagCachePrivate::tagsOfMask(const TagMask &mask) const
+{
+    QVector<int> ids;
+    for (int word = 0; word != mask.size(); ++word) {
+        for (quint64 bits = mask.at(word); bits; bits &= bits - 1)
+            ids.append(word * 64 + static_cast<int>(qCountTrailingZeroBits(bits)));
+    }
+    std::sort(ids.begin(), ids.end(), [this](int lhs, int rhs) {
+        return tagRanks.at(lhs) < tagRanks.at(rhs);
+    });
+    return ids;
+}
+
+bool FileTagCachePrivate::hasTag(const TagMask &mask, int id)
+{
+    const int word = id / 64;
+    return word < mask.size() && (mask.at(word) & (quint64(1) << (id % 64)));
+}
+
+void FileTagCachePrivate::setTag(TagMask *mask, int id)
+{
+    const int word = id / 64;
+    while (mask->size() <= word)
+        mask->append(0);
+    (*mask)[word] |= quint64(1) << (id % 64);
+}
+
+void FileTagCachePrivate::clearTag(TagMask *mask, int id)
+{
+    const int word = id / 64;
+    if (word < mask->size())
+        (*mask)[word] &= ~(quint64(1) << (id % 64));
+}
+
+bool FileTagCachePrivate::isEmpty(const TagMask &mask)
+{
+    return std::all_of(mask.begin(), mask.end(), [](quint64 bits) { return bits == 0; });
+}
+
 FileTagCache::FileTagCache(QObject *parent)
     : QObject(parent), d(new FileTagCachePrivate(this))
 {
@@ -93,116 +212,120 @@ void FileTagCache::loadFileTagsFromDatabase()
     // 加载数据库所有文件标记,和标记属性到缓存
     if (!TagProxyHandle::instance()->isValid())
         fmWarning() << "tagService is inValid";
-    d->fileTagsCache = TagProxyHandle::instance()->getAllFileWithTags();
+    const auto &filesTags = TagProxyHandle::instance()->getAllFileWithTags();
     const auto &tagsColor = TagProxyHandle::instance()->getAllTags();
-    auto it = tagsColor.begin();
-    for (; it != tagsColor.end(); ++it)
-        d->tagProperty.insert(it.key(), QColor(it.value().toString()));
+
+    QWriteLocker lk(&d->lock);
+    d->fileTags.clear();
+    d->tagIds.clear();
+    d->tagNames.clear();
+    d->tagColors.clear();
+    d->tagRanks.clear();
+    d->freeIds.clear();
+
+    for (auto it = tagsColor.begin(); it != tagsColor.end(); ++it) {
+        const int id = d->internTag(it.key());
+        d->tagColors[id] = QColor(it.value().toString());
+    }
+
+    d->fileTags.reserve(filesTags.size());
+    for (auto it = filesTags.begin(); it != filesTags.end(); ++it) {
+        const QStringList &tags = it.value().toStringList();
+        if (tags.isEmpty())
+            continue;
+
+        FileTagCachePrivate::TagMask &mask = d->fileTags[it.key()];
+        for (const QString &tag : tags)
+            FileTagCachePrivate::setTag(&mask, d->internTag(tag));
+    }
 }
 
 void FileTagCache::addTags(const QVariantMap &tags)
 {
+    QWriteLocker lk(&d->lock);
     auto it = tags.begin();
     for (; it != tags.end(); ++it) {
-        if (d->tagProperty.contains(it.key()))
+        const int id = d->internTag(it.key());
+        if (d->tagColors.at(id).isValid())
             continue;
-        d->tagProperty.insert(it.key(), QColor(it.value().toString()));
+        d->tagColors[id] = QColor(it.value().toString());
     }
 }
 
 void FileTagCache::deleteTags(const QStringList &tags)
 {
-    QVariantMap map {};
+    QWriteLocker lk(&d->lock);
     for (const QString &tag : tags) {
-        d->tagProperty.remove(tag);
-
-        auto iter = d->fileTagsCache.begin();
-        while (iter != d->fileTagsCache.end()) {
-            if (iter.value().toStringList().contains(tag)) {
-                QStringList fileTags = map[iter.key()].toStringList();
-                fileTags.append(tag);
-                map[iter.key()] = fileTags;
-            }
-
-            ++iter;
-        }
+        const int id = d->tagIds.value(tag, -1);
+        if (id >= 0)
+            d->releaseTag(id);
     }
-
-    if (!map.isEmpty())
-        untaggeFiles(map);
 }
 
 void FileTagCache::changeTagColor(const QVariantMap &tagAndColorName)
 {
+    QWriteLocker lk(&d->lock);
     auto it = tagAndColorName.begin();
     for (; it != tagAndColorName.end(); ++it) {
-        if (d->tagProperty.contains(it.key()))
-            d->tagProperty[it.key()] = QColor(it.value().toString());
+        const int id = d->tagIds.value(it.key(), -1);
+        if (id >= 0 && d->tagColors.at(id).isValid())
+            d->tagColors[id] = QColor(it.value().toString());
     }
 }
 
 void FileTagCache::changeTagName(const QVariantMap &oldAndNew)
 {
+    QWriteLocker lk(&d->lock);
     auto it = oldAndNew.begin();
     for (; it != oldAndNew.end(); ++it) {
-        const QString &oldName { it.key() };
-        const QString &newName { it.value().toString() };
-        if (d->tagProperty.contains(oldName)) {
-            const auto &color { d->tagProperty.value(oldName) };
-            d->tagProperty.remove(oldName);
-            d->tagProperty.insert(newName, color);
-        }
+        const int id = d->tagIds.value(it.key(), -1);
+        if (id >= 0)
+            d->renameTag(id, it.value().toString());
     }
 }
 
 void FileTagCache::changeFilesTagName(const QString &oldName, const QString &newName)
 {
-    std::for_each(d->fileTagsCache.begin(), d->fileTagsCache.end(), [oldName, newName](QVariant &var) {
-        QStringList tagNames { var.toStringList() };
-        auto result { std::find(tagNames.begin(), tagNames.end(), oldName) };
-        if (result != tagNames.end()) {
-            int index { result - tagNames.begin() };
-            tagNames.replace(index, newName);
-            var.setValue(tagNames);
-        }
-    });
+    // the files refer to the tag id, they are already renamed with the tag in most cases
+    QWriteLocker lk(&d->lock);
+    const int id = d->tagIds.value(oldName, -1);
+    if (id >= 0)
+        d->renameTag(id, newName);
 }
 
 void FileTagCache::taggeFiles(const QVariantMap &fileAndTags)
 {
+    QWriteLocker lk(&d->lock);
     auto it = fileAndTags.begin();
     for (; it != fileAndTags.end(); ++it) {
-        if (!d->fileTagsCache.contains(it.key())) {
-            d->fileTagsCache.insert(it.key(), it.value().toStringList());
-        } else {
-            const auto &lst = it.value().toStringList();
-            auto cacheLst = d->fileTagsCache.value(it.key()).toStringList();
-            for (const QString &tag : lst)
-                if (!cacheLst.contains(tag))
-                    cacheLst.append(tag);
-
-            d->fileTagsCache[it.key()] = cacheLst;
-        }
+        const QStringList &tags = it.value().toStringList();
+        if (tags.isEmpty())
+            continue;
+
+        FileTagCachePrivate::TagMask &mask = d->fileTags[it.key()];
+        for (const QString &tag : tags)
+            FileTagCachePrivate::setTag(&mask, d->internTag(tag));
     }
 }
 
 void FileTagCache::untaggeFiles(const QVariantMap &fileAndTags)
 {
+    QWriteLocker lk(&d->lock);
     auto it = fileAndTags.begin();
     for (; it != fileAndTags.end(); ++it) {
-        if (d->fileTagsCache.contains(it.key())) {
-            const auto &lst = it.value().toStringList();
-            auto cacheLst = d->fileTagsCache.value(it.key()).toStringList();
-            for (const QString &tag : lst)
-                if (cacheLst.contains(tag))
-                    cacheLst.removeOne(tag);
-
-            if (cacheLst.isEmpty()) {
-                d->fileTagsCache.remove(it.key());
-            } else {
-                d->fileTagsCache[it.key()] = cacheLst;
-            }
+        auto iter = d->fileTags.find(it.key());
+        if (iter == d->fileTags.end())
+            continue;
+
+        const QStringList &tags = it.value().toStringList();
+        for (const QString &tag : tags) {
+            const int id = d->tagIds.value(tag, -1);
+            if (id >= 0)
+                FileTagCachePrivate::clearTag(&iter.value(), id);
         }
+
+        if (FileTagCachePrivate::isEmpty(iter.value()))
+            d->fileTags.erase(iter);
     }
 }
 
@@ -220,15 +343,21 @@ QStringList FileTagCache::getTagsByFiles(const QStringList &paths) const
     if (paths.isEmpty())
         return {};
 
-    QReadLocker wlk(&d->lock);
-    QStringList intersectionTags = d->fileTagsCache.value(paths.first()).toStringList();
-
+    QReadLocker rlk(&d->lock);
+    FileTagCachePrivate::TagMask intersection = d->fileTags.value(paths.first());
     for (const QString &path : paths) {
-        QStringList tags = d->fileTagsCache.value(path).toStringList();
-        intersectionTags = intersectionTags.toSet().intersect(tags.toSet()).values();
-        if (intersectionTags.isEmpty())
-            break;
+        auto iter = d->fileTags.constFind(path);
+        if (iter == d->fileTags.cend())
+            return {};
+
+        intersection.resize(qMin(intersection.size(), iter->size()));
+        for (int word = 0; word != intersection.size(); ++word)
+            intersection[word] &= iter->at(word);
     }
+
+    QStringList intersectionTags;
+    for (int id : d->tagsOfMask(intersection))
+        intersectionTags.append(d->tagNames.at(id));
     return intersectionTags;
 }
 
@@ -237,16 +366,35 @@ FileTagCache::TagColorMap FileTagCache::getTagsColor(const QStringList &tags) co
     if (tags.isEmpty())
         return {};
 
-    QReadLocker wlk(&d->lock);
+    QReadLocker rlk(&d->lock);
     TagColorMap tagsColor;
     for (const auto &tag : tags) {
-        if (d->tagProperty.contains(tag))
-            tagsColor.insert(tag, d->tagProperty.value(tag));
+        const int id = d->tagIds.value(tag, -1);
+        if (id >= 0 && d->tagColors.at(id).isValid())
+            tagsColor.insert(tag, d->tagColors.at(id));
     }
 
     return tagsColor;
 }
 
+/**
+ * @brief The colors of the tags of a file in the order of the tag names, used in painting
+ */
+QList<QColor> FileTagCache::getTagColorsByFile(const QString &path) const
+{
+    QReadLocker rlk(&d->lock);
+    auto iter = d->fileTags.constFind(path);
+    if (iter == d->fileTags.cend())
+        return {};
+
+    QList<QColor> colors;
+    for (int id : d->tagsOfMask(iter.value())) {
+        if (d->tagColors.at(id).isValid())
+            colors.append(d->tagColors.at(id));
+    }
+    return colors;
+}
+
 FileTagCacheController &FileTagCacheController::instance()
 {
     static FileTagCacheController cacheController;
@@ -268,6 +416,11 @@ QMap<QString, QColor> FileTagCacheController::getCacheTagsColor(const QStringLis
     return FileTagCache::instance().getTagsColor(tags);
 }
 
+QList<QColor> FileTagCacheController::getTagColorsByFile(const QString &path)
+{
+    return FileTagCache::instance().getTagColorsByFile(path);
+}
+
 FileTagCacheController::~FileTagCacheController()
 {
     updateThread->quit();
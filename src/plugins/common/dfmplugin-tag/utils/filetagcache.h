@@ -50,6 +50,7 @@ public:
     //query
     QStringList getTagsByFiles(const QStringList &paths) const;
     TagColorMap getTagsColor(const QStringList &tags) const;
+    QList<QColor> getTagColorsByFile(const QString &path) const;
 
 private:
     explicit FileTagCache(QObject *parent = nullptr);
@@ -80,6 +81,7 @@ public:
     QStringList getTagsByFiles(const QStringList &paths);
     QStringList getTagsByFile(const QString &path);
     QMap<QString, QColor> getCacheTagsColor(const QStringList &tags);
+    QList<QColor> getTagColorsByFile(const QString &path);
 
 Q_SIGNALS:
     void initLoadTagInfos();
@@ -8,6 +8,10 @@
 #include "utils/filetagcache.h"
 #include <QReadWriteLock>
 #include <QMutex>
+#include <QColor>
+#include <QHash>
+#include <QVarLengthArray>
+#include <QVector>
 
 namespace dfmplugin_tag {
 class FileTagCachePrivate
@@ -15,13 +19,32 @@ class FileTagCachePrivate
     friend class FileTagCache;
     FileTagCache *const q;
 
-    QHash<QString, QVariant> fileTagsCache;   // file path ->  tag name list
-    QHash<QString, QColor> tagProperty;   // tag name -> QColor
+    // the tags are interned to small ids, the tags of a file are stored as a bitmask of the ids,
+    // so that looking up the tags of a file in painting does not copy any string
+    using TagMask = QVarLengthArray<quint64, 1>;
+
+    QHash<QString, TagMask> fileTags;   // file path -> tag ids
+    QHash<QString, int> tagIds;   // tag name -> tag id
+    QStringList tagNames;   // tag id -> tag name, empty if the id is free
+    QVector<QColor> tagColors;   // tag id -> QColor, invalid if the tag has no property
+    QVector<int> tagRanks;   // tag id -> order of the name, the tags are listed in the order of names
+    QVector<int> freeIds;
     QReadWriteLock lock;
 
 public:
     explicit FileTagCachePrivate(FileTagCache *qq);
     virtual ~FileTagCachePrivate();
+
+    int internTag(const QString &name);
+    void releaseTag(int id);
+    void renameTag(int id, const QString &newName);
+    void updateRanks();
+    QVector<int> tagsOfMask(const TagMask &mask) const;
+
+    static bool hasTag(const TagMask &mask, int id);
+    static void setTag(TagMask *mask, int id);
+    static void clearTag(TagMask *mask, int id);
+    static bool isEmpty(const TagMask &mask);
 };
 }
 
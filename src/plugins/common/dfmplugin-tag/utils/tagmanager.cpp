@@ -132,17 +132,13 @@ bool TagManager::paintListTagsHandle(int role, const FileInfoPointer &info, QPai
 
     QString path = info->pathOf(PathInfoType::kFilePath);
     path = FileUtils::bindPathTransform(path, false);
-    const auto &tags = FileTagCacheIns.getTagsByFile(path);
-    if (tags.isEmpty())
-        return false;
-
-    const auto &tagsColor = FileTagCacheIns.getCacheTagsColor(tags);
+    const auto &tagsColor = FileTagCacheIns.getTagColorsByFile(path);
     if (!tagsColor.isEmpty()) {
         QRectF boundingRect(0, 0, (tagsColor.size() + 1) * kTagDiameter / 2, kTagDiameter);
         boundingRect.moveCenter(rect->center());
         boundingRect.moveRight(rect->right());
 
-        TagHelper::instance()->paintTags(painter, boundingRect, tagsColor.values());
+        TagHelper::instance()->paintTags(painter, boundingRect, tagsColor);
 
         rect->setRight(boundingRect.left() - 10);
     }
@@ -157,18 +153,13 @@ bool TagManager::addIconTagsHandle(const FileInfoPointer &info, ElideTextLayout
 
     QString path = info->pathOf(PathInfoType::kFilePath);
     path = FileUtils::bindPathTransform(path, false);
-    const auto &fileTags = FileTagCacheIns.getTagsByFile(path);
-    if (fileTags.isEmpty())
-        return false;
-
-    const auto &tagsColor = FileTagCacheIns.getCacheTagsColor(fileTags);
-
+    const auto &tagsColor = FileTagCacheIns.getTagColorsByFile(path);
     if (!tagsColor.isEmpty()) {
         auto document = layout->documentHandle();
         if (document) {
             document->documentLayout()->registerHandler(textObjectType, tagPainter);
             QTextCursor cursor(document);
-            TagTextFormat format(textObjectType, tagsColor.values(), Qt::white);
+            TagTextFormat format(textObjectType, tagsColor, Qt::white);
 
             cursor.setPosition(0);
             cursor.insertText(QString(QChar::ObjectReplacementCharacter), format);
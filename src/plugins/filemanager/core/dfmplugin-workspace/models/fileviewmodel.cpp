@@ -21,6 +21,7 @@
 #include <dfm-base/utils/universalutils.h>
 #include <dfm-base/base/application/application.h>
 #include <dfm-base/utils/thumbnail/thumbnailfactory.h>
+#include <dfm-base/utils/thumbnail/thumbnailhelper.h>
 #include <dfm-base/widgets/filemanagerwindowsmanager.h>
 #include <dfm-base/base/configs/dconfig/dconfigmanager.h>
 
@@ -358,6 +359,10 @@ QVariant FileViewModel::headerData(int column, Qt::Orientation, int role) const
 
 void FileViewModel::refresh()
 {
+    // 本地目录只比较目录的变化，不重置model
+    if (FileDataManager::instance()->refreshRoot(dirRootUrl))
+        return;
+
     FileDataManager::instance()->cleanRoot(dirRootUrl, currentKey, true);
 
     Q_EMIT requestRefreshAllChildren();
@@ -714,7 +719,7 @@ void FileViewModel::updateThumbnailIcon(const QModelIndex &index, const QString
         return;
 
     // Creating thumbnail icon in a thread may cause the program to crash
-    QIcon thumbIcon(thumb);
+    const QIcon &thumbIcon = ThumbnailHelper::thumbnailIcon(thumb);
     if (thumbIcon.isNull())
         return;
 
@@ -4,6 +4,7 @@
 
 #include "rootinfo.h"
 #include "fileitemdata.h"
+#include "utils/dirsnapshotcache.h"
 
 #include <dfm-base/base/schemefactory.h>
 #include <dfm-base/utils/universalutils.h>
@@ -18,6 +19,12 @@
 #include <QApplication>
 #include <QtConcurrent>
 #include <QElapsedTimer>
+#include <QDateTime>
+
+#include <dirent.h>
+#include <string.h>
+#include <fcntl.h>
+#include <sys/stat.h>
 
 using namespace dfmbase;
 using namespace dfmplugin_workspace;
@@ -36,6 +43,7 @@ RootInfo::~RootInfo()
         watcher->stopWatcher();
     cancelWatcherEvent = true;
     watcherEventFuture.waitForFinished();
+    refreshFuture.waitForFinished();
     for (const auto &thread : traversalThreads) {
         thread->traversalThread->stop();
         thread->traversalThread->wait();
@@ -100,6 +108,10 @@ void RootInfo::startWork(const QString &key, const bool getCache)
         childrenUrlList.clear();
         sourceDataList.clear();
     }
+    snapshotTime = QDateTime::currentMSecsSinceEpoch() * 1000000;
+    if (loadDirSnapshot(key))
+        return;
+
     traversalThreads.value(key)->traversalThread->start();
 }
 
@@ -171,6 +183,29 @@ void RootInfo::reset()
     traversalFinish = false;
 }
 
+/*!
+ * \brief RootInfo::canRefreshIncrementally 本地目录遍历完成后，刷新时只需要比较目录的变化
+ */
+bool RootInfo::canRefreshIncrementally() const
+{
+    return url.isLocalFile() && traversalFinish && !traversaling && !traversalThreads.isEmpty();
+}
+/*!
+ * \brief RootInfo::refreshIncrementally 重新读取一次目录，只把新增、删除和修改的文件通知给排序线程，
+ * 不重置model，滚动位置、选中和缩略图都会保留
+ */
+void RootInfo::refreshIncrementally()
+{
+    if (refreshing)
+        return;
+
+    refreshing = true;
+    refreshFuture = QtConcurrent::run([this]() {
+        doIncrementalRefresh();
+        refreshing = false;
+    });
+}
+
 void RootInfo::doFileDeleted(const QUrl &url)
 {
     enqueueEvent(QPair<QUrl, EventType>(url, kRmFile));
@@ -373,6 +408,7 @@ void RootInfo::handleTraversalFinish(const QString &travseToken)
     if (isRefresh) {
         isRefresh = false;
     }
+    saveDirSnapshot();
 }
 
 void RootInfo::handleTraversalSort(const QString &travseToken)
@@ -594,6 +630,165 @@ QPair<QUrl, RootInfo::EventType> RootInfo::dequeueEvent()
     return QPair<QUrl, RootInfo::EventType>();
 }
 
+void RootInfo::doIncrementalRefresh()
+{
+    const qint64 scanTime = QDateTime::currentMSecsSinceEpoch() * 1000000;
+
+    // 当前的文件按名称建立索引，遍历目录后剩下的就是被删除的文件
+    QList<QUrl> urls;
+    QList<SortInfoPointer> sortInfos;
+    {
+        QReadLocker lk(&childrenLock);
+        urls = childrenUrlList;
+        sortInfos = sourceDataList;
+    }
+    QHash<QString, int> childIndexes;
+    childIndexes.reserve(urls.count());
+    for (int i = 0; i < urls.count(); ++i)
+        childIndexes.insert(urls.at(i).fileName(), i);
+
+    const QByteArray &dirPath = QFile::encodeName(url.path());
+    DIR *dir = opendir(dirPath.constData());
+    if (!dir) {
+        fmWarning() << "Incremental refresh open dir failed! url = " << url << strerror(errno);
+        return;
+    }
+
+    QHash<QString, DirSnapshotEntry> snapshot;
+    snapshot.reserve(urls.count());
+    QList<QUrl> adds, updates, removes;
+    const int dirFd = dirfd(dir);
+    while (struct dirent *ent = readdir(dir)) {
+        if (cancelWatcherEvent) {
+            closedir(dir);
+            return;
+        }
+        if (strcmp(ent->d_name, ".") == 0 || strcmp(ent->d_name, "..") == 0)
+            continue;
+
+        DirSnapshotEntry entry;
+        entry.inode = ent->d_ino;
+        bool isDir = ent->d_type == DT_DIR;
+        struct stat st;
+        if (fstatat(dirFd, ent->d_name, &st, AT_SYMLINK_NOFOLLOW) == 0) {
+            entry.inode = st.st_ino;
+            entry.size = st.st_size;
+            entry.mtime = qMax(st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec,
+                               st.st_ctim.tv_sec * 1000000000 + st.st_ctim.tv_nsec);
+            isDir = S_ISDIR(st.st_mode);
+        }
+
+        const QString &name = QFile::decodeName(ent->d_name);
+        snapshot.insert(name, entry);
+
+        auto it = childIndexes.find(name);
+        if (it == childIndexes.end()) {
+            QUrl childUrl = url;
+            childUrl.setPath(DFMIO::DFMUtils::buildFilePath(url.path().toStdString().c_str(),
+                                                            name.toStdString().c_str(), nullptr));
+            adds.append(childUrl);
+            continue;
+        }
+
+        const int index = it.value();
+        childIndexes.erase(it);
+        bool changed = false;
+        auto old = dirSnapshot.constFind(name);
+        if (old != dirSnapshot.cend()) {
+            changed = old->inode != entry.inode || old->mtime != entry.mtime || old->size != entry.size;
+        } else {
+            // 第一次刷新没有快照，遍历开始之后修改过的文件才需要更新
+            const auto &sortInfo = sortInfos.at(index);
+            changed = entry.mtime >= snapshotTime
+                    || (!isDir && sortInfo && sortInfo->fileSize() != entry.size);
+        }
+        if (changed)
+            updates.append(urls.at(index));
+    }
+    closedir(dir);
+
+    for (auto index : childIndexes)
+        removes.append(urls.at(index));
+
+    dirSnapshot = snapshot;
+    snapshotTime = scanTime;
+
+    if (cancelWatcherEvent)
+        return;
+
+    // 缓存中的fileinfo先更新，排序线程才能取到新的属性
+    for (const auto &updateUrl : updates) {
+        auto info = InfoCacheController::instance().getCacheInfo(updateUrl);
+        if (info)
+            info->updateAttributes();
+    }
+
+    if (!removes.isEmpty())
+        removeChildren(removes);
+    if (!adds.isEmpty())
+        addChildren(adds);
+    if (!updates.isEmpty())
+        updateChildren(updates);
+
+    if (!adds.isEmpty() || !removes.isEmpty() || !updates.isEmpty())
+        saveDirSnapshot();
+}
+/*!
+ * \brief RootInfo::loadDirSnapshot 目录有可用的快照时，直接用快照作为遍历结果，
+ * 然后在后台增量刷新一次，校正快照之后的修改
+ * \return 是否使用了快照
+ */
+bool RootInfo::loadDirSnapshot(const QString &key)
+{
+    if (!DirSnapshotCache::isSupported(url) || !DirSnapshotCache::isEnabled())
+        return false;
+
+    qint64 dataTime { 0 };
+    const QList<SortInfoPointer> &children = DirSnapshotCache::load(url, &dataTime);
+    if (children.isEmpty())
+        return false;
+
+    const auto &thread = traversalThreads.value(key);
+    originSortRole = dfmio::DEnumerator::SortRoleCompareFlag::kSortRoleCompareDefault;
+    originSortOrder = thread->originSortOrder;
+    originMixSort = thread->originMixSort;
+    addChildren(children);
+    // 快照之后修改过的文件，增量刷新时需要更新
+    snapshotTime = dataTime;
+    traversaling = false;
+
+    Q_EMIT iteratorLocalFiles(key, children, originSortRole, originSortOrder, originMixSort);
+    emit traversalFinished(key);
+    traversalFinish = true;
+    isRefresh = false;
+
+    startWatcher();
+    refreshIncrementally();
+    return true;
+}
+/*!
+ * \brief RootInfo::saveDirSnapshot 大目录遍历完成或者增量刷新有变化后，在后台保存目录快照
+ */
+void RootInfo::saveDirSnapshot()
+{
+    if (!DirSnapshotCache::isSupported(url) || !DirSnapshotCache::isEnabled())
+        return;
+
+    QList<SortInfoPointer> children;
+    {
+        QReadLocker lk(&childrenLock);
+        if (sourceDataList.count() < DirSnapshotCache::kMinChildrenCount)
+            return;
+        children = sourceDataList;
+    }
+
+    const QUrl dirUrl = url;
+    const qint64 dataTime = snapshotTime;
+    QtConcurrent::run([dirUrl, children, dataTime]() {
+        DirSnapshotCache::save(dirUrl, children, dataTime);
+    });
+}
+
 // When monitoring the mtp directory, the monitor monitors that the scheme of the
 // url used for adding and deleting files is mtp (mtp://path).
 // Here, the monitor's url is used to re-complete the current url
@@ -39,6 +39,14 @@ public:
         bool originMixSort { false };
     };
 
+    // 目录刷新时的文件快照，只保存比较需要的信息
+    struct DirSnapshotEntry
+    {
+        quint64 inode { 0 };
+        qint64 mtime { 0 };   // st_mtim和st_ctim中较新的一个，单位ns
+        qint64 size { 0 };
+    };
+
 public:
     explicit RootInfo(const QUrl &u, const bool canCache, QObject *parent = nullptr);
     ~RootInfo();
@@ -49,6 +57,8 @@ public:
     int clearTraversalThread(const QString &key, const bool isRefresh = false);
 
     void reset();
+    bool canRefreshIncrementally() const;
+    void refreshIncrementally();
 
     void addConnectToken(const QString &token) {
         if (connectedTokens.contains(token))
@@ -124,6 +134,9 @@ private:
     void enqueueEvent(const QPair<QUrl, EventType> &e);
     QPair<QUrl, EventType> dequeueEvent();
     FileInfoPointer fileInfo(const QUrl &url);
+    void doIncrementalRefresh();
+    bool loadDirSnapshot(const QString &key);
+    void saveDirSnapshot();
 
 public:
     AbstractFileWatcherPointer watcher;
@@ -157,6 +170,12 @@ private:
     std::atomic_bool needStartWatcher { true };
     std::atomic_bool isRefresh { false };
     QStringList connectedTokens;
+
+    // 增量刷新，snapshotTime之后修改过的文件需要更新
+    QHash<QString, DirSnapshotEntry> dirSnapshot;
+    std::atomic<qint64> snapshotTime { 0 };
+    std::atomic_bool refreshing { false };
+    QFuture<void> refreshFuture;
 };
 }
 
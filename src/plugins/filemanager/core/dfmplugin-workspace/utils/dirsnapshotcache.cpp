@@ -0,0 +1,275 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dirsnapshotcache.h"
+
+#include <dfm-base/base/standardpaths.h>
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <dfm-io/dfmio_utils.h>
+
+#include <QCryptographicHash>
+#include <QSaveFile>
+#include <QFile>
+#include <QDir>
+
+#include <cstring>
+#include <sys/stat.h>
+
+using namespace dfmbase;
+using namespace dfmplugin_workspace;
+
+namespace {
+
+constexpr char kSnapshotMagic[8] { 'D', 'F', 'M', 'S', 'N', 'A', 'P', '\0' };
+constexpr quint32 kSnapshotVersion { 1 };
+constexpr char kSnapshotSuffix[] { ".snap" };
+
+enum RecordFlag : quint32 {
+    kFlagFile = 0x01,
+    kFlagDir = 0x02,
+    kFlagSymlink = 0x04,
+    kFlagHide = 0x08,
+    kFlagReadable = 0x10,
+    kFlagWriteable = 0x20,
+    kFlagExecutable = 0x40,
+};
+
+struct SnapshotHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 count;
+    quint64 device;
+    quint64 inode;
+    qint64 dirMtime;   // 目录的修改时间，单位ns
+    qint64 dataTime;   // 快照数据开始遍历的时间，单位ns，之后修改的文件需要重新获取属性
+    quint64 namesOffset;
+    quint64 namesSize;
+};
+
+struct SnapshotRecord
+{
+    quint32 nameOffset;
+    quint32 nameLength;
+    qint64 size;
+    quint32 flags;
+    quint32 reserved;
+};
+
+static_assert(sizeof(SnapshotHeader) == 64, "snapshot header layout changed");
+static_assert(sizeof(SnapshotRecord) == 24, "snapshot record layout changed");
+
+bool statDir(const QUrl &dirUrl, struct stat *st)
+{
+    const QByteArray &path = QFile::encodeName(dirUrl.path());
+    return ::stat(path.constData(), st) == 0 && S_ISDIR(st->st_mode);
+}
+
+qint64 mtimeOf(const struct stat &st)
+{
+    return st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+}   // namespace
+
+bool DirSnapshotCache::isEnabled()
+{
+    return DConfigManager::instance()->value(kViewDConfName, kDirSnapshotEnable, false).toBool();
+}
+
+bool DirSnapshotCache::isSupported(const QUrl &dirUrl)
+{
+    return dirUrl.isLocalFile() && !dirUrl.path().isEmpty();
+}
+/*!
+ * \brief DirSnapshotCache::load 读取目录的快照
+ * \param dirUrl 目录
+ * \param dataTime 快照数据的遍历时间
+ * \return 快照不存在或者目录已经变化时返回空
+ */
+QList<SortInfoPointer> DirSnapshotCache::load(const QUrl &dirUrl, qint64 *dataTime)
+{
+    if (!isSupported(dirUrl))
+        return {};
+
+    struct stat st;
+    if (!statDir(dirUrl, &st))
+        return {};
+
+    QFile file(snapshotPath(dirUrl));
+    if (!file.exists() || !file.open(QIODevice::ReadOnly))
+        return {};
+
+    const qint64 fileSize = file.size();
+    if (fileSize < static_cast<qint64>(sizeof(SnapshotHeader)))
+        return {};
+
+    uchar *data = file.map(0, fileSize);
+    if (!data)
+        return {};
+
+    const auto header = reinterpret_cast<const SnapshotHeader *>(data);
+    const quint64 recordsEnd = sizeof(SnapshotHeader) + static_cast<quint64>(header->count) * sizeof(SnapshotRecord);
+    bool valid = memcmp(header->magic, kSnapshotMagic, sizeof(kSnapshotMagic)) == 0
+            && header->version == kSnapshotVersion
+            && header->device == static_cast<quint64>(st.st_dev)
+            && header->inode == static_cast<quint64>(st.st_ino)
+            && header->dirMtime == mtimeOf(st)
+            && recordsEnd <= header->namesOffset
+            && header->namesOffset + header->namesSize <= static_cast<quint64>(fileSize);
+    if (!valid) {
+        file.unmap(data);
+        return {};
+    }
+
+    const auto records = reinterpret_cast<const SnapshotRecord *>(data + sizeof(SnapshotHeader));
+    const char *names = reinterpret_cast<const char *>(data + header->namesOffset);
+    const QString &dirPath = dirUrl.path();
+
+    QList<SortInfoPointer> children;
+    children.reserve(static_cast<int>(header->count));
+    for (quint32 i = 0; i < header->count; ++i) {
+        const SnapshotRecord &record = records[i];
+        if (static_cast<quint64>(record.nameOffset) + record.nameLength > header->namesSize) {
+            valid = false;
+            break;
+        }
+
+        const QString &name = QString::fromUtf8(names + record.nameOffset, static_cast<int>(record.nameLength));
+        QUrl childUrl = dirUrl;
+        childUrl.setPath(DFMIO::DFMUtils::buildFilePath(dirPath.toStdString().c_str(),
+                                                        name.toStdString().c_str(), nullptr));
+
+        SortInfoPointer sortInfo(new SortFileInfo);
+        sortInfo->setUrl(childUrl);
+        sortInfo->setSize(record.size);
+        sortInfo->setFile(record.flags & kFlagFile);
+        sortInfo->setDir(record.flags & kFlagDir);
+        sortInfo->setSymlink(record.flags & kFlagSymlink);
+        sortInfo->setHide(record.flags & kFlagHide);
+        sortInfo->setReadable(record.flags & kFlagReadable);
+        sortInfo->setWriteable(record.flags & kFlagWriteable);
+        sortInfo->setExecutable(record.flags & kFlagExecutable);
+        children.append(sortInfo);
+    }
+
+    if (valid && dataTime)
+        *dataTime = header->dataTime;
+
+    file.unmap(data);
+    if (!valid) {
+        fmWarning() << "Dir snapshot is broken, remove it! url = " << dirUrl;
+        remove(dirUrl);
+        return {};
+    }
+
+    return children;
+}
+/*!
+ * \brief DirSnapshotCache::save 保存目录的快照，先写临时文件再替换，读取时不会看到写了一半的快照
+ * \param dirUrl 目录
+ * \param children 目录下的文件
+ * \param dataTime 开始遍历目录的时间，单位ns
+ * \return 是否保存成功
+ */
+bool DirSnapshotCache::save(const QUrl &dirUrl, const QList<SortInfoPointer> &children, const qint64 dataTime)
+{
+    if (!isSupported(dirUrl))
+        return false;
+
+    struct stat st;
+    if (!statDir(dirUrl, &st))
+        return false;
+
+    QVector<SnapshotRecord> records;
+    records.reserve(children.count());
+    QByteArray names;
+    names.reserve(children.count() * 24);
+    for (const auto &child : children) {
+        if (!child)
+            continue;
+
+        const QByteArray &name = child->fileUrl().fileName().toUtf8();
+        if (name.isEmpty())
+            continue;
+
+        SnapshotRecord record {};
+        record.nameOffset = static_cast<quint32>(names.size());
+        record.nameLength = static_cast<quint32>(name.size());
+        record.size = child->fileSize();
+        record.flags = (child->isFile() ? kFlagFile : 0)
+                | (child->isDir() ? kFlagDir : 0)
+                | (child->isSymLink() ? kFlagSymlink : 0)
+                | (child->isHide() ? kFlagHide : 0)
+                | (child->isReadable() ? kFlagReadable : 0)
+                | (child->isWriteable() ? kFlagWriteable : 0)
+                | (child->isExecutable() ? kFlagExecutable : 0);
+        records.append(record);
+        names.append(name);
+    }
+
+    SnapshotHeader header {};
+    memcpy(header.magic, kSnapshotMagic, sizeof(kSnapshotMagic));
+    header.version = kSnapshotVersion;
+    header.count = static_cast<quint32>(records.count());
+    header.device = static_cast<quint64>(st.st_dev);
+    header.inode = static_cast<quint64>(st.st_ino);
+    header.dirMtime = mtimeOf(st);
+    header.dataTime = dataTime;
+    header.namesOffset = sizeof(SnapshotHeader) + static_cast<quint64>(records.count()) * sizeof(SnapshotRecord);
+    header.namesSize = static_cast<quint64>(names.size());
+
+    if (!QDir().mkpath(snapshotDir()))
+        return false;
+
+    const QString &path = snapshotPath(dirUrl);
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        fmWarning() << "Open dir snapshot failed! path = " << path << file.errorString();
+        return false;
+    }
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(records.constData()),
+               static_cast<qint64>(records.count()) * static_cast<qint64>(sizeof(SnapshotRecord)));
+    file.write(names);
+    if (!file.commit()) {
+        fmWarning() << "Save dir snapshot failed! path = " << path << file.errorString();
+        return false;
+    }
+
+    removeOutdated(path);
+    return true;
+}
+
+void DirSnapshotCache::remove(const QUrl &dirUrl)
+{
+    QFile::remove(snapshotPath(dirUrl));
+}
+
+QString DirSnapshotCache::snapshotDir()
+{
+    return QString("%1/%2").arg(StandardPaths::location(StandardPaths::kCachePath), "dirsnapshot");
+}
+
+QString DirSnapshotCache::snapshotPath(const QUrl &dirUrl)
+{
+    const QByteArray &hash = QCryptographicHash::hash(dirUrl.path().toUtf8(), QCryptographicHash::Md5).toHex();
+    return QString("%1/%2%3").arg(snapshotDir(), QString::fromLatin1(hash), kSnapshotSuffix);
+}
+/*!
+ * \brief DirSnapshotCache::removeOutdated 快照超过kMaxSnapshotCount个时，删除最久没有更新的
+ * \param keepPath 刚保存的快照
+ */
+void DirSnapshotCache::removeOutdated(const QString &keepPath)
+{
+    QDir dir(snapshotDir());
+    const auto &infos = dir.entryInfoList({ QString("*%1").arg(kSnapshotSuffix) }, QDir::Files, QDir::Time);
+    for (int i = kMaxSnapshotCount; i < infos.count(); ++i) {
+        const QString &path = infos.at(i).absoluteFilePath();
+        if (path != keepPath)
+            QFile::remove(path);
+    }
+}
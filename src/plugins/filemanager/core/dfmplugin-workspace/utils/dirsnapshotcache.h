@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef DIRSNAPSHOTCACHE_H
+#define DIRSNAPSHOTCACHE_H
+
+#include "dfmplugin_workspace_global.h"
+
+#include <dfm-base/interfaces/sortfileinfo.h>
+
+#include <QUrl>
+
+namespace dfmplugin_workspace {
+
+/*!
+ * \brief The DirSnapshotCache class 目录快照的磁盘缓存
+ *
+ * 大目录遍历完成后，把子文件的名称和SortFileInfo中的属性写入缓存目录下的快照文件，
+ * 快照以目录的(设备号, inode, 修改时间)作为key。再次打开目录时，key一致就直接用快照显示，
+ * 然后在后台做一次增量刷新来校正快照之后的修改。
+ * 快照文件是定长的记录加上名称数据，可以直接mmap读取。
+ */
+class DirSnapshotCache
+{
+public:
+    // 子文件少于这个数量的目录遍历很快，不需要快照
+    static constexpr int kMinChildrenCount { 1000 };
+    // 最多保留的快照文件数量
+    static constexpr int kMaxSnapshotCount { 128 };
+
+    static bool isEnabled();
+    static bool isSupported(const QUrl &dirUrl);
+
+    static QList<SortInfoPointer> load(const QUrl &dirUrl, qint64 *dataTime = nullptr);
+    static bool save(const QUrl &dirUrl, const QList<SortInfoPointer> &children, const qint64 dataTime);
+    static void remove(const QUrl &dirUrl);
+
+    static QString snapshotDir();
+    static QString snapshotPath(const QUrl &dirUrl);
+
+private:
+    static void removeOutdated(const QString &keepPath);
+};
+
+}
+
+#endif   // DIRSNAPSHOTCACHE_H
@@ -80,6 +80,33 @@ void FileDataManager::cleanRoot(const QUrl &rootUrl)
     }
 }
 
+/*!
+ * \brief FileDataManager::refreshRoot 增量刷新rootUrl及其展开的子目录
+ * \return 有目录不支持增量刷新时返回false，需要清理后重新遍历
+ */
+bool FileDataManager::refreshRoot(const QUrl &rootUrl)
+{
+    QString rootPath = rootUrl.path();
+    if (!rootPath.endsWith("/"))
+        rootPath.append("/");
+
+    QList<RootInfo *> roots;
+    for (auto it = rootInfoMap.cbegin(); it != rootInfoMap.cend(); ++it) {
+        if (!it.key().path().startsWith(rootPath) && it.key().path() != rootUrl.path())
+            continue;
+        if (!it.value() || !it.value()->canRefreshIncrementally())
+            return false;
+        roots.append(it.value());
+    }
+
+    if (roots.isEmpty())
+        return false;
+
+    for (auto root : roots)
+        root->refreshIncrementally();
+    return true;
+}
+
 void FileDataManager::setFileActive(const QUrl &rootUrl, const QUrl &childUrl, bool active)
 {
     RootInfo *root = rootInfoMap.value(rootUrl);
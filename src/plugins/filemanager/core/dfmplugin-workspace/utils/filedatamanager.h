@@ -32,6 +32,7 @@ public:
     // self = false, will clean children
     void cleanRoot(const QUrl &rootUrl, const QString &key, const bool refresh = false, const bool self = true);
     void cleanRoot(const QUrl &rootUrl);
+    bool refreshRoot(const QUrl &rootUrl);
     void setFileActive(const QUrl &rootUrl, const QUrl &childUrl, bool active);
 
 public Q_SLOTS:
@@ -15,6 +15,12 @@
 #include <dfm-io/dfmio_utils.h>
 
 #include <QStandardPaths>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+// 超过该数量的文件才分段并行排序
+static constexpr int kParallelSortThreshold { 10000 };
 
 using namespace dfmplugin_workspace;
 using namespace dfmbase::Global;
@@ -40,6 +46,7 @@ FileSortWorker::~FileSortWorker()
     childrenDataMap.clear();
     visibleChildren.clear();
     children.clear();
+    sortKeys.clear();
     if (updateRefresh) {
         updateRefresh->stop();
         updateRefresh->deleteLater();
@@ -58,6 +65,9 @@ FileSortWorker::SortOpt FileSortWorker::setSortAgruments(const Qt::SortOrder ord
         opt = FileSortWorker::SortOpt::kSortOptOnlyOrderChanged;
     }
 
+    // 比较数据中的roleData和size跟随排序角色
+    if (orgSortRole != sortRole)
+        sortKeys.clear();
     sortOrder = order;
     orgSortRole = sortRole;
     this->isMixDirAndFile = isMixDirAndFile;
@@ -328,6 +338,7 @@ void FileSortWorker::handleWatcherRemoveChildren(const QList<SortInfoPointer> &c
 
         subChildren.remove(sortInfo->fileUrl());
         subVisibleList.removeOne(sortInfo->fileUrl());
+        sortKeys.remove(sortInfo->fileUrl());
 
         {
             QWriteLocker lk(&childrenDataLocker);
@@ -566,6 +577,7 @@ void FileSortWorker::handleRefresh()
     children.clear();
     visibleTreeChildren.clear();
     depthMap.clear();
+    sortKeys.clear();
 
     {
         QWriteLocker lk(&childrenDataLocker);
@@ -1004,6 +1016,8 @@ bool FileSortWorker::sortInfoUpdateByFileInfo(const FileInfoPointer fileInfo)
     if (!sortInfo)
         return false;
 
+    // 文件属性变化后重新取比较数据
+    sortKeys.remove(url);
     sortInfo->setUrl(fileInfo->urlOf(UrlInfoType::kUrl));
     sortInfo->setSize(fileInfo->size());
     sortInfo->setFile(fileInfo->isAttributes(OptInfoType::kIsFile));
@@ -1054,6 +1068,8 @@ void FileSortWorker::switchListView()
     }
     children.clear();
     children.insert(current, allShowChildren);
+    for (const auto &url : removeChildren)
+        sortKeys.remove(url);
     // 移除fileitem
     QWriteLocker lk(&childrenDataLocker);
     for (const auto &url : removeChildren)
@@ -1121,23 +1137,41 @@ QList<QUrl> FileSortWorker::sortTreeFiles(const QList<QUrl> &children, const boo
     }
 
     QList<QUrl> sortList;
-    int sortIndex = 0;
-    QMap<QUrl, SortInfoPointer> sortInfos = reverse && !isMixDirAndFile ? this->children.value(parentUrl)
-                                                                        : QMap<QUrl, SortInfoPointer>();
-    bool firstFile = false;
-    for (const auto &url : children) {
+    if (!reverse) {
+        // 先取出所有文件的比较数据，再对连续的数组排序
+        QVector<SortKey> keys;
+        keys.reserve(children.count());
+        for (const auto &url : children) {
+            if (isCanceled)
+                return {};
+            keys.append(makeSortKey(url));
+        }
+        sortByKeys(keys, AbstractSortFilter::SortScenarios::kSortScenariosNormal);
         if (isCanceled)
             return {};
-        if (!reverse) {
-            sortIndex = insertSortList(url, sortList, AbstractSortFilter::SortScenarios::kSortScenariosNormal);
-        } else if (!firstFile && !isMixDirAndFile) {
-            auto sortInfo = sortInfos.value(url);
-            if (sortInfo && sortInfo->isFile()) {
-                firstFile = true;
-                sortIndex = sortList.count();
+
+        sortList.reserve(keys.count());
+        for (const auto &key : keys) {
+            sortList.append(key.url);
+            sortKeys.insert(key.url, key);
+        }
+    } else {
+        int sortIndex = 0;
+        QMap<QUrl, SortInfoPointer> sortInfos = !isMixDirAndFile ? this->children.value(parentUrl)
+                                                                 : QMap<QUrl, SortInfoPointer>();
+        bool firstFile = false;
+        for (const auto &url : children) {
+            if (isCanceled)
+                return {};
+            if (!firstFile && !isMixDirAndFile) {
+                auto sortInfo = sortInfos.value(url);
+                if (sortInfo && sortInfo->isFile()) {
+                    firstFile = true;
+                    sortIndex = sortList.count();
+                }
             }
+            sortList.insert(sortIndex, url);
         }
-        sortList.insert(sortIndex, url);
     }
 
     if (sortList.isEmpty())
@@ -1205,6 +1239,9 @@ void FileSortWorker::removeSubDir(const QUrl &dir)
 
 void FileSortWorker::removeFileItems(const QList<QUrl> &urls)
 {
+    for (const auto &url : urls)
+        sortKeys.remove(url);
+
     QWriteLocker lk(&childrenDataLocker);
     for (const auto &url : urls)
         childrenDataMap.remove(url);
@@ -1330,10 +1367,13 @@ int FileSortWorker::insertSortList(const QUrl &needNode, const QList<QUrl> &list
     if (isCanceled)
         return 0;
 
-    if ((sortOrder == Qt::AscendingOrder) ^ !lessThan(needNode, list.first(), sort))
+    // 插入的文件只取一次比较数据，已排序的文件使用保存的比较数据
+    const SortKey &needKey = makeSortKey(needNode);
+    sortKeys.insert(needNode, needKey);
+    if ((sortOrder == Qt::AscendingOrder) ^ !keyLessThan(needKey, sortKeyOf(list.first()), sort))
         return 0;
 
-    if ((sortOrder == Qt::AscendingOrder) ^ lessThan(needNode, list.last(), sort))
+    if ((sortOrder == Qt::AscendingOrder) ^ keyLessThan(needKey, sortKeyOf(list.last()), sort))
         return list.count();
 
     int row = (begin + end) / 2;
@@ -1347,7 +1387,7 @@ int FileSortWorker::insertSortList(const QUrl &needNode, const QList<QUrl> &list
             break;
 
         const QUrl &node = list.at(row);
-        if ((sortOrder == Qt::AscendingOrder) ^ lessThan(needNode, node, sort)) {
+        if ((sortOrder == Qt::AscendingOrder) ^ keyLessThan(needKey, sortKeyOf(node), sort)) {
             begin = row;
             row = (end + begin + 1) / 2;
             if (row >= end)
@@ -1361,67 +1401,117 @@ int FileSortWorker::insertSortList(const QUrl &needNode, const QList<QUrl> &list
     return row;
 }
 
-// 左边比右边小返回true，
-bool FileSortWorker::lessThan(const QUrl &left, const QUrl &right, AbstractSortFilter::SortScenarios sort)
+FileSortWorker::SortKey FileSortWorker::makeSortKey(const QUrl &url)
 {
-    if (isCanceled)
-        return false;
+    SortKey key;
+    key.url = url;
+
+    const auto &item = childrenDataMap.value(url);
+    key.info = item && item->fileInfo()
+            ? item->fileInfo()
+            : InfoFactory::create<FileInfo>(url);
+    if (!key.info)
+        return key;
+
+    key.isDir = key.info->isAttributes(OptInfoType::kIsDir);
+    key.roleData = data(key.info, orgSortRole).toString();
+    key.displayName = key.info->displayOf(DisPlayInfoType::kFileDisplayName);
+    if (orgSortRole == kItemFileSizeRole)
+        key.size = key.info->size();
+
+    return key;
+}
 
-    const auto &leftItem = childrenDataMap.value(left);
-    const auto &rightItem = childrenDataMap.value(right);
+// 返回保存的比较数据，没有时取出并保存
+const FileSortWorker::SortKey &FileSortWorker::sortKeyOf(const QUrl &url)
+{
+    auto iter = sortKeys.find(url);
+    if (iter == sortKeys.end())
+        iter = sortKeys.insert(url, makeSortKey(url));
+    return iter.value();
+}
 
-    const FileInfoPointer leftInfo = leftItem && leftItem->fileInfo()
-            ? leftItem->fileInfo()
-            : InfoFactory::create<FileInfo>(left);
-    const FileInfoPointer rightInfo = rightItem && rightItem->fileInfo()
-            ? rightItem->fileInfo()
-            : InfoFactory::create<FileInfo>(right);
+// 左边比右边小返回true，只比较预先取出的数据
+bool FileSortWorker::keyLessThan(const SortKey &left, const SortKey &right, AbstractSortFilter::SortScenarios sort)
+{
+    if (isCanceled)
+        return false;
 
-    if (!leftInfo)
+    if (!left.info)
         return false;
-    if (!rightInfo)
+    if (!right.info)
         return false;
 
     if (sortAndFilter) {
-        auto result = sortAndFilter->lessThan(leftInfo, rightInfo, isMixDirAndFile,
+        auto result = sortAndFilter->lessThan(left.info, right.info, isMixDirAndFile,
                                               orgSortRole, sort);
         if (result > 0)
             return result;
     }
 
-    bool isDirLeft = leftInfo->isAttributes(OptInfoType::kIsDir);
-    bool isDirRight = rightInfo->isAttributes(OptInfoType::kIsDir);
-
     // The folder is fixed in the front position
     if (!isMixDirAndFile)
-        if (isDirLeft ^ isDirRight)
-            return (sortOrder == Qt::DescendingOrder) ^ isDirLeft;
+        if (left.isDir ^ right.isDir)
+            return (sortOrder == Qt::DescendingOrder) ^ left.isDir;
 
-    if (isCanceled)
-        return false;
+    // When the selected sort attribute value is the same, sort by file name
+    if (left.roleData == right.roleData)
+        return FileUtils::compareByStringEx(left.displayName, right.displayName);
 
-    QVariant leftData = data(leftInfo, orgSortRole);
-    QVariant rightData = data(rightInfo, orgSortRole);
+    switch (orgSortRole) {
+    case kItemFileSizeRole:
+        return left.size < right.size;
+    default:
+        return FileUtils::compareByStringEx(left.roleData, right.roleData);
+    }
+}
+/*!
+ * \brief FileSortWorker::sortByKeys 按当前的排序方式排序keys，数量较多时分段并行排序后再逐层归并
+ * \param keys 需要排序的文件比较数据
+ * \param sort 排序场景
+ */
+void FileSortWorker::sortByKeys(QVector<SortKey> &keys, AbstractSortFilter::SortScenarios sort)
+{
+    const bool ascending = sortOrder == Qt::AscendingOrder;
+    auto before = [this, ascending, sort](const SortKey &left, const SortKey &right) {
+        return ascending ? keyLessThan(left, right, sort) : keyLessThan(right, left, sort);
+    };
 
-    // When the selected sort attribute value is the same, sort by file name
-    if (leftData == rightData) {
-        QString leftName = leftInfo->displayOf(DisPlayInfoType::kFileDisplayName);
-        QString rightName = rightInfo->displayOf(DisPlayInfoType::kFileDisplayName);
-        return FileUtils::compareByStringEx(leftName, rightName);
+    const int count = keys.count();
+    int segmentCount = 1;
+    // 插件提供的排序不一定是线程安全的，只在当前线程排序
+    if (!sortAndFilter && count >= kParallelSortThreshold) {
+        const int threadCount = qMax(1, QThread::idealThreadCount());
+        while (segmentCount * 2 <= threadCount && count / (segmentCount * 2) >= kParallelSortThreshold / 2)
+            segmentCount *= 2;
     }
 
-    switch (orgSortRole) {
-    case kItemFileDisplayNameRole:
-    case kItemFileLastModifiedRole:
-    case kItemFileMimeTypeRole:
-        return FileUtils::compareByStringEx(leftData.toString(), rightData.toString());
-    case kItemFileSizeRole: {
-        qint64 sizel = leftInfo->size();
-        qint64 sizer = rightInfo->size();
-        return sizel < sizer;
+    if (segmentCount <= 1) {
+        std::stable_sort(keys.begin(), keys.end(), before);
+        return;
     }
-    default:
-        return FileUtils::compareByStringEx(leftData.toString(), rightData.toString());
+
+    // 先在当前线程完成detach，各个线程只操作互不重叠的区间
+    SortKey *data = keys.data();
+    const int segmentSize = (count + segmentCount - 1) / segmentCount;
+    QVector<QPair<int, int>> segments;
+    for (int begin = 0; begin < count; begin += segmentSize)
+        segments.append({ begin, qMin(begin + segmentSize, count) });
+    QtConcurrent::blockingMap(segments, [data, &before](const QPair<int, int> &segment) {
+        std::stable_sort(data + segment.first, data + segment.second, before);
+    });
+
+    for (int width = segmentSize; width < count; width *= 2) {
+        if (isCanceled)
+            return;
+
+        QVector<QPair<int, int>> merges;
+        for (int begin = 0; begin + width < count; begin += 2 * width)
+            merges.append({ begin, begin + width });
+        QtConcurrent::blockingMap(merges, [data, count, width, &before](const QPair<int, int> &merge) {
+            std::inplace_merge(data + merge.first, data + merge.second,
+                               data + qMin(merge.second + width, count), before);
+        });
     }
 }
 
@@ -20,6 +20,7 @@
 #include <QDirIterator>
 #include <QReadWriteLock>
 #include <QMultiMap>
+#include <QHash>
 
 using namespace dfmbase;
 namespace dfmplugin_workspace {
@@ -38,6 +39,17 @@ class FileSortWorker : public QObject
         kInsertOptForce = 2,
     };
 
+    // 排序前为每个文件预先取出的比较数据，比较时不再查找itemdata和fileinfo
+    struct SortKey
+    {
+        QUrl url;
+        FileInfoPointer info { nullptr };   // 只在有sortAndFilter时参与比较
+        QString roleData;
+        QString displayName;
+        qint64 size { 0 };
+        bool isDir { false };
+    };
+
 public:
     explicit FileSortWorker(const QUrl &url,
                             const QString &key,
@@ -190,7 +202,10 @@ private:
 private:
     int insertSortList(const QUrl &needNode, const QList<QUrl> &list,
                        AbstractSortFilter::SortScenarios sort);
-    bool lessThan(const QUrl &left, const QUrl &right, AbstractSortFilter::SortScenarios sort);
+    SortKey makeSortKey(const QUrl &url);
+    const SortKey &sortKeyOf(const QUrl &url);
+    bool keyLessThan(const SortKey &left, const SortKey &right, AbstractSortFilter::SortScenarios sort);
+    void sortByKeys(QVector<SortKey> &keys, AbstractSortFilter::SortScenarios sort);
     QVariant data(const FileInfoPointer &info, Global::ItemRoles role);
 
     bool checkFilters(const SortInfoPointer &sortInfo, const bool byInfo = false);
@@ -229,6 +244,8 @@ private:
     std::atomic_bool istree;
     std::atomic_bool currentSupportTreeView {false};
     QList<QUrl> fileInfoRefresh;
+    // 排序过和插入过的文件的比较数据，插入文件二分查找时使用，文件变化或移除时删除
+    QHash<QUrl, SortKey> sortKeys;
     QTimer *updateRefresh {nullptr};
 };
 
@@ -37,6 +37,7 @@
 #include <dfm-base/utils/networkutils.h>
 #include <dfm-base/utils/fileutils.h>
 #include <dfm-base/utils/dialogmanager.h>
+#include <dfm-base/utils/thumbnail/thumbnailfactory.h>
 #include <dfm-base/widgets/filemanagerwindowsmanager.h>
 #include <dfm-base/base/configs/dconfig/dconfigmanager.h>
 
@@ -1142,6 +1143,7 @@ void FileView::onRowCountChanged()
 
     delayUpdateStatusBar();
     updateContentLabel();
+    delayUpdateThumbnailJobs();
 }
 
 void FileView::setFilterData(const QUrl &url, const QVariant &data)
@@ -1197,6 +1199,7 @@ void FileView::resizeEvent(QResizeEvent *event)
         updateViewportContentsMargins(itemSizeHint());
 
     verticalScrollBar()->setFixedHeight(rect().height() - d->statusBar->height() - (d->headerView ? d->headerView->height() : 0));
+    delayUpdateThumbnailJobs();
 }
 
 void FileView::setSelection(const QRect &rect, QItemSelectionModel::SelectionFlags flags)
@@ -1922,7 +1925,94 @@ void FileView::initializeScrollBarWatcher()
     connect(verticalScrollBar(), &QScrollBar::valueChanged, this, [this] {
         if (d->scrollBarSliderPressed)
             d->scrollBarValueChangedTimer->start();
+        delayUpdateThumbnailJobs();
     });
+
+    d->thumbnailJobsTimer = new QTimer(this);
+    d->thumbnailJobsTimer->setInterval(100);
+    d->thumbnailJobsTimer->setSingleShot(true);
+    connect(d->thumbnailJobsTimer, &QTimer::timeout, this, &FileView::updateThumbnailJobs);
+}
+
+void FileView::delayUpdateThumbnailJobs()
+{
+    if (d->thumbnailJobsTimer)
+        d->thumbnailJobsTimer->start();
+}
+/*!
+ * \brief FileView::updateThumbnailJobs 按照可见区域调整缩略图任务
+ * 可见区域上下各一屏的文件作为预取提前生成缩略图，已经滚出这个范围还在排队的任务被取消，
+ * 取消的文件清除缩略图标记，再次可见时重新请求
+ */
+void FileView::updateThumbnailJobs()
+{
+    if (!isVisible() || !model())
+        return;
+
+    const QRect &visibleRect = viewport()->rect().translated(horizontalOffset(), verticalOffset());
+    auto indexInfos = [this](const RandeIndexList &list) {
+        QList<FileInfoPointer> infos;
+        for (const RandeIndex &range : list) {
+            for (int row = range.first; row <= range.second; ++row) {
+                const auto &info = model()->fileInfo(model()->index(row, 0, rootIndex()));
+                if (info)
+                    infos.append(info);
+            }
+        }
+        return infos;
+    };
+
+    QList<QUrl> visibleUrls;
+    for (const auto &info : indexInfos(visibleIndexes(visibleRect)))
+        visibleUrls.append(info->urlOf(UrlInfoType::kUrl));
+
+    QList<QUrl> prefetchUrls;
+    auto prefetchInfos = indexInfos(visibleIndexes(visibleRect.translated(0, visibleRect.height())));
+    prefetchInfos.append(indexInfos(visibleIndexes(visibleRect.translated(0, -visibleRect.height()))));
+    for (const auto &info : prefetchInfos) {
+        const QUrl &url = info->urlOf(UrlInfoType::kUrl);
+        prefetchUrls.append(url);
+        if (info->extendAttributes(ExtInfoType::kFileThumbnail).isValid())
+            continue;
+
+        ThumbnailFactory::instance()->joinThumbnailJob(url, Global::kLarge, Global::ThumbnailPriority::kPrefetch);
+        // make sure the thumbnail is generated only once
+        info->setExtendedAttributes(ExtInfoType::kFileThumbnail, QIcon());
+    }
+
+    const auto &canceledUrls = ThumbnailFactory::instance()->rescheduleThumbnailJobs(rootUrl(), visibleUrls, prefetchUrls);
+    for (const QUrl &url : canceledUrls) {
+        const auto &info = model()->fileInfo(model()->getIndexByUrl(url));
+        if (info)
+            info->setExtendedAttributes(ExtInfoType::kFileThumbnail, QVariant());
+    }
+
+    prefetchFileNames(visibleRect);
+}
+
+/*!
+ * \brief FileView::prefetchFileNames 图标模式下在后台线程预先排版可见区域上下各一屏的文件名
+ */
+void FileView::prefetchFileNames(const QRect &visibleRect)
+{
+    auto delegate = qobject_cast<IconItemDelegate *>(itemDelegate());
+    if (!delegate)
+        return;
+
+    RandeIndexList ranges = visibleIndexes(visibleRect.translated(0, visibleRect.height()));
+    ranges.append(visibleIndexes(visibleRect.translated(0, -visibleRect.height())));
+
+    QModelIndexList indexes;
+    for (const RandeIndex &range : ranges) {
+        for (int row = range.first; row <= range.second; ++row)
+            indexes.append(model()->index(row, 0, rootIndex()));
+    }
+    if (indexes.isEmpty())
+        return;
+
+    QStyleOptionViewItem option = viewOptions();
+    option.rect = visualRect(indexes.first());
+    delegate->prefetchFileNames(option, indexes);
 }
 
 void FileView::initializePreSelectTimer()
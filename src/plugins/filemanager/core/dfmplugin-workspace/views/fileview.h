@@ -192,6 +192,9 @@ private:
     void initializeConnect();
     void initializeScrollBarWatcher();
     void initializePreSelectTimer();
+    void delayUpdateThumbnailJobs();
+    void updateThumbnailJobs();
+    void prefetchFileNames(const QRect &visibleRect);
 
     void delayUpdateStatusBar();
     void updateStatusBar();
@@ -397,6 +397,35 @@ QList<QRectF> IconItemDelegate::calFileNameRect(const QString &name, const QRect
     return layout->layout(rect, elideMode);
 }
 
+/*!
+ * \brief IconItemDelegate::prefetchFileNames lay out the names of `indexes` in a background thread,
+ * the cached lines are used when the items are painted by paintItemFileName
+ */
+void IconItemDelegate::prefetchFileNames(const QStyleOptionViewItem &option, const QModelIndexList &indexes) const
+{
+    Q_D(const IconItemDelegate);
+
+    if (indexes.isEmpty())
+        return;
+
+    // the same rect as paintItemFileName
+    const QRectF &iconRect = itemIconRect(option.rect);
+    QRectF labelRect = option.rect;
+    labelRect.setTop(static_cast<int>(iconRect.bottom()) + kIconModeTextPadding + kIconModeIconSpacing);
+    labelRect.setLeft(labelRect.left() + kIconModeRectRadius);
+    labelRect.setWidth(labelRect.width() - kIconModeRectRadius);
+
+    QStringList names;
+    for (const QModelIndex &index : indexes)
+        names.append(displayFileName(index));
+
+    QScopedPointer<ElideTextLayout> layout(ItemDelegateHelper::createTextLayout(QString(), QTextOption::WrapAtWordBoundaryOrAnywhere,
+                                                                                d->textLineHeight, Qt::AlignCenter));
+    layout->setAttribute(ElideTextLayout::kFont, option.font);
+    layout->setAttribute(ElideTextLayout::kTextDirection, parent()->parent()->viewport()->layoutDirection());
+    layout->prefetch(names, labelRect.size(), option.textElideMode);
+}
+
 void IconItemDelegate::editorFinished()
 {
     FileViewHelper *viewHelper = parent();
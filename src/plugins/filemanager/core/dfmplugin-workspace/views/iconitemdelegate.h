@@ -57,6 +57,7 @@ public:
 
     QString displayFileName(const QModelIndex &index) const;
     QList<QRectF> calFileNameRect(const QString &name, const QRectF &rect, Qt::TextElideMode elideMode) const;
+    void prefetchFileNames(const QStyleOptionViewItem &option, const QModelIndexList &indexes) const;
 
 private slots:
     void editorFinished();
@@ -73,6 +73,7 @@ class FileViewPrivate
 
     QTimer *scrollBarValueChangedTimer { nullptr };
     bool scrollBarSliderPressed { false };
+    QTimer *thumbnailJobsTimer { nullptr };
 
     bool pressedStartWithExpand { false };
     bool mouseLeftPressed { false };
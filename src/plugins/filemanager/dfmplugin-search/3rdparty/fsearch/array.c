@@ -100,6 +100,35 @@ darray_set_item (DynamicArray *array, void *data, uint32_t idx)
     }
 }
 
+void
+darray_insert_item (DynamicArray *array, void *data, uint32_t idx)
+{
+    assert (array != NULL);
+    assert (array->data != NULL);
+    assert (idx <= array->num_items);
+
+    if (array->num_items + 1 > array->max_items) {
+        darray_expand (array, array->num_items + 1);
+    }
+
+    memmove (array->data + idx + 1,
+             array->data + idx,
+             (array->num_items - idx) * sizeof (void *));
+    array->data[idx] = data;
+    array->num_items++;
+}
+
+void
+darray_reserve (DynamicArray *array, size_t num_items)
+{
+    assert (array != NULL);
+    assert (array->data != NULL);
+
+    if (num_items > array->max_items) {
+        darray_expand (array, num_items);
+    }
+}
+
 void
 darray_remove_item (DynamicArray *array, uint32_t idx)
 {
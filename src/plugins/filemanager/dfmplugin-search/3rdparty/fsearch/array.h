@@ -49,6 +49,14 @@ darray_remove_item(DynamicArray *array, uint32_t idx);
 void
 darray_set_item(DynamicArray *array, void *data, uint32_t idx);
 
+// inserts data before idx and moves the following items backwards, idx must not exceed num_items
+void
+darray_insert_item(DynamicArray *array, void *data, uint32_t idx);
+
+// grows the storage to hold at least num_items, the items are left untouched
+void
+darray_reserve(DynamicArray *array, size_t num_items);
+
 DynamicArray *
 darray_new(size_t num_items);
 
@@ -42,6 +42,10 @@ btree_node_new (const char *name,
 
     // data
     new->name = strdup(name);
+    new->lower_name = fs_str_casefold (name);
+    if (!new->lower_name) {
+        new->lower_name = new->name;
+    }
     new->full_py_name = strdup(full_py_name);
     new->first_py_name = strdup(first_py_name);
 
@@ -54,10 +58,11 @@ btree_node_new (const char *name,
 }
 
 static void
-btree_node_data_free (BTreeNode *node)
+btree_node_strings_free (BTreeNode *node)
 {
-    if (!node) {
-        return;
+    if (node->lower_name && node->lower_name != node->name) {
+        free (node->lower_name);
+        node->lower_name = NULL;
     }
     if (node->name) {
         free (node->name);
@@ -71,10 +76,46 @@ btree_node_data_free (BTreeNode *node)
         free (node->first_py_name);
         node->first_py_name = NULL;
     }
+}
+
+static void
+btree_node_data_free (BTreeNode *node)
+{
+    if (!node) {
+        return;
+    }
+    if (node->flags & BTREE_NODE_BORROWED) {
+        if (node->flags & BTREE_NODE_OWN_STRINGS) {
+            btree_node_strings_free (node);
+        }
+        return;
+    }
+    btree_node_strings_free (node);
     free (node);
     node = NULL;
 }
 
+void
+btree_node_set_name (BTreeNode *node,
+                     const char *name,
+                     const char *full_py_name,
+                     const char *first_py_name)
+{
+    assert (node);
+    if (!(node->flags & BTREE_NODE_BORROWED) || (node->flags & BTREE_NODE_OWN_STRINGS)) {
+        btree_node_strings_free (node);
+    }
+    node->flags |= BTREE_NODE_OWN_STRINGS;
+
+    node->name = strdup (name);
+    node->lower_name = fs_str_casefold (name);
+    if (!node->lower_name) {
+        node->lower_name = node->name;
+    }
+    node->full_py_name = strdup (full_py_name);
+    node->first_py_name = strdup (first_py_name);
+}
+
 static void
 btree_nodes_free (BTreeNode *node)
 {
@@ -24,6 +24,16 @@
 
 typedef struct _BTreeNode BTreeNode;
 
+enum {
+    // the node and its strings are owned by a mapped database, see database.c
+    BTREE_NODE_BORROWED = (1 << 0),
+    // the strings of a borrowed node were replaced by btree_node_set_name and are owned by the node
+    BTREE_NODE_OWN_STRINGS = (1 << 1),
+    // states of the incremental updates, see db_commit_changes
+    BTREE_NODE_REMOVED = (1 << 2),
+    BTREE_NODE_PENDING = (1 << 3),
+};
+
 struct _BTreeNode {
     BTreeNode *next;
     BTreeNode *parent;
@@ -31,6 +41,8 @@ struct _BTreeNode {
 
     // data
     char *name;
+    // case folded name, same pointer as name if it has no uppercase
+    char *lower_name;
     char *full_py_name;
     char *first_py_name;
 
@@ -38,6 +50,7 @@ struct _BTreeNode {
     off_t size;
     uint32_t pos;
     bool is_dir;
+    uint8_t flags;
 };
 
 BTreeNode *
@@ -52,6 +65,12 @@ btree_node_new(const char *name,
 void
 btree_node_free(BTreeNode *node);
 
+void
+btree_node_set_name(BTreeNode *node,
+                    const char *name,
+                    const char *full_py_name,
+                    const char *first_py_name);
+
 void
 btree_node_unlink(BTreeNode *node);
 
@@ -24,6 +24,8 @@
 #include <sys/time.h>
 #include <sys/stat.h>
 #include <sys/types.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <string.h>
 #include <unistd.h>
 #include <dirent.h>
@@ -44,8 +46,12 @@
 #define WS_DOTFILES (1 << 2) /* per unix convention, .file is hidden */
 
 // add py index,update database version to 1.0
-#define DATABASE_MAJOR_VERSION 1
-#define DATABASE_MINOR_VERSION 0
+#define DATABASE_V1_MAJOR_VERSION 1
+#define DATABASE_V1_MINOR_VERSION 0
+// mmap-able node records and string arena, update database version to 2.0
+// fold the case of non-ascii letters in the lowercase column, update database version to 2.1
+#define DATABASE_MAJOR_VERSION 2
+#define DATABASE_MINOR_VERSION 1
 
 #define DATABASE_FILTER_PATH "^((/boot)|(/dev)|(/proc)|(/sys)|(/root)|(/run)).*$"
 
@@ -54,6 +60,12 @@ struct _DatabaseLocation
     // B+ tree of entry nodes
     BTreeNode *entries;
     uint32_t num_items;
+
+    // the nodes loaded from a v2 database are allocated in one block,
+    // and their strings point into the mapped file
+    BTreeNode *node_block;
+    void *map;
+    size_t map_size;
 };
 
 enum {
@@ -107,8 +119,51 @@ get_fstable_bindinfo(void)
     return list;
 }
 
-DatabaseLocation *
-db_location_load_from_file(const char *fname)
+/*
+ * database format v2, one file which is mapped into memory on load:
+ *
+ *   DatabaseHeader
+ *   DatabaseNodeRecord[num_nodes]   nodes in pre-order, a parent is always stored before its children
+ *   string arena                    NUL-terminated strings, offset 0 is the empty string
+ *
+ * the loaded nodes point into the arena directly, so no string is parsed or copied.
+ * all the integers are stored in host byte order, same as v1.
+ */
+#define DATABASE_NO_PARENT UINT32_MAX
+
+typedef struct
+{
+    char magic[4];
+    uint8_t majorver;
+    uint8_t minorver;
+    uint16_t record_size;
+    uint32_t num_nodes;
+    uint32_t reserved;
+    uint64_t nodes_offset;
+    uint64_t strings_offset;
+    uint64_t strings_size;
+} DatabaseHeader;
+
+typedef struct
+{
+    uint64_t size;
+    int64_t mtime;
+    uint32_t parent;
+    // offsets in the string arena
+    uint32_t name;
+    uint32_t lower_name;
+    uint32_t full_py_name;
+    uint32_t first_py_name;
+    uint32_t pos;
+    uint8_t is_dir;
+    uint8_t reserved[7];
+} DatabaseNodeRecord;
+
+_Static_assert(sizeof(DatabaseHeader) % 8 == 0, "node records must be 8-byte aligned");
+_Static_assert(sizeof(DatabaseNodeRecord) % 8 == 0, "node records must be 8-byte aligned");
+
+static DatabaseLocation *
+db_location_load_from_file_v1(const char *fname)
 {
     assert(fname != NULL);
 
@@ -134,7 +189,7 @@ db_location_load_from_file(const char *fname)
         goto load_fail;
     }
 
-    if (majorver != DATABASE_MAJOR_VERSION) {
+    if (majorver != DATABASE_V1_MAJOR_VERSION) {
         printf("bad majorver=%d\n", majorver);
         goto load_fail;
     }
@@ -144,7 +199,7 @@ db_location_load_from_file(const char *fname)
         goto load_fail;
     }
 
-    if (minorver != DATABASE_MINOR_VERSION) {
+    if (minorver != DATABASE_V1_MINOR_VERSION) {
         printf("bad minorver=%d\n", minorver);
         goto load_fail;
     }
@@ -277,6 +332,150 @@ load_fail:
     return NULL;
 }
 
+static DatabaseLocation *
+db_location_map_file(int fd, size_t file_size)
+{
+    if (file_size < sizeof(DatabaseHeader)) {
+        printf("database is too small\n");
+        return NULL;
+    }
+
+    void *map = mmap(NULL, file_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+        printf("failed to map database: %s\n", strerror(errno));
+        return NULL;
+    }
+
+    const DatabaseHeader *header = map;
+    const uint64_t nodes_size = (uint64_t)header->num_nodes * sizeof(DatabaseNodeRecord);
+    if (header->minorver != DATABASE_MINOR_VERSION
+        || header->record_size != sizeof(DatabaseNodeRecord)
+        || header->num_nodes == 0
+        || header->nodes_offset % 8 != 0
+        || header->nodes_offset < sizeof(DatabaseHeader)
+        || header->nodes_offset > file_size
+        || header->nodes_offset + nodes_size > header->strings_offset
+        || header->strings_size == 0
+        || header->strings_offset > file_size
+        || header->strings_size > file_size - header->strings_offset) {
+        printf("bad database header\n");
+        munmap(map, file_size);
+        return NULL;
+    }
+
+    const DatabaseNodeRecord *records = (const DatabaseNodeRecord *)((const char *)map + header->nodes_offset);
+    char *strings = (char *)map + header->strings_offset;
+    if (strings[header->strings_size - 1] != '\0') {
+        printf("bad database strings\n");
+        munmap(map, file_size);
+        return NULL;
+    }
+
+    const uint32_t num_nodes = header->num_nodes;
+    BTreeNode *nodes = calloc(num_nodes, sizeof(BTreeNode));
+    if (!nodes) {
+        munmap(map, file_size);
+        return NULL;
+    }
+
+    // walk backwards and prepend, so the siblings keep their stored order
+    for (uint32_t i = num_nodes; i-- > 0;) {
+        const DatabaseNodeRecord *record = &records[i];
+        const bool bad_parent = i == 0 ? record->parent != DATABASE_NO_PARENT : record->parent >= i;
+        if (bad_parent
+            || record->name >= header->strings_size
+            || record->lower_name >= header->strings_size
+            || record->full_py_name >= header->strings_size
+            || record->first_py_name >= header->strings_size) {
+            printf("bad database node %u\n", i);
+            free(nodes);
+            munmap(map, file_size);
+            return NULL;
+        }
+
+        BTreeNode *node = &nodes[i];
+        node->name = strings + record->name;
+        node->lower_name = strings + record->lower_name;
+        node->full_py_name = strings + record->full_py_name;
+        node->first_py_name = strings + record->first_py_name;
+        node->mtime = record->mtime;
+        node->size = record->size;
+        node->pos = record->pos;
+        node->is_dir = record->is_dir;
+        node->flags = BTREE_NODE_BORROWED;
+        if (i > 0) {
+            btree_node_prepend(&nodes[record->parent], node);
+        }
+    }
+
+    DatabaseLocation *location = db_location_new();
+    location->num_items = num_nodes - 1;
+    location->entries = nodes;
+    location->node_block = nodes;
+    location->map = map;
+    location->map_size = file_size;
+    return location;
+}
+
+DatabaseLocation *
+db_location_load_from_file(const char *fname)
+{
+    assert(fname != NULL);
+
+    int fd = open(fname, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    DatabaseLocation *location = NULL;
+    struct stat st;
+    char magic[6] = { 0 };
+    if (fstat(fd, &st) == -1 || pread(fd, magic, sizeof(magic), 0) != sizeof(magic) || strncmp(magic, "FSDB", 4)) {
+        printf("bad signature\n");
+    } else if ((uint8_t)magic[4] == DATABASE_MAJOR_VERSION) {
+        location = db_location_map_file(fd, st.st_size);
+    } else if ((uint8_t)magic[4] == DATABASE_V1_MAJOR_VERSION) {
+        location = db_location_load_from_file_v1(fname);
+    } else {
+        printf("bad majorver=%d\n", magic[4]);
+    }
+
+    close(fd);
+    if (!location) {
+        fprintf(stderr, "database load fail (%s)!\n", fname);
+    }
+    return location;
+}
+
+static bool
+db_strings_add(GString *strings, const char *str, uint32_t *offset)
+{
+    if (*str == '\0') {
+        *offset = 0;
+        return true;
+    }
+
+    const size_t len = strlen(str) + 1;
+    if (strings->len + len > UINT32_MAX) {
+        return false;
+    }
+    *offset = (uint32_t)strings->len;
+    g_string_append_len(strings, str, len);
+    return true;
+}
+
+// the pinyin of a name without chinese characters and the lowercase of a lowercase name
+// are the name itself, they share its string in the arena
+static bool
+db_strings_add_alias(GString *strings, const char *str, const char *name, uint32_t name_offset, uint32_t *offset)
+{
+    if (str == name || !strcmp(str, name)) {
+        *offset = name_offset;
+        return true;
+    }
+    return db_strings_add(strings, str, offset);
+}
+
 bool db_location_write_to_file(DatabaseLocation *location, const char *path)
 {
     assert(path != NULL);
@@ -287,136 +486,98 @@ bool db_location_write_to_file(DatabaseLocation *location, const char *path)
     }
     g_mkdir_with_parents(path, 0700);
 
+    gchar fname[PATH_MAX] = "";
+    snprintf(fname, sizeof(fname), "%s/database.db", path);
     gchar tempfile[PATH_MAX] = "";
-    snprintf(tempfile, sizeof(tempfile), "%s/database.db", path);
+    snprintf(tempfile, sizeof(tempfile), "%s/database.db.tmp", path);
 
-    FILE *fp = fopen(tempfile, "w+b");
+    FILE *fp = fopen(tempfile, "wb");
     if (!fp) {
         return false;
     }
 
-    const char magic[] = "FSDB";
-    if (fwrite(magic, 1, 4, fp) != 4) {
-        goto save_fail;
-    }
-
-    const uint8_t majorver = DATABASE_MAJOR_VERSION;
-    if (fwrite(&majorver, 1, 1, fp) != 1) {
-        goto save_fail;
-    }
+    DatabaseHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "FSDB", 4);
+    header.majorver = DATABASE_MAJOR_VERSION;
+    header.minorver = DATABASE_MINOR_VERSION;
+    header.record_size = sizeof(DatabaseNodeRecord);
+    header.nodes_offset = sizeof(DatabaseHeader);
 
-    const uint8_t minorver = DATABASE_MINOR_VERSION;
-    if (fwrite(&minorver, 1, 1, fp) != 1) {
-        goto save_fail;
-    }
+    GString *strings = g_string_sized_new(4096);
+    g_string_append_c(strings, '\0');
+    GArray *parents = g_array_new(FALSE, FALSE, sizeof(uint32_t));
 
-    uint32_t num_items = btree_node_n_nodes(location->entries);
-    if (fwrite(&num_items, 1, 4, fp) != 4) {
+    // the header is written at last, when the sizes are known
+    if (fwrite(&header, sizeof(header), 1, fp) != 1) {
         goto save_fail;
     }
 
-    const uint16_t del = 0;
-
     BTreeNode *root = location->entries;
     BTreeNode *node = root;
-    uint32_t is_root = !strcmp(root->name, "");
-
+    uint32_t parent = DATABASE_NO_PARENT;
+    uint32_t num_nodes = 0;
     while (node) {
-        const char *name = is_root ? "/" : node->name;
-        is_root = 0;
-        uint16_t len = (uint16_t)strlen(name);
-        uint16_t full_py_len = (uint16_t)strlen(node->full_py_name);
-        uint16_t first_py_len = (uint16_t)strlen(node->first_py_name);
-        if (len) {
-            // write length of node name
-            if (fwrite(&len, 1, 2, fp) != 2) {
-                goto save_fail;
-            }
-            // write node name
-            if (fwrite(name, 1, len, fp) != len) {
-                goto save_fail;
-            }
-            // write length of node full pinyin name
-            if (fwrite(&full_py_len, 1, 2, fp) != 2) {
-                goto save_fail;
-            }
-            // write node full pinyin name
-            if (full_py_len && fwrite(node->full_py_name, 1, full_py_len, fp) != full_py_len) {
-                goto save_fail;
-            }
-            // write length of node first pinyin name
-            if (fwrite(&first_py_len, 1, 2, fp) != 2) {
-                goto save_fail;
-            }
-            // write node first pinyin name
-            if (first_py_len && fwrite(node->first_py_name, 1, first_py_len, fp) != first_py_len) {
-                goto save_fail;
-            }
-
-            // write node name
-            uint8_t is_dir = node->is_dir;
-            if (fwrite(&is_dir, 1, 1, fp) != 1) {
-                goto save_fail;
-            }
-
-            // write node name
-            uint64_t size = node->size;
-            if (fwrite(&size, 1, 8, fp) != 8) {
-                goto save_fail;
-            }
+        DatabaseNodeRecord record;
+        memset(&record, 0, sizeof(record));
+        record.parent = parent;
+        record.size = node->size;
+        record.mtime = node->mtime;
+        record.pos = node->pos;
+        record.is_dir = node->is_dir;
+        if (!db_strings_add(strings, node->name, &record.name)
+            || !db_strings_add_alias(strings, node->lower_name, node->name, record.name, &record.lower_name)
+            || !db_strings_add_alias(strings, node->full_py_name, node->name, record.name, &record.full_py_name)
+            || !db_strings_add_alias(strings, node->first_py_name, node->name, record.name, &record.first_py_name)) {
+            goto save_fail;
+        }
 
-            // write node name
-            uint64_t mtime = node->mtime;
-            if (fwrite(&mtime, 1, 8, fp) != 8) {
-                goto save_fail;
-            }
+        if (fwrite(&record, sizeof(record), 1, fp) != 1) {
+            goto save_fail;
+        }
+        const uint32_t current = num_nodes++;
 
-            // write node name
-            uint32_t pos = node->pos;
-            if (fwrite(&pos, 1, 4, fp) != 4) {
-                goto save_fail;
-            }
+        if (node->children) {
+            g_array_append_val(parents, parent);
+            parent = current;
+            node = node->children;
+            continue;
+        }
 
-            BTreeNode *temp = node->children;
-            if (!temp) {
-                // reached end of children, write delimiter
-                if (fwrite(&del, 1, 2, fp) != 2) {
-                    goto save_fail;
-                }
-                BTreeNode *current = node;
-                while (true) {
-                    temp = current->next;
-                    if (temp) {
-                        // found next, sibling add that
-                        node = temp;
-                        break;
-                    }
-
-                    if (fwrite(&del, 1, 2, fp) != 2) {
-                        goto save_fail;
-                    }
-                    temp = current->parent;
-                    if (!temp) {
-                        // reached last node, abort
-                        node = NULL;
-                        break;
-                    } else {
-                        current = temp;
-                    }
-                }
-            } else {
-                node = temp;
-            }
-        } else {
-            goto save_fail;
+        // no more children, go to the next sibling of the nearest ancestor
+        while (node != root && !node->next) {
+            node = node->parent;
+            parent = g_array_index(parents, uint32_t, parents->len - 1);
+            g_array_set_size(parents, parents->len - 1);
         }
+        node = node != root ? node->next : NULL;
     }
 
-    fclose(fp);
+    header.num_nodes = num_nodes;
+    header.strings_offset = header.nodes_offset + (uint64_t)num_nodes * sizeof(DatabaseNodeRecord);
+    header.strings_size = strings->len;
+    if (fwrite(strings->str, 1, strings->len, fp) != strings->len
+        || fseek(fp, 0, SEEK_SET) != 0
+        || fwrite(&header, sizeof(header), 1, fp) != 1) {
+        goto save_fail;
+    }
+
+    g_string_free(strings, TRUE);
+    g_array_free(parents, TRUE);
+    if (fclose(fp) != 0) {
+        unlink(tempfile);
+        return false;
+    }
+    // replace the old database atomically, it may be mapped by a running search
+    if (rename(tempfile, fname) != 0) {
+        unlink(tempfile);
+        return false;
+    }
     return true;
 
 save_fail:
-
+    g_string_free(strings, TRUE);
+    g_array_free(parents, TRUE);
     fclose(fp);
     unlink(tempfile);
     return false;
@@ -556,6 +717,19 @@ db_location_walk_tree_recursive(DatabaseLocation *location,
     return WALK_OK;
 }
 
+static bool
+db_path_has_data_prefix(const char *dname)
+{
+    GList *info = get_fstable_bindinfo();
+    for (info = g_list_first(info); info != NULL; info = g_list_next(info)) {
+        char *data = info->data;
+        if (strncmp(data, dname, strlen(data)) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
 static DatabaseLocation *
 db_location_build_tree(const char *dname, DatabaseConfig *db_config, bool *is_stop, void (*callback)(const char *))
 {
@@ -578,16 +752,7 @@ db_location_build_tree(const char *dname, DatabaseConfig *db_config, bool *is_st
     GTimer *timer = g_timer_new();
     g_timer_start(timer);
 
-    bool has_data_prefix = false;
-    GList *info = get_fstable_bindinfo();
-    for (info = g_list_first(info); info != NULL; info = g_list_next(info)) {
-        char *data = info->data;
-        if (strncmp(data, dname, strlen(data)) == 0) {
-            has_data_prefix = true;
-            break;
-        }
-    }
-
+    bool has_data_prefix = db_path_has_data_prefix(dname);
     uint32_t res = db_location_walk_tree_recursive(location,
                                                    db_config,
                                                    config->exclude_locations,
@@ -693,6 +858,14 @@ void db_location_free(DatabaseLocation *location)
         btree_node_free(location->entries);
         location->entries = NULL;
     }
+    if (location->node_block) {
+        free(location->node_block);
+        location->node_block = NULL;
+    }
+    if (location->map) {
+        munmap(location->map, location->map_size);
+        location->map = NULL;
+    }
     g_free(location);
     location = NULL;
 }
@@ -815,8 +988,10 @@ bool db_location_load(Database *db, const char *location_name)
     load_path = NULL;
 
     if (location) {
-        location->num_items = btree_node_n_nodes(location->entries);
-        //        trace ("number of nodes: %d\n", location->num_items);
+        // convert the database of old format, so it is mapped next time
+        if (!location->map) {
+            db_location_write_to_file(location, location_name);
+        }
         db->locations = g_list_append(db->locations, location);
         db->num_entries += location->num_items;
         db_update_timestamp(db);
@@ -853,6 +1028,439 @@ bool db_location_add(Database *db,
     return false;
 }
 
+static DatabaseLocation *
+db_location_find_for_path(Database *db, const char *path, const char **relative_path)
+{
+    DatabaseLocation *found = NULL;
+    size_t found_len = 0;
+    for (GList *l = db->locations; l != NULL; l = l->next) {
+        DatabaseLocation *location = l->data;
+        const char *root_name = location->entries->name;
+        const size_t len = strlen(root_name);
+        if (strncmp(path, root_name, len) || (path[len] != '/' && path[len] != '\0')) {
+            continue;
+        }
+        if (!found || len > found_len) {
+            found = location;
+            found_len = len;
+        }
+    }
+    if (found) {
+        *relative_path = path + found_len;
+    }
+    return found;
+}
+
+static BTreeNode *
+db_node_find_child(BTreeNode *parent, const char *name, size_t len)
+{
+    for (BTreeNode *child = parent->children; child; child = child->next) {
+        if (!strncmp(child->name, name, len) && child->name[len] == '\0') {
+            return child;
+        }
+    }
+    return NULL;
+}
+
+// finds the node of path, if the node does not exist but its parent does,
+// parent and base_name are set for creating it
+static BTreeNode *
+db_node_lookup(Database *db,
+               const char *path,
+               DatabaseLocation **location,
+               BTreeNode **parent,
+               const char **base_name,
+               bool *is_hidden)
+{
+    const char *rest = NULL;
+    *location = db_location_find_for_path(db, path, &rest);
+    *parent = NULL;
+    *base_name = NULL;
+    *is_hidden = false;
+    if (!*location) {
+        return NULL;
+    }
+
+    BTreeNode *node = (*location)->entries;
+    while (node) {
+        while (*rest == '/') {
+            rest++;
+        }
+        if (*rest == '\0') {
+            return node;
+        }
+
+        const char *end = strchrnul(rest, '/');
+        if (*rest == '.') {
+            *is_hidden = true;
+        }
+        BTreeNode *child = db_node_find_child(node, rest, end - rest);
+        if (!child && *end == '\0') {
+            *parent = node;
+            *base_name = rest;
+        }
+        node = child;
+        rest = end;
+    }
+    return NULL;
+}
+
+static BTreeNode *
+db_node_new_for_stat(Database *db, const char *name, const struct stat *st)
+{
+    char full_py_name[FILENAME_MAX] = "";
+    char first_py_name[FILENAME_MAX] = "";
+    if (db->db_config->enable_py) {
+        convert_all_pinyin(name, first_py_name, full_py_name);
+    }
+    return btree_node_new(name, full_py_name, first_py_name, st->st_mtime, st->st_size, 0, S_ISDIR(st->st_mode));
+}
+
+static bool
+db_node_mark_pending(BTreeNode *node, void *data)
+{
+    Database *db = data;
+    if (!(node->flags & BTREE_NODE_PENDING)) {
+        node->flags |= BTREE_NODE_PENDING;
+        g_ptr_array_add(db->pending_nodes, node);
+    }
+    return true;
+}
+
+static bool
+db_node_mark_removed(BTreeNode *node, void *data)
+{
+    uint32_t *num_nodes = data;
+    node->flags |= BTREE_NODE_REMOVED;
+    (*num_nodes)++;
+    return true;
+}
+
+static void
+db_node_remove_node(Database *db, DatabaseLocation *location, BTreeNode *node)
+{
+    uint32_t num_nodes = 0;
+    btree_node_traverse(node, db_node_mark_removed, &num_nodes);
+    location->num_items -= MIN(location->num_items, num_nodes);
+    btree_node_unlink(node);
+    // the nodes are still referenced by entries, they are released in db_commit_changes
+    g_ptr_array_add(db->removed_nodes, node);
+    db->compact_entries = true;
+}
+
+static BTreeNode *
+db_node_create(Database *db, DatabaseLocation *location, BTreeNode *parent, const char *path, const char *name)
+{
+    struct stat st;
+    if (lstat(path, &st) == -1) {
+        return NULL;
+    }
+
+    BTreeNode *node = db_node_new_for_stat(db, name, &st);
+    btree_node_prepend(parent, node);
+    location->num_items++;
+    if (node->is_dir) {
+        GTimer *timer = g_timer_new();
+        bool is_stop = false;
+        db_location_walk_tree_recursive(location,
+                                        db->db_config,
+                                        NULL,
+                                        NULL,
+                                        path,
+                                        timer,
+                                        NULL,
+                                        node,
+                                        0,
+                                        &is_stop,
+                                        db_path_has_data_prefix(path));
+        g_timer_destroy(timer);
+    }
+    btree_node_traverse(node, db_node_mark_pending, db);
+    return node;
+}
+
+bool db_node_add(Database *db, const char *path)
+{
+    assert(db != NULL);
+    assert(path != NULL);
+
+    DatabaseLocation *location = NULL;
+    BTreeNode *parent = NULL;
+    const char *name = NULL;
+    bool is_hidden = false;
+    BTreeNode *node = db_node_lookup(db, path, &location, &parent, &name, &is_hidden);
+    if (is_hidden && db->db_config->filter_hidden_file) {
+        return false;
+    }
+
+    if (node) {
+        struct stat st;
+        if (lstat(path, &st) == -1) {
+            return false;
+        }
+        if (node->is_dir == S_ISDIR(st.st_mode) || !node->parent) {
+            node->mtime = st.st_mtime;
+            node->size = st.st_size;
+            return true;
+        }
+        // replaced by an entry of another type
+        parent = node->parent;
+        name = strrchr(path, '/') + 1;
+        db_node_remove_node(db, location, node);
+    }
+    if (!parent) {
+        return false;
+    }
+
+    return db_node_create(db, location, parent, path, name) != NULL;
+}
+
+bool db_node_remove(Database *db, const char *path)
+{
+    assert(db != NULL);
+    assert(path != NULL);
+
+    DatabaseLocation *location = NULL;
+    BTreeNode *parent = NULL;
+    const char *name = NULL;
+    bool is_hidden = false;
+    BTreeNode *node = db_node_lookup(db, path, &location, &parent, &name, &is_hidden);
+    if (!node || !node->parent) {
+        return false;
+    }
+
+    db_node_remove_node(db, location, node);
+    return true;
+}
+
+bool db_node_move(Database *db, const char *from, const char *to)
+{
+    assert(db != NULL);
+    assert(from != NULL);
+    assert(to != NULL);
+
+    DatabaseLocation *from_location = NULL;
+    BTreeNode *from_parent = NULL;
+    const char *from_name = NULL;
+    bool from_hidden = false;
+    BTreeNode *node = db_node_lookup(db, from, &from_location, &from_parent, &from_name, &from_hidden);
+    if (!node || !node->parent) {
+        // moved in from a place which is not indexed
+        return db_node_add(db, to);
+    }
+
+    DatabaseLocation *to_location = NULL;
+    BTreeNode *to_parent = NULL;
+    const char *to_name = NULL;
+    bool to_hidden = false;
+    BTreeNode *target = db_node_lookup(db, to, &to_location, &to_parent, &to_name, &to_hidden);
+    if (target == node) {
+        return true;
+    }
+    if (target && target->parent) {
+        // overwritten
+        to_parent = target->parent;
+        to_name = strrchr(to, '/') + 1;
+        db_node_remove_node(db, to_location, target);
+    }
+
+    if (!to_parent || to_location != from_location || (to_hidden && db->db_config->filter_hidden_file)) {
+        db_node_remove_node(db, from_location, node);
+        return to_parent ? db_node_add(db, to) : true;
+    }
+
+    // the subtree is kept, only the moved node gets a new name and position
+    btree_node_unlink(node);
+    if (strcmp(node->name, to_name)) {
+        char full_py_name[FILENAME_MAX] = "";
+        char first_py_name[FILENAME_MAX] = "";
+        if (db->db_config->enable_py) {
+            convert_all_pinyin(to_name, first_py_name, full_py_name);
+        }
+        btree_node_set_name(node, to_name, full_py_name, first_py_name);
+    }
+    btree_node_prepend(to_parent, node);
+
+    if (!(node->flags & BTREE_NODE_PENDING)) {
+        db_node_mark_pending(node, db);
+        db->compact_entries = true;
+    }
+    return true;
+}
+
+BTreeNode *
+db_node_find(Database *db, const char *path)
+{
+    assert(db != NULL);
+    assert(path != NULL);
+
+    DatabaseLocation *location = NULL;
+    BTreeNode *parent = NULL;
+    const char *name = NULL;
+    bool is_hidden = false;
+    return db_node_lookup(db, path, &location, &parent, &name, &is_hidden);
+}
+
+bool db_node_sync_dir(Database *db, const char *path)
+{
+    assert(db != NULL);
+    assert(path != NULL);
+
+    DatabaseLocation *location = NULL;
+    BTreeNode *parent = NULL;
+    const char *name = NULL;
+    bool is_hidden = false;
+    BTreeNode *node = db_node_lookup(db, path, &location, &parent, &name, &is_hidden);
+    if (!node || !node->is_dir) {
+        return false;
+    }
+
+    struct stat st;
+    DIR *dir = NULL;
+    if (lstat(path, &st) == -1 || !(dir = opendir(path))) {
+        return false;
+    }
+    node->mtime = st.st_mtime;
+
+    // the children which are not found in the directory any more are removed at last
+    GHashTable *children = g_hash_table_new(g_str_hash, g_str_equal);
+    for (BTreeNode *child = node->children; child; child = child->next) {
+        g_hash_table_insert(children, child->name, child);
+    }
+
+    char fn[PATH_MAX] = "";
+    int len = snprintf(fn, sizeof(fn), "%s/", strcmp(path, "/") ? path : "");
+    struct dirent *dent = NULL;
+    while ((dent = readdir(dir))) {
+        if (!strcmp(dent->d_name, ".") || !strcmp(dent->d_name, "..")) {
+            continue;
+        }
+        if (db->db_config->filter_hidden_file && dent->d_name[0] == '.') {
+            continue;
+        }
+        if (len + strlen(dent->d_name) >= sizeof(fn)) {
+            continue;
+        }
+        strcpy(fn + len, dent->d_name);
+
+        BTreeNode *child = g_hash_table_lookup(children, dent->d_name);
+        if (child) {
+            g_hash_table_remove(children, dent->d_name);
+            if (lstat(fn, &st) == -1) {
+                continue;
+            }
+            if (child->is_dir == S_ISDIR(st.st_mode)) {
+                child->size = st.st_size;
+                if (!child->is_dir) {
+                    child->mtime = st.st_mtime;
+                }
+                continue;
+            }
+            db_node_remove_node(db, location, child);
+        }
+        db_node_create(db, location, node, fn, dent->d_name);
+    }
+    closedir(dir);
+
+    GHashTableIter iter;
+    gpointer value = NULL;
+    g_hash_table_iter_init(&iter, children);
+    while (g_hash_table_iter_next(&iter, NULL, &value)) {
+        db_node_remove_node(db, location, value);
+    }
+    g_hash_table_destroy(children);
+    return true;
+}
+
+static int
+sort_by_name(const void *a, const void *b);
+
+bool db_commit_changes(Database *db)
+{
+    assert(db != NULL);
+    if (db->pending_nodes->len == 0 && db->removed_nodes->len == 0) {
+        return false;
+    }
+
+    if (!db->entries) {
+        db->entries = darray_new(db->pending_nodes->len);
+    }
+
+    // drop the removed nodes and the moved ones, which are inserted again below
+    if (db->compact_entries) {
+        uint32_t num_entries = 0;
+        for (uint32_t i = 0; i < db->num_entries; ++i) {
+            BTreeNode *node = darray_get_item(db->entries, i);
+            if (node && !(node->flags & (BTREE_NODE_REMOVED | BTREE_NODE_PENDING))) {
+                db->entries->data[num_entries++] = node;
+            }
+        }
+        memset(db->entries->data + num_entries, 0, (db->num_entries - num_entries) * sizeof(void *));
+        db->num_entries = num_entries;
+        db->entries->num_items = num_entries;
+        db->compact_entries = false;
+    }
+
+    uint32_t num_pending = 0;
+    for (uint32_t i = 0; i < db->pending_nodes->len; ++i) {
+        BTreeNode *node = g_ptr_array_index(db->pending_nodes, i);
+        node->flags &= ~BTREE_NODE_PENDING;
+        if (!(node->flags & BTREE_NODE_REMOVED)) {
+            g_ptr_array_index(db->pending_nodes, num_pending++) = node;
+        }
+    }
+
+    // keep the entries sorted, binary insertion is cheaper than a merge for a few nodes
+    if (num_pending <= 8) {
+        for (uint32_t i = 0; i < num_pending; ++i) {
+            BTreeNode *node = g_ptr_array_index(db->pending_nodes, i);
+            uint32_t low = 0;
+            uint32_t high = db->num_entries;
+            while (low < high) {
+                const uint32_t mid = low + (high - low) / 2;
+                if (sort_by_name(&db->entries->data[mid], &node) <= 0) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+            darray_insert_item(db->entries, node, low);
+            db->num_entries++;
+        }
+    } else if (num_pending > 0) {
+        // sort the pending nodes once and merge them from the back, the entries are moved only once
+        void **pending = db->pending_nodes->pdata;
+        qsort(pending, num_pending, sizeof(void *), sort_by_name);
+        darray_reserve(db->entries, (size_t)db->num_entries + num_pending);
+
+        void **entries = db->entries->data;
+        int64_t i = (int64_t)db->num_entries - 1;
+        int64_t j = (int64_t)num_pending - 1;
+        int64_t k = i + num_pending;
+        while (j >= 0) {
+            // equal names keep the existing entry first, as the binary insertion does
+            if (i >= 0 && sort_by_name(&entries[i], &pending[j]) > 0) {
+                entries[k--] = entries[i--];
+            } else {
+                entries[k--] = pending[j--];
+            }
+        }
+        db->num_entries += num_pending;
+        db->entries->num_items = db->num_entries;
+    }
+    g_ptr_array_set_size(db->pending_nodes, 0);
+
+    for (uint32_t i = 0; i < db->removed_nodes->len; ++i) {
+        btree_node_free(g_ptr_array_index(db->removed_nodes, i));
+    }
+    g_ptr_array_set_size(db->removed_nodes, 0);
+
+    name_index_free(db->name_index);
+    db->name_index = NULL;
+    db_update_timestamp(db);
+    return true;
+}
+
 void db_update_sort_index(Database *db)
 {
     assert(db != NULL);
@@ -931,6 +1539,8 @@ db_new()
 {
     Database *db = g_new0(Database, 1);
     db->db_config = g_new0(DatabaseConfig, 1);
+    db->pending_nodes = g_ptr_array_new();
+    db->removed_nodes = g_ptr_array_new();
     g_mutex_init(&db->mutex);
     return db;
 }
@@ -946,6 +1556,20 @@ db_entries_clear(Database *db)
         db->entries = NULL;
     }
     db->num_entries = 0;
+    name_index_free(db->name_index);
+    db->name_index = NULL;
+
+    // the uncommitted updates refer to the old entries
+    for (uint32_t i = 0; i < db->pending_nodes->len; ++i) {
+        BTreeNode *node = g_ptr_array_index(db->pending_nodes, i);
+        node->flags &= ~BTREE_NODE_PENDING;
+    }
+    g_ptr_array_set_size(db->pending_nodes, 0);
+    for (uint32_t i = 0; i < db->removed_nodes->len; ++i) {
+        btree_node_free(g_ptr_array_index(db->removed_nodes, i));
+    }
+    g_ptr_array_set_size(db->removed_nodes, 0);
+    db->compact_entries = false;
 }
 
 void db_free(Database *db)
@@ -953,6 +1577,8 @@ void db_free(Database *db)
     assert(db != NULL);
 
     db_entries_clear(db);
+    g_ptr_array_free(db->pending_nodes, TRUE);
+    g_ptr_array_free(db->removed_nodes, TRUE);
     g_mutex_clear(&db->mutex);
     g_free(db->db_config);
     g_free(db);
@@ -999,6 +1625,28 @@ db_get_entries(Database *db)
     return db->entries;
 }
 
+// the caller must hold the lock of db
+NameIndex *
+db_get_name_index(Database *db)
+{
+    assert(db != NULL);
+    if (!db->entries || db->num_entries == 0) {
+        return NULL;
+    }
+
+    if (db->name_index && db->db_config->enable_py && !name_index_has_pinyin(db->name_index)) {
+        name_index_free(db->name_index);
+        db->name_index = NULL;
+    }
+    if (!db->name_index) {
+        db->name_index = name_index_new(db->entries,
+                                        db->num_entries,
+                                        db->db_config->enable_py,
+                                        db->db_config->enable_trigram);
+    }
+    return db->name_index;
+}
+
 static int
 sort_by_name(const void *a, const void *b)
 {
@@ -1026,6 +1674,10 @@ void db_sort(Database *db)
     assert(db != NULL);
     assert(db->entries != NULL);
 
+    // the index follows the order of entries
+    name_index_free(db->name_index);
+    db->name_index = NULL;
+
     //    trace ("start sorting\n");
     darray_sort(db->entries, sort_by_name);
     //    trace ("finished sorting\n");
@@ -23,11 +23,13 @@
 #include <stdbool.h>
 #include "array.h"
 #include "btree.h"
+#include "name_index.h"
 
 typedef struct _DatabaseConfig
 {
     bool enable_py;
     bool filter_hidden_file;
+    bool enable_trigram;
 } DatabaseConfig;
 
 struct _Database
@@ -37,6 +39,13 @@ struct _Database
     DynamicArray *entries;
     uint32_t num_entries;
     DatabaseConfig *db_config;
+    // built on demand for the current entries list
+    NameIndex *name_index;
+
+    // incremental updates which are not merged into entries yet, see db_commit_changes
+    GPtrArray *pending_nodes;
+    GPtrArray *removed_nodes;
+    bool compact_entries;
 
     time_t timestamp;
 
@@ -99,8 +108,29 @@ bool db_try_lock(Database *db);
 DynamicArray *
 db_get_entries(Database *db);
 
+NameIndex *
+db_get_name_index(Database *db);
+
 void db_sort(Database *db);
 
+// incremental updates of the indexed locations, the caller must hold the lock of db
+// and call db_commit_changes before releasing it.
+// adds path, or updates its attributes if it is indexed already
+bool db_node_add(Database *db, const char *path);
+
+bool db_node_remove(Database *db, const char *path);
+
+bool db_node_move(Database *db, const char *from, const char *to);
+
+BTreeNode *
+db_node_find(Database *db, const char *path);
+
+// rescans the children of the indexed directory path
+bool db_node_sync_dir(Database *db, const char *path);
+
+// merges the updates into the entries list, returns true if anything changed
+bool db_commit_changes(Database *db);
+
 bool db_clear(Database *db);
 
 bool db_support(const char *search_path, bool has_data_prefix);
@@ -29,6 +29,7 @@
 
 #include "database_search.h"
 #include "string_utils.h"
+#include "string_match.h"
 #include "query.h"
 //#include "debug.h"
 #include "utf8.h"
@@ -38,6 +39,8 @@
 typedef struct search_query_s
 {
     char *query;
+    // case folded query, for the name index
+    char *folded_query;
     uint32_t (*search_func)(const char *, const char *);
     size_t query_len;
     uint32_t has_uppercase;
@@ -159,6 +162,80 @@ filter_node(BTreeNode *node, FsearchFilter filter)
     return false;
 }
 
+static inline bool
+search_query_match_node(DatabaseSearch *search, search_query_t *query, BTreeNode *node)
+{
+    if (query->search_func(node->name, query->query)) {
+        return true;
+    }
+    return search->enable_py && node->full_py_name[0] != '\0'
+            && (query->search_func(node->first_py_name, query->query)
+                || query->search_func(node->full_py_name, query->query));
+}
+
+static bool
+search_thread_can_use_index(search_thread_context_t *ctx)
+{
+    DatabaseSearch *search = ctx->search;
+    const NameIndex *index = search->name_index;
+    if (!index || ctx->num_queries != 1 || name_index_get_num_entries(index) != search->num_entries) {
+        return false;
+    }
+
+    const search_query_t *query = ctx->queries[0];
+    if (search->search_in_path || (search->auto_search_in_path && query->has_separator)) {
+        return false;
+    }
+    return !search->enable_py || name_index_has_pinyin(index);
+}
+
+/*
+ * the names of the range are searched in the name index, which gives the same
+ * results as search_thread. A case-insensitive match in the index is exact,
+ * and it is a candidate of a case-sensitive match which is verified at last.
+ */
+static void *
+search_thread_indexed(search_thread_context_t *ctx)
+{
+    DatabaseSearch *search = ctx->search;
+    search_query_t *query = ctx->queries[0];
+    const uint32_t start = ctx->start_pos;
+    const uint32_t end = ctx->end_pos;
+    const uint32_t max_results = search->max_results;
+    DynamicArray *entries = search->entries;
+    BTreeNode **results = ctx->results;
+
+    const uint32_t num_words = (end - start) / 64 + 1;
+    uint64_t *matches = calloc(num_words, sizeof(uint64_t));
+    assert(matches != NULL);
+    name_index_search(search->name_index, NAME_INDEX_COLUMN_NAME, query->folded_query, start, end, matches);
+    if (search->enable_py) {
+        name_index_search(search->name_index, NAME_INDEX_COLUMN_FIRST_PY, query->folded_query, start, end, matches);
+        name_index_search(search->name_index, NAME_INDEX_COLUMN_FULL_PY, query->folded_query, start, end, matches);
+    }
+
+    uint32_t num_results = 0;
+    for (uint32_t word = 0; word < num_words; ++word) {
+        uint64_t bits = matches[word];
+        while (bits && !(max_results && num_results == max_results)) {
+            const uint32_t i = start + word * 64 + __builtin_ctzll(bits);
+            bits &= bits - 1;
+
+            BTreeNode *node = darray_get_item(entries, i);
+            if (!node || !filter_node(node, search->filter)) {
+                continue;
+            }
+            if (search->match_case && !search_query_match_node(search, query, node)) {
+                continue;
+            }
+            results[num_results++] = node;
+        }
+    }
+    free(matches);
+    ctx->num_results = num_results;
+    return NULL;
+}
+
 static void *
 search_thread(void *user_data)
 {
@@ -171,6 +248,9 @@ search_thread(void *user_data)
     if (ctx->results == NULL) {
         return NULL;
     }
+    if (search_thread_can_use_index(ctx)) {
+        return search_thread_indexed(ctx);
+    }
     const uint32_t start = ctx->start_pos;
     const uint32_t end = ctx->end_pos;
     const uint32_t max_results = ctx->search->max_results;
@@ -284,6 +364,8 @@ search_regex_thread(void *user_data)
                                &error,
                                &erroffset,
                                NULL);
+    // the same pattern is matched with all the names of the range, compile it with jit
+    pcre_extra *extra = regex ? pcre_study(regex, PCRE_STUDY_JIT_COMPILE, &error) : NULL;
 
     int ovector[OVECCOUNT];
 
@@ -321,18 +403,18 @@ search_regex_thread(void *user_data)
             }
             size_t haystack_len = strlen(haystack);
 
-            if (pcre_exec(regex, NULL, haystack, haystack_len,
+            if (pcre_exec(regex, extra, haystack, haystack_len,
                           0, 0, ovector, OVECCOUNT)
                 >= 0) {
                 results[num_results] = node;
                 num_results++;
             } else if (ctx->search->enable_py && strlen(node->full_py_name)) {
-                if (pcre_exec(regex, NULL, node->first_py_name, strlen(node->first_py_name),
+                if (pcre_exec(regex, extra, node->first_py_name, strlen(node->first_py_name),
                               0, 0, ovector, OVECCOUNT)
                     >= 0) {
                     results[num_results] = node;
                     num_results++;
-                } else if (pcre_exec(regex, NULL, node->full_py_name, strlen(node->full_py_name),
+                } else if (pcre_exec(regex, extra, node->full_py_name, strlen(node->full_py_name),
                                      0, 0, ovector, OVECCOUNT)
                            >= 0) {
                     results[num_results] = node;
@@ -341,6 +423,9 @@ search_regex_thread(void *user_data)
             }
         }
         ctx->num_results = num_results;
+        if (extra) {
+            pcre_free_study(extra);
+        }
         pcre_free(regex);
     }
     return NULL;
@@ -409,6 +494,10 @@ search_query_free(void *data)
         g_free(query->query);
         query->query = NULL;
     }
+    if (query->folded_query != NULL) {
+        free(query->folded_query);
+        query->folded_query = NULL;
+    }
     g_free(query);
     query = NULL;
 }
@@ -420,6 +509,10 @@ search_query_new(const char *query, bool match_case)
     assert(new != NULL);
 
     new->query = g_strdup(query);
+    new->folded_query = fs_str_casefold(query);
+    if (!new->folded_query) {
+        new->folded_query = strdup(query);
+    }
     new->query_len = strlen(query);
     new->has_uppercase = fs_str_has_upper(query);
     new->has_separator = strchr(query, '/') ? 1 : 0;
@@ -714,6 +807,13 @@ void db_search_set_search_in_path(DatabaseSearch *search, bool search_in_path)
     search->search_in_path = search_in_path;
 }
 
+void db_search_set_name_index(DatabaseSearch *search, NameIndex *index)
+{
+    assert(search != NULL);
+
+    search->name_index = index;
+}
+
 void db_search_set_query(DatabaseSearch *search, const char *query)
 {
     assert(search != NULL);
@@ -20,6 +20,7 @@
 #include <stdint.h>
 #include "array.h"
 #include "btree.h"
+#include "name_index.h"
 #include "query.h"
 #include "fsearch_thread_pool.h"
 
@@ -57,6 +58,7 @@ struct _DatabaseSearch
 
     DynamicArray *entries;
     uint32_t num_entries;
+    NameIndex *name_index;
 
     GThread *search_thread;
     bool search_thread_terminate;
@@ -106,6 +108,9 @@ void db_search_update(DatabaseSearch *search,
                       bool search_in_path,
                       bool enable_py);
 
+// the index of entries, the names are searched in it when it is set
+void db_search_set_name_index(DatabaseSearch *search, NameIndex *index);
+
 void db_search_results_clear(DatabaseSearch *search);
 
 void db_search_set_search_in_path(DatabaseSearch *search, bool search_in_path);
@@ -0,0 +1,277 @@
+/*
+   FSearch - A fast file search utility
+   Copyright © 2020 Christian Boxdörfer
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+   */
+
+/*
+ * The name index keeps the case folded names (and pinyin) of the sorted entries in
+ * contiguous arenas, each name is terminated by '\0' so a match can not cross two names.
+ * A search scans the arena of a range with fs_memmem and maps the found offsets back
+ * to the entries, instead of calling strcasestr for every node.
+ *
+ * With trigrams enabled, every block of NAME_INDEX_BLOCK_SIZE entries has a signature,
+ * a bitset of the hashed trigrams of its strings. A needle of 3 or more bytes can only
+ * be found in the blocks which have all of its trigram bits, the other blocks are skipped.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <glib.h>
+#include "name_index.h"
+#include "btree.h"
+#include "string_match.h"
+#include "string_utils.h"
+
+#define NAME_INDEX_BLOCK_SIZE 128
+#define NAME_INDEX_SIGNATURE_BITS 4096
+#define NAME_INDEX_SIGNATURE_WORDS (NAME_INDEX_SIGNATURE_BITS / 64)
+
+typedef struct
+{
+    char *arena;
+    // offsets[i] is the start of entry i, offsets[num_entries] is the end of the arena
+    uint32_t *offsets;
+} NameIndexArena;
+
+struct _NameIndex
+{
+    uint32_t num_entries;
+    bool has_pinyin;
+    NameIndexArena columns[NAME_INDEX_NUM_COLUMNS];
+
+    uint64_t *signatures;
+    uint32_t num_blocks;
+};
+
+static inline uint32_t
+trigram_hash(const unsigned char *str)
+{
+    const uint32_t trigram = ((uint32_t)str[0] << 16) | ((uint32_t)str[1] << 8) | str[2];
+    return (trigram * 2654435761u) >> (32 - 12);
+}
+
+static void
+signature_add(uint64_t *signature, const char *str, size_t len)
+{
+    const unsigned char *s = (const unsigned char *)str;
+    for (size_t i = 0; i + 3 <= len; ++i) {
+        const uint32_t bit = trigram_hash(s + i);
+        signature[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+}
+
+static const char *
+column_string(BTreeNode *node, NameIndexColumn column)
+{
+    switch (column) {
+    case NAME_INDEX_COLUMN_NAME:
+        return node->lower_name;
+    case NAME_INDEX_COLUMN_FULL_PY:
+        return node->full_py_name;
+    case NAME_INDEX_COLUMN_FIRST_PY:
+        return node->first_py_name;
+    default:
+        return "";
+    }
+}
+
+static bool
+name_index_build_column(NameIndex *index, DynamicArray *entries, NameIndexColumn column)
+{
+    NameIndexArena *arena = &index->columns[column];
+    arena->offsets = malloc(((size_t)index->num_entries + 1) * sizeof(uint32_t));
+    if (!arena->offsets) {
+        return false;
+    }
+
+    GString *buffer = g_string_sized_new((size_t)index->num_entries * 16);
+    for (uint32_t i = 0; i < index->num_entries; ++i) {
+        BTreeNode *node = darray_get_item(entries, i);
+        const char *str = node ? column_string(node, column) : "";
+        // the pinyin is only searched for the names which have it
+        if (column != NAME_INDEX_COLUMN_NAME && node && node->full_py_name[0] == '\0') {
+            str = "";
+        }
+
+        char *folded = column == NAME_INDEX_COLUMN_NAME ? NULL : fs_str_casefold(str);
+        const char *value = folded ? folded : str;
+        const size_t len = strlen(value);
+        if (buffer->len + len + 1 > UINT32_MAX) {
+            g_free(folded);
+            g_string_free(buffer, TRUE);
+            return false;
+        }
+
+        arena->offsets[i] = (uint32_t)buffer->len;
+        g_string_append_len(buffer, value, len + 1);
+        if (index->signatures) {
+            signature_add(index->signatures + (size_t)(i / NAME_INDEX_BLOCK_SIZE) * NAME_INDEX_SIGNATURE_WORDS, value, len);
+        }
+        free(folded);
+    }
+    arena->offsets[index->num_entries] = (uint32_t)buffer->len;
+    arena->arena = g_string_free(buffer, FALSE);
+    return true;
+}
+
+NameIndex *
+name_index_new(DynamicArray *entries, uint32_t num_entries, bool with_pinyin, bool with_trigrams)
+{
+    assert(entries != NULL);
+
+    NameIndex *index = calloc(1, sizeof(NameIndex));
+    assert(index != NULL);
+    index->num_entries = num_entries;
+    index->has_pinyin = with_pinyin;
+    if (with_trigrams) {
+        index->num_blocks = (num_entries + NAME_INDEX_BLOCK_SIZE - 1) / NAME_INDEX_BLOCK_SIZE;
+        index->signatures = calloc((size_t)index->num_blocks * NAME_INDEX_SIGNATURE_WORDS, sizeof(uint64_t));
+    }
+
+    const int num_columns = with_pinyin ? NAME_INDEX_NUM_COLUMNS : 1;
+    for (int column = 0; column < num_columns; ++column) {
+        if (!name_index_build_column(index, entries, column)) {
+            name_index_free(index);
+            return NULL;
+        }
+    }
+    return index;
+}
+
+void
+name_index_free(NameIndex *index)
+{
+    if (!index) {
+        return;
+    }
+    for (int column = 0; column < NAME_INDEX_NUM_COLUMNS; ++column) {
+        g_free(index->columns[column].arena);
+        free(index->columns[column].offsets);
+    }
+    free(index->signatures);
+    free(index);
+}
+
+bool
+name_index_has_pinyin(const NameIndex *index)
+{
+    assert(index != NULL);
+    return index->has_pinyin;
+}
+
+uint32_t
+name_index_get_num_entries(const NameIndex *index)
+{
+    assert(index != NULL);
+    return index->num_entries;
+}
+
+// the last entry which starts at or before offset
+static uint32_t
+find_entry(const uint32_t *offsets, uint32_t first, uint32_t last, uint32_t offset)
+{
+    while (first < last) {
+        const uint32_t mid = first + (last - first + 1) / 2;
+        if (offsets[mid] <= offset) {
+            first = mid;
+        } else {
+            last = mid - 1;
+        }
+    }
+    return first;
+}
+
+static void
+scan_range(const NameIndexArena *arena,
+           const char *needle,
+           size_t needle_len,
+           uint32_t first,
+           uint32_t last,
+           uint32_t start,
+           uint64_t *matches)
+{
+    const char *ptr = arena->arena + arena->offsets[first];
+    const char *end = arena->arena + arena->offsets[last + 1];
+    uint32_t entry = first;
+    while (ptr < end) {
+        const char *found = fs_memmem(ptr, end - ptr, needle, needle_len);
+        if (!found) {
+            break;
+        }
+        entry = find_entry(arena->offsets, entry, last, (uint32_t)(found - arena->arena));
+        const uint32_t bit = entry - start;
+        matches[bit / 64] |= (uint64_t)1 << (bit % 64);
+        // continue with the next name
+        ptr = arena->arena + arena->offsets[entry + 1];
+    }
+}
+
+void
+name_index_search(const NameIndex *index,
+                  NameIndexColumn column,
+                  const char *folded_needle,
+                  uint32_t start,
+                  uint32_t end,
+                  uint64_t *matches)
+{
+    assert(index != NULL);
+    assert(matches != NULL);
+    assert(end < index->num_entries);
+
+    const NameIndexArena *arena = &index->columns[column];
+    if (!arena->arena || start > end) {
+        return;
+    }
+
+    const size_t needle_len = strlen(folded_needle);
+    if (!index->signatures || needle_len < 3) {
+        scan_range(arena, folded_needle, needle_len, start, end, start, matches);
+        return;
+    }
+
+    uint64_t query[NAME_INDEX_SIGNATURE_WORDS] = { 0 };
+    signature_add(query, folded_needle, needle_len);
+    // only the words which have a bit of the needle are compared
+    int words[NAME_INDEX_SIGNATURE_WORDS];
+    int num_words = 0;
+    for (int i = 0; i < NAME_INDEX_SIGNATURE_WORDS; ++i) {
+        if (query[i]) {
+            words[num_words++] = i;
+        }
+    }
+
+    // scan the runs of adjacent candidate blocks at once
+    int64_t run_first = -1;
+    for (uint32_t block = start / NAME_INDEX_BLOCK_SIZE; block <= end / NAME_INDEX_BLOCK_SIZE; ++block) {
+        const uint64_t *signature = index->signatures + (size_t)block * NAME_INDEX_SIGNATURE_WORDS;
+        bool candidate = true;
+        for (int i = 0; i < num_words && candidate; ++i) {
+            candidate = (signature[words[i]] & query[words[i]]) == query[words[i]];
+        }
+
+        const uint32_t block_first = MAX(start, block * NAME_INDEX_BLOCK_SIZE);
+        if (candidate && run_first < 0) {
+            run_first = block_first;
+        } else if (!candidate && run_first >= 0) {
+            scan_range(arena, folded_needle, needle_len, (uint32_t)run_first, block_first - 1, start, matches);
+            run_first = -1;
+        }
+    }
+    if (run_first >= 0) {
+        scan_range(arena, folded_needle, needle_len, (uint32_t)run_first, end, start, matches);
+    }
+}
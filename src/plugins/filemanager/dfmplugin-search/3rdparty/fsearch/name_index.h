@@ -0,0 +1,57 @@
+/*
+   FSearch - A fast file search utility
+   Copyright © 2020 Christian Boxdörfer
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+   */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "array.h"
+
+typedef struct _NameIndex NameIndex;
+
+typedef enum {
+    NAME_INDEX_COLUMN_NAME,
+    NAME_INDEX_COLUMN_FULL_PY,
+    NAME_INDEX_COLUMN_FIRST_PY,
+    NAME_INDEX_NUM_COLUMNS,
+} NameIndexColumn;
+
+NameIndex *
+name_index_new(DynamicArray *entries,
+               uint32_t num_entries,
+               bool with_pinyin,
+               bool with_trigrams);
+
+void
+name_index_free(NameIndex *index);
+
+bool
+name_index_has_pinyin(const NameIndex *index);
+
+uint32_t
+name_index_get_num_entries(const NameIndex *index);
+
+// marks the entries in [start, end] whose column contains the case folded needle,
+// bit (i - start) of matches is set for entry i
+void
+name_index_search(const NameIndex *index,
+                  NameIndexColumn column,
+                  const char *folded_needle,
+                  uint32_t start,
+                  uint32_t end,
+                  uint64_t *matches);
@@ -0,0 +1,152 @@
+/*
+   FSearch - A fast file search utility
+   Copyright © 2020 Christian Boxdörfer
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+   */
+
+/*
+ * substring search that compares the first and the last byte of the needle with
+ * a block of 16 or 32 positions at once, and only calls memcmp for the positions
+ * where both of them match. The needle is rarely found in a file name, so most
+ * of the blocks are skipped by two compares.
+ */
+
+#define _GNU_SOURCE
+#include <string.h>
+#include <stdint.h>
+#include "string_match.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define FS_MEMMEM_SIMD 1
+#endif
+
+typedef const char *(*MemmemFunc)(const char *, size_t, const char *, size_t);
+
+static const char *
+fs_memmem_scalar(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+    return memmem(haystack, haystack_len, needle, needle_len);
+}
+
+#ifdef FS_MEMMEM_SIMD
+static inline const char *
+fs_memmem_check(const char *haystack, uint32_t mask, const char *needle, size_t needle_len)
+{
+    while (mask) {
+        const int bit = __builtin_ctz(mask);
+        if (!memcmp(haystack + bit + 1, needle + 1, needle_len - 2)) {
+            return haystack + bit;
+        }
+        mask &= mask - 1;
+    }
+    return NULL;
+}
+
+// sse2 is part of x86_64, no runtime check is needed
+static const char *
+fs_memmem_sse2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+    size_t i = 0;
+    for (; i + needle_len + 15 <= haystack_len; i += 16) {
+        const __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + i));
+        const __m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + i + needle_len - 1));
+        const __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last));
+        const uint32_t mask = (uint32_t)_mm_movemask_epi8(eq);
+        const char *found = mask ? fs_memmem_check(haystack + i, mask, needle, needle_len) : NULL;
+        if (found) {
+            return found;
+        }
+    }
+    return fs_memmem_scalar(haystack + i, haystack_len - i, needle, needle_len);
+}
+
+__attribute__((target("avx2"))) static const char *
+fs_memmem_avx2(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+    size_t i = 0;
+    for (; i + needle_len + 31 <= haystack_len; i += 32) {
+        const __m256i block_first = _mm256_loadu_si256((const __m256i *)(haystack + i));
+        const __m256i block_last = _mm256_loadu_si256((const __m256i *)(haystack + i + needle_len - 1));
+        const __m256i eq = _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last));
+        const uint32_t mask = (uint32_t)_mm256_movemask_epi8(eq);
+        const char *found = mask ? fs_memmem_check(haystack + i, mask, needle, needle_len) : NULL;
+        if (found) {
+            return found;
+        }
+    }
+    return fs_memmem_sse2(haystack + i, haystack_len - i, needle, needle_len);
+}
+#endif
+
+static MemmemFunc
+fs_memmem_resolve(const char **name)
+{
+#ifdef FS_MEMMEM_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        *name = "avx2";
+        return fs_memmem_avx2;
+    }
+    *name = "sse2";
+    return fs_memmem_sse2;
+#else
+    *name = "scalar";
+    return fs_memmem_scalar;
+#endif
+}
+
+static MemmemFunc memmem_impl = NULL;
+static const char *memmem_impl_name = NULL;
+
+static MemmemFunc
+fs_memmem_get_impl(void)
+{
+    // resolving is idempotent, a race only resolves it twice
+    MemmemFunc impl = __atomic_load_n(&memmem_impl, __ATOMIC_ACQUIRE);
+    if (!impl) {
+        const char *name = NULL;
+        impl = fs_memmem_resolve(&name);
+        __atomic_store_n(&memmem_impl_name, name, __ATOMIC_RELEASE);
+        __atomic_store_n(&memmem_impl, impl, __ATOMIC_RELEASE);
+    }
+    return impl;
+}
+
+const char *
+fs_memmem(const char *haystack, size_t haystack_len, const char *needle, size_t needle_len)
+{
+    if (needle_len == 0) {
+        return haystack;
+    }
+    if (needle_len > haystack_len) {
+        return NULL;
+    }
+    if (needle_len == 1) {
+        return memchr(haystack, needle[0], haystack_len);
+    }
+    return fs_memmem_get_impl()(haystack, haystack_len, needle, needle_len);
+}
+
+const char *
+fs_memmem_impl_name(void)
+{
+    fs_memmem_get_impl();
+    return __atomic_load_n(&memmem_impl_name, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,31 @@
+/*
+   FSearch - A fast file search utility
+   Copyright © 2020 Christian Boxdörfer
+
+   This program is free software; you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation; either version 2 of the License, or
+   (at your option) any later version.
+
+   This program is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with this program; if not, see <http://www.gnu.org/licenses/>.
+   */
+
+#pragma once
+#include <stddef.h>
+
+// finds the first occurrence of needle in haystack, the best implementation for the cpu is picked at the first call
+const char *
+fs_memmem(const char *haystack,
+          size_t haystack_len,
+          const char *needle,
+          size_t needle_len);
+
+// the name of the picked implementation
+const char *
+fs_memmem_impl_name(void);
@@ -21,6 +21,7 @@
 #include <assert.h>
 #include <string.h>
 #include "string_utils.h"
+#include "utf8.h"
 
 bool
 fs_str_is_empty (const char *str)
@@ -62,3 +63,85 @@ fs_str_copy (char *dest, char *end, const char *src)
     return ptr;
 }
 
+
+// decodes one code point, invalid sequences are taken as a single byte
+static const char *
+fs_str_next_codepoint (const char *str, int32_t *cp)
+{
+    const unsigned char *s = (const unsigned char *)str;
+    size_t len = 1;
+    if (s[0] >= 0xf0 && s[0] <= 0xf4) {
+        *cp = s[0] & 0x07;
+        len = 4;
+    }
+    else if (s[0] >= 0xe0 && s[0] <= 0xef) {
+        *cp = s[0] & 0x0f;
+        len = 3;
+    }
+    else if (s[0] >= 0xc2 && s[0] <= 0xdf) {
+        *cp = s[0] & 0x1f;
+        len = 2;
+    }
+
+    if (len == 1) {
+        *cp = s[0];
+        return str + 1;
+    }
+    for (size_t i = 1; i < len; ++i) {
+        // also stops at the terminator
+        if ((s[i] & 0xc0) != 0x80) {
+            *cp = s[0];
+            return str + 1;
+        }
+        *cp = (*cp << 6) | (s[i] & 0x3f);
+    }
+    return str + len;
+}
+
+/*
+ * returns the lowercase copy of the utf8 string `str`, or NULL if it has nothing to fold.
+ * the result is folded per code point, so a substring search in the folded strings
+ * is a case-insensitive search in the original ones.
+ */
+char *
+fs_str_casefold (const char *str)
+{
+    assert (str != NULL);
+    const char *ptr = str;
+    while (*ptr != '\0' && (unsigned char)*ptr < 0x80 && !isupper ((unsigned char)*ptr)) {
+        ptr++;
+    }
+    if (*ptr == '\0') {
+        return NULL;
+    }
+
+    // a lowercase code point takes at most one byte more than the uppercase one
+    const size_t size = strlen (str) * 2 + 1;
+    char *folded = malloc (size);
+    assert (folded != NULL);
+    char *dest = folded;
+    const char *end = folded + size - 1;
+    bool changed = false;
+    ptr = str;
+    while (*ptr != '\0') {
+        int32_t cp = 0;
+        const char *next = fs_str_next_codepoint (ptr, &cp);
+        const int32_t lower = next - ptr == 1 && cp >= 0x80 ? cp : utf8lwrcodepoint (cp);
+        if (lower == cp) {
+            memcpy (dest, ptr, next - ptr);
+            dest += next - ptr;
+        }
+        else {
+            dest = utf8catcodepoint (dest, lower, end - dest);
+            changed = true;
+        }
+        ptr = next;
+    }
+    *dest = '\0';
+
+    if (!changed) {
+        free (folded);
+        return NULL;
+    }
+    return folded;
+}
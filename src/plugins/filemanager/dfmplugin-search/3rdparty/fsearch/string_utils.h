@@ -30,3 +30,6 @@ char *
 fs_str_copy(char *dest,
             char *end,
             const char *src);
+
+char *
+fs_str_casefold(const char *str);
@@ -6,6 +6,7 @@
 #include "searcheventcaller.h"
 #include "utils/searchhelper.h"
 #include "searchmanager/searchmanager.h"
+#include "searchmanager/searcher/fulltext/fulltextsearcher.h"
 
 #include <dfm-base/widgets/filemanagerwindowsmanager.h>
 
@@ -59,6 +60,41 @@ void SearchEventReceiver::handleAddressInputStr(quint64 windId, QString *str)
     }
 }
 
+void SearchEventReceiver::handlePasteFileResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    // the source files are removed if they are cut
+    FullTextSearcher::recordChanges(srcUrls + destUrls);
+}
+
+void SearchEventReceiver::handleRemoveFileResult(const QList<QUrl> &srcUrls, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    FullTextSearcher::recordChanges(srcUrls);
+}
+
+void SearchEventReceiver::handleRenameFileResult(quint64 winId, const QMap<QUrl, QUrl> &renamedUrls, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(winId)
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    FullTextSearcher::recordChanges(renamedUrls.keys() + renamedUrls.values());
+}
+
+void SearchEventReceiver::handleTouchFileResult(quint64 winId, const QList<QUrl> &urls, bool ok, const QString &errMsg)
+{
+    Q_UNUSED(winId)
+    Q_UNUSED(ok)
+    Q_UNUSED(errMsg)
+
+    FullTextSearcher::recordChanges(urls);
+}
+
 SearchEventReceiver::SearchEventReceiver(QObject *parent)
     : QObject(parent)
 {
@@ -8,6 +8,8 @@
 #include "dfmplugin_search_global.h"
 
 #include <QObject>
+#include <QUrl>
+#include <QMap>
 
 #define SearchEventReceiverIns DPSEARCH_NAMESPACE::SearchEventReceiver::instance()
 
@@ -27,6 +29,11 @@ public slots:
     void handleUrlChanged(quint64 winId, const QUrl &u);
     void handleAddressInputStr(quint64 windId, QString *str);
 
+    void handlePasteFileResult(const QList<QUrl> &srcUrls, const QList<QUrl> &destUrls, bool ok, const QString &errMsg);
+    void handleRemoveFileResult(const QList<QUrl> &srcUrls, bool ok, const QString &errMsg);
+    void handleRenameFileResult(quint64 winId, const QMap<QUrl, QUrl> &renamedUrls, bool ok, const QString &errMsg);
+    void handleTouchFileResult(quint64 winId, const QList<QUrl> &urls, bool ok, const QString &errMsg);
+
 private:
     explicit SearchEventReceiver(QObject *parent = nullptr);
 };
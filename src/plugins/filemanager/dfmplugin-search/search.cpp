@@ -195,6 +195,20 @@ void Search::bindEvents()
     dpfSignalDispatcher->subscribe("dfmplugin_titlebar", "signal_InputAdddressStr_Check",
                                    SearchEventReceiverIns, &SearchEventReceiver::handleAddressInputStr);
 
+    // record the changed files for full-text index
+    dpfSignalDispatcher->subscribe(GlobalEventType::kCopyResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handlePasteFileResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kCutFileResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handlePasteFileResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kMoveToTrashResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleRemoveFileResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kDeleteFilesResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleRemoveFileResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kRenameFileResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleRenameFileResult);
+    dpfSignalDispatcher->subscribe(GlobalEventType::kTouchFileResult,
+                                   SearchEventReceiverIns, &SearchEventReceiver::handleTouchFileResult);
+
     // connect self slot events
     static constexpr auto selfSpace { DPF_MACRO_TO_STR(DPSEARCH_NAMESPACE) };
     dpfSlotChannel->connect(selfSpace, "slot_Custom_Register",
@@ -20,7 +20,8 @@ FSearcher::FSearcher(const QUrl &url, const QString &key, QObject *parent)
       searchHandler(new FSearchHandler)
 {
     searchHandler->init();
-    searchHandler->setFlags(FSearchHandler::FSEARCH_FLAG_REGEX | FSearchHandler::FSEARCH_FLAG_FILTER_HIDDEN_FILE);
+    searchHandler->setFlags(FSearchHandler::FSEARCH_FLAG_REGEX | FSearchHandler::FSEARCH_FLAG_FILTER_HIDDEN_FILE
+                           | FSearchHandler::FSEARCH_FLAG_TRIGRAM);
 }
 
 FSearcher::~FSearcher()
@@ -53,7 +54,8 @@ bool FSearcher::search()
     }
 
     notifyTimer.start();
-    searchHandler->loadDatabase(path, "");
+    if (!searchHandler->attachLiveDatabase(path))
+        searchHandler->loadDatabase(path, "");
     auto callback = std::bind(FSearcher::receiveResultCallback, std::placeholders::_1, std::placeholders::_2, this);
 
     conditionMtx.lock();
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: GPL-3.0-or-later
 
 #include "fsearchhandler.h"
+#include "fsearchlivedatabase.h"
 
 #include <dfm-base/base/device/deviceutils.h>
 
@@ -65,8 +66,31 @@ bool FSearchHandler::loadDatabase(const QString &path, const QString &dbLocation
                          &isStop);
 }
 
+/*!
+ * \brief FSearchHandler::attachLiveDatabase
+ * searches the shared database of `path` which is updated by the file changes,
+ * instead of walking `path` again.
+ * \return false if the path can not be watched, call loadDatabase then
+ */
+bool FSearchHandler::attachLiveDatabase(const QString &path)
+{
+    auto database = FSearchLiveDatabase::acquire(path, *app->db->db_config, &isStop);
+    if (!database)
+        return false;
+
+    db_clear(app->db);
+    db_free(app->db);
+    app->db = database->database();
+    liveDatabase = database;
+    return true;
+}
+
 bool FSearchHandler::updateDatabase()
 {
+    // the live database never needs to be loaded again
+    if (liveDatabase && liveDatabase->isLive())
+        return true;
+
     isStop = false;
     GList *locations = app->config->locations;
     for (GList *l = locations; l != nullptr; l = l->next) {
@@ -91,7 +115,9 @@ bool FSearchHandler::search(const QString &keyword, FSearchHandler::FSearchCallb
     callbackFunc = callback;
     db_search_results_clear(app->search);
     Database *db = app->db;
-    if (!db_try_lock(db))
+    if (liveDatabase)
+        db_lock(db);
+    else if (!db_try_lock(db))
         return false;
 
     if (app->search) {
@@ -107,7 +133,11 @@ bool FSearchHandler::search(const QString &keyword, FSearchHandler::FSearchCallb
                          app->config->auto_search_in_path,
                          app->config->search_in_path,
                          app->db->db_config->enable_py);
+        db_search_set_name_index(app->search, db_get_name_index(db));
         syncMutex.lock();
+        // the entries are not changed until the results are received
+        if (liveDatabase && db_get_entries(db))
+            liveDatabase->beginSearch();
         db_perform_search(app->search, FSearchHandler::reveiceResultsCallback, app, this);
     }
 
@@ -127,18 +157,28 @@ void FSearchHandler::setMaxResults(uint32_t max)
 
 void FSearchHandler::setFlags(FSearchFlags flags)
 {
+    // the config of a live database is shared by the searchers, it is decided when the database is built
+    DatabaseConfig *dbConfig = app->db->db_config;
+    DatabaseConfig liveConfig = *dbConfig;
+    if (liveDatabase)
+        dbConfig = &liveConfig;
+
     if (flags.testFlag(FSEARCH_FLAG_FILTER_HIDDEN_FILE))
-        app->db->db_config->filter_hidden_file = true;
+        dbConfig->filter_hidden_file = true;
 
     if (flags.testFlag(FSEARCH_FLAG_PINYIN))
-        app->db->db_config->enable_py = true;
+        dbConfig->enable_py = true;
 
     if (flags.testFlag(FSEARCH_FLAG_REGEX))
         app->config->enable_regex = true;
 
+    if (flags.testFlag(FSEARCH_FLAG_TRIGRAM))
+        dbConfig->enable_trigram = true;
+
     if (flags.testFlag(FSEARCH_FLAG_NONE)) {
-        app->db->db_config->filter_hidden_file = false;
-        app->db->db_config->enable_py = false;
+        dbConfig->filter_hidden_file = false;
+        dbConfig->enable_py = false;
+        dbConfig->enable_trigram = false;
         app->config->enable_regex = false;
     }
 }
@@ -154,7 +194,9 @@ long FSearchHandler::dbTimeStamp()
 void FSearchHandler::releaseApp()
 {
     if (app) {
-        if (app->db) {
+        if (liveDatabase) {
+            liveDatabase.reset();
+        } else if (app->db) {
             db_clear(app->db);
             db_free(app->db);
         }
@@ -170,6 +212,14 @@ void FSearchHandler::releaseApp()
     }
 }
 
+void FSearchHandler::finishSearch()
+{
+    callbackFunc("", true);
+    if (liveDatabase)
+        liveDatabase->endSearch();
+    syncMutex.unlock();
+}
+
 void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
 {
     DatabaseSearchResult *results = static_cast<DatabaseSearchResult *>(data);
@@ -177,8 +227,7 @@ void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
     Q_ASSERT(results && self);
 
     if (self->isStop) {
-        self->callbackFunc("", true);
-        self->syncMutex.unlock();
+        self->finishSearch();
         return;
     }
 
@@ -186,8 +235,7 @@ void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
         uint32_t num_results = results->results->len;
         for (uint32_t i = 0; i < num_results; ++i) {
             if (self->isStop) {
-                self->callbackFunc("", true);
-                self->syncMutex.unlock();
+                self->finishSearch();
                 return;
             }
 
@@ -197,8 +245,7 @@ void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
                 auto *node = entry->node;
                 while (node != nullptr) {
                     if (self->isStop) {
-                        self->callbackFunc("", true);
-                        self->syncMutex.unlock();
+                        self->finishSearch();
                         return;
                     }
 
@@ -216,6 +263,5 @@ void FSearchHandler::reveiceResultsCallback(void *data, void *sender)
         }
     }
 
-    self->callbackFunc("", true);
-    self->syncMutex.unlock();
+    self->finishSearch();
 }
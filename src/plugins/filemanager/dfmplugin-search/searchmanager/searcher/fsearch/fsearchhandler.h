@@ -15,11 +15,13 @@ extern "C" {
 #include <QMutex>
 
 #include <functional>
+#include <memory>
 
 #define DEFAULT_MAX_RESULTS 50000
 
 DPSEARCH_BEGIN_NAMESPACE
 
+class FSearchLiveDatabase;
 class FSearchHandler
 {
 public:
@@ -29,7 +31,8 @@ public:
         FSEARCH_FLAG_FILTER_HIDDEN_FILE = 1,
         FSEARCH_FLAG_PINYIN = 1 << 1,
         FSEARCH_FLAG_REGEX = 1 << 2,
-        FSEARCH_FLAG_ALL = FSEARCH_FLAG_FILTER_HIDDEN_FILE | FSEARCH_FLAG_REGEX | FSEARCH_FLAG_PINYIN
+        FSEARCH_FLAG_TRIGRAM = 1 << 3,
+        FSEARCH_FLAG_ALL = FSEARCH_FLAG_FILTER_HIDDEN_FILE | FSEARCH_FLAG_REGEX | FSEARCH_FLAG_PINYIN | FSEARCH_FLAG_TRIGRAM
     };
     Q_DECLARE_FLAGS(FSearchFlags, FSearchFlag)
 
@@ -41,6 +44,7 @@ public:
     void init();
     void reset();
     bool loadDatabase(const QString &path, const QString &dbLocation);
+    bool attachLiveDatabase(const QString &path);
     bool updateDatabase();
     bool saveDatabase(const QString &savePath);
     bool search(const QString &keyword, FSearchCallbackFunc callback);
@@ -51,11 +55,14 @@ public:
 
 private:
     void releaseApp();
+    void finishSearch();
     static void reveiceResultsCallback(void *data, void *sender);
 
 private:
     bool isStop = false;
     FsearchApplication *app = nullptr;
+    // app->db belongs to it when a live database is attached
+    std::shared_ptr<FSearchLiveDatabase> liveDatabase;
     uint32_t maxResults = DEFAULT_MAX_RESULTS;
     FSearchCallbackFunc callbackFunc = nullptr;
     QMutex syncMutex;
@@ -0,0 +1,445 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "fsearchlivedatabase.h"
+
+extern "C" {
+#include "fsearch/fsearch.h"
+}
+
+#include <QMutex>
+#include <QList>
+#include <QSet>
+#include <QDir>
+#include <QCryptographicHash>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QFile>
+
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+#include <ctime>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+DPSEARCH_USE_NAMESPACE
+
+static constexpr int kMaxDatabases { 3 };
+static constexpr int kCheckpointInterval { 10 * 60 * 1000 };   // ms
+static constexpr uint32_t kWatchMask { IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB
+                                       | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK };
+
+namespace {
+struct DatabaseCache
+{
+    QMutex mutex;
+    // the most recently used one is at the end
+    QList<QPair<QString, std::shared_ptr<FSearchLiveDatabase>>> databases;
+    // the locations which have more directories than the inotify limit
+    QSet<QString> unwatchable;
+};
+
+QByteArray joinPath(const QByteArray &dir, const char *name)
+{
+    return dir == "/" ? dir + name : dir + '/' + name;
+}
+}   // namespace
+
+Q_GLOBAL_STATIC(DatabaseCache, databaseCache)
+
+FSearchLiveDatabase::FSearchLiveDatabase(const QString &path, const DatabaseConfig &config)
+    : rootPath(path.toLocal8Bit())
+{
+    db = db_new();
+    *db->db_config = config;
+}
+
+FSearchLiveDatabase::~FSearchLiveDatabase()
+{
+    if (watcher.joinable()) {
+        quit = true;
+        quint64 value = 1;
+        ssize_t ret = ::write(wakeFd, &value, sizeof(value));
+        Q_UNUSED(ret)
+        watcher.join();
+    }
+
+    if (inotifyFd >= 0)
+        ::close(inotifyFd);
+    if (wakeFd >= 0)
+        ::close(wakeFd);
+
+    // some changes may be missed if it is not live any more, keep the last checkpoint then
+    if (dirty && live)
+        checkpoint();
+
+    db_clear(db);
+    db_free(db);
+}
+
+/*!
+ * \brief FSearchLiveDatabase::acquire
+ * \return the shared database of `path`, nullptr if the location can not be watched,
+ * the caller should build a private database then.
+ * A new database is opened without holding the lock of the cache, so the searchers
+ * of the other locations are not blocked by the walk of the location.
+ */
+std::shared_ptr<FSearchLiveDatabase> FSearchLiveDatabase::acquire(const QString &path, const DatabaseConfig &config, bool *isStop)
+{
+    const QString &key = QString("%1|%2|%3").arg(path).arg(config.filter_hidden_file).arg(config.enable_py);
+    DatabaseCache *cache = databaseCache;
+    std::shared_ptr<FSearchLiveDatabase> outdated;
+    {
+        QMutexLocker lk(&cache->mutex);
+        if (cache->unwatchable.contains(path))
+            return nullptr;
+
+        for (int i = 0; i < cache->databases.count(); ++i) {
+            if (cache->databases.at(i).first != key)
+                continue;
+
+            auto database = cache->databases.takeAt(i).second;
+            if (!database->isLive()) {
+                // released after unlocking, the thread is joined in the destructor
+                outdated = database;
+                break;
+            }
+
+            cache->databases.append({ key, database });
+            return database;
+        }
+    }
+    outdated.reset();
+
+    std::shared_ptr<FSearchLiveDatabase> database(new FSearchLiveDatabase(path, config));
+    const bool opened = database->open(isStop);
+
+    // the evicted ones are released after unlocking and after their searches are finished
+    QList<QPair<QString, std::shared_ptr<FSearchLiveDatabase>>> evicted;
+    {
+        QMutexLocker lk(&cache->mutex);
+        if (!opened) {
+            if (database->unwatchable)
+                cache->unwatchable.insert(path);
+            // `database` is destroyed after unlocking
+            return nullptr;
+        }
+
+        // another searcher has opened the location meanwhile, share its database
+        for (const auto &item : cache->databases) {
+            if (item.first == key && item.second->isLive()) {
+                evicted.append({ key, database });
+                database = item.second;
+                break;
+            }
+        }
+
+        cache->databases.removeOne({ key, database });
+        cache->databases.append({ key, database });
+        while (cache->databases.count() > kMaxDatabases)
+            evicted.append(cache->databases.takeFirst());
+    }
+    return database;
+}
+
+Database *FSearchLiveDatabase::database() const
+{
+    return db;
+}
+
+bool FSearchLiveDatabase::isLive() const
+{
+    return live;
+}
+
+bool FSearchLiveDatabase::checkpoint()
+{
+    const QString &dir = checkpointPath();
+    if (!QDir().mkpath(dir)) {
+        fmWarning() << "fsearch: can not create the checkpoint directory" << dir;
+        return false;
+    }
+
+    lockForUpdate();
+    // the positions are stored in the database file
+    db_update_sort_index(db);
+
+    // the mtime has a resolution of one second, a directory changed in the second of its
+    // recorded mtime looks unchanged when the checkpoint is loaded, so rescan it then
+    const time_t recent = time(nullptr) - 1;
+    DynamicArray *entries = db_get_entries(db);
+    for (uint32_t i = 0; i < db_get_num_entries(db); ++i) {
+        auto node = static_cast<BTreeNode *>(darray_get_item(entries, i));
+        if (node && node->is_dir && node->mtime >= recent)
+            node->mtime = 0;
+    }
+    if (BTreeNode *root = db_node_find(db, rootPath.constData()))
+        root->mtime = root->mtime >= recent ? 0 : root->mtime;
+    bool ret = db_save_locations(db, dir.toLocal8Bit().data());
+    dirty = false;
+    db_unlock(db);
+    return ret;
+}
+
+void FSearchLiveDatabase::beginSearch()
+{
+    ++activeSearches;
+}
+
+void FSearchLiveDatabase::endSearch()
+{
+    --activeSearches;
+}
+
+bool FSearchLiveDatabase::open(bool *isStop)
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0) {
+        fmWarning() << "fsearch: can not create inotify instance:" << strerror(errno);
+        return false;
+    }
+
+    // loads the checkpoint, or walks the location if there is no one
+    dirty = !QFile::exists(checkpointPath() + "/database.db");
+    if (!load_database(db, rootPath.data(), checkpointPath().toLocal8Bit().data(), isStop) || *isStop)
+        return false;
+
+    BTreeNode *root = db_node_find(db, rootPath.constData());
+    if (!root)
+        return false;
+
+    // the watches are added before the search starts, so no change is lost after it
+    QByteArrayList outdatedDirs;
+    live = true;
+    watchTree(root, rootPath, &outdatedDirs);
+    if (!live) {
+        unwatchable = true;
+        return false;
+    }
+
+    syncDirs(outdatedDirs);
+    watcher = std::thread(&FSearchLiveDatabase::watch, this);
+    return true;
+}
+
+QString FSearchLiveDatabase::checkpointPath() const
+{
+    const QByteArray &key = rootPath + '|' + QByteArray::number(db->db_config->filter_hidden_file)
+            + '|' + QByteArray::number(db->db_config->enable_py);
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+            + "/deepin/dde-file-manager/fsearch/"
+            + QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex();
+}
+
+void FSearchLiveDatabase::watch()
+{
+    pollfd fds[2] { { inotifyFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+    // large enough for the events of a few hundred files
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    QElapsedTimer sinceCheckpoint;
+    sinceCheckpoint.start();
+    while (!quit && live) {
+        int ret = ::poll(fds, 2, kCheckpointInterval);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            fmWarning() << "fsearch: poll inotify failed:" << strerror(errno);
+            live = false;
+            return;
+        }
+
+        if (fds[1].revents & POLLIN)
+            return;
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t length = ::read(inotifyFd, buffer, sizeof(buffer));
+            if (length > 0)
+                handleEvents(buffer, length);
+        }
+
+        if (dirty && sinceCheckpoint.hasExpired(kCheckpointInterval)) {
+            checkpoint();
+            sinceCheckpoint.restart();
+        }
+    }
+}
+
+void FSearchLiveDatabase::lockForUpdate()
+{
+    db_lock(db);
+    while (activeSearches > 0) {
+        db_unlock(db);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        db_lock(db);
+    }
+}
+
+/*!
+ * \brief FSearchLiveDatabase::watchTree
+ * adds the watches of the directories under `node`, the directories changed after they were
+ * scanned are appended to `outdatedDirs`. Only the watcher changes the tree, so it is read without lock.
+ */
+void FSearchLiveDatabase::watchTree(BTreeNode *node, const QByteArray &path, QByteArrayList *outdatedDirs)
+{
+    int wd = inotify_add_watch(inotifyFd, path.constData(), kWatchMask);
+    if (wd < 0) {
+        if (errno == ENOSPC) {
+            fmWarning() << "fsearch: too many directories to watch in" << rootPath;
+            live = false;
+        }
+        return;
+    }
+    watches.insert(wd, path);
+
+    // the mtime has a resolution of one second, the recent ones can not tell whether
+    // the directory changed after it was scanned
+    struct stat st;
+    if (lstat(path.constData(), &st) == 0 && (st.st_mtime != node->mtime || st.st_mtime >= time(nullptr) - 1))
+        outdatedDirs->append(path);
+
+    for (BTreeNode *child = node->children; child && live; child = child->next) {
+        if (child->is_dir)
+            watchTree(child, joinPath(path, child->name), outdatedDirs);
+    }
+}
+
+void FSearchLiveDatabase::syncDirs(QByteArrayList dirs)
+{
+    while (!dirs.isEmpty() && live) {
+        // the sub directories found by the rescan have to be watched too
+        QList<QSet<QByteArray>> knownDirs;
+        for (const QByteArray &dir : dirs) {
+            QSet<QByteArray> names;
+            BTreeNode *node = db_node_find(db, dir.constData());
+            for (BTreeNode *child = node ? node->children : nullptr; child; child = child->next) {
+                if (child->is_dir)
+                    names.insert(child->name);
+            }
+            knownDirs.append(names);
+        }
+
+        lockForUpdate();
+        for (const QByteArray &dir : dirs)
+            db_node_sync_dir(db, dir.constData());
+        if (db_commit_changes(db))
+            dirty = true;
+        db_unlock(db);
+
+        QByteArrayList outdatedDirs;
+        for (int i = 0; i < dirs.count(); ++i) {
+            BTreeNode *node = db_node_find(db, dirs.at(i).constData());
+            for (BTreeNode *child = node ? node->children : nullptr; child && live; child = child->next) {
+                if (child->is_dir && !knownDirs.at(i).contains(child->name))
+                    watchTree(child, joinPath(dirs.at(i), child->name), &outdatedDirs);
+            }
+        }
+        dirs = outdatedDirs;
+    }
+}
+
+void FSearchLiveDatabase::handleEvents(const char *buffer, ssize_t length)
+{
+    QHash<quint32, QByteArray> movedFrom;
+    QByteArrayList newDirs;
+
+    lockForUpdate();
+    for (const char *ptr = buffer; ptr < buffer + length;) {
+        auto event = reinterpret_cast<const struct inotify_event *>(ptr);
+        ptr += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            // some changes are lost, the location is loaded again by the next searcher
+            fmWarning() << "fsearch: inotify queue overflow in" << rootPath;
+            live = false;
+            break;
+        }
+        if (event->mask & IN_IGNORED) {
+            watches.remove(event->wd);
+            continue;
+        }
+
+        const QByteArray &dir = watches.value(event->wd);
+        if (dir.isEmpty())
+            continue;
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+            if (dir == rootPath)
+                live = false;
+            continue;
+        }
+        if (event->len == 0)
+            continue;
+
+        const QByteArray &filePath = joinPath(dir, event->name);
+        const bool isDir = event->mask & IN_ISDIR;
+        if (event->mask & IN_MOVED_FROM) {
+            movedFrom.insert(event->cookie, filePath);
+        } else if (event->mask & IN_MOVED_TO) {
+            const QByteArray &from = movedFrom.take(event->cookie);
+            if (!from.isEmpty()) {
+                db_node_move(db, from.constData(), filePath.constData());
+                if (isDir) {
+                    // the watches of the sub directories may be not added yet when it is moved
+                    moveWatches(from, filePath);
+                    newDirs.append(filePath);
+                }
+            } else {
+                db_node_add(db, filePath.constData());
+                if (isDir)
+                    newDirs.append(filePath);
+            }
+        } else if (event->mask & IN_CREATE) {
+            db_node_add(db, filePath.constData());
+            if (isDir)
+                newDirs.append(filePath);
+        } else if (event->mask & IN_DELETE) {
+            db_node_remove(db, filePath.constData());
+        } else if (event->mask & (IN_CLOSE_WRITE | IN_ATTRIB)) {
+            db_node_add(db, filePath.constData());
+        }
+    }
+
+    // moved out of the location
+    for (const QByteArray &path : movedFrom) {
+        db_node_remove(db, path.constData());
+        removeWatches(path);
+    }
+
+    if (db_commit_changes(db))
+        dirty = true;
+    db_unlock(db);
+
+    QByteArrayList outdatedDirs;
+    for (const QByteArray &dir : newDirs) {
+        if (BTreeNode *node = db_node_find(db, dir.constData()))
+            watchTree(node, dir, &outdatedDirs);
+    }
+    syncDirs(outdatedDirs);
+}
+
+void FSearchLiveDatabase::moveWatches(const QByteArray &from, const QByteArray &to)
+{
+    for (auto iter = watches.begin(); iter != watches.end(); ++iter) {
+        const QByteArray &path = iter.value();
+        if (path == from || (path.startsWith(from) && path.at(from.length()) == '/'))
+            iter.value() = to + path.mid(from.length());
+    }
+}
+
+void FSearchLiveDatabase::removeWatches(const QByteArray &path)
+{
+    for (auto iter = watches.begin(); iter != watches.end();) {
+        if (iter.value() == path || (iter.value().startsWith(path) && iter.value().at(path.length()) == '/')) {
+            inotify_rm_watch(inotifyFd, iter.key());
+            iter = watches.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
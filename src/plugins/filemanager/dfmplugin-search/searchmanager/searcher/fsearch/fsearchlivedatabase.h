@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef FSEARCHLIVEDATABASE_H
+#define FSEARCHLIVEDATABASE_H
+
+#include "dfmplugin_search_global.h"
+
+extern "C" {
+#include "fsearch/database.h"
+}
+
+#include <QHash>
+#include <QByteArray>
+#include <QByteArrayList>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+DPSEARCH_BEGIN_NAMESPACE
+
+/*!
+ * \brief The FSearchLiveDatabase class
+ * the fsearch database of one location shared by the searchers of the process. It is kept up to date
+ * by a recursive inotify watcher, so searching again does not walk the location, and it is checkpointed
+ * to the cache directory periodically. A checkpoint is loaded when the location is searched in a new
+ * process, the directories whose mtime changed since the checkpoint are rescanned.
+ */
+class FSearchLiveDatabase
+{
+public:
+    ~FSearchLiveDatabase();
+
+    static std::shared_ptr<FSearchLiveDatabase> acquire(const QString &path, const DatabaseConfig &config, bool *isStop);
+
+    Database *database() const;
+    bool isLive() const;
+    bool checkpoint();
+
+    // the watcher does not change the database until the running searches are finished,
+    // both are called with the lock of the database held
+    void beginSearch();
+    void endSearch();
+
+private:
+    FSearchLiveDatabase(const QString &path, const DatabaseConfig &config);
+
+    bool open(bool *isStop);
+    QString checkpointPath() const;
+
+    void watch();
+    void lockForUpdate();
+    void watchTree(BTreeNode *node, const QByteArray &path, QByteArrayList *outdatedDirs);
+    void syncDirs(QByteArrayList dirs);
+    void handleEvents(const char *buffer, ssize_t length);
+    void moveWatches(const QByteArray &from, const QByteArray &to);
+    void removeWatches(const QByteArray &path);
+
+private:
+    QByteArray rootPath;
+    Database *db { nullptr };
+    std::atomic_bool live { false };
+    std::atomic_bool dirty { false };
+    std::atomic_int activeSearches { 0 };
+    std::atomic_bool quit { false };
+    bool unwatchable { false };
+
+    int inotifyFd { -1 };
+    int wakeFd { -1 };
+    std::thread watcher;
+    // wd -> directory, only used in the watcher thread
+    QHash<int, QByteArray> watches;
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // FSEARCHLIVEDATABASE_H
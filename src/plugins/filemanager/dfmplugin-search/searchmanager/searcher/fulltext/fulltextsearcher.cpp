@@ -4,6 +4,7 @@
 
 #include "fulltextsearcher.h"
 #include "fulltextsearcher_p.h"
+#include "indexwatcher.h"
 #include "fulltext/chineseanalyzer.h"
 #include "utils/searchhelper.h"
 
@@ -18,6 +19,7 @@
 #include <FilterIndexReader.h>
 #include <FuzzyQuery.h>
 #include <QueryWrapperFilter.h>
+#include <MapFieldSelector.h>
 
 #include <QRegExp>
 #include <QDebug>
@@ -26,9 +28,13 @@
 #include <QDir>
 #include <QTime>
 #include <QUrl>
+#include <QRegularExpression>
+#include <QThread>
+#include <QtConcurrent>
 
 #include <dirent.h>
 #include <exception>
+#include <functional>
 #include <docparser.h>
 
 static constexpr char kFilterFolders[] = "^/(boot|dev|proc|sys|run|lib|usr).*$";
@@ -38,6 +44,9 @@ static constexpr char kSupportFiles[] = "(rtf)|(odt)|(ods)|(odp)|(odg)|(docx)|(x
                                         "(json)|(css)|(yaml)|(ini)|(bat)|(js)|(sql)|(uof)|(ofd)";
 static int kMaxResultNum = 100000;   // 最大搜索结果数
 static int kEmitInterval = 50;   // 推送时间间隔
+static constexpr int kBatchFactor = 4;   // 每批提取内容的文件数是线程数的倍数
+static constexpr double kRamBufferSize = 64;   // 索引写入的缓存(MB)
+static constexpr qint64 kRescanInterval = 10 * 60;   // 无法监视的目录重新扫描的时间间隔(秒)
 
 using namespace Lucene;
 DFMBASE_USE_NAMESPACE
@@ -46,6 +55,7 @@ DPSEARCH_USE_NAMESPACE
 bool FullTextSearcherPrivate::isIndexCreating = false;
 FullTextSearcherPrivate::FullTextSearcherPrivate(FullTextSearcher *parent)
     : QObject(parent),
+      journal(IndexJournal::instance()),
       q(parent)
 {
     bindPathTable = DeviceUtils::fstabBindInfo();
@@ -68,26 +78,65 @@ IndexReaderPtr FullTextSearcherPrivate::newIndexReader()
     return IndexReader::open(FSDirectory::open(indexStorePath().toStdWString()), true);
 }
 
-void FullTextSearcherPrivate::doIndexTask(const IndexReaderPtr &reader, const IndexWriterPtr &writer, const QString &path, TaskType type)
+void FullTextSearcherPrivate::doIndexTask(const IndexWriterPtr &writer, const QString &path, TaskType type)
 {
-    if (status.loadAcquire() != AbstractSearcher::kRuning)
+    if (status.loadAcquire() != AbstractSearcher::kRuning || isFilterDirectory(path))
         return;
 
-    // filter some folders
-    static QRegExp reg(kFilterFolders);
-    if (bindPathTable.contains(path) || (reg.exactMatch(path) && !path.startsWith("/run/user")))
+    // QtConcurrent of Qt5 can not deduce the result type of lambda
+    const std::function<ScanResult(const QString &)> scan = [this](const QString &dir) {
+        return scanDirectory(dir);
+    };
+    QList<IndexTask> tasks;
+    QSet<QString> foundFiles;
+    // walk the tree level by level, the directories of one level are scanned in parallel
+    QStringList level { path };
+    while (!level.isEmpty() && status.loadAcquire() == AbstractSearcher::kRuning) {
+        const QList<ScanResult> &results = QtConcurrent::blockingMapped<QList<ScanResult>>(level, scan);
+
+        level.clear();
+        for (const ScanResult &result : results) {
+            level.append(result.dirs);
+            for (const auto &file : result.files) {
+                if (type == kCreate) {
+                    tasks.append({ file.first, file.second, kAddIndex });
+                    continue;
+                }
+
+                foundFiles.insert(file.first);
+                if (journal->isChanged(file.first, file.second))
+                    tasks.append({ file.first, file.second, kUpdateIndex });
+            }
+        }
+    }
+
+    // the files which are not found in an interrupted walk may still exist
+    if (status.loadAcquire() != AbstractSearcher::kRuning)
         return;
 
+    if (type == kUpdate) {
+        for (const QString &file : journal->indexedFiles(path)) {
+            if (!foundFiles.contains(file))
+                tasks.append({ file, FileStamp(), kDeleteIndex });
+        }
+    }
+
+    indexFiles(writer, tasks);
+}
+
+FullTextSearcherPrivate::ScanResult FullTextSearcherPrivate::scanDirectory(const QString &path) const
+{
+    ScanResult result;
     // limit file name length and level
     if (path.size() > FILENAME_MAX - 1 || path.count('/') > 20)
-        return;
+        return result;
 
-    const std::string tmp = path.toStdString();
-    const char *filePath = tmp.c_str();
+    const QByteArray &tmp = QFile::encodeName(path);
+    const char *filePath = tmp.constData();
     DIR *dir = nullptr;
     if (!(dir = opendir(filePath))) {
         fmWarning() << "can not open: " << path;
-        return;
+        return result;
     }
 
     struct dirent *dent = nullptr;
@@ -105,59 +154,129 @@ void FullTextSearcherPrivate::doIndexTask(const IndexReaderPtr &reader, const In
         if (!strcmp(dent->d_name, ".") || !strcmp(dent->d_name, ".."))
             continue;
 
+        // only stat the directories of unknown type and the supported files
+        const bool isDir = dent->d_type == DT_DIR;
+        if (!isDir && dent->d_type != DT_UNKNOWN && !isSupportFile(QFile::decodeName(dent->d_name)))
+            continue;
+
         struct stat st;
         strncpy(fn + len, dent->d_name, FILENAME_MAX - len);
-        if (lstat(fn, &st) == -1)
+        if (!isDir && lstat(fn, &st) == -1)
             continue;
 
-        const bool is_dir = S_ISDIR(st.st_mode);
-        if (is_dir) {
-            doIndexTask(reader, writer, fn, type);
-        } else {
-            auto info = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(fn));
-            if (!info) continue;
-
-            QString suffix = info->nameOf(NameInfoType::kSuffix);
-            static QRegExp suffixRegExp(kSupportFiles);
-            if (suffixRegExp.exactMatch(suffix)) {
-                switch (type) {
-                case kCreate:
-                    indexDocs(writer, fn, kAddIndex);
-                    break;
-                case kUpdate:
-                    IndexType type;
-                    if (checkUpdate(reader, fn, type)) {
-                        indexDocs(writer, fn, type);
-                        isUpdated = true;
-                    }
-                    break;
-                }
-            }
+        const QString &file = QFile::decodeName(fn);
+        if (isDir || S_ISDIR(st.st_mode)) {
+            if (!isFilterDirectory(file))
+                result.dirs.append(file);
+        } else if (isSupportFile(file)) {
+            result.files.append({ file, FileStamp { st.st_mtime, st.st_size } });
+        }
+    }
+
+    closedir(dir);
+    return result;
+}
+
+bool FullTextSearcherPrivate::isFilterDirectory(const QString &path) const
+{
+    return isFilterDirectory(path, bindPathTable);
+}
+
+bool FullTextSearcherPrivate::isFilterDirectory(const QString &path, const QMap<QString, QString> &bindPathTable)
+{
+    // filter some folders
+    static const QRegularExpression reg(kFilterFolders);
+    return bindPathTable.contains(path) || (reg.match(path).hasMatch() && !path.startsWith("/run/user"));
+}
+/*!
+ * \brief FullTextSearcherPrivate::indexFiles
+ * the contents are extracted by the thread pool in batches, and then written by the only writer in current thread
+ */
+void FullTextSearcherPrivate::indexFiles(const IndexWriterPtr &writer, const QList<IndexTask> &tasks)
+{
+    const std::function<DocumentPtr(const IndexTask &)> parse = [this](const IndexTask &task) {
+        if (task.type == kDeleteIndex)
+            return DocumentPtr();
+
+        try {
+            return fileDocument(task.path, task.stamp);
+        } catch (const LuceneException &e) {
+            fmWarning() << QString::fromStdWString(e.getError()) << " file: " << task.path;
+        } catch (const std::exception &e) {
+            fmWarning() << QString(e.what()) << " file: " << task.path;
+        } catch (...) {
+            fmWarning() << "Parse document failed! " << task.path;
+        }
+        return DocumentPtr();
+    };
+    const int batchSize = qMax(1, QThread::idealThreadCount()) * kBatchFactor;
+    for (int i = 0; i < tasks.count() && status.loadAcquire() == AbstractSearcher::kRuning; i += batchSize) {
+        const QList<IndexTask> &batch = tasks.mid(i, batchSize);
+        const QList<DocumentPtr> &docs = QtConcurrent::blockingMapped<QList<DocumentPtr>>(batch, parse);
+
+        for (int j = 0; j < batch.count(); ++j) {
+            const IndexTask &task = batch.at(j);
+            if (!indexDocs(writer, task.path, task.type, docs.at(j)))
+                continue;
+
+            if (task.type == kDeleteIndex)
+                journal->remove(task.path);
+            else
+                journal->update(task.path, task.stamp);
+        }
+    }
+}
+/*!
+ * \brief FullTextSearcherPrivate::indexChangedFiles
+ * update the index with the files recorded by file operations, the directories are walked,
+ * the removed ones are deleted from the index with all of their children.
+ */
+void FullTextSearcherPrivate::indexChangedFiles(const IndexWriterPtr &writer, const QStringList &paths)
+{
+    QList<IndexTask> tasks;
+    for (const QString &path : paths) {
+        struct stat st;
+        if (lstat(QFile::encodeName(path).constData(), &st) == -1) {
+            for (const QString &file : journal->indexedFiles(path))
+                tasks.append({ file, FileStamp(), kDeleteIndex });
+            continue;
+        }
+
+        if (S_ISDIR(st.st_mode)) {
+            doIndexTask(writer, path, kUpdate);
+            continue;
         }
+
+        const FileStamp stamp { st.st_mtime, st.st_size };
+        if (isSupportFile(path) && journal->isChanged(path, stamp))
+            tasks.append({ path, stamp, kUpdateIndex });
     }
 
-    if (dir)
-        closedir(dir);
+    indexFiles(writer, tasks);
 }
 
-void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QString &file, IndexType type)
+bool FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QString &file, IndexType type, const DocumentPtr &doc)
 {
     Q_ASSERT(writer);
 
     try {
         switch (type) {
         case kAddIndex: {
+            if (!doc)
+                return false;
             fmDebug() << "Adding [" << file << "]";
             // 添加
-            writer->addDocument(fileDocument(file));
+            writer->addDocument(doc);
             break;
         }
         case kUpdateIndex: {
+            if (!doc)
+                return false;
             fmDebug() << "Update file: [" << file << "]";
             // 定义一个更新条件
             TermPtr term = newLucene<Term>(L"path", file.toStdWString());
             // 更新
-            writer->updateDocument(term, fileDocument(file));
+            writer->updateDocument(term, doc);
             break;
         }
         case kDeleteIndex: {
@@ -169,6 +288,7 @@ void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QStr
             break;
         }
         }
+        return true;
     } catch (const LuceneException &e) {
         QMetaEnum enumType = QMetaEnum::fromType<FullTextSearcherPrivate::IndexType>();
         fmWarning() << QString::fromStdWString(e.getError()) << " type: " << enumType.valueToKey(type);
@@ -178,45 +298,43 @@ void FullTextSearcherPrivate::indexDocs(const IndexWriterPtr &writer, const QStr
     } catch (...) {
         fmWarning() << "Index document failed! " << file;
     }
+    return false;
 }
-
-bool FullTextSearcherPrivate::checkUpdate(const IndexReaderPtr &reader, const QString &file, IndexType &type)
+/*!
+ * \brief FullTextSearcherPrivate::importJournal
+ * the index created by older versions has no journal, import the paths and modified times from the index,
+ * so the files are not indexed again.
+ */
+void FullTextSearcherPrivate::importJournal()
 {
-    Q_ASSERT(reader);
-
-    try {
-        SearcherPtr searcher = newLucene<IndexSearcher>(reader);
-        TermQueryPtr query = newLucene<TermQuery>(newLucene<Term>(L"path", file.toStdWString()));
-
-        // 文件路径为唯一值，所以搜索一个结果就行了
-        TopDocsPtr topDocs = searcher->search(query, 1);
-        int32_t numTotalHits = topDocs->totalHits;
-        if (numTotalHits == 0) {
-            type = kAddIndex;
-            return true;
-        } else {
-            DocumentPtr doc = searcher->doc(topDocs->scoreDocs[0]->doc);
-            auto info = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(file));
-            if (!info)
-                return false;
+    IndexReaderPtr reader = newIndexReader();
+    FieldSelectorPtr selector = newLucene<MapFieldSelector>(newCollection<String>(L"path", L"modified"));
+    for (int32_t i = 0; i < reader->maxDoc(); ++i) {
+        if (reader->isDeleted(i))
+            continue;
 
-            const QDateTime &modifyTime { info->timeOf(TimeInfoType::kLastModified).toDateTime() };
-            const QString &modifyEpoch { QString::number(modifyTime.toSecsSinceEpoch()) };
-            const String &storeTime { doc->get(L"modified") };
-            if (modifyEpoch.toStdWString() != storeTime) {
-                type = kUpdateIndex;
-                return true;
-            }
-        }
-    } catch (const LuceneException &e) {
-        fmWarning() << QString::fromStdWString(e.getError()) << " file: " << file;
-    } catch (const std::exception &e) {
-        fmWarning() << QString(e.what()) << " file: " << file;
-    } catch (...) {
-        fmWarning() << "The file checked failed!" << file;
+        DocumentPtr doc = reader->document(i, selector);
+        const QString &path = QString::fromStdWString(doc->get(L"path"));
+        if (!path.isEmpty())
+            journal->update(path, FileStamp { QString::fromStdWString(doc->get(L"modified")).toLongLong(), -1 });
     }
+    reader->close();
+}
 
-    return false;
+bool FullTextSearcherPrivate::isSupportFile(const QString &fileName)
+{
+    static const QSet<QString> kSuffixes = [] {
+        QSet<QString> suffixes;
+        for (QString suffix : QString(kSupportFiles).split('|'))
+            suffixes.insert(suffix.remove('(').remove(')'));
+        return suffixes;
+    }();
+
+    const int pos = fileName.lastIndexOf('.');
+    if (pos < 0 || fileName.indexOf('/', pos) >= 0)
+        return false;
+
+    return kSuffixes.contains(fileName.mid(pos + 1));
 }
 
 void FullTextSearcherPrivate::tryNotify()
@@ -229,16 +347,14 @@ void FullTextSearcherPrivate::tryNotify()
     }
 }
 
-DocumentPtr FullTextSearcherPrivate::fileDocument(const QString &file)
+DocumentPtr FullTextSearcherPrivate::fileDocument(const QString &file, const FileStamp &stamp)
 {
     DocumentPtr doc = newLucene<Document>();
     // file path
     doc->add(newLucene<Field>(L"path", file.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
 
     // file last modified time
-    auto info = InfoFactory::create<FileInfo>(QUrl::fromLocalFile(file));
-    const QDateTime &modifyTime { info->timeOf(TimeInfoType::kLastModified).toDateTime() };
-    const QString &modifyEpoch { QString::number(modifyTime.toSecsSinceEpoch()) };
+    const QString &modifyEpoch { QString::number(stamp.modified) };
     doc->add(newLucene<Field>(L"modified", modifyEpoch.toStdWString(), Field::STORE_YES, Field::INDEX_NOT_ANALYZED));
 
     // file contents
@@ -274,13 +390,20 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
         QTime timer;
         timer.start();
         IndexWriterPtr writer = newIndexWriter(true);
+        writer->setRAMBufferSizeMB(kRamBufferSize);
         fmInfo() << "Indexing to directory: " << indexStorePath();
 
         writer->deleteAll();
-        doIndexTask(nullptr, writer, path, kCreate);
+        journal->clear();
+        // the changes made after the watcher started are recorded, the next update does not walk again
+        IndexWatcher::watch(path, journal, bindPathTable);
+        const qint64 startTime = QDateTime::currentSecsSinceEpoch();
+        doIndexTask(writer, path, kCreate);
         writer->optimize();
         writer->close();
 
+        journal->setLastScanTime(path, startTime);
+        journal->save();
         fmInfo() << "create index spending: " << timer.elapsed();
         status.storeRelease(AbstractSearcher::kCompleted);
         return true;
@@ -296,19 +419,39 @@ bool FullTextSearcherPrivate::createIndex(const QString &path)
     return false;
 }
 
+/*!
+ * \brief FullTextSearcherPrivate::updateIndex
+ * the changes recorded by file operations and by the inotify watcher of the location are indexed before searching.
+ * The directory is walked again only when the watcher started after the last walk, to find the changes made
+ * while it was not watched. A location which can not be watched is walked if it has not been walked in
+ * kRescanInterval, the changes made by other applications are not found in that window.
+ */
 bool FullTextSearcherPrivate::updateIndex(const QString &path)
 {
     QString bindPath = FileUtils::bindPathTransform(path, false);
     try {
-        IndexReaderPtr reader = newIndexReader();
-        IndexWriterPtr writer = newIndexWriter();
+        if (journal->isEmpty())
+            importJournal();
 
-        doIndexTask(reader, writer, bindPath, kUpdate);
+        IndexWriterPtr writer = newIndexWriter();
+        writer->setRAMBufferSizeMB(kRamBufferSize);
+
+        // the watches are added before the changes are taken, no change is lost between them
+        const qint64 watchedSince = IndexWatcher::watch(bindPath, journal, bindPathTable);
+        const qint64 now = QDateTime::currentSecsSinceEpoch();
+        const qint64 lastScanTime = journal->lastScanTime(bindPath);
+        const QStringList &changes = journal->takeChanges(bindPath);
+        indexChangedFiles(writer, changes);
+        if (watchedSince < 0 ? now - lastScanTime > kRescanInterval : lastScanTime < watchedSince) {
+            doIndexTask(writer, bindPath, kUpdate);
+            if (status.loadAcquire() == AbstractSearcher::kRuning)
+                journal->setLastScanTime(bindPath, now);
+        }
+        if (status.loadAcquire() != AbstractSearcher::kRuning)
+            journal->markChanged(changes);
 
-        writer->optimize();
         writer->close();
-        reader->close();
-
+        journal->save();
         return true;
     } catch (const LuceneException &e) {
         fmWarning() << QString::fromStdWString(e.getError());
@@ -318,6 +461,8 @@ bool FullTextSearcherPrivate::updateIndex(const QString &path)
         fmWarning() << "The file index updated failed!";
     }
 
+    // drop the records which are not written to index
+    journal->load();
     return false;
 }
 
@@ -363,7 +508,8 @@ bool FullTextSearcherPrivate::doSearch(const QString &path, const QString &keywo
                 auto info = InfoFactory::create<FileInfo>(url);
                 // delete invalid index
                 if (!info || !info->exists()) {
-                    indexDocs(writer, url.path(), kDeleteIndex);
+                    if (indexDocs(writer, url.path(), kDeleteIndex))
+                        journal->remove(url.path());
                     continue;
                 }
 
@@ -468,6 +614,24 @@ bool FullTextSearcher::isSupport(const QUrl &url)
             .toBool();
 }
 
+/*!
+ * \brief FullTextSearcher::recordChanges 记录文件操作修改的文件，下次搜索前更新这些文件的索引
+ */
+void FullTextSearcher::recordChanges(const QList<QUrl> &urls)
+{
+    if (urls.isEmpty() || !isSupport(urls.first()))
+        return;
+
+    QStringList paths;
+    for (const QUrl &url : urls) {
+        if (url.isLocalFile())
+            paths.append(FileUtils::bindPathTransform(url.path(), false));
+    }
+
+    if (!paths.isEmpty())
+        IndexJournal::instance()->markChanged(paths);
+}
+
 bool FullTextSearcher::search()
 {
     if (d->isIndexCreating)
@@ -19,6 +19,9 @@ class FullTextSearcher : public AbstractSearcher
     friend class MainController;
     friend class FullTextSearcherPrivate;
 
+public:
+    static void recordChanges(const QList<QUrl> &urls);
+
 private:
     explicit FullTextSearcher(const QUrl &url, const QString &key, QObject *parent = nullptr);
     bool createIndex(const QString &path);
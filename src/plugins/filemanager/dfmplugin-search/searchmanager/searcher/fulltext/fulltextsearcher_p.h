@@ -6,6 +6,7 @@
 #define FULLTEXTSEARCHER_P_H
 
 #include "searchmanager/searcher/abstractsearcher.h"
+#include "indexjournal.h"
 
 #include <lucene++/LuceneHeaders.h>
 
@@ -21,6 +22,8 @@ class FullTextSearcherPrivate : public QObject
 {
     Q_OBJECT
     friend class FullTextSearcher;
+    friend class IndexJournal;
+    friend class IndexWatcher;
 
 public:
     enum WordType {
@@ -42,6 +45,19 @@ public:
     };
     Q_ENUM(IndexType)
 
+    struct IndexTask
+    {
+        QString path;
+        FileStamp stamp;
+        IndexType type { kAddIndex };
+    };
+
+    struct ScanResult
+    {
+        QStringList dirs;
+        QList<QPair<QString, FileStamp>> files;
+    };
+
     explicit FullTextSearcherPrivate(FullTextSearcher *parent);
     ~FullTextSearcherPrivate();
 
@@ -59,19 +75,27 @@ private:
         return path;
     }
 
-    Lucene::DocumentPtr fileDocument(const QString &file);
+    Lucene::DocumentPtr fileDocument(const QString &file, const FileStamp &stamp);
     QString dealKeyword(const QString &keyword);
-    void doIndexTask(const Lucene::IndexReaderPtr &reader, const Lucene::IndexWriterPtr &writer, const QString &path, TaskType type);
-    void indexDocs(const Lucene::IndexWriterPtr &writer, const QString &file, IndexType type);
-    bool checkUpdate(const Lucene::IndexReaderPtr &reader, const QString &file, IndexType &type);
+    void doIndexTask(const Lucene::IndexWriterPtr &writer, const QString &path, TaskType type);
+    ScanResult scanDirectory(const QString &path) const;
+    bool isFilterDirectory(const QString &path) const;
+    static bool isFilterDirectory(const QString &path, const QMap<QString, QString> &bindPathTable);
+    void indexFiles(const Lucene::IndexWriterPtr &writer, const QList<IndexTask> &tasks);
+    void indexChangedFiles(const Lucene::IndexWriterPtr &writer, const QStringList &paths);
+    bool indexDocs(const Lucene::IndexWriterPtr &writer, const QString &file, IndexType type,
+                   const Lucene::DocumentPtr &doc = Lucene::DocumentPtr());
+    void importJournal();
     void tryNotify();
 
-    bool isUpdated = false;
+    static bool isSupportFile(const QString &fileName);
+
     QAtomicInt status = AbstractSearcher::kReady;
     QList<QUrl> allResults;
     mutable QMutex mutex;
     static bool isIndexCreating;
     QMap<QString, QString> bindPathTable;
+    IndexJournal *journal { nullptr };   // the journal of the index, the tests use their own
 
     //计时
     QTime notifyTimer;
@@ -0,0 +1,206 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "indexjournal.h"
+#include "fulltextsearcher_p.h"
+#include "indexwatcher.h"
+
+#include <QSaveFile>
+#include <QDataStream>
+#include <QFile>
+
+static constexpr quint32 kJournalMagic { 0x464A524E };   // "FJRN"
+static constexpr quint32 kJournalVersion { 1 };
+// 记录的变更太多时不再逐个处理，放弃扫描记录，下次搜索时重新扫描
+static constexpr int kMaxChanges { 10000 };
+
+DPSEARCH_USE_NAMESPACE
+
+IndexJournal *IndexJournal::instance()
+{
+    static IndexJournal ins(FullTextSearcherPrivate::indexStorePath() + ".journal");
+    return &ins;
+}
+
+IndexJournal::IndexJournal(const QString &filePath)
+    : filePath(filePath)
+{
+    load();
+}
+
+IndexJournal::~IndexJournal()
+{
+    IndexWatcher::release(this);
+}
+
+bool IndexJournal::load()
+{
+    QWriteLocker lk(&lock);
+    files.clear();
+    changes.clear();
+    scans.clear();
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    stream >> magic >> version;
+    if (magic != kJournalMagic || version != kJournalVersion) {
+        fmWarning() << "invalid full-text index journal: " << filePath;
+        return false;
+    }
+
+    qint32 count = 0;
+    stream >> count;
+    files.reserve(count);
+    for (qint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        QString path;
+        FileStamp stamp;
+        stream >> path >> stamp.modified >> stamp.size;
+        files.insert(path, stamp);
+    }
+    stream >> changes >> scans;
+
+    if (stream.status() != QDataStream::Ok) {
+        fmWarning() << "broken full-text index journal: " << filePath;
+        files.clear();
+        changes.clear();
+        scans.clear();
+        return false;
+    }
+    return true;
+}
+
+bool IndexJournal::save()
+{
+    QReadLocker lk(&lock);
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        fmWarning() << "can not save full-text index journal: " << filePath;
+        return false;
+    }
+
+    QDataStream stream(&file);
+    stream << kJournalMagic << kJournalVersion << static_cast<qint32>(files.count());
+    for (auto iter = files.cbegin(); iter != files.cend(); ++iter)
+        stream << iter.key() << iter.value().modified << iter.value().size;
+    stream << changes << scans;
+
+    return file.commit();
+}
+
+void IndexJournal::clear()
+{
+    QWriteLocker lk(&lock);
+    files.clear();
+    changes.clear();
+    scans.clear();
+}
+
+bool IndexJournal::isEmpty() const
+{
+    QReadLocker lk(&lock);
+    return files.isEmpty();
+}
+
+bool IndexJournal::isChanged(const QString &path, const FileStamp &stamp) const
+{
+    QReadLocker lk(&lock);
+    auto iter = files.constFind(path);
+    if (iter == files.cend())
+        return true;
+
+    // the size is unknown for the records imported from the index
+    return iter->modified != stamp.modified || (iter->size >= 0 && iter->size != stamp.size);
+}
+
+void IndexJournal::update(const QString &path, const FileStamp &stamp)
+{
+    QWriteLocker lk(&lock);
+    files.insert(path, stamp);
+}
+
+void IndexJournal::remove(const QString &path)
+{
+    QWriteLocker lk(&lock);
+    files.remove(path);
+}
+
+QStringList IndexJournal::indexedFiles(const QString &dir) const
+{
+    QReadLocker lk(&lock);
+    QStringList result;
+    for (auto iter = files.cbegin(); iter != files.cend(); ++iter) {
+        if (isUnder(iter.key(), dir))
+            result.append(iter.key());
+    }
+    return result;
+}
+
+void IndexJournal::markChanged(const QStringList &paths)
+{
+    QWriteLocker lk(&lock);
+    for (const QString &path : paths)
+        changes.insert(path);
+
+    if (changes.count() > kMaxChanges) {
+        changes.clear();
+        scans.clear();
+    }
+}
+
+QStringList IndexJournal::takeChanges(const QString &dir)
+{
+    QWriteLocker lk(&lock);
+    QStringList result;
+    for (auto iter = changes.begin(); iter != changes.end();) {
+        if (isUnder(*iter, dir)) {
+            result.append(*iter);
+            iter = changes.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    return result;
+}
+/*!
+ * \brief IndexJournal::lastScanTime
+ * \return the last time when `path` or one of its parents was fully scanned, 0 if never scanned
+ */
+qint64 IndexJournal::lastScanTime(const QString &path) const
+{
+    QReadLocker lk(&lock);
+    qint64 time = 0;
+    for (auto iter = scans.cbegin(); iter != scans.cend(); ++iter) {
+        if (isUnder(path, iter.key()))
+            time = qMax(time, iter.value());
+    }
+    return time;
+}
+
+void IndexJournal::setLastScanTime(const QString &dir, qint64 time)
+{
+    QWriteLocker lk(&lock);
+    for (auto iter = scans.begin(); iter != scans.end();) {
+        if (isUnder(iter.key(), dir))
+            iter = scans.erase(iter);
+        else
+            ++iter;
+    }
+    scans.insert(dir, time);
+}
+
+bool IndexJournal::isUnder(const QString &path, const QString &dir)
+{
+    if (dir == "/" || path == dir)
+        return true;
+
+    if (dir.endsWith('/'))
+        return path.startsWith(dir);
+
+    return path.startsWith(dir) && path.length() > dir.length() && path.at(dir.length()) == '/';
+}
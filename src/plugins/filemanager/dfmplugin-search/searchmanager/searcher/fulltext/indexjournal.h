@@ -0,0 +1,63 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef INDEXJOURNAL_H
+#define INDEXJOURNAL_H
+
+#include "dfmplugin_search_global.h"
+
+#include <QHash>
+#include <QSet>
+#include <QStringList>
+#include <QReadWriteLock>
+
+DPSEARCH_BEGIN_NAMESPACE
+
+struct FileStamp
+{
+    qint64 modified { 0 };   // seconds since epoch, same as the "modified" field in index
+    qint64 size { -1 };   // -1 means unknown
+};
+
+/*!
+ * \brief The IndexJournal class 全文索引的变更日志
+ * 持久化记录已经索引的文件的修改时间和大小，更新索引时直接和它比较，不需要逐个文件查询Lucene；
+ * 同时记录文件操作和IndexWatcher监视到的变更，搜索前只处理这些文件；监视开始之后没有遍历过的目录才重新遍历。
+ */
+class IndexJournal
+{
+public:
+    static IndexJournal *instance();
+    explicit IndexJournal(const QString &filePath);
+    ~IndexJournal();
+
+    bool load();
+    bool save();
+    void clear();
+    bool isEmpty() const;
+
+    bool isChanged(const QString &path, const FileStamp &stamp) const;
+    void update(const QString &path, const FileStamp &stamp);
+    void remove(const QString &path);
+    QStringList indexedFiles(const QString &dir) const;
+
+    void markChanged(const QStringList &paths);
+    QStringList takeChanges(const QString &dir);
+
+    qint64 lastScanTime(const QString &path) const;
+    void setLastScanTime(const QString &dir, qint64 time);
+
+    static bool isUnder(const QString &path, const QString &dir);
+
+private:
+    QString filePath;
+    mutable QReadWriteLock lock;
+    QHash<QString, FileStamp> files;
+    QSet<QString> changes;
+    QHash<QString, qint64> scans;
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // INDEXJOURNAL_H
@@ -0,0 +1,321 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "indexwatcher.h"
+#include "indexjournal.h"
+#include "fulltextsearcher_p.h"
+
+#include <QMutex>
+#include <QList>
+#include <QSet>
+#include <QFile>
+#include <QDateTime>
+
+#include <cerrno>
+#include <cstring>
+
+#include <dirent.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+
+DPSEARCH_USE_NAMESPACE
+
+static constexpr int kMaxWatchers { 3 };
+static constexpr int kMaxDepth { 20 };   // same as the walk of the index
+static constexpr uint32_t kWatchMask { IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB
+                                       | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR | IN_DONT_FOLLOW | IN_EXCL_UNLINK };
+
+namespace {
+struct WatcherCache
+{
+    QMutex mutex;
+    // the most recently used one is at the end
+    QList<std::shared_ptr<IndexWatcher>> watchers;
+    // the locations which have more directories than the inotify limit
+    QSet<QString> unwatchable;
+};
+
+QByteArray joinPath(const QByteArray &dir, const char *name)
+{
+    return dir == "/" ? dir + name : dir + '/' + name;
+}
+}   // namespace
+
+Q_GLOBAL_STATIC(WatcherCache, watcherCache)
+
+IndexWatcher::IndexWatcher(const QString &path, IndexJournal *journal, const QMap<QString, QString> &bindPathTable)
+    : rootPath(QFile::encodeName(path)), journal(journal), bindPathTable(bindPathTable)
+{
+}
+
+IndexWatcher::~IndexWatcher()
+{
+    if (watcher.joinable()) {
+        quit = true;
+        quint64 value = 1;
+        ssize_t ret = ::write(wakeFd, &value, sizeof(value));
+        Q_UNUSED(ret)
+        watcher.join();
+    }
+
+    if (inotifyFd >= 0)
+        ::close(inotifyFd);
+    if (wakeFd >= 0)
+        ::close(wakeFd);
+}
+
+/*!
+ * \brief IndexWatcher::watch
+ * the watcher of `path` or one of its parents is reused, a new one is built without holding
+ * the lock of the cache, the directories of the location are walked to add the watches.
+ */
+qint64 IndexWatcher::watch(const QString &path, IndexJournal *journal, const QMap<QString, QString> &bindPathTable)
+{
+    WatcherCache *cache = watcherCache;
+    std::shared_ptr<IndexWatcher> outdated;
+    {
+        QMutexLocker lk(&cache->mutex);
+        if (cache->unwatchable.contains(path))
+            return -1;
+
+        for (int i = 0; i < cache->watchers.count(); ++i) {
+            const auto &watcher = cache->watchers.at(i);
+            if (watcher->journal != journal || !IndexJournal::isUnder(path, QFile::decodeName(watcher->rootPath)))
+                continue;
+
+            if (!watcher->live) {
+                // released after unlocking, the thread is joined in the destructor
+                outdated = cache->watchers.takeAt(i);
+                break;
+            }
+
+            cache->watchers.move(i, cache->watchers.count() - 1);
+            return watcher->startTime;
+        }
+    }
+    outdated.reset();
+
+    std::shared_ptr<IndexWatcher> watcher(new IndexWatcher(path, journal, bindPathTable));
+    const bool opened = watcher->open();
+
+    QList<std::shared_ptr<IndexWatcher>> evicted;
+    {
+        QMutexLocker lk(&cache->mutex);
+        if (!opened) {
+            if (watcher->unwatchable)
+                cache->unwatchable.insert(path);
+            return -1;
+        }
+
+        cache->watchers.append(watcher);
+        while (cache->watchers.count() > kMaxWatchers)
+            evicted.append(cache->watchers.takeFirst());
+    }
+    return watcher->startTime;
+}
+
+void IndexWatcher::release(const IndexJournal *journal)
+{
+    // the cache is destroyed before the global journal
+    if (!watcherCache.exists())
+        return;
+
+    // released after unlocking
+    QList<std::shared_ptr<IndexWatcher>> released;
+    WatcherCache *cache = watcherCache;
+    QMutexLocker lk(&cache->mutex);
+    for (auto iter = cache->watchers.begin(); iter != cache->watchers.end();) {
+        if ((*iter)->journal == journal) {
+            released.append(*iter);
+            iter = cache->watchers.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+bool IndexWatcher::open()
+{
+    inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (inotifyFd < 0 || wakeFd < 0) {
+        fmWarning() << "full-text: can not create inotify instance:" << strerror(errno);
+        return false;
+    }
+
+    // the changes made while adding the watches are found by the walk after it
+    startTime = QDateTime::currentSecsSinceEpoch();
+    live = true;
+    watchTree(rootPath);
+    if (!live)
+        return false;
+
+    watcher = std::thread(&IndexWatcher::run, this);
+    return true;
+}
+
+void IndexWatcher::run()
+{
+    pollfd fds[2] { { inotifyFd, POLLIN, 0 }, { wakeFd, POLLIN, 0 } };
+    // large enough for the events of a few hundred files
+    char buffer[64 * 1024] __attribute__((aligned(__alignof__(struct inotify_event))));
+    while (!quit && live) {
+        int ret = ::poll(fds, 2, -1);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            fmWarning() << "full-text: poll inotify failed:" << strerror(errno);
+            live = false;
+            return;
+        }
+
+        if (fds[1].revents & POLLIN)
+            return;
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t length = ::read(inotifyFd, buffer, sizeof(buffer));
+            if (length > 0)
+                handleEvents(buffer, length);
+        }
+    }
+}
+
+void IndexWatcher::watchTree(const QByteArray &path)
+{
+    QByteArrayList dirs { path };
+    while (!dirs.isEmpty() && live) {
+        const QByteArray dir = dirs.takeLast();
+        int wd = inotify_add_watch(inotifyFd, dir.constData(), kWatchMask);
+        if (wd < 0) {
+            if (errno == ENOSPC) {
+                fmWarning() << "full-text: too many directories to watch in" << rootPath;
+                unwatchable = true;
+                live = false;
+            }
+            continue;
+        }
+        watches.insert(wd, dir);
+
+        DIR *dirp = opendir(dir.constData());
+        if (!dirp)
+            continue;
+
+        while (struct dirent *dent = readdir(dirp)) {
+            if (!strcmp(dent->d_name, ".") || !strcmp(dent->d_name, ".."))
+                continue;
+
+            const QByteArray &child = joinPath(dir, dent->d_name);
+            bool isDir = dent->d_type == DT_DIR;
+            if (dent->d_type == DT_UNKNOWN) {
+                struct stat st;
+                isDir = lstat(child.constData(), &st) == 0 && S_ISDIR(st.st_mode);
+            }
+            if (isDir && !isIgnored(dent->d_name, true, child))
+                dirs.append(child);
+        }
+        closedir(dirp);
+    }
+}
+
+/*!
+ * \brief IndexWatcher::handleEvents
+ * the changed files and directories are recorded in the journal, the directories are walked
+ * by the next update of the index, the removed ones are deleted from the index with their children.
+ */
+void IndexWatcher::handleEvents(const char *buffer, ssize_t length)
+{
+    QStringList changes;
+    QHash<quint32, QByteArray> movedFrom;
+
+    for (const char *ptr = buffer; ptr < buffer + length;) {
+        auto event = reinterpret_cast<const struct inotify_event *>(ptr);
+        ptr += sizeof(struct inotify_event) + event->len;
+
+        if (event->mask & IN_Q_OVERFLOW) {
+            // some changes are lost, the location is walked again by the next search
+            fmWarning() << "full-text: inotify queue overflow in" << rootPath;
+            live = false;
+            break;
+        }
+        if (event->mask & IN_IGNORED) {
+            watches.remove(event->wd);
+            continue;
+        }
+
+        const QByteArray &dir = watches.value(event->wd);
+        if (dir.isEmpty())
+            continue;
+        if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF)) {
+            if (dir == rootPath)
+                live = false;
+            continue;
+        }
+        if (event->len == 0)
+            continue;
+
+        const bool isDir = event->mask & IN_ISDIR;
+        const QByteArray &filePath = joinPath(dir, event->name);
+        if (isIgnored(event->name, isDir, filePath))
+            continue;
+
+        changes.append(QFile::decodeName(filePath));
+        if (!isDir)
+            continue;
+
+        if (event->mask & IN_MOVED_FROM) {
+            movedFrom.insert(event->cookie, filePath);
+        } else if (event->mask & IN_MOVED_TO) {
+            const QByteArray &from = movedFrom.take(event->cookie);
+            if (!from.isEmpty())
+                moveWatches(from, filePath);
+            else
+                watchTree(filePath);
+        } else if (event->mask & IN_CREATE) {
+            watchTree(filePath);
+        }
+    }
+
+    // moved out of the location
+    for (const QByteArray &path : movedFrom)
+        removeWatches(path);
+
+    if (!changes.isEmpty())
+        journal->markChanged(changes);
+}
+
+void IndexWatcher::moveWatches(const QByteArray &from, const QByteArray &to)
+{
+    for (auto iter = watches.begin(); iter != watches.end(); ++iter) {
+        const QByteArray &path = iter.value();
+        if (path == from || (path.startsWith(from) && path.at(from.length()) == '/'))
+            iter.value() = to + path.mid(from.length());
+    }
+}
+
+void IndexWatcher::removeWatches(const QByteArray &path)
+{
+    for (auto iter = watches.begin(); iter != watches.end();) {
+        if (iter.value() == path || (iter.value().startsWith(path) && iter.value().at(path.length()) == '/')) {
+            inotify_rm_watch(inotifyFd, iter.key());
+            iter = watches.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+bool IndexWatcher::isIgnored(const char *name, bool isDir, const QByteArray &path) const
+{
+    // the same files as the walk of the index
+    if (name[0] == '.' && strncmp(name, ".local", strlen(".local")))
+        return true;
+
+    const QString &filePath = QFile::decodeName(path);
+    if (isDir)
+        return filePath.count('/') > kMaxDepth || FullTextSearcherPrivate::isFilterDirectory(filePath, bindPathTable);
+    return !FullTextSearcherPrivate::isSupportFile(filePath);
+}
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#ifndef INDEXWATCHER_H
+#define INDEXWATCHER_H
+
+#include "dfmplugin_search_global.h"
+
+#include <QHash>
+#include <QMap>
+#include <QByteArray>
+#include <QStringList>
+
+#include <atomic>
+#include <memory>
+#include <thread>
+
+#include <sys/types.h>
+
+DPSEARCH_BEGIN_NAMESPACE
+
+class IndexJournal;
+
+/*!
+ * \brief The IndexWatcher class
+ * watches an indexed location with a recursive inotify watcher and records the changed files
+ * and directories in the journal, so the location is not walked again before every search.
+ * The watchers are shared by the searchers of the process.
+ */
+class IndexWatcher
+{
+public:
+    ~IndexWatcher();
+
+    // the time (seconds since epoch) since when the changes under `path` are recorded in `journal`,
+    // -1 if the location can not be watched
+    static qint64 watch(const QString &path, IndexJournal *journal, const QMap<QString, QString> &bindPathTable);
+    // stops the watchers recording in `journal`, called before the journal is destroyed
+    static void release(const IndexJournal *journal);
+
+private:
+    IndexWatcher(const QString &path, IndexJournal *journal, const QMap<QString, QString> &bindPathTable);
+
+    bool open();
+    void run();
+    void watchTree(const QByteArray &path);
+    void handleEvents(const char *buffer, ssize_t length);
+    void moveWatches(const QByteArray &from, const QByteArray &to);
+    void removeWatches(const QByteArray &path);
+    bool isIgnored(const char *name, bool isDir, const QByteArray &path) const;
+
+private:
+    QByteArray rootPath;
+    IndexJournal *journal { nullptr };
+    QMap<QString, QString> bindPathTable;
+    qint64 startTime { 0 };
+    std::atomic_bool live { false };
+    std::atomic_bool quit { false };
+    bool unwatchable { false };
+
+    int inotifyFd { -1 };
+    int wakeFd { -1 };
+    std::thread watcher;
+    // wd -> directory, only used in the watcher thread after it is started
+    QHash<int, QByteArray> watches;
+};
+
+DPSEARCH_END_NAMESPACE
+
+#endif   // INDEXWATCHER_H
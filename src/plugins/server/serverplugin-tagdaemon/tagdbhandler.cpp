@@ -26,6 +26,7 @@ SERVERTAGDAEMON_BEGIN_NAMESPACE
 
 static constexpr char kTagTableFileTags[] = "file_tags";
 static constexpr char kTagTableTagProperty[] = "tag_property";
+static constexpr int kMaxFilesOfQuery { 500 };
 
 TagDbHandler *TagDbHandler::instance()
 {
@@ -81,18 +82,22 @@ QVariantMap TagDbHandler::getTagsByUrls(const QStringList &urlList)
         return {};
     }
 
-    // query
-    const auto &field = Expression::Field<FileTagInfo>;
+    // query the files in chunks with `IN`, not one query for each file
     QVariantMap allFileTags;
-    for (auto &path : urlList) {
-        const auto &beanList = handle->query<FileTagInfo>().where(field("filePath") == path).toBeans();
+    for (int i = 0; i < urlList.size(); i += kMaxFilesOfQuery) {
+        QStringList values;
+        for (const auto &path : urlList.mid(i, kMaxFilesOfQuery)) {
+            QString value;
+            SerializationHelper::serialize(&value, QString(path).replace("'", "''"));
+            values.append(value);
+        }
 
-        QStringList fileTags;
-        for (auto oneBean : beanList)
+        const auto &beanList = handle->query<FileTagInfo>().where(Expression::Expr("filePath", " IN (" + values.join(",") + ")")).toBeans();
+        for (auto oneBean : beanList) {
+            QStringList fileTags = allFileTags.value(oneBean->getFilePath()).toStringList();
             fileTags.append(oneBean->getTagName());
-
-        if (!fileTags.isEmpty())
-            allFileTags.insert(path, fileTags);
+            allFileTags.insert(oneBean->getFilePath(), fileTags);
+        }
     }
 
     finally.dismiss();
@@ -227,14 +232,22 @@ bool TagDbHandler::addTagsForFiles(const QVariantMap &data)
     }
 
     // insert file--tags
-    bool ret = handle->transaction([tmpData, this]() -> bool {
-        for (auto dataIt = tmpData.begin(); dataIt != tmpData.end(); ++dataIt) {
-            bool ret = tagFile(dataIt.key(), dataIt.value());
-            if (!ret)
-                return ret;
+    QList<QSharedPointer<FileTagInfo>> beans;
+    for (auto dataIt = tmpData.begin(); dataIt != tmpData.end(); ++dataIt) {
+        const QStringList &tags = dataIt.value().toStringList();
+        for (const auto &tag : tags) {
+            QSharedPointer<FileTagInfo> bean { new FileTagInfo };
+            bean->setFilePath(dataIt.key());
+            bean->setTagName(tag);
+            bean->setTagOrder(0);
+            bean->setFuture("null");
+            beans.append(bean);
         }
-        return true;
-    });
+    }
+
+    bool ret = handle->insertMany<FileTagInfo>(beans);
+    if (!ret)
+        lastErr = QString("Tag files failed! count: %1").arg(beans.size());
 
     emit filesWereTagged(data);
     finally.dismiss();
@@ -251,13 +264,16 @@ bool TagDbHandler::removeTagsOfFiles(const QVariantMap &data)
     }
 
     // remove file--tags
+    QList<QVariantList> rows;
+    for (auto it = data.begin(); it != data.end(); ++it) {
+        const QStringList &tags = it.value().toStringList();
+        for (const auto &tag : tags)
+            rows.append({ it.key(), tag });
+    }
 
-    bool ret = handle->transaction([data, this]() -> bool {
-        for (auto it = data.begin(); it != data.end(); ++it)
-            if (!removeSpecifiedTagOfFile(it.key(), it.value()))
-                return false;
-        return true;
-    });
+    bool ret = handle->removeMany<FileTagInfo>({ "filePath", "tagName" }, rows);
+    if (!ret)
+        lastErr = QString("Remove tags of files failed! count: %1").arg(rows.size());
 
     emit filesUntagged(data);
     finally.dismiss();
@@ -300,10 +316,13 @@ bool TagDbHandler::deleteFiles(const QStringList &urls)
         return false;
     }
 
-    auto field = Expression::Field<FileTagInfo>;
-    for (const auto &url : urls) {
-        if (!handle->remove<FileTagInfo>(field("filePath") == url))
-            return false;
+    QList<QVariantList> rows;
+    for (const auto &url : urls)
+        rows.append({ url });
+
+    if (!handle->removeMany<FileTagInfo>({ "filePath" }, rows)) {
+        lastErr = QString("Delete files failed! count: %1").arg(rows.size());
+        return false;
     }
 
     finally.dismiss();
@@ -370,10 +389,19 @@ bool TagDbHandler::changeFilePaths(const QVariantMap &data)
         return false;
     }
 
-    auto it = data.begin();
-    for (; it != data.end(); ++it)
-        if (!changeFilePath(it.key(), it.value().toString()))
+    QList<QVariantList> rows;
+    for (auto it = data.begin(); it != data.end(); ++it) {
+        if (it.key().isEmpty() || it.value().toString().isEmpty()) {
+            lastErr = "input parameter is empty!";
             return false;
+        }
+        rows.append({ it.value().toString(), it.key() });
+    }
+
+    if (!handle->updateMany<FileTagInfo>({ "filePath" }, { "filePath" }, rows)) {
+        lastErr = QString("Change file paths failed! count: %1").arg(rows.size());
+        return false;
+    }
 
     finally.dismiss();
     return true;
@@ -471,65 +499,6 @@ bool TagDbHandler::insertTagProperty(const QString &name, const QVariant &value)
     return true;
 }
 
-bool TagDbHandler::tagFile(const QString &file, const QVariant &tags)
-{
-    DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
-
-    if (file.isEmpty() || tags.isNull()) {
-        lastErr = "input parameter is empty!";
-        return false;
-    }
-
-    // insert file--tags
-    const QStringList &tempTags = tags.toStringList();
-    int suc = tempTags.count();
-    for (const auto &tag : tempTags) {
-        FileTagInfo temp;
-        temp.setFilePath(file);
-        temp.setTagName(tag);
-        temp.setTagOrder(0);
-        temp.setFuture("null");
-        if (-1 == handle->insert<FileTagInfo>(temp))
-            break;
-        suc--;
-    }
-
-    if (0 < suc) {
-        lastErr = QString("Tag file failed! file: %1, tagName: %2").arg(file).arg(tempTags.at(--suc));
-        return false;
-    }
-
-    finally.dismiss();
-    return true;
-}
-
-bool TagDbHandler::removeSpecifiedTagOfFile(const QString &url, const QVariant &val)
-{
-    DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
-
-    if (url.isEmpty() || val.isNull()) {
-        lastErr = "input parameter is empty!";
-        return false;
-    }
-
-    auto field = Expression::Field<FileTagInfo>;
-    const auto tempTags = val.toStringList();
-    int suc = tempTags.count();
-    for (const auto &tag : tempTags) {
-        if (!handle->remove<FileTagInfo>((field("filePath") == url) && (field("tagName") == tag)))
-            break;
-        suc--;
-    }
-
-    if (0 < suc) {
-        lastErr = QString("Remove specified tag Of File failed! file: %1, tagName: %2").arg(url).arg(tempTags.at(--suc));
-        return false;
-    }
-
-    finally.dismiss();
-    return true;
-}
-
 bool TagDbHandler::changeTagColor(const QString &tagName, const QString &newTagColor)
 {
     DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
@@ -580,23 +549,4 @@ bool TagDbHandler::changeTagNameWithFile(const QString &tagName, const QString &
     return ret;
 }
 
-bool TagDbHandler::changeFilePath(const QString &oldPath, const QString &newPath)
-{
-    DFMBASE_NAMESPACE::FinallyUtil finally([&]() { lastErr.clear(); });
-
-    if (oldPath.isEmpty() || newPath.isEmpty()) {
-        lastErr = "input parameter is empty!";
-        return false;
-    }
-
-    const auto &field = Expression::Field<FileTagInfo>;
-    if (!handle->update<TagProperty>(field("filePath") = newPath, field("filePath") == oldPath)) {
-        lastErr = QString("Change file path failed! oldPath: %1, newPath: %2").arg(oldPath).arg(oldPath);
-        return false;
-    }
-
-    finally.dismiss();
-    return true;
-}
-
 SERVERTAGDAEMON_END_NAMESPACE
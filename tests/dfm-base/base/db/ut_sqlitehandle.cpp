@@ -5,6 +5,8 @@
 #include "stubext.h"
 #include <dfm-base/base/db/sqlitehandle.h>
 
+#include <QTemporaryDir>
+
 #include <gtest/gtest.h>
 
 class UT_SqliteHelper : public testing::Test
@@ -16,3 +18,67 @@ protected:
 public:
     stub_ext::StubExt stub;
 };
+
+class UT_SqliteHandleBean : public QObject
+{
+    Q_OBJECT
+    Q_CLASSINFO("TableName", "batch_test")
+    Q_PROPERTY(int id READ getId WRITE setId)
+    Q_PROPERTY(QString path READ getPath WRITE setPath)
+    Q_PROPERTY(int rank READ getRank WRITE setRank)
+
+public:
+    int getId() const { return id; }
+    void setId(int value) { id = value; }
+    QString getPath() const { return path; }
+    void setPath(const QString &value) { path = value; }
+    int getRank() const { return rank; }
+    void setRank(int value) { rank = value; }
+
+private:
+    int id {};
+    QString path {};
+    int rank {};
+};
+
+TEST_F(UT_SqliteHelper, batch)
+{
+    DFMBASE_USE_NAMESPACE
+    QTemporaryDir dir;
+    SqliteHandle handle(dir.filePath("batch.db"));
+    ASSERT_TRUE(handle.createTable<UT_SqliteHandleBean>(SqliteConstraint::primary("id"),
+                                                        SqliteConstraint::autoIncreament("id")));
+
+    QList<QSharedPointer<UT_SqliteHandleBean>> beans;
+    for (int i = 0; i != 1000; ++i) {
+        QSharedPointer<UT_SqliteHandleBean> bean { new UT_SqliteHandleBean };
+        bean->setPath(QString("/tmp/it's %1").arg(i));
+        bean->setRank(i);
+        beans.append(bean);
+    }
+    EXPECT_TRUE(handle.insertMany<UT_SqliteHandleBean>(beans));
+    EXPECT_EQ(1000, handle.query<UT_SqliteHandleBean>().toBeans().size());
+
+    const auto &field = Expression::Field<UT_SqliteHandleBean>;
+    EXPECT_TRUE(handle.updateMany<UT_SqliteHandleBean>({ "path" }, { "path" },
+                                                       { { "/tmp/moved", "/tmp/it's 1" }, { "/tmp/moved 2", "/tmp/it's 2" } }));
+    auto moved = handle.query<UT_SqliteHandleBean>().where(field("path") == "/tmp/moved").toBean();
+    ASSERT_TRUE(moved);
+    EXPECT_EQ(1, moved->getRank());
+
+    EXPECT_TRUE(handle.removeMany<UT_SqliteHandleBean>({ "path", "rank" }, { { "/tmp/moved", 1 }, { "/tmp/it's 3", 3 } }));
+    EXPECT_EQ(998, handle.query<UT_SqliteHandleBean>().toBeans().size());
+
+    // the whole batch is rolled back when one row fails
+    EXPECT_FALSE(handle.updateMany<UT_SqliteHandleBean>({ "path" }, { "rank" }, { { "/tmp/a", 4 }, { QVariant(), 5 } }));
+    EXPECT_FALSE(handle.query<UT_SqliteHandleBean>().where(field("path") == "/tmp/a").toBean());
+
+    // a batch inside of a transaction
+    EXPECT_FALSE(handle.transaction([&]() {
+        EXPECT_TRUE(handle.removeMany<UT_SqliteHandleBean>({ "rank" }, { { 4 } }));
+        return false;
+    }));
+    EXPECT_EQ(998, handle.query<UT_SqliteHandleBean>().toBeans().size());
+}
+
+#include "ut_sqlitehandle.moc"
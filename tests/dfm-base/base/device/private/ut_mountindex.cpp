@@ -0,0 +1,84 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stubext.h>
+#include <dfm-base/base/device/private/mountindex.h>
+#include <dfm-base/base/device/deviceutils.h>
+
+#include <QUrl>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_MountTable : public testing::Test
+{
+protected:
+    static MountTable::MountPoint mount(const QString &target, const QString &source, const QString &fsType)
+    {
+        MountTable::MountPoint mpt;
+        mpt.target = target;
+        mpt.source = source;
+        mpt.fsType = fsType;
+        mpt.lowSpeed = MountTable::isLowSpeedFileSystem(fsType);
+        return mpt;
+    }
+
+    MountTable table { { mount("/", "/dev/sda1", "ext4"),
+                         mount("/data", "/dev/sda2", "ext4"),
+                         mount("/media/user/disk", "/dev/sdb1", "vfat"),
+                         mount("/media/user/disk", "/dev/sdc1", "exfat"),
+                         mount("/run/user/1000/gvfs", "gvfsd-fuse", "fuse.gvfsd-fuse") },
+                       { { "/data/home", "/home" }, { "/data/opt/", "/opt/" } } };
+};
+
+TEST_F(UT_MountTable, FindMount)
+{
+    EXPECT_EQ("/", table.findMount("/usr/bin")->target);
+    EXPECT_EQ("/", table.findMount("/datafile")->target);
+    EXPECT_EQ("/data", table.findMount("/data")->target);
+    EXPECT_EQ("/data", table.findMount("/data/home/user/")->target);
+
+    // the later mounted one covers the former
+    EXPECT_EQ("/dev/sdc1", table.findMount("/media/user/disk/a.txt")->source);
+
+    EXPECT_FALSE(table.findMount("/media/user/disk")->lowSpeed);
+    EXPECT_TRUE(table.findMount("/run/user/1000/gvfs/smb-share:server=1.2.3.4,share=a")->lowSpeed);
+}
+
+TEST_F(UT_MountTable, BindPathTransform)
+{
+    EXPECT_EQ("/data/home/user/a.txt", table.bindPathTransform("/home/user/a.txt", true));
+    EXPECT_EQ("/home/user/a.txt", table.bindPathTransform("/data/home/user/a.txt", false));
+    EXPECT_EQ("/data/home", table.bindPathTransform("/home", true));
+    EXPECT_EQ("/data/opt/app", table.bindPathTransform("/opt/app", true));
+    EXPECT_EQ("/opt/app", table.bindPathTransform("/data/opt/app", false));
+
+    // only whole components are matched
+    EXPECT_EQ("/homework/a.txt", table.bindPathTransform("/homework/a.txt", true));
+    EXPECT_EQ("/usr/home", table.bindPathTransform("/usr/home", true));
+}
+
+TEST(UT_MountIndex, MatchesDeviceUtils)
+{
+    EXPECT_EQ("/", MountIndex::instance()->mountRoot("/"));
+    EXPECT_EQ(MountIndex::instance()->mountRoot("/proc/self"), DeviceUtils::getLongestMountRootPath("/proc/self"));
+    EXPECT_EQ(MountIndex::instance()->bindInfo(), DeviceUtils::fstabBindInfo());
+
+    MountIndex::instance()->refresh();
+    EXPECT_EQ("/proc/", MountIndex::instance()->mountRoot("/proc/self/mountinfo"));
+    EXPECT_TRUE(DeviceUtils::isLowSpeedDevice(QUrl::fromLocalFile("/run/user/1000/gvfs/a")));
+    EXPECT_TRUE(DeviceUtils::isOnLowSpeedFileSystem(QUrl::fromLocalFile("/run/user/1000/gvfs/a")));
+}
+
+TEST(UT_MountIndex, LowSpeedFileSystemIsOptIn)
+{
+    // the fs type of the mount is only checked by isOnLowSpeedFileSystem
+    stub_ext::StubExt stub;
+    stub.set_lamda(&MountIndex::isLowSpeed, [] { __DBG_STUB_INVOKE__ return true; });
+
+    const QUrl &url = QUrl::fromLocalFile("/home/user/nfs/a.txt");
+    EXPECT_FALSE(DeviceUtils::isLowSpeedDevice(url));
+    EXPECT_TRUE(DeviceUtils::isOnLowSpeedFileSystem(url));
+}
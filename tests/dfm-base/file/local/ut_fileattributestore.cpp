@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stubext.h>
+#include "file/local/private/fileattributestore.h"
+
+#include <dfm-io/dfile.h>
+
+#include <QUrl>
+
+#include <gtest/gtest.h>
+
+
+DFMBASE_USE_NAMESPACE
+USING_IO_NAMESPACE
+
+using AttributeID = FileInfo::FileInfoAttributeID;
+
+static QMap<AttributeID, QVariant> typicalAttributes(int index)
+{
+    const QString name = QString("file_%1.txt").arg(index);
+    QMap<AttributeID, QVariant> attributes;
+    attributes.insert(AttributeID::kStandardName, name);
+    attributes.insert(AttributeID::kStandardCompleteBaseName, name.left(name.length() - 4));
+    attributes.insert(AttributeID::kStandardCompleteSuffix, QString("txt"));
+    attributes.insert(AttributeID::kStandardDisplayName, name);
+    attributes.insert(AttributeID::kStandardSize, static_cast<qulonglong>(index * 1024));
+    attributes.insert(AttributeID::kStandardFilePath, "/tmp/bench/" + name);
+    attributes.insert(AttributeID::kStandardParentPath, QString("/tmp/bench"));
+    attributes.insert(AttributeID::kStandardFileExists, true);
+    attributes.insert(AttributeID::kStandardSymlinkTarget, QString());
+    attributes.insert(AttributeID::kAccessCanRead, true);
+    attributes.insert(AttributeID::kAccessCanWrite, true);
+    attributes.insert(AttributeID::kAccessCanExecute, false);
+    attributes.insert(AttributeID::kStandardIsHidden, false);
+    attributes.insert(AttributeID::kStandardIsFile, true);
+    attributes.insert(AttributeID::kStandardIsDir, false);
+    attributes.insert(AttributeID::kStandardIsSymlink, false);
+    attributes.insert(AttributeID::kAccessCanDelete, true);
+    attributes.insert(AttributeID::kAccessCanTrash, true);
+    attributes.insert(AttributeID::kAccessCanRename, true);
+    attributes.insert(AttributeID::kOwnerUser, QString("user"));
+    attributes.insert(AttributeID::kOwnerGroup, QString("user"));
+    attributes.insert(AttributeID::kUnixInode, static_cast<qulonglong>(100000 + index));
+    attributes.insert(AttributeID::kUnixUID, 1000u);
+    attributes.insert(AttributeID::kUnixGID, 1000u);
+    attributes.insert(AttributeID::kTimeCreated, static_cast<qulonglong>(1690000000 + index));
+    attributes.insert(AttributeID::kTimeChanged, static_cast<qulonglong>(1690000000 + index));
+    attributes.insert(AttributeID::kTimeModified, static_cast<qulonglong>(1690000000 + index));
+    attributes.insert(AttributeID::kTimeAccess, static_cast<qulonglong>(1690000000 + index));
+    attributes.insert(AttributeID::kTimeCreatedUsec, 0u);
+    attributes.insert(AttributeID::kTimeChangedUsec, 0u);
+    attributes.insert(AttributeID::kTimeModifiedUsec, 0u);
+    attributes.insert(AttributeID::kTimeAccessUsec, 0u);
+    attributes.insert(AttributeID::kStandardFileType, QVariant::fromValue(FileInfo::FileType::kRegularFile));
+    attributes.insert(AttributeID::kAccessPermissions, QVariant::fromValue(DFile::Permissions(DFile::Permission::kReadOwner)));
+    attributes.insert(AttributeID::kStandardContentType, QString("text/plain"));
+    attributes.insert(AttributeID::kStandardIcon, QString("text-plain"));
+    attributes.insert(AttributeID::kStandardIsLocalDevice, false);
+    attributes.insert(AttributeID::kStandardIsCdRomDevice, false);
+    return attributes;
+}
+
+TEST(UT_FileAttributeStore, testValueKeepsType)
+{
+    FileAttributeStore store;
+    EXPECT_TRUE(store.isEmpty());
+
+    store.set(AttributeID::kStandardSize, static_cast<qulonglong>(4096));
+    store.set(AttributeID::kStandardIsDir, true);
+    store.set(AttributeID::kStandardName, QString("a.txt"));
+    store.set(AttributeID::kOriginalUri, QUrl("file:///tmp/a.txt"));
+    store.set(AttributeID::kUnixMode, QString("not a number"));
+
+    EXPECT_FALSE(store.isEmpty());
+    EXPECT_EQ(QMetaType::ULongLong, store.value(AttributeID::kStandardSize).userType());
+    EXPECT_EQ(4096, store.value(AttributeID::kStandardSize).toLongLong());
+    EXPECT_TRUE(store.value(AttributeID::kStandardIsDir).toBool());
+    EXPECT_EQ("a.txt", store.value(AttributeID::kStandardName).toString());
+    EXPECT_EQ(QUrl("file:///tmp/a.txt"), store.value(AttributeID::kOriginalUri).toUrl());
+    EXPECT_EQ("not a number", store.value(AttributeID::kUnixMode).toString());
+    EXPECT_TRUE(store.contains(AttributeID::kUnixMode));
+    EXPECT_FALSE(store.contains(AttributeID::kStandardIsFile));
+    EXPECT_FALSE(store.value(AttributeID::kStandardIsFile).isValid());
+
+    store.set(AttributeID::kStandardFileType, QVariant::fromValue(FileInfo::FileType::kDirectory));
+    EXPECT_EQ(FileInfo::FileType::kDirectory, store.value(AttributeID::kStandardFileType).value<FileInfo::FileType>());
+}
+
+TEST(UT_FileAttributeStore, testInsertAndAssign)
+{
+    FileAttributeStore store;
+    EXPECT_FALSE(store.insert(AttributeID::kStandardSize, QVariant()));
+    EXPECT_TRUE(store.insert(AttributeID::kStandardSize, static_cast<qulonglong>(1)));
+    EXPECT_FALSE(store.insert(AttributeID::kStandardSize, static_cast<qulonglong>(1)));
+    EXPECT_TRUE(store.insert(AttributeID::kStandardSize, static_cast<qulonglong>(2)));
+    EXPECT_TRUE(store.insert(AttributeID::kStandardDisplayName, QString("b")));
+    EXPECT_FALSE(store.insert(AttributeID::kStandardDisplayName, QString("b")));
+
+    const auto &attributes = typicalAttributes(1);
+    store.assign(attributes);
+    for (auto it = attributes.cbegin(); it != attributes.cend(); ++it) {
+        EXPECT_TRUE(store.contains(it.key()));
+        EXPECT_EQ(it.value(), store.value(it.key()));
+    }
+
+    store.clear();
+    EXPECT_TRUE(store.isEmpty());
+}
+
+TEST(UT_FileAttributeStore, testMemoryPerInfo)
+{
+    // the typical attributes all fit in the fixed slots, nothing is allocated for the rare ones
+    FileAttributeStore store;
+    const auto &attributes = typicalAttributes(1);
+    store.assign(attributes);
+    EXPECT_TRUE(store.others.isEmpty());
+    EXPECT_EQ(0, store.others.capacity());
+
+    // smaller than the keys and values of the map, not counting its nodes
+    EXPECT_LT(sizeof(FileAttributeStore), attributes.size() * (sizeof(AttributeID) + sizeof(QVariant)));
+}
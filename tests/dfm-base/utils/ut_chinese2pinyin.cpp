@@ -0,0 +1,28 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/chinese2pinyin.h"
+
+#include <gtest/gtest.h>
+
+TEST(UT_Chinese2Pinyin, testChinese2Pinyin)
+{
+    EXPECT_EQ(QString("wen2jian4guan3li3qi4"), Pinyin::Chinese2Pinyin(QString::fromUtf8("文件管理器")));
+    EXPECT_EQ(QString("abc_wen2.txt"), Pinyin::Chinese2Pinyin(QString::fromUtf8("abc_文.txt")));
+    EXPECT_EQ(QString("qiu1"), Pinyin::Chinese2Pinyin(QString(QChar(0x3400))));
+    EXPECT_EQ(QString("he4"), Pinyin::Chinese2Pinyin(QString(QChar(0xfa2d))));
+    EXPECT_TRUE(Pinyin::Chinese2Pinyin(QString()).isEmpty());
+}
+
+TEST(UT_Chinese2Pinyin, testChinese2PinyinReuseResult)
+{
+    QString result;
+    Pinyin::Chinese2Pinyin(QString::fromUtf8("管理"), &result);
+    EXPECT_EQ(QString("guan3li3"), result);
+
+    const QString ascii("readme.md");
+    Pinyin::Chinese2Pinyin(ascii, &result);
+    EXPECT_EQ(ascii, result);
+    EXPECT_TRUE(result.isSharedWith(ascii));
+}
@@ -0,0 +1,83 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/elidetextlayout.h"
+
+#include <QTextLayout>
+
+#include <gtest/gtest.h>
+
+using namespace dfmbase;
+
+namespace {
+// counts the text layouts made for the document
+class CountedLayout : public ElideTextLayout
+{
+public:
+    explicit CountedLayout(const QString &text)
+        : ElideTextLayout(text)
+    {
+        setAttribute(kLineHeight, 20);
+    }
+
+    int layoutCount { 0 };
+
+protected:
+    void initLayoutOption(QTextLayout *lay) override
+    {
+        ++layoutCount;
+        ElideTextLayout::initLayoutOption(lay);
+    }
+};
+}
+
+class UT_ElideTextLayout : public testing::Test
+{
+protected:
+    void SetUp() override { ElideTextLayout::clearCache(); }
+    void TearDown() override { ElideTextLayout::clearCache(); }
+};
+
+TEST_F(UT_ElideTextLayout, testLayoutCached)
+{
+    const QString name = QString::fromUtf8("一个很长很长很长很长很长很长很长很长很长很长很长很长的文件名.txt");
+    const QRectF rect(10, 20, 80, 40);
+
+    CountedLayout first(name);
+    QStringList firstLines;
+    const QList<QRectF> &firstRects = first.layout(rect, Qt::ElideMiddle, nullptr, Qt::NoBrush, &firstLines);
+    EXPECT_LT(0, first.layoutCount);
+    EXPECT_EQ(2, firstRects.size());
+
+    CountedLayout second(name);
+    QStringList secondLines;
+    const QList<QRectF> &secondRects = second.layout(rect.translated(100, 100), Qt::ElideMiddle, nullptr, Qt::NoBrush, &secondLines);
+    EXPECT_EQ(0, second.layoutCount);
+    EXPECT_EQ(firstLines, secondLines);
+    ASSERT_EQ(firstRects.size(), secondRects.size());
+    for (int i = 0; i < firstRects.size(); ++i)
+        EXPECT_EQ(firstRects.at(i).translated(100, 100), secondRects.at(i));
+
+    // the height of one more line is not enough for the third line
+    second.layout(QRectF(rect.topLeft(), QSizeF(80, 59)), Qt::ElideMiddle);
+    EXPECT_EQ(0, second.layoutCount);
+
+    second.layout(QRectF(rect.topLeft(), QSizeF(80, 60)), Qt::ElideMiddle);
+    EXPECT_LT(0, second.layoutCount);
+
+    second.layoutCount = 0;
+    ElideTextLayout::clearCache();
+    second.layout(rect, Qt::ElideMiddle);
+    EXPECT_LT(0, second.layoutCount);
+}
+
+TEST_F(UT_ElideTextLayout, testLayoutNotCachedWithDocument)
+{
+    CountedLayout layout("test.txt");
+    EXPECT_TRUE(layout.documentHandle());
+
+    layout.layout(QRectF(0, 0, 80, 40), Qt::ElideMiddle);
+    layout.layout(QRectF(0, 0, 80, 40), Qt::ElideMiddle);
+    EXPECT_EQ(2, layout.layoutCount);
+}
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "dfm-base/utils/filestatisticsjob.h"
+#include "dfm-base/utils/private/filestatissticsjob_p.h"
+
+#include "stubext.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QUrl>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_FileStatisticsJob : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(tempDir.isValid());
+        for (int i = 0; i < 3; ++i) {
+            const QString &dirPath = tempDir.path() + QString("/dir%1/sub").arg(i);
+            QDir().mkpath(dirPath);
+            for (int j = 0; j < 10; ++j) {
+                QFile file(dirPath + QString("/file%1.txt").arg(j));
+                file.open(QIODevice::WriteOnly);
+                file.write(QByteArray(100, 'a'));
+                file.close();
+            }
+        }
+        QFile::link(tempDir.path() + "/dir0", tempDir.path() + "/dir1/link");
+        ::link(QFile::encodeName(tempDir.path() + "/dir0/sub/file0.txt").constData(),
+               QFile::encodeName(tempDir.path() + "/dir2/hard.txt").constData());
+    }
+    void TearDown() override {}
+
+    QTemporaryDir tempDir;
+};
+
+TEST_F(UT_FileStatisticsJob, testStatisticsLocalFiles)
+{
+    FileStatisticsJob job;
+    job.d->sourceUrlList = { QUrl::fromLocalFile(tempDir.path()) };
+    EXPECT_TRUE(job.d->canStatisticsLocally());
+
+    job.d->state = FileStatisticsJob::kRunningState;
+    job.d->statisticsLocalFiles();
+
+    // the hard link is counted without its size, the linked directory is counted once
+    EXPECT_EQ(31, job.filesCount());
+    EXPECT_EQ(3000, job.totalSize());
+    EXPECT_EQ(7, job.directorysCount());
+    EXPECT_EQ(job.filesCount() + job.directorysCount() + 1, job.getFileSizeInfo()->allFiles.count());
+}
+
+TEST_F(UT_FileStatisticsJob, testStatisticsLocalFilesNoFollowSymlink)
+{
+    FileStatisticsJob job;
+    job.setFileHints(FileStatisticsJob::kNoFollowSymlink | FileStatisticsJob::kExcludeSourceFile);
+    job.d->sourceUrlList = { QUrl::fromLocalFile(tempDir.path()) };
+
+    job.d->state = FileStatisticsJob::kRunningState;
+    job.d->statisticsLocalFiles();
+
+    EXPECT_EQ(31, job.filesCount());
+    EXPECT_EQ(7, job.directorysCount());
+}
+
+TEST_F(UT_FileStatisticsJob, testCanStatisticsLocally)
+{
+    FileStatisticsJob job;
+    job.d->sourceUrlList = { QUrl::fromLocalFile(tempDir.path()), QUrl("smb://host/share") };
+    EXPECT_FALSE(job.d->canStatisticsLocally());
+
+    job.d->sourceUrlList = { QUrl::fromLocalFile(tempDir.path()) };
+    job.setFileHints(FileStatisticsJob::kSingleDepth);
+    EXPECT_FALSE(job.d->canStatisticsLocally());
+}
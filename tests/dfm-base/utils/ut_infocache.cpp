@@ -0,0 +1,160 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stubext.h>
+#include "utils/private/infocache_p.h"
+
+#include <dfm-base/utils/watchercache.h>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_InfoCache : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // 不创建监视器
+        stub.set_lamda(&WatcherCache::cacheDisable, [] { __DBG_STUB_INVOKE__ return true; });
+        cache.reset(new InfoCache);
+        QObject::connect(cache.data(), &InfoCache::cacheDisconnectWatcher, [this](const QMap<QUrl, FileInfoPointer> infos) {
+            evicted.append(infos.keys());
+            evictedInfos = infos;
+        });
+    }
+    void TearDown() override
+    {
+        cache.reset();
+        stub.clear();
+    }
+
+    // 同一个分片的url
+    QList<QUrl> shardUrls(int count) const
+    {
+        QList<QUrl> urls;
+        for (int i = 0; urls.size() < count; ++i) {
+            const QUrl &url = QUrl::fromLocalFile(QString("/tmp/infocache/%1").arg(i));
+            if (qHash(url) % kCacheShardCount == 0)
+                urls.append(url);
+        }
+        return urls;
+    }
+
+    void cacheUrls(const QList<QUrl> &urls)
+    {
+        for (const QUrl &url : urls)
+            cache->cacheInfo(url, FileInfoPointer(new FileInfo(url)));
+    }
+
+    CacheShard &shard() { return cache->d->shards[0]; }
+
+    QScopedPointer<InfoCache> cache;
+    QList<QUrl> evicted;
+    QMap<QUrl, FileInfoPointer> evictedInfos;
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_InfoCache, TouchMovesToFront)
+{
+    const auto &urls = shardUrls(3);
+    cacheUrls(urls);
+    EXPECT_EQ(urls.at(2), shard().lru.front().url);
+    EXPECT_EQ(urls.at(0), shard().lru.back().url);
+
+    EXPECT_TRUE(cache->getCacheInfo(urls.at(0)));
+    EXPECT_EQ(urls.at(0), shard().lru.front().url);
+    EXPECT_EQ(urls.at(1), shard().lru.back().url);
+
+    EXPECT_FALSE(cache->getCacheInfo(QUrl::fromLocalFile("/tmp/infocache/none")));
+}
+
+TEST_F(UT_InfoCache, EvictPastBytes)
+{
+    // 刚好超出分片预算的个数，只按内存占用淘汰
+    const qint64 shardBudget = 64 * 1024 * 1024 / kCacheShardCount;
+    QList<QUrl> urls;
+    qint64 cost = 0;
+    for (const QUrl &url : shardUrls(shardBudget / 1024)) {
+        urls.append(url);
+        cost += InfoCachePrivate::entryCost(url);
+        if (cost > shardBudget)
+            break;
+    }
+    ASSERT_GT(cost, shardBudget);
+
+    cacheUrls(urls.mid(0, urls.size() - 1));
+    EXPECT_TRUE(evicted.isEmpty());
+    EXPECT_EQ(static_cast<size_t>(urls.size() - 1), shard().lru.size());
+
+    cacheUrls(urls.mid(urls.size() - 1));
+    ASSERT_FALSE(evicted.isEmpty());
+    EXPECT_EQ(urls.at(0), evicted.first());
+    EXPECT_LE(shard().cost, shardBudget);
+    EXPECT_EQ(shard().lru.size(), static_cast<size_t>(shard().index.size()));
+    EXPECT_FALSE(cache->getCacheInfo(urls.at(0)));
+    EXPECT_TRUE(cache->getCacheInfo(urls.last()));
+}
+
+TEST_F(UT_InfoCache, EvictPastBudget)
+{
+    const auto &urls = shardUrls(3);
+    cacheUrls(urls.mid(0, 2));
+
+    // 最久未访问的记录超出分片的内存预算
+    auto &oldest = shard().lru.back();
+    shard().cost += 64 * 1024 * 1024 - oldest.cost;
+    oldest.cost = 64 * 1024 * 1024;
+
+    cacheUrls(urls.mid(2));
+    EXPECT_EQ(QList<QUrl>({ urls.at(0) }), evicted);
+    EXPECT_EQ(2u, shard().lru.size());
+
+    qint64 cost = 0;
+    for (const auto &entry : shard().lru)
+        cost += entry.cost;
+    EXPECT_EQ(cost, shard().cost);
+}
+
+TEST_F(UT_InfoCache, RemoveExpired)
+{
+    const auto &urls = shardUrls(2);
+    cacheUrls(urls);
+    shard().lru.back().lastAccess = 0;
+
+    cache->timeRemoveCache();
+    EXPECT_EQ(QList<QUrl>({ urls.at(0) }), evicted);
+    EXPECT_FALSE(cache->getCacheInfo(urls.at(0)));
+    EXPECT_TRUE(cache->getCacheInfo(urls.at(1)));
+
+    evicted.clear();
+    cache->timeRemoveCache();
+    EXPECT_TRUE(evicted.isEmpty());
+}
+
+TEST_F(UT_InfoCache, DisconnectEvictedWatcher)
+{
+    QList<QUrl> watcherUrls;
+    stub.set_lamda(&WatcherCache::getCacheWatcher, [&watcherUrls](WatcherCache *, const QUrl &url) {
+        __DBG_STUB_INVOKE__
+        watcherUrls.append(url);
+        return QSharedPointer<AbstractFileWatcher>();
+    });
+
+    const auto &urls = shardUrls(2);
+    cacheUrls(urls);
+    shard().lru.back().lastAccess = 0;
+    cache->timeRemoveCache();
+    ASSERT_EQ(1, evictedInfos.size());
+
+    // 淘汰的fileinfo断开父目录的监视器
+    cache->disconnectWatcher(evictedInfos);
+    EXPECT_EQ(QList<QUrl>({ QUrl::fromLocalFile("/tmp/infocache/") }), watcherUrls);
+
+    // 停止后不再处理
+    watcherUrls.clear();
+    cache->stop();
+    cache->disconnectWatcher(evictedInfos);
+    EXPECT_TRUE(watcherUrls.isEmpty());
+}
@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "utils/thumbnail/jpegthumbnailreader.h"
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QBuffer>
+#include <QtEndian>
+
+DFMBASE_USE_NAMESPACE
+
+class UT_JpegThumbnailReader : public testing::Test
+{
+protected:
+    static QByteArray encode(int width, int height, const QColor &color)
+    {
+        QImage img(width, height, QImage::Format_RGB32);
+        img.fill(color);
+
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        img.save(&buffer, "JPEG", 90);
+        return data;
+    }
+
+    // 构造小端序的EXIF：IFD0中只有方向，IFD1中是内嵌缩略图的位置
+    static QByteArray exifSegment(quint16 orientation, const QByteArray &thumbnail,
+                                  quint32 ifd0 = 8, quint32 ifd1 = 26)
+    {
+        QByteArray tiff("II\x2A\x00", 4);
+        auto append16 = [&tiff](quint16 value) {
+            const quint16 le = qToLittleEndian(value);
+            tiff.append(reinterpret_cast<const char *>(&le), 2);
+        };
+        auto append32 = [&tiff](quint32 value) {
+            const quint32 le = qToLittleEndian(value);
+            tiff.append(reinterpret_cast<const char *>(&le), 4);
+        };
+        auto appendEntry = [&](quint16 tag, quint16 type, quint32 value) {
+            append16(tag);
+            append16(type);
+            append32(1);
+            if (type == 3) {
+                append16(static_cast<quint16>(value));
+                append16(0);
+            } else {
+                append32(value);
+            }
+        };
+
+        append32(ifd0);   // IFD0
+        append16(1);
+        appendEntry(0x0112, 3, orientation);
+        append32(ifd1);   // IFD1
+        append16(2);
+        appendEntry(0x0201, 4, 56);
+        appendEntry(0x0202, 4, static_cast<quint32>(thumbnail.size()));
+        append32(0);
+        tiff.append(thumbnail);
+
+        QByteArray segment("\xFF\xE1", 2);
+        const quint16 length = qToBigEndian(static_cast<quint16>(2 + 6 + tiff.size()));
+        segment.append(reinterpret_cast<const char *>(&length), 2);
+        segment.append("Exif\0\0", 6);
+        segment.append(tiff);
+        return segment;
+    }
+
+    QString writeFile(const QString &name, const QByteArray &data)
+    {
+        const QString &path = dir.filePath(name);
+        QFile file(path);
+        file.open(QIODevice::WriteOnly);
+        file.write(data);
+        file.close();
+        return path;
+    }
+
+    static bool isColor(const QImage &img, const QColor &color)
+    {
+        const QColor &pixel = img.pixelColor(img.width() / 2, img.height() / 2);
+        return qAbs(pixel.red() - color.red()) < 16 && qAbs(pixel.green() - color.green()) < 16
+                && qAbs(pixel.blue() - color.blue()) < 16;
+    }
+
+    QTemporaryDir dir;
+};
+
+TEST_F(UT_JpegThumbnailReader, ScaledDecode)
+{
+    JpegThumbnailReader reader(writeFile("plain.jpg", encode(1200, 800, Qt::blue)));
+    ASSERT_TRUE(reader.open());
+    EXPECT_EQ(QSize(1200, 800), reader.size());
+    EXPECT_EQ(1, reader.orientation());
+    EXPECT_TRUE(reader.exifThumbnail().isNull());
+
+    const QImage &img = reader.read(256);
+    EXPECT_EQ(QSize(256, 170), img.size());
+    EXPECT_TRUE(isColor(img, Qt::blue));
+}
+
+TEST_F(UT_JpegThumbnailReader, ExifThumbnailAndOrientation)
+{
+    QByteArray data = encode(1200, 800, Qt::blue);
+    data.insert(2, exifSegment(6, encode(300, 200, Qt::red)));
+    const QString &path = writeFile("exif.jpg", data);
+
+    JpegThumbnailReader reader(path);
+    ASSERT_TRUE(reader.open());
+    EXPECT_EQ(QSize(1200, 800), reader.size());
+    EXPECT_EQ(6, reader.orientation());
+    EXPECT_EQ(QSize(300, 200), reader.exifThumbnail().size());
+
+    // 内嵌缩略图足够大时直接使用，并旋转90度
+    const QImage &small = reader.read(256);
+    EXPECT_EQ(QSize(170, 256), small.size());
+    EXPECT_TRUE(isColor(small, Qt::red));
+
+    // 内嵌缩略图太小时解码原图
+    const QImage &large = reader.read(512);
+    EXPECT_EQ(QSize(341, 512), large.size());
+    EXPECT_TRUE(isColor(large, Qt::blue));
+}
+
+TEST_F(UT_JpegThumbnailReader, MaliciousIfdOffset)
+{
+    // IFD0的偏移加上长度后回绕，不能越界读取
+    QByteArray data = encode(400, 300, Qt::blue);
+    data.insert(2, exifSegment(6, encode(300, 200, Qt::red), 0xFFFFFFFE));
+    JpegThumbnailReader reader(writeFile("ifd0.jpg", data));
+    ASSERT_TRUE(reader.open());
+    EXPECT_EQ(1, reader.orientation());
+    EXPECT_TRUE(reader.exifThumbnail().isNull());
+
+    // IFD1的链接回绕，方向仍然有效
+    data = encode(400, 300, Qt::blue);
+    data.insert(2, exifSegment(6, encode(300, 200, Qt::red), 8, 0xFFFFFFFF));
+    JpegThumbnailReader linked(writeFile("ifd1.jpg", data));
+    ASSERT_TRUE(linked.open());
+    EXPECT_EQ(6, linked.orientation());
+    EXPECT_TRUE(linked.exifThumbnail().isNull());
+    EXPECT_EQ(QSize(300, 400), linked.read(400).size());
+}
+
+TEST_F(UT_JpegThumbnailReader, InvalidFile)
+{
+    JpegThumbnailReader reader(writeFile("broken.jpg", QByteArray("\xFF\xD8\xFF\xE0garbage", 10)));
+    EXPECT_FALSE(reader.open());
+    EXPECT_TRUE(reader.read(256).isNull());
+}
@@ -0,0 +1,34 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stubext.h>
+#include "utils/thumbnail/thumbnailhelper.h"
+
+#include <dfm-base/base/application/application.h>
+#include <dfm-base/base/device/deviceproxymanager.h>
+#include <dfm-base/base/device/deviceutils.h>
+#include <dfm-base/utils/fileutils.h>
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+
+TEST(UT_ThumbnailHelper, RemoteFileSystemFollowsRemoteSetting)
+{
+    bool showRemote = false;
+    stub_ext::StubExt stub;
+    stub.set_lamda(&FileUtils::isMtpFile, [] { __DBG_STUB_INVOKE__ return false; });
+    stub.set_lamda(&DeviceProxyManager::isFileOfProtocolMounts, [] { __DBG_STUB_INVOKE__ return false; });
+    stub.set_lamda(&DeviceUtils::isOnLowSpeedFileSystem, [] { __DBG_STUB_INVOKE__ return true; });
+    stub.set_lamda(&Application::genericAttribute, [&showRemote] { __DBG_STUB_INVOKE__ return QVariant(showRemote); });
+    stub.set_lamda(&ThumbnailHelper::checkMimeTypeSupport, [] { __DBG_STUB_INVOKE__ return true; });
+
+    // 网络文件系统(nfs, cifs...)上的文件和协议设备一样受远程缩略图设置控制
+    ThumbnailHelper helper;
+    const QUrl &url = QUrl::fromLocalFile("/mnt/nfs/a.png");
+    EXPECT_FALSE(helper.checkThumbEnable(url));
+
+    showRemote = true;
+    EXPECT_TRUE(helper.checkThumbEnable(url));
+}
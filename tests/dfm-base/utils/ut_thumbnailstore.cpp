@@ -0,0 +1,191 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stubext.h>
+#include "utils/thumbnail/thumbnailstore.h"
+
+#include <dfm-base/base/configs/dconfig/dconfigmanager.h>
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QPainter>
+#include <QDir>
+#include <QThread>
+
+DFMBASE_USE_NAMESPACE
+DFMGLOBAL_USE_NAMESPACE
+
+class UT_ThumbnailStore : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        stub.set_lamda(&DConfigManager::value, [](DConfigManager *, const QString &, const QString &, const QVariant &fallback) {
+            __DBG_STUB_INVOKE__
+            return fallback;
+        });
+    }
+    void TearDown() override
+    {
+        stub.clear();
+    }
+
+    QString createFile(const QString &name)
+    {
+        const QString &path = dataDir.filePath(name);
+        QFile file(path);
+        file.open(QIODevice::WriteOnly);
+        file.write(name.toUtf8());
+        file.close();
+        return path;
+    }
+
+    static QImage createImage(int width, int height, const QColor &color)
+    {
+        QImage img(width, height, QImage::Format_ARGB32_Premultiplied);
+        img.fill(color);
+        QPainter painter(&img);
+        painter.fillRect(0, 0, width / 2, height / 2, Qt::red);
+        return img;
+    }
+
+    QTemporaryDir storeDir;
+    QTemporaryDir dataDir;
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_ThumbnailStore, InsertAndRead)
+{
+    ThumbnailStore store(storeDir.path());
+    const QString &small = createFile("small.png");
+    const QString &large = createFile("large.png");
+    const QImage &smallImg = createImage(64, 48, Qt::blue);
+    const QImage &largeImg = createImage(256, 200, Qt::green);
+
+    const QString &smallPath = store.insert(small, smallImg, kSmall);
+    const QString &largePath = store.insert(large, largeImg, kLarge);
+    EXPECT_TRUE(ThumbnailStore::isStorePath(smallPath));
+    EXPECT_TRUE(ThumbnailStore::isStorePath(largePath));
+
+    QString thumbnail;
+    EXPECT_EQ(smallImg, store.image(small, kSmall, &thumbnail));
+    EXPECT_EQ(smallPath, thumbnail);
+    EXPECT_EQ(largeImg, store.image(largePath));
+    EXPECT_TRUE(store.image(large, kNormal).isNull());
+
+    // 源文件修改后缩略图失效
+    QFile file(large);
+    ASSERT_TRUE(file.open(QIODevice::Append));
+    file.write("changed");
+    file.close();
+    EXPECT_TRUE(store.image(large, kLarge).isNull());
+}
+
+TEST_F(UT_ThumbnailStore, ReloadFromDisk)
+{
+    const QString &path = createFile("a.png");
+    const QImage &img = createImage(128, 128, Qt::yellow);
+    {
+        ThumbnailStore store(storeDir.path());
+        EXPECT_FALSE(store.insert(path, createImage(128, 128, Qt::black), kNormal).isEmpty());
+        EXPECT_FALSE(store.insert(path, img, kNormal).isEmpty());
+    }
+
+    // 段文件末尾写了一半的记录被截断
+    const auto &segments = QDir(storeDir.path()).entryInfoList({ "*.seg" }, QDir::Files);
+    ASSERT_EQ(1, segments.count());
+    QFile file(segments.first().absoluteFilePath());
+    ASSERT_TRUE(file.open(QIODevice::Append));
+    file.write(QByteArray(100, 'x'));
+    file.close();
+
+    ThumbnailStore store(storeDir.path());
+    EXPECT_EQ(img, store.image(path, kNormal));
+}
+
+TEST_F(UT_ThumbnailStore, EvictAndCompact)
+{
+    ThumbnailStore store(storeDir.path());
+    QStringList paths;
+    for (int i = 0; i < 20; ++i) {
+        paths.append(createFile(QString("%1.png").arg(i)));
+        store.insert(paths.last(), createImage(64, 64, QColor(i, i, i)), kSmall);
+    }
+
+    const qint64 used = store.usedSize();
+    store.image(paths.first(), kSmall);
+    store.setSizeLimit(used / 2);
+    store.compact();
+
+    EXPECT_LE(store.usedSize(), used / 2);
+    // 最近访问过的缩略图保留，最早写入的被淘汰
+    EXPECT_FALSE(store.image(paths.at(0), kSmall).isNull());
+    EXPECT_TRUE(store.image(paths.at(1), kSmall).isNull());
+    EXPECT_FALSE(store.image(paths.last(), kSmall).isNull());
+}
+
+TEST_F(UT_ThumbnailStore, RecordKeyMismatch)
+{
+    ThumbnailStore store(storeDir.path());
+    const QString &a = createFile("a.png");
+    const QString &b = createFile("b.png");
+    const QImage &bImg = createImage(64, 64, Qt::blue);
+    const QString &aPath = store.insert(a, createImage(64, 64, Qt::green), kSmall);
+    const QString &bPath = store.insert(b, bImg, kSmall);
+
+    // 索引指向另一个文件的记录时当作没有缓存
+    ThumbnailStore::StoreKey aKey;
+    ThumbnailStore::StoreKey bKey;
+    ASSERT_TRUE(ThumbnailStore::pathToKey(aPath, &aKey));
+    ASSERT_TRUE(ThumbnailStore::pathToKey(bPath, &bKey));
+    store.entries[aKey].offset = store.entries.value(bKey).offset;
+
+    EXPECT_TRUE(store.image(a, kSmall).isNull());
+    EXPECT_FALSE(store.entries.contains(aKey));
+    EXPECT_EQ(bImg, store.image(b, kSmall));
+}
+
+TEST_F(UT_ThumbnailStore, SharedByProcesses)
+{
+    const QString &a = createFile("a.png");
+    const QString &b = createFile("b.png");
+    const QImage &aImg = createImage(64, 64, Qt::green);
+    const QImage &bImg = createImage(64, 64, Qt::blue);
+
+    // 两个实例模拟共用缓存目录的两个进程，分别写入自己的段文件
+    ThumbnailStore first(storeDir.path());
+    ThumbnailStore second(storeDir.path());
+    EXPECT_FALSE(first.insert(a, aImg, kSmall).isEmpty());
+    EXPECT_FALSE(second.insert(b, bImg, kSmall).isEmpty());
+    EXPECT_FALSE(first.insert(b, bImg, kNormal).isEmpty());
+    EXPECT_EQ(2, QDir(storeDir.path()).entryList({ "*.seg" }, QDir::Files).count());
+
+    ThumbnailStore store(storeDir.path());
+    EXPECT_EQ(aImg, store.image(a, kSmall));
+    EXPECT_EQ(bImg, store.image(b, kSmall));
+    EXPECT_EQ(bImg, store.image(b, kNormal));
+}
+
+TEST_F(UT_ThumbnailStore, ImportStoppedByDestructor)
+{
+    std::atomic_bool started { false };
+    std::atomic_bool finished { false };
+    stub.set_lamda(&ThumbnailStore::importFreedesktopCache, [&started, &finished](ThumbnailStore *store) {
+        __DBG_STUB_INVOKE__
+        started = true;
+        while (!store->stopped)
+            QThread::msleep(10);
+        finished = true;
+    });
+
+    {
+        ThumbnailStore store(storeDir.path());
+        store.startImport();
+        while (!started)
+            QThread::msleep(10);
+    }
+    // 析构时等待导入结束
+    EXPECT_TRUE(finished);
+}
@@ -0,0 +1,121 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include <stubext.h>
+#include "utils/thumbnail/thumbnailworker.h"
+#include "utils/thumbnail/private/thumbnailworker_p.h"
+
+#include <gtest/gtest.h>
+
+DFMBASE_USE_NAMESPACE
+DFMGLOBAL_USE_NAMESPACE
+
+using ThumbnailTask = ThumbnailWorkerPrivate::ThumbnailTask;
+using TaskKind = ThumbnailWorkerPrivate::TaskKind;
+
+class UT_ThumbnailWorker : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        // 不启动线程池，只验证任务的调度
+        stub.set_lamda(&ThumbnailWorkerPrivate::startLoops, [] { __DBG_STUB_INVOKE__ });
+        worker.reset(new ThumbnailWorker);
+        d = worker->d.data();
+        d->runningLoops = 1;
+    }
+    void TearDown() override
+    {
+        worker.reset();
+        stub.clear();
+    }
+
+    QUrl fileUrl(const QString &name) const
+    {
+        return QUrl::fromLocalFile("/tmp/thumbnail/" + name);
+    }
+
+    QList<QUrl> takeAll()
+    {
+        QList<QUrl> urls;
+        ThumbnailTask task;
+        while (d->takeTask(&task)) {
+            urls.append(task.url);
+            d->runningLoops = 1;
+        }
+        return urls;
+    }
+
+    QScopedPointer<ThumbnailWorker> worker;
+    ThumbnailWorkerPrivate *d { nullptr };
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_ThumbnailWorker, TakeByPriority)
+{
+    worker->addTask(fileUrl("a.png"), kLarge, ThumbnailPriority::kBackground);
+    worker->addTask(fileUrl("b.png"), kLarge, ThumbnailPriority::kPrefetch);
+    worker->addTask(fileUrl("c.png"), kLarge, ThumbnailPriority::kVisible);
+    // 再次请求只会提升优先级
+    worker->addTask(fileUrl("a.png"), kLarge, ThumbnailPriority::kVisible);
+    worker->addTask(fileUrl("c.png"), kLarge, ThumbnailPriority::kBackground);
+
+    EXPECT_EQ(3, d->queuedTasks.count());
+    EXPECT_EQ(QList<QUrl>({ fileUrl("c.png"), fileUrl("a.png"), fileUrl("b.png") }), takeAll());
+    EXPECT_TRUE(d->queuedTasks.isEmpty());
+}
+
+TEST_F(UT_ThumbnailWorker, CancelAndReschedule)
+{
+    const QUrl &dirUrl = QUrl::fromLocalFile("/tmp/thumbnail");
+    worker->addTask(fileUrl("a.png"), kLarge, ThumbnailPriority::kVisible);
+    worker->addTask(fileUrl("b.png"), kLarge, ThumbnailPriority::kVisible);
+    worker->addTask(fileUrl("c.png"), kLarge, ThumbnailPriority::kVisible);
+    worker->addTask(fileUrl("d.png"), kLarge, ThumbnailPriority::kBackground);
+    worker->addTask(QUrl::fromLocalFile("/tmp/other/e.png"), kLarge, ThumbnailPriority::kVisible);
+
+    EXPECT_EQ(QList<QUrl>({ fileUrl("a.png") }), worker->cancelTasks({ fileUrl("a.png"), fileUrl("x.png") }));
+
+    // b滚出可见区域被取消，c变为预取，d是后台任务不取消，e不在当前目录
+    const auto &canceled = worker->rescheduleTasks(dirUrl, {}, { fileUrl("c.png") });
+    EXPECT_EQ(QList<QUrl>({ fileUrl("b.png") }), canceled);
+    EXPECT_EQ(QList<QUrl>({ QUrl::fromLocalFile("/tmp/other/e.png"), fileUrl("c.png"), fileUrl("d.png") }), takeAll());
+}
+
+TEST_F(UT_ThumbnailWorker, KindLimit)
+{
+    d->pool.setMaxThreadCount(4);
+    EXPECT_EQ(TaskKind::kVideo, d->kindOf("video/mp4"));
+    EXPECT_EQ(TaskKind::kDocument, d->kindOf(Mime::kTypeAppPdf));
+    EXPECT_EQ(TaskKind::kImage, d->kindOf("image/jpeg"));
+    EXPECT_EQ(1, d->kindLimit(TaskKind::kVideo));
+
+    auto videoTask = [this](const QString &name) {
+        ThumbnailTask task;
+        task.url = fileUrl(name);
+        task.kind = TaskKind::kVideo;
+        return task;
+    };
+
+    QMutexLocker lk(&d->mutex);
+    d->enqueueTask(videoTask("a.mp4"));
+    d->enqueueTask(videoTask("b.mp4"));
+    lk.unlock();
+    worker->addTask(fileUrl("c.png"), kLarge, ThumbnailPriority::kBackground);
+
+    ThumbnailTask task;
+    ASSERT_TRUE(d->takeTask(&task));
+    EXPECT_EQ(fileUrl("a.mp4"), task.url);
+
+    // 视频的执行数量已满，跳过b.mp4
+    ASSERT_TRUE(d->takeTask(&task));
+    EXPECT_EQ(fileUrl("c.png"), task.url);
+    EXPECT_FALSE(d->takeTask(&task));
+
+    d->releaseSlot(TaskKind::kVideo);
+    d->runningLoops = 1;
+    ASSERT_TRUE(d->takeTask(&task));
+    EXPECT_EQ(fileUrl("b.mp4"), task.url);
+    d->releaseSlot(TaskKind::kVideo);
+}
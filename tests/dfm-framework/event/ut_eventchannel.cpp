@@ -9,6 +9,9 @@
 
 #include <gtest/gtest.h>
 
+#include <QElapsedTimer>
+#include <QDebug>
+
 DPF_USE_NAMESPACE
 
 class UT_EventChannel : public testing::Test
@@ -60,3 +63,69 @@ TEST_F(UT_EventChannel, test_manager_post)
     QVariant value = future.result();
     EXPECT_EQ(value.toInt(), 20);
 }
+
+TEST_F(UT_EventChannel, test_typed_send)
+{
+    TestQObject b;
+    EventChannel channel;
+    channel.setReceiver(&b, &TestQObject::test1);
+    // same signature, called without QVariant
+    EXPECT_EQ(channel.send(8).toInt(), 18);
+    // different signature, converted by QVariant
+    EXPECT_EQ(channel.send(qint64(8)).toInt(), 18);
+    EXPECT_EQ(channel.send(QString("8")).toInt(), 18);
+}
+
+TEST_F(UT_EventChannel, test_manager_disconnect)
+{
+    TestQObject b;
+    EventType type = 12346;
+    EXPECT_TRUE(dpfSlotChannel->connect(type, &b, &TestQObject::test1));
+    EXPECT_EQ(dpfSlotChannel->push(type, 1).toInt(), 11);
+    EXPECT_TRUE(dpfSlotChannel->disconnect(type));
+    EXPECT_FALSE(dpfSlotChannel->push(type, 1).isValid());
+    EXPECT_FALSE(dpfSlotChannel->disconnect(type));
+
+    EXPECT_TRUE(dpfSlotChannel->connect(type, &b, &TestQObject::test1));
+    EXPECT_EQ(dpfSlotChannel->push(type, 2).toInt(), 12);
+    EXPECT_TRUE(dpfSlotChannel->disconnect(type));
+}
+
+// run with --gtest_also_run_disabled_tests
+TEST_F(UT_EventChannel, DISABLED_test_push_benchmark)
+{
+    static constexpr int kLoopCount = 200000;
+    TestQObject b;
+    EventType type = 12347;
+    dpfSlotChannel->connect(type, &b, &TestQObject::test1);
+
+    // the previous path: lock the map, look up the channel and pack the arguments into QVariantList
+    EventChannel channel;
+    channel.setReceiver(&b, &TestQObject::test1);
+    QReadWriteLock lock;
+    QMap<EventType, EventChannel *> channels { { type, &channel } };
+
+    qint64 variantSum { 0 };
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < kLoopCount; ++i) {
+        QReadLocker guard(&lock);
+        auto c = channels.value(type);
+        guard.unlock();
+        QVariantList args;
+        makeVariantList(&args, i);
+        variantSum += c->send(args).toInt();
+    }
+    const qint64 variantNs = timer.nsecsElapsed();
+
+    qint64 typedSum { 0 };
+    timer.restart();
+    for (int i = 0; i < kLoopCount; ++i)
+        typedSum += dpfSlotChannel->push(type, i).toInt();
+    const qint64 typedNs = timer.nsecsElapsed();
+
+    EXPECT_EQ(variantSum, typedSum);
+    qInfo() << "push latency(ns), QVariant path:" << variantNs / kLoopCount << "typed path:" << typedNs / kLoopCount;
+
+    dpfSlotChannel->disconnect(type);
+}
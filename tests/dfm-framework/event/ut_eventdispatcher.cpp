@@ -65,3 +65,21 @@ TEST_F(UT_EventDispatcher, test_unsub)
 
     EXPECT_TRUE(dpfSignalDispatcher->unsubscribe(eType1));
 }
+
+TEST_F(UT_EventDispatcher, test_typed_filter)
+{
+    TestQObject b;
+    EventType eType1 = 3;
+    int called = 0;
+    EXPECT_TRUE(dpfSignalDispatcher->installEventFilter(eType1, &b, &TestQObject::bigger10));
+    EXPECT_TRUE(dpfSignalDispatcher->subscribe(eType1, &b, &TestQObject::add1));
+
+    // the filter and the handler have different signatures
+    EXPECT_TRUE(dpfSignalDispatcher->publish(eType1, 5, &called));
+    EXPECT_EQ(called, 10);
+    EXPECT_FALSE(dpfSignalDispatcher->publish(eType1, 20, &called));
+    EXPECT_EQ(called, 10);
+
+    EXPECT_TRUE(dpfSignalDispatcher->removeEventFilter(eType1, &b, &TestQObject::bigger10));
+    EXPECT_TRUE(dpfSignalDispatcher->unsubscribe(eType1));
+}
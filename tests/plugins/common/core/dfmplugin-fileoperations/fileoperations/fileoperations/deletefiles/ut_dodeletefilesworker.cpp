@@ -51,6 +51,7 @@ TEST_F(UT_DoDeleteFilesWorker, testDoWork)
 
     stub.set_lamda(VADDR(AbstractWorker, doWork), []{ __DBG_STUB_INVOKE__ return true;});
     stub.set_lamda(&DoDeleteFilesWorker::deleteFilesOnCanNotRemoveDevice,[]{ __DBG_STUB_INVOKE__ return true;});
+    stub.set_lamda(&DoDeleteFilesWorker::deleteFilesOnLocalDevice,[]{ __DBG_STUB_INVOKE__ return true;});
     stub.set_lamda(&DoDeleteFilesWorker::deleteFilesOnOtherDevice,[]{ __DBG_STUB_INVOKE__ return true;});
     stub.set_lamda(VADDR(AbstractWorker, endWork), []{ __DBG_STUB_INVOKE__ });
     EXPECT_TRUE(worker.doWork());
@@ -93,6 +94,26 @@ TEST_F(UT_DoDeleteFilesWorker, testDeleteFilesOnCanNotRemoveDevice)
     EXPECT_FALSE(worker.deleteFilesOnCanNotRemoveDevice());
 }
 
+TEST_F(UT_DoDeleteFilesWorker, testDeleteFilesOnLocalDevice)
+{
+    DoDeleteFilesWorker worker;
+    stub_ext::StubExt stub;
+    const QString &dirPath = QDir::currentPath() + "/localDeleteWorkerDir";
+    QDir().mkpath(dirPath + "/sub");
+    QFile file(dirPath + "/sub/file.txt");
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    worker.sourceUrls.append(QUrl::fromLocalFile(dirPath));
+
+    stub.set_lamda(&FileUtils::notifyFileChangeManual, []{ __DBG_STUB_INVOKE__ });
+    EXPECT_TRUE(worker.deleteFilesOnLocalDevice());
+    EXPECT_FALSE(QFileInfo::exists(dirPath));
+    EXPECT_EQ(1, worker.completeSourceFiles.count());
+
+    stub.set_lamda(&DoDeleteFilesWorker::deleteFilesOnCanNotRemoveDevice, []{ __DBG_STUB_INVOKE__ return false;});
+    EXPECT_FALSE(worker.deleteFilesOnLocalDevice());
+}
+
 TEST_F(UT_DoDeleteFilesWorker, testDeleteFilesOnOtherDevice)
 {
     DoDeleteFilesWorker worker;
@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/copybufferpool.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/workerdata.h"
+
+#include <gtest/gtest.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+TEST(UT_CopyBufferPool, testRoundCapacity)
+{
+    EXPECT_EQ(4096, CopyBufferPool::roundCapacity(0));
+    EXPECT_EQ(4096, CopyBufferPool::roundCapacity(100));
+    EXPECT_EQ(1024 * 1024, CopyBufferPool::roundCapacity(1024 * 1024));
+    EXPECT_EQ(2 * 1024 * 1024, CopyBufferPool::roundCapacity(1024 * 1024 + 1));
+}
+
+TEST(UT_CopyBufferPool, testAcquireAndRelease)
+{
+    CopyBufferPool pool(8192);
+    qint64 capacity { 0 };
+    char *buffer = pool.acquire(5000, &capacity);
+    ASSERT_NE(nullptr, buffer);
+    EXPECT_EQ(8192, capacity);
+    EXPECT_EQ(0, reinterpret_cast<quintptr>(buffer) % 4096);
+
+    pool.release(buffer, capacity);
+    EXPECT_EQ(8192, pool.idleSize());
+    EXPECT_EQ(buffer, pool.acquire(8000, &capacity));
+    EXPECT_EQ(0, pool.idleSize());
+
+    char *other = pool.acquire(100, nullptr);
+    pool.release(buffer, capacity);
+    // the pool is full, the buffer is freed
+    pool.release(other, 4096);
+    EXPECT_EQ(8192, pool.idleSize());
+
+    pool.clear();
+    EXPECT_EQ(0, pool.idleSize());
+}
+
+TEST(UT_CopyBufferPool, testCopyBuffer)
+{
+    CopyBufferPool pool;
+    {
+        CopyBuffer buffer(&pool, 1024);
+        EXPECT_EQ(4096, buffer.capacity());
+        buffer.reserve(4096);
+        EXPECT_EQ(4096, buffer.capacity());
+        buffer.reserve(10000);
+        EXPECT_EQ(16384, buffer.capacity());
+        EXPECT_EQ(4096, pool.idleSize());
+    }
+    EXPECT_EQ(4096 + 16384, pool.idleSize());
+}
+
+TEST(UT_CopyBufferPool, testCopyBlockSize)
+{
+    WorkerData data;
+    EXPECT_EQ(1024 * 1024, data.copyBlockSize());
+    EXPECT_EQ(16 * 1024 * 1024, data.maxCopyBlockSize());
+
+    data.isBlockDevice = true;
+    EXPECT_EQ(8 * 1024 * 1024, data.maxCopyBlockSize());
+
+    data.isTargetLowSpeed = true;
+    EXPECT_EQ(256 * 1024, data.copyBlockSize());
+    EXPECT_EQ(2 * 1024 * 1024, data.maxCopyBlockSize());
+}
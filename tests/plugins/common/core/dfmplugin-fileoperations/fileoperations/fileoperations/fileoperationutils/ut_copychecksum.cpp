@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/copychecksum.h"
+
+#include <QByteArray>
+
+#include <gtest/gtest.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+TEST(UT_CopyCheckSum, testCrc32c)
+{
+    const QByteArray data("123456789");
+    EXPECT_EQ(0xE3069283, CopyCheckSum::crc32c(0, data.constData(), static_cast<size_t>(data.size())));
+
+    quint32 crc = CopyCheckSum::crc32c(0, data.constData(), 4);
+    crc = CopyCheckSum::crc32c(crc, data.constData() + 4, 5);
+    EXPECT_EQ(0xE3069283, crc);
+}
+
+TEST(UT_CopyCheckSum, testSamples)
+{
+    const QByteArray data(100000, 'x');
+    CopyCheckSum checkSum(data.size(), 4);
+    for (int offset = 0; offset < data.size(); offset += 4096)
+        checkSum.update(offset, data.constData() + offset, qMin(4096, data.size() - offset));
+
+    EXPECT_EQ(CopyCheckSum::crc32c(0, data.constData(), static_cast<size_t>(data.size())), checkSum.value());
+    ASSERT_EQ(4, checkSum.samples().size());
+    EXPECT_EQ(0, checkSum.samples().first().offset);
+    EXPECT_EQ(24576, checkSum.samples().at(1).offset);
+    EXPECT_EQ(49152, checkSum.samples().at(2).offset);
+    EXPECT_EQ(98304, checkSum.samples().last().offset);
+    EXPECT_EQ(1696, checkSum.samples().last().size);
+}
@@ -4,6 +4,7 @@
 
 #include "stubext.h"
 #include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/docopyfileworker.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/fileoperationsutils.h"
 
 #include <dfm-base/base/urlroute.h>
 #include <dfm-base/base/schemefactory.h>
@@ -459,3 +460,38 @@ TEST_F(UT_DoCopyFileWorker, testSyncBlockFile)
     stub.set(&::close, SyncFFunc);
     worker.syncBlockFile(sorceInfo);
 }
+
+TEST_F(UT_DoCopyFileWorker, testDoKernelCopyFile)
+{
+    QSharedPointer<WorkerData> data(new WorkerData);
+    DoCopyFileWorker worker(data);
+
+    auto sorceUrl = QUrl::fromLocalFile(QDir::currentPath() + "/kernelSourceUrl.txt");
+    auto targetUrl = QUrl::fromLocalFile(QDir::currentPath() + "/kernelTargetUrl.txt");
+    QFile sourceFile(sorceUrl.path());
+    ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+    sourceFile.write(QByteArray(4096, 'a'));
+    sourceFile.close();
+    auto sorceInfo = InfoFactory::create<FileInfo>(sorceUrl);
+    auto targetInfo = InfoFactory::create<FileInfo>(targetUrl);
+
+    bool skip { false };
+    EXPECT_EQ(DoCopyFileWorker::KernelCopyResult::kUnsupported, worker.doKernelCopyFile(sorceInfo, targetInfo, &skip));
+
+    data->kernelCopy = true;
+    data->jobFlags |= AbstractJobHandler::JobFlag::kCopyIntegrityChecking;
+    EXPECT_FALSE(worker.canKernelCopy(sorceInfo, targetInfo));
+
+    data->jobFlags = AbstractJobHandler::JobFlag::kNoHint;
+    EXPECT_TRUE(worker.canKernelCopy(sorceInfo, targetInfo));
+    EXPECT_EQ(DoCopyFileWorker::KernelCopyResult::kCopied, worker.doKernelCopyFile(sorceInfo, targetInfo, &skip));
+    EXPECT_EQ(4096, QFileInfo(targetUrl.path()).size());
+    EXPECT_EQ(4096, data->currentWriteSize);
+
+    worker.stop();
+    stub_ext::StubExt stub;
+    stub.set_lamda(&FileOperationsUtils::reflinkFile, []{ __DBG_STUB_INVOKE__ return false;});
+    EXPECT_EQ(DoCopyFileWorker::KernelCopyResult::kFailed, worker.doKernelCopyFile(sorceInfo, targetInfo, &skip));
+
+    QProcess::execute("rm kernelSourceUrl.txt kernelTargetUrl.txt");
+}
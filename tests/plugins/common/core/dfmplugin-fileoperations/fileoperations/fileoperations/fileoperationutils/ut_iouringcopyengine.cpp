@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/iouringcopyengine.h"
+
+#include <dfm-base/base/urlroute.h>
+#include <dfm-base/base/schemefactory.h>
+#include <dfm-base/file/local/syncfileinfo.h>
+
+#include <QDir>
+#include <QFile>
+#include <QProcess>
+
+#include <gtest/gtest.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+DFMBASE_USE_NAMESPACE
+
+class UT_IoUringCopyEngine : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        UrlRoute::regScheme(Global::Scheme::kFile, "/", QIcon(), false, QObject::tr("System Disk"));
+        InfoFactory::regClass<dfmbase::SyncFileInfo>(Global::Scheme::kFile);
+    }
+    void TearDown() override {}
+};
+
+TEST_F(UT_IoUringCopyEngine, testCopyFiles)
+{
+    QSharedPointer<WorkerData> data(new WorkerData);
+    IoUringCopyEngine engine(data);
+    if (!IoUringCopyEngine::isSupported() || !engine.isValid())
+        return;
+
+    QList<CopyFilePair> files;
+    for (int i = 0; i < 3; ++i) {
+        const QString &sourcePath = QDir::currentPath() + QString("/uringSource%1.txt").arg(i);
+        QFile sourceFile(sourcePath);
+        ASSERT_TRUE(sourceFile.open(QIODevice::WriteOnly));
+        sourceFile.write(QByteArray(1000 * i, 'a'));
+        sourceFile.close();
+        files.append(qMakePair(InfoFactory::create<FileInfo>(QUrl::fromLocalFile(sourcePath)),
+                               InfoFactory::create<FileInfo>(QUrl::fromLocalFile(QDir::currentPath() + QString("/uringTarget%1.txt").arg(i)))));
+    }
+
+    EXPECT_TRUE(engine.copyFiles(files, [] { return false; }).size() == 3);
+
+    EXPECT_TRUE(engine.copyFiles(files, [] { return true; }).isEmpty());
+    for (int i = 0; i < 3; ++i)
+        EXPECT_EQ(1000 * i, QFileInfo(QDir::currentPath() + QString("/uringTarget%1.txt").arg(i)).size());
+    EXPECT_EQ(3000, data->currentWriteSize);
+    EXPECT_EQ(3, data->completeFileCount);
+
+    QProcess::execute("sh -c \"rm uringSource*.txt uringTarget*.txt\"");
+}
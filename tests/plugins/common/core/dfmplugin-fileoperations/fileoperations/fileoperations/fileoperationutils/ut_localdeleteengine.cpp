@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/localdeleteengine.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QProcess>
+
+#include <gtest/gtest.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+class UT_LocalDeleteEngine : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        rootPath = QDir::currentPath() + "/localDeleteEngineRoot";
+        for (int i = 0; i < 3; ++i) {
+            const QString &dirPath = rootPath + QString("/dir%1/sub").arg(i);
+            QDir().mkpath(dirPath);
+            for (int j = 0; j < 10; ++j) {
+                QFile file(dirPath + QString("/file%1.txt").arg(j));
+                file.open(QIODevice::WriteOnly);
+                file.close();
+            }
+        }
+    }
+    void TearDown() override
+    {
+        QProcess::execute("rm", { "-rf", rootPath });
+    }
+
+    QString rootPath;
+};
+
+TEST_F(UT_LocalDeleteEngine, testDeleteTree)
+{
+    QAtomicInteger<qint64> deletedCount { 0 };
+    LocalDeleteEngine engine(&deletedCount, 4);
+
+    EXPECT_TRUE(engine.deleteTree(QFile::encodeName(rootPath), [] { return true; }));
+    EXPECT_FALSE(QFileInfo::exists(rootPath));
+    EXPECT_EQ(30, deletedCount);
+
+    EXPECT_FALSE(engine.deleteTree(QFile::encodeName(rootPath), [] { return true; }));
+}
+
+TEST_F(UT_LocalDeleteEngine, testDeleteDeepTreeClosesFds)
+{
+    QString dirPath = rootPath;
+    for (int i = 0; i < 64; ++i)
+        dirPath += QString("/deep%1").arg(i);
+    QDir().mkpath(dirPath);
+    QFile file(dirPath + "/file.txt");
+    file.open(QIODevice::WriteOnly);
+    file.close();
+
+    const int fdCount = QDir("/proc/self/fd").entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size();
+    QAtomicInteger<qint64> deletedCount { 0 };
+    LocalDeleteEngine engine(&deletedCount, 4);
+
+    EXPECT_TRUE(engine.deleteTree(QFile::encodeName(rootPath), [] { return true; }));
+    EXPECT_FALSE(QFileInfo::exists(rootPath));
+    EXPECT_EQ(31, deletedCount);
+    EXPECT_EQ(fdCount, QDir("/proc/self/fd").entryList(QDir::AllEntries | QDir::System | QDir::NoDotAndDotDot).size());
+}
+
+TEST_F(UT_LocalDeleteEngine, testDeleteFile)
+{
+    QAtomicInteger<qint64> deletedCount { 0 };
+    LocalDeleteEngine engine(&deletedCount, 1);
+
+    EXPECT_TRUE(engine.deleteTree(QFile::encodeName(rootPath + "/dir0/sub/file0.txt"), [] { return true; }));
+    EXPECT_FALSE(QFileInfo::exists(rootPath + "/dir0/sub/file0.txt"));
+    EXPECT_EQ(1, deletedCount);
+}
+
+TEST_F(UT_LocalDeleteEngine, testStop)
+{
+    LocalDeleteEngine engine(nullptr, 2);
+
+    // stop before reading the first directory, everything is left
+    stub_ext::StubExt stub;
+    stub.set_lamda(&LocalDeleteEngine::deleteDir, [](LocalDeleteEngine *self, const int index, LocalDeleteEngine::DirTask *task) {
+        __DBG_STUB_INVOKE__
+        self->stopped = true;
+        self->finishDir(index, task);
+    });
+    EXPECT_FALSE(engine.deleteTree(QFile::encodeName(rootPath), [] { return true; }));
+    EXPECT_TRUE(QFileInfo::exists(rootPath + "/dir0/sub/file0.txt"));
+}
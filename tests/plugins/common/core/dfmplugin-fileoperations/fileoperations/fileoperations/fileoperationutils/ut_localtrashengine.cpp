@@ -0,0 +1,74 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/localtrashengine.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+
+#include <gtest/gtest.h>
+
+DPFILEOPERATIONS_USE_NAMESPACE
+
+class UT_LocalTrashEngine : public testing::Test
+{
+public:
+    void SetUp() override
+    {
+        ASSERT_TRUE(tempDir.isValid());
+        QDir().mkpath(tempDir.path() + "/source1");
+        QDir().mkpath(tempDir.path() + "/source2");
+    }
+    void TearDown() override {}
+
+    QUrl createFile(const QString &path)
+    {
+        QFile file(tempDir.path() + path);
+        file.open(QIODevice::WriteOnly);
+        file.close();
+        return QUrl::fromLocalFile(file.fileName());
+    }
+
+    QTemporaryDir tempDir;
+};
+
+TEST_F(UT_LocalTrashEngine, testTrashFiles)
+{
+    LocalTrashEngine engine(tempDir.path() + "/Trash/files", tempDir.path() + "/Trash/info");
+    ASSERT_TRUE(engine.isValid());
+
+    QList<QUrl> urls { createFile("/source1/a.tar.gz"), createFile("/source2/a.tar.gz"), createFile("/source1/b c") };
+    EXPECT_TRUE(engine.canTrash(urls.first()));
+
+    QList<QUrl> trashedUrls;
+    const QString &trashTime = engine.trashFiles(urls, &trashedUrls);
+    EXPECT_EQ(2, trashTime.split("-").count());
+    EXPECT_EQ(urls, trashedUrls);
+
+    // the same names as gio
+    EXPECT_TRUE(QFileInfo::exists(tempDir.path() + "/Trash/files/a.tar.gz"));
+    EXPECT_TRUE(QFileInfo::exists(tempDir.path() + "/Trash/files/a.2.tar.gz"));
+    EXPECT_FALSE(QFileInfo::exists(tempDir.path() + "/source1/a.tar.gz"));
+
+    QFile info(tempDir.path() + "/Trash/info/b c.trashinfo");
+    ASSERT_TRUE(info.open(QIODevice::ReadOnly));
+    const QByteArray &content = info.readAll();
+    EXPECT_TRUE(content.startsWith("[Trash Info]\n"));
+    EXPECT_TRUE(content.contains("Path=" + QFile::encodeName(tempDir.path()) + "/source1/b%20c\n"));
+    EXPECT_TRUE(content.contains("DeletionDate="));
+}
+
+TEST_F(UT_LocalTrashEngine, testTrashMissingFile)
+{
+    LocalTrashEngine engine(tempDir.path() + "/Trash/files", tempDir.path() + "/Trash/info");
+
+    QList<QUrl> trashedUrls;
+    engine.trashFiles({ QUrl::fromLocalFile(tempDir.path() + "/source1/missing") }, &trashedUrls);
+    EXPECT_TRUE(trashedUrls.isEmpty());
+    EXPECT_FALSE(QFileInfo::exists(tempDir.path() + "/Trash/info/missing.trashinfo"));
+    EXPECT_FALSE(engine.canTrash(QUrl::fromLocalFile(tempDir.path() + "/source1/missing")));
+}
@@ -5,6 +5,7 @@
 #include "stubext.h"
 #include "plugins/common/core/dfmplugin-fileoperations/fileoperations/trashfiles/movetotrashfiles.h"
 #include "plugins/common/core/dfmplugin-fileoperations/fileoperations/trashfiles/domovetotrashfilesworker.h"
+#include "plugins/common/core/dfmplugin-fileoperations/fileoperations/fileoperationutils/localtrashengine.h"
 
 #include <dfm-base/base/urlroute.h>
 #include <dfm-base/base/schemefactory.h>
@@ -80,6 +81,34 @@ TEST_F(UT_DoMoveToTrashFilesWorker, testIsCanMoveToTrash)
 }
 
 
+TEST_F(UT_DoMoveToTrashFilesWorker, testDoMoveToTrashOnLocalDevice)
+{
+    DoMoveToTrashFilesWorker worker;
+    stub_ext::StubExt stub;
+    const QString &sourcePath = QDir::currentPath() + "/localTrashSource_DoMoveToTrashFilesWorker.txt";
+    worker.sourceUrls.append(QUrl::fromLocalFile(sourcePath));
+
+    QSet<QUrl> trashedUrls;
+    stub.set_lamda(&LocalTrashEngine::isValid, []{ __DBG_STUB_INVOKE__ return false;});
+    EXPECT_TRUE(worker.doMoveToTrashOnLocalDevice(&trashedUrls));
+    EXPECT_TRUE(trashedUrls.isEmpty());
+
+    stub.set_lamda(&LocalTrashEngine::isValid, []{ __DBG_STUB_INVOKE__ return true;});
+    stub.set_lamda(&LocalTrashEngine::canTrash, []{ __DBG_STUB_INVOKE__ return true;});
+    stub.set_lamda(&LocalTrashEngine::trashFiles, [](LocalTrashEngine *, const QList<QUrl> &urls, QList<QUrl> *trashed) {
+        __DBG_STUB_INVOKE__
+        *trashed = urls;
+        return QString("1-2");
+    });
+    EXPECT_TRUE(worker.doMoveToTrashOnLocalDevice(&trashedUrls));
+    EXPECT_TRUE(trashedUrls.contains(QUrl::fromLocalFile(sourcePath)));
+    ASSERT_EQ(1, worker.completeTargetFiles.count());
+    EXPECT_EQ(QString("1-2"), worker.completeTargetFiles.first().userInfo());
+
+    worker.stop();
+    EXPECT_FALSE(worker.doMoveToTrashOnLocalDevice(&trashedUrls));
+}
+
 bool isCanMoveToTrashFunc(DoMoveToTrashFilesWorker *&, const QUrl &url, bool *result) {
     __DBG_STUB_INVOKE__
     if (result)
@@ -91,6 +120,7 @@ TEST_F(UT_DoMoveToTrashFilesWorker, testDoMoveToTrash)
 {
     DoMoveToTrashFilesWorker worker;
     stub_ext::StubExt stub;
+    stub.set_lamda(&LocalTrashEngine::canTrash, []{ __DBG_STUB_INVOKE__ return false;});
     QUrl url = QUrl::fromLocalFile("/data/home");
     worker.sourceUrls.append(url);
     worker.stop();
@@ -160,3 +160,37 @@ TEST_F(FileTagCacheTest, onFilesUntagged)
     FileTagCacheController::instance().cacheWorker->onFilesUntagged(QVariantMap());
     EXPECT_TRUE(isRun);
 }
+
+TEST_F(FileTagCacheTest, tagColorsByFile)
+{
+    QVariantMap tags;
+    tags["zeta"] = QString("#ff0000");
+    tags["alpha"] = QString("#00ff00");
+    ins->addTags(tags);
+
+    QVariantMap files;
+    files["/tmp/a"] = QStringList { "zeta", "alpha", "nocolor" };
+    files["/tmp/b"] = QStringList { "zeta" };
+    ins->taggeFiles(files);
+
+    // in the order of the tag names, the tags without color are skipped
+    EXPECT_EQ((QList<QColor> { QColor("#00ff00"), QColor("#ff0000") }), ins->getTagColorsByFile("/tmp/a"));
+    EXPECT_EQ(QStringList { "zeta" }, ins->getTagsByFiles({ "/tmp/a", "/tmp/b" }));
+    EXPECT_TRUE(ins->getTagsByFiles({ "/tmp/a", "/tmp/none" }).isEmpty());
+
+    QVariantMap names;
+    names["zeta"] = QString("beta");
+    ins->changeTagName(names);
+    ins->changeFilesTagName("zeta", "beta");
+    EXPECT_EQ((QStringList { "alpha", "beta", "nocolor" }), ins->getTagsByFiles({ "/tmp/a" }));
+    EXPECT_EQ(QColor("#ff0000"), ins->getTagsColor({ "beta" }).value("beta"));
+
+    ins->deleteTags({ "beta" });
+    EXPECT_TRUE(ins->getTagColorsByFile("/tmp/b").isEmpty());
+
+    QVariantMap untag;
+    untag["/tmp/a"] = QStringList { "alpha", "nocolor" };
+    ins->untaggeFiles(untag);
+    EXPECT_TRUE(ins->getTagsByFiles({ "/tmp/a" }).isEmpty());
+    ins->deleteTags({ "alpha", "nocolor" });
+}
@@ -15,6 +15,7 @@
 
 #include <QStandardPaths>
 #include <QString>
+#include <QTemporaryDir>
 
 DFMBASE_USE_NAMESPACE
 DFMGLOBAL_USE_NAMESPACE
@@ -600,3 +601,76 @@ TEST_F(UT_RootInfo, Bug_221483_traversalToken) {
 
     EXPECT_EQ(rootInfoObj->traversalThreads.value(key)->traversalThread->traversalToken, key);
 }
+
+TEST_F(UT_RootInfo, DoIncrementalRefresh)
+{
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    auto touch = [&tmpDir](const QString &name, const QByteArray &content) {
+        QFile file(tmpDir.filePath(name));
+        file.open(QIODevice::WriteOnly);
+        file.write(content);
+    };
+    touch("keep", "keep");
+    touch("added", "added");
+
+    RootInfo root(QUrl::fromLocalFile(tmpDir.path()), false);
+    root.childrenUrlList = { QUrl::fromLocalFile(tmpDir.filePath("keep")),
+                             QUrl::fromLocalFile(tmpDir.filePath("removed")) };
+    SortInfoPointer keepInfo(new SortFileInfo);
+    keepInfo->setSize(4);
+    root.sourceDataList = { keepInfo, SortInfoPointer(new SortFileInfo) };
+    root.snapshotTime = QDateTime::currentMSecsSinceEpoch() * 1000000 + 1000000000;
+
+    QList<QUrl> adds, removes, updates;
+    stub.set_lamda(static_cast<void (RootInfo::*)(const QList<QUrl> &)>(&RootInfo::addChildren),
+                   [&adds](RootInfo *, const QList<QUrl> &urls) { adds = urls; });
+    stub.set_lamda(ADDR(RootInfo, removeChildren), [&removes](RootInfo *, const QList<QUrl> &urls) { removes = urls; });
+    stub.set_lamda(ADDR(RootInfo, updateChildren), [&updates](RootInfo *, const QList<QUrl> &urls) { updates = urls; });
+
+    root.doIncrementalRefresh();
+    EXPECT_EQ(adds, QList<QUrl> { QUrl::fromLocalFile(tmpDir.filePath("added")) });
+    EXPECT_EQ(removes, QList<QUrl> { QUrl::fromLocalFile(tmpDir.filePath("removed")) });
+    EXPECT_TRUE(updates.isEmpty());
+    EXPECT_EQ(2, root.dirSnapshot.count());
+
+    // 有快照之后，大小变化的文件需要更新
+    adds.clear();
+    removes.clear();
+    touch("keep", "changed");
+    root.childrenUrlList = { QUrl::fromLocalFile(tmpDir.filePath("keep")),
+                             QUrl::fromLocalFile(tmpDir.filePath("added")) };
+    root.sourceDataList = { keepInfo, SortInfoPointer(new SortFileInfo) };
+    root.doIncrementalRefresh();
+    EXPECT_TRUE(adds.isEmpty());
+    EXPECT_TRUE(removes.isEmpty());
+    EXPECT_EQ(updates, QList<QUrl> { QUrl::fromLocalFile(tmpDir.filePath("keep")) });
+}
+
+TEST_F(UT_RootInfo, DoIncrementalRefreshHashCollision)
+{
+    // 两个名称的qHash在polynomial实现下相同，增量刷新必须按名称区分
+    QTemporaryDir tmpDir;
+    ASSERT_TRUE(tmpDir.isValid());
+    for (const QString &name : { QString("Aa.txt"), QString("BB.txt") }) {
+        QFile file(tmpDir.filePath(name));
+        file.open(QIODevice::WriteOnly);
+    }
+
+    RootInfo root(QUrl::fromLocalFile(tmpDir.path()), false);
+    root.childrenUrlList = { QUrl::fromLocalFile(tmpDir.filePath("Aa.txt")),
+                             QUrl::fromLocalFile(tmpDir.filePath("BB.txt")) };
+    root.sourceDataList = { SortInfoPointer(new SortFileInfo), SortInfoPointer(new SortFileInfo) };
+    root.snapshotTime = QDateTime::currentMSecsSinceEpoch() * 1000000 + 1000000000;
+
+    QList<QUrl> adds, removes;
+    stub.set_lamda(static_cast<void (RootInfo::*)(const QList<QUrl> &)>(&RootInfo::addChildren),
+                   [&adds](RootInfo *, const QList<QUrl> &urls) { adds = urls; });
+    stub.set_lamda(ADDR(RootInfo, removeChildren), [&removes](RootInfo *, const QList<QUrl> &urls) { removes = urls; });
+    stub.set_lamda(ADDR(RootInfo, updateChildren), [](RootInfo *, const QList<QUrl> &) {});
+
+    root.doIncrementalRefresh();
+    EXPECT_TRUE(adds.isEmpty());
+    EXPECT_TRUE(removes.isEmpty());
+    EXPECT_EQ(2, root.dirSnapshot.count());
+}
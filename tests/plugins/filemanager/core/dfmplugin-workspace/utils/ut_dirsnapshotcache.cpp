@@ -0,0 +1,93 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "stubext.h"
+#include "plugins/filemanager/core/dfmplugin-workspace/utils/dirsnapshotcache.h"
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDir>
+
+DFMBASE_USE_NAMESPACE
+DPWORKSPACE_USE_NAMESPACE
+
+class UT_DirSnapshotCache : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        const QString &cachePath = cacheDir.path();
+        stub.set_lamda(&DirSnapshotCache::snapshotDir, [cachePath] { return cachePath; });
+    }
+    void TearDown() override
+    {
+        stub.clear();
+    }
+
+    SortInfoPointer makeSortInfo(const QString &name, qint64 size, bool isDir)
+    {
+        SortInfoPointer info(new SortFileInfo);
+        info->setUrl(QUrl::fromLocalFile(dataDir.filePath(name)));
+        info->setSize(size);
+        info->setFile(!isDir);
+        info->setDir(isDir);
+        info->setHide(name.startsWith("."));
+        info->setReadable(true);
+        info->setWriteable(!isDir);
+        return info;
+    }
+
+    QTemporaryDir cacheDir;
+    QTemporaryDir dataDir;
+    stub_ext::StubExt stub;
+};
+
+TEST_F(UT_DirSnapshotCache, SaveAndLoad)
+{
+    const QUrl &dirUrl = QUrl::fromLocalFile(dataDir.path());
+    QList<SortInfoPointer> children { makeSortInfo("a.txt", 10, false),
+                                      makeSortInfo(".hidden", 0, false),
+                                      makeSortInfo("子目录", 4096, true) };
+    EXPECT_TRUE(DirSnapshotCache::save(dirUrl, children, 123));
+    EXPECT_TRUE(QFile::exists(DirSnapshotCache::snapshotPath(dirUrl)));
+
+    qint64 dataTime { 0 };
+    const auto &loaded = DirSnapshotCache::load(dirUrl, &dataTime);
+    ASSERT_EQ(children.count(), loaded.count());
+    EXPECT_EQ(123, dataTime);
+    for (int i = 0; i < children.count(); ++i) {
+        EXPECT_EQ(children.at(i)->fileUrl(), loaded.at(i)->fileUrl());
+        EXPECT_EQ(children.at(i)->fileSize(), loaded.at(i)->fileSize());
+        EXPECT_EQ(children.at(i)->isDir(), loaded.at(i)->isDir());
+        EXPECT_EQ(children.at(i)->isFile(), loaded.at(i)->isFile());
+        EXPECT_EQ(children.at(i)->isHide(), loaded.at(i)->isHide());
+        EXPECT_EQ(children.at(i)->isWriteable(), loaded.at(i)->isWriteable());
+    }
+}
+
+TEST_F(UT_DirSnapshotCache, LoadChangedDir)
+{
+    const QUrl &dirUrl = QUrl::fromLocalFile(dataDir.path());
+    EXPECT_TRUE(DirSnapshotCache::save(dirUrl, { makeSortInfo("a.txt", 10, false) }, 0));
+
+    // 目录的修改时间变化后快照失效
+    QFile file(dataDir.filePath("b.txt"));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.close();
+    EXPECT_TRUE(DirSnapshotCache::load(dirUrl).isEmpty());
+}
+
+TEST_F(UT_DirSnapshotCache, LoadBrokenSnapshot)
+{
+    const QUrl &dirUrl = QUrl::fromLocalFile(dataDir.path());
+    EXPECT_TRUE(DirSnapshotCache::save(dirUrl, { makeSortInfo("a.txt", 10, false) }, 0));
+
+    QFile file(DirSnapshotCache::snapshotPath(dirUrl));
+    ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+    file.resize(40);
+    file.close();
+    EXPECT_TRUE(DirSnapshotCache::load(dirUrl).isEmpty());
+}
@@ -70,3 +70,70 @@ TEST_F(UT_FileSortWorker, Bug_199473_handleUpdateFile)
 
     EXPECT_EQ(selectAndEditFile, updateFile);
 }
+
+TEST_F(UT_FileSortWorker, sortByKeys)
+{
+    worker->sortAndFilter = nullptr;
+    worker->isMixDirAndFile = true;
+    worker->orgSortRole = Global::ItemRoles::kItemFileDisplayNameRole;
+
+    FileInfoPointer info(new SyncFileInfo(url));
+    static constexpr int kCount = 20000;
+    QVector<FileSortWorker::SortKey> keys;
+    for (int i = 0; i < kCount; ++i) {
+        // 打乱顺序，名称按数字大小排序
+        const int number = (i * 7919) % kCount;
+        FileSortWorker::SortKey key;
+        key.url = QUrl::fromLocalFile(QString("/tmp/file_%1").arg(number));
+        key.info = info;
+        key.displayName = QString("file_%1").arg(number);
+        keys.append(key);
+    }
+
+    worker->sortOrder = Qt::AscendingOrder;
+    worker->sortByKeys(keys, AbstractSortFilter::SortScenarios::kSortScenariosNormal);
+    ASSERT_EQ(kCount, keys.count());
+    for (int i = 0; i < kCount; ++i)
+        EXPECT_EQ(QString("file_%1").arg(i), keys.at(i).displayName);
+
+    worker->sortOrder = Qt::DescendingOrder;
+    worker->sortByKeys(keys, AbstractSortFilter::SortScenarios::kSortScenariosNormal);
+    EXPECT_EQ(QString("file_%1").arg(kCount - 1), keys.first().displayName);
+    EXPECT_EQ(QString("file_0"), keys.last().displayName);
+}
+
+TEST_F(UT_FileSortWorker, insertSortListByStoredKeys)
+{
+    worker->sortAndFilter = nullptr;
+    worker->isMixDirAndFile = true;
+    worker->sortOrder = Qt::AscendingOrder;
+    worker->orgSortRole = Global::ItemRoles::kItemFileDisplayNameRole;
+
+    FileInfoPointer info(new SyncFileInfo(url));
+    auto keyOf = [info](int number) {
+        FileSortWorker::SortKey key;
+        key.url = QUrl::fromLocalFile(QString("/tmp/file_%1").arg(number));
+        key.info = info;
+        key.displayName = QString("file_%1").arg(number);
+        return key;
+    };
+
+    QList<QUrl> list;
+    for (int i = 0; i < 100; i += 2) {
+        list.append(keyOf(i).url);
+        worker->sortKeys.insert(list.last(), keyOf(i));
+    }
+
+    // 只为插入的文件取比较数据
+    int made = 0;
+    stub.set_lamda(ADDR(FileSortWorker, makeSortKey), [&made, &keyOf](FileSortWorker *, const QUrl &url) {
+        __DBG_STUB_INVOKE__
+        ++made;
+        return keyOf(url.fileName().mid(strlen("file_")).toInt());
+    });
+
+    const QUrl &needNode = keyOf(51).url;
+    EXPECT_EQ(26, worker->insertSortList(needNode, list, AbstractSortFilter::SortScenarios::kSortScenariosWatcherAddFile));
+    EXPECT_EQ(1, made);
+    EXPECT_TRUE(worker->sortKeys.contains(needNode));
+}
@@ -0,0 +1,127 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+extern "C" {
+#include "fsearch/database.h"
+}
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+
+class FSearchDatabaseTest : public testing::Test
+{
+protected:
+    virtual void SetUp() override
+    {
+        QDir dir(source.path());
+        dir.mkpath("Docs/sub");
+        for (const QString &name : { "Docs/Readme.md", "Docs/sub/a.txt", "b.txt" }) {
+            QFile file(dir.filePath(name));
+            file.open(QIODevice::WriteOnly);
+            file.write("test");
+        }
+    }
+
+    static QSet<QString> names(Database *db)
+    {
+        QSet<QString> result;
+        DynamicArray *entries = db_get_entries(db);
+        for (uint32_t i = 0; i < db_get_num_entries(db); ++i) {
+            auto node = static_cast<BTreeNode *>(darray_get_item(entries, i));
+            if (node)
+                result.insert(QString("%1|%2").arg(node->name, node->lower_name));
+        }
+        return result;
+    }
+
+    QTemporaryDir source;
+    QTemporaryDir store;
+};
+
+TEST_F(FSearchDatabaseTest, ut_saveAndLoad)
+{
+    bool stop = false;
+    Database *db = db_new();
+    ASSERT_TRUE(db_location_add(db, source.path().toLocal8Bit().data(), &stop, nullptr));
+    db_build_initial_entries_list(db);
+    ASSERT_TRUE(db_save_locations(db, store.path().toLocal8Bit().data()));
+
+    const QSet<QString> &expected = names(db);
+    EXPECT_TRUE(expected.contains("Readme.md|readme.md"));
+    EXPECT_TRUE(expected.contains("b.txt|b.txt"));
+
+    Database *loaded = db_new();
+    ASSERT_TRUE(db_location_load(loaded, store.path().toLocal8Bit().data()));
+    db_update_entries_list(loaded);
+    EXPECT_EQ(db_get_num_entries(loaded), db_get_num_entries(db));
+    EXPECT_EQ(names(loaded), expected);
+
+    // saving a mapped database replaces the file, the mapping is still valid
+    ASSERT_TRUE(db_save_locations(loaded, store.path().toLocal8Bit().data()));
+    EXPECT_EQ(names(loaded), expected);
+
+    db_clear(loaded);
+    db_free(loaded);
+    db_clear(db);
+    db_free(db);
+}
+
+TEST_F(FSearchDatabaseTest, ut_loadBroken)
+{
+    QFile file(QDir(store.path()).filePath("database.db"));
+    file.open(QIODevice::WriteOnly);
+    file.write(QByteArray("FSDB\x02\x00", 6) + QByteArray(64, '\xff'));
+    file.close();
+
+    Database *db = db_new();
+    EXPECT_FALSE(db_location_load(db, store.path().toLocal8Bit().data()));
+    db_free(db);
+}
+
+TEST_F(FSearchDatabaseTest, ut_incrementalUpdates)
+{
+    bool stop = false;
+    const QByteArray &root = source.path().toLocal8Bit();
+    Database *db = db_new();
+    ASSERT_TRUE(db_location_add(db, root.data(), &stop, nullptr));
+    db_build_initial_entries_list(db);
+
+    auto rebuilt = [&] {
+        Database *fresh = db_new();
+        db_location_add(fresh, root.data(), &stop, nullptr);
+        db_build_initial_entries_list(fresh);
+        const QSet<QString> &result = names(fresh);
+        db_clear(fresh);
+        db_free(fresh);
+        return result;
+    };
+
+    QDir dir(source.path());
+    dir.mkpath("New/deep");
+    QFile(dir.filePath("New/deep/c.txt")).open(QIODevice::WriteOnly);
+    EXPECT_TRUE(db_node_add(db, (root + "/New").data()));
+    EXPECT_TRUE(dir.rename("Docs", "Renamed"));
+    EXPECT_TRUE(db_node_move(db, (root + "/Docs").data(), (root + "/Renamed").data()));
+    EXPECT_TRUE(dir.remove("b.txt"));
+    EXPECT_TRUE(db_node_remove(db, (root + "/b.txt").data()));
+    EXPECT_TRUE(db_commit_changes(db));
+    EXPECT_EQ(names(db), rebuilt());
+    EXPECT_EQ(db_get_num_entries(db), static_cast<uint32_t>(rebuilt().count()));
+
+    // the changes missed by the watcher are found by rescanning the directory
+    QFile(dir.filePath("d.txt")).open(QIODevice::WriteOnly);
+    EXPECT_TRUE(QDir(dir.filePath("New/deep")).removeRecursively());
+    EXPECT_TRUE(db_node_sync_dir(db, root.data()));
+    EXPECT_TRUE(db_node_sync_dir(db, (root + "/New").data()));
+    EXPECT_TRUE(db_commit_changes(db));
+    EXPECT_EQ(names(db), rebuilt());
+    EXPECT_FALSE(db_commit_changes(db));
+
+    db_clear(db);
+    db_free(db);
+}
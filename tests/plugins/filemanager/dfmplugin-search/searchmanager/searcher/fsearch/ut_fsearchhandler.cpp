@@ -118,6 +118,7 @@ TEST(FSearchHandlerTest, ut_setFlags_1)
 
     EXPECT_TRUE(handler.app->db->db_config->filter_hidden_file);
     EXPECT_TRUE(handler.app->db->db_config->enable_py);
+    EXPECT_TRUE(handler.app->db->db_config->enable_trigram);
     EXPECT_TRUE(handler.app->config->enable_regex);
 }
 
@@ -130,6 +131,7 @@ TEST(FSearchHandlerTest, ut_setFlags_2)
 
     EXPECT_FALSE(handler.app->db->db_config->filter_hidden_file);
     EXPECT_FALSE(handler.app->db->db_config->enable_py);
+    EXPECT_FALSE(handler.app->db->db_config->enable_trigram);
     EXPECT_FALSE(handler.app->config->enable_regex);
 }
 
@@ -0,0 +1,102 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchmanager/searcher/fsearch/fsearchlivedatabase.h"
+
+#include "stubext.h"
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QStandardPaths>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDir>
+#include <QFile>
+
+DPSEARCH_USE_NAMESPACE
+
+class FSearchLiveDatabaseTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        QStandardPaths::setTestModeEnabled(true);
+        QDir(source.path()).mkpath("sub");
+    }
+
+    void TearDown() override
+    {
+        QStandardPaths::setTestModeEnabled(false);
+    }
+
+    static bool waitFor(const std::shared_ptr<FSearchLiveDatabase> &database, const QByteArray &path, bool exists)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (!timer.hasExpired(3000)) {
+            db_lock(database->database());
+            bool found = db_node_find(database->database(), path.constData()) != nullptr;
+            db_unlock(database->database());
+            if (found == exists)
+                return true;
+            QThread::msleep(20);
+        }
+        return false;
+    }
+
+    QTemporaryDir source;
+};
+
+TEST_F(FSearchLiveDatabaseTest, ut_watchChanges)
+{
+    bool stop = false;
+    DatabaseConfig config {};
+    auto database = FSearchLiveDatabase::acquire(source.path(), config, &stop);
+    ASSERT_TRUE(database);
+    EXPECT_TRUE(database->isLive());
+    EXPECT_EQ(database, FSearchLiveDatabase::acquire(source.path(), config, &stop));
+
+    const QByteArray &root = source.path().toLocal8Bit();
+    QFile(source.filePath("sub/new.txt")).open(QIODevice::WriteOnly);
+    EXPECT_TRUE(waitFor(database, root + "/sub/new.txt", true));
+
+    QDir(source.path()).mkpath("sub/dir/inner");
+    QFile(source.filePath("sub/dir/inner/a.txt")).open(QIODevice::WriteOnly);
+    EXPECT_TRUE(waitFor(database, root + "/sub/dir/inner/a.txt", true));
+
+    EXPECT_TRUE(QDir(source.path()).rename("sub", "moved"));
+    EXPECT_TRUE(waitFor(database, root + "/moved/dir/inner/a.txt", true));
+    EXPECT_TRUE(waitFor(database, root + "/sub", false));
+
+    // the watches follow the moved directory
+    QFile(source.filePath("moved/dir/b.txt")).open(QIODevice::WriteOnly);
+    EXPECT_TRUE(waitFor(database, root + "/moved/dir/b.txt", true));
+
+    EXPECT_TRUE(QDir(source.filePath("moved")).removeRecursively());
+    EXPECT_TRUE(waitFor(database, root + "/moved", false));
+    EXPECT_TRUE(database->checkpoint());
+}
+
+TEST_F(FSearchLiveDatabaseTest, ut_openWithoutLock)
+{
+    QTemporaryDir other;
+    bool stop = false;
+    DatabaseConfig config {};
+    std::shared_ptr<FSearchLiveDatabase> nested;
+    int opened = 0;
+
+    // another location is acquired while the first one is opening
+    stub_ext::StubExt st;
+    st.set_lamda(&FSearchLiveDatabase::open, [&](FSearchLiveDatabase *, bool *) {
+        __DBG_STUB_INVOKE__
+        if (++opened == 1)
+            nested = FSearchLiveDatabase::acquire(other.path(), config, &stop);
+        return false;
+    });
+
+    EXPECT_FALSE(FSearchLiveDatabase::acquire(source.path(), config, &stop));
+    EXPECT_EQ(2, opened);
+    EXPECT_FALSE(nested);
+}
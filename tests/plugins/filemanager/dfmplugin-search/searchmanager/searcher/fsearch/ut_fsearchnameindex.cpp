@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+extern "C" {
+#include "fsearch/name_index.h"
+#include "fsearch/string_match.h"
+#include "fsearch/string_utils.h"
+#include "fsearch/btree.h"
+}
+
+#include <gtest/gtest.h>
+
+#include <QElapsedTimer>
+#include <QDebug>
+
+#include <cstring>
+#include <random>
+#include <vector>
+
+class FSearchNameIndexTest : public testing::Test
+{
+protected:
+    void TearDown() override
+    {
+        if (entries) {
+            for (uint32_t i = 0; i < numEntries; ++i)
+                btree_node_free(static_cast<BTreeNode *>(darray_get_item(entries, i)));
+            darray_free(entries);
+        }
+    }
+
+    void createEntries(uint32_t count)
+    {
+        static const char *kWords[] { "Report", "photo", "IMG_", "Ärger", "src", "main", "test",
+                                      "中文", "data", "Backup", "final", "draft", "ÉTÉ", "lib", "x" };
+        std::mt19937 gen(7);
+        numEntries = count;
+        entries = darray_new(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            std::string name;
+            const int parts = 1 + static_cast<int>(gen() % 4);
+            for (int j = 0; j < parts; ++j) {
+                name += kWords[gen() % 15];
+                if (gen() % 2)
+                    name += std::to_string(gen() % 1000);
+            }
+            name += gen() % 2 ? ".txt" : ".JPG";
+
+            const bool withPinyin = gen() % 5 == 0;
+            BTreeNode *node = btree_node_new(name.c_str(), withPinyin ? "zhongwenwenjian" : name.c_str(),
+                                             withPinyin ? "zwwj" : name.c_str(), 0, 0, i, false);
+            darray_set_item(entries, node, i);
+        }
+    }
+
+    // the result of the plain scan which the index replaces
+    std::vector<uint32_t> scan(const char *needle) const
+    {
+        char *folded = fs_str_casefold(needle);
+        const char *query = folded ? folded : needle;
+        std::vector<uint32_t> result;
+        for (uint32_t i = 0; i < numEntries; ++i) {
+            auto node = static_cast<BTreeNode *>(darray_get_item(entries, i));
+            if (strstr(node->lower_name, query))
+                result.push_back(i);
+        }
+        free(folded);
+        return result;
+    }
+
+    static std::vector<uint32_t> search(NameIndex *index, NameIndexColumn column, const char *needle, uint32_t count)
+    {
+        char *folded = fs_str_casefold(needle);
+        std::vector<uint64_t> matches((count + 63) / 64, 0);
+        name_index_search(index, column, folded ? folded : needle, 0, count - 1, matches.data());
+        free(folded);
+
+        std::vector<uint32_t> result;
+        for (uint32_t i = 0; i < count; ++i) {
+            if (matches[i / 64] & (UINT64_C(1) << (i % 64)))
+                result.push_back(i);
+        }
+        return result;
+    }
+
+    DynamicArray *entries { nullptr };
+    uint32_t numEntries { 0 };
+};
+
+TEST_F(FSearchNameIndexTest, ut_memmem)
+{
+    std::mt19937 gen(3);
+    for (int round = 0; round < 2000; ++round) {
+        std::string haystack(gen() % 200, 'a');
+        for (char &c : haystack)
+            c = static_cast<char>('a' + gen() % 3);
+        std::string needle(1 + gen() % 6, 'a');
+        for (char &c : needle)
+            c = static_cast<char>('a' + gen() % 3);
+
+        const void *expected = memmem(haystack.data(), haystack.size(), needle.data(), needle.size());
+        EXPECT_EQ(expected, fs_memmem(haystack.data(), haystack.size(), needle.data(), needle.size()));
+    }
+    EXPECT_NE(nullptr, fs_memmem_impl_name());
+}
+
+TEST_F(FSearchNameIndexTest, ut_casefold)
+{
+    char *folded = fs_str_casefold("ÄRGER.TXT");
+    ASSERT_NE(nullptr, folded);
+    EXPECT_STREQ("ärger.txt", folded);
+    free(folded);
+
+    EXPECT_EQ(nullptr, fs_str_casefold("already lower"));
+    EXPECT_EQ(nullptr, fs_str_casefold("中文"));
+}
+
+TEST_F(FSearchNameIndexTest, ut_search)
+{
+    createEntries(5000);
+    for (bool trigrams : { false, true }) {
+        NameIndex *index = name_index_new(entries, numEntries, true, trigrams);
+        ASSERT_NE(nullptr, index);
+        EXPECT_TRUE(name_index_has_pinyin(index));
+        EXPECT_EQ(numEntries, name_index_get_num_entries(index));
+
+        for (const char *needle : { "report", "IMG_", "ärger", "ÄRGER", "été", "x.txt", "t", ".jpg", "中文", "zz" })
+            EXPECT_EQ(scan(needle), search(index, NAME_INDEX_COLUMN_NAME, needle, numEntries)) << needle;
+
+        EXPECT_FALSE(search(index, NAME_INDEX_COLUMN_FIRST_PY, "zwwj", numEntries).empty());
+        name_index_free(index);
+    }
+}
+
+// run with --gtest_also_run_disabled_tests
+TEST_F(FSearchNameIndexTest, DISABLED_benchmark_search)
+{
+    createEntries(5000000);
+    NameIndex *index = name_index_new(entries, numEntries, false, true);
+
+    for (const char *needle : { "report", "ärger", "x.txt" }) {
+        QElapsedTimer timer;
+        timer.start();
+        const auto &scanned = scan(needle);
+        const qint64 scanTime = timer.nsecsElapsed();
+
+        timer.restart();
+        const auto &indexed = search(index, NAME_INDEX_COLUMN_NAME, needle, numEntries);
+        const qint64 indexTime = timer.nsecsElapsed();
+
+        EXPECT_EQ(scanned, indexed);
+        qInfo() << needle << "matches:" << indexed.size() << "scan(ms):" << scanTime / 1e6
+                << "index(ms):" << indexTime / 1e6 << "impl:" << fs_memmem_impl_name();
+    }
+    name_index_free(index);
+}
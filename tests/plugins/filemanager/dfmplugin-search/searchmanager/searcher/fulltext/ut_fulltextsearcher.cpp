@@ -4,6 +4,7 @@
 
 #include "searchmanager/searcher/fulltext/fulltextsearcher.h"
 #include "searchmanager/searcher/fulltext/fulltextsearcher_p.h"
+#include "searchmanager/searcher/fulltext/indexwatcher.h"
 #include "utils/searchhelper.h"
 
 #include "stubext.h"
@@ -20,8 +21,7 @@
 #include <DirectoryReader.h>
 
 #include <QDir>
-
-#include <dirent.h>
+#include <QTemporaryDir>
 
 DFMBASE_USE_NAMESPACE
 DPSEARCH_USE_NAMESPACE
@@ -170,112 +170,115 @@ TEST_F(FullTextSearcherPrivateTest, ut_newIndexWriter)
 
 TEST_F(FullTextSearcherPrivateTest, ut_doIndexTask_1)
 {
+    bool called = false;
+    stub_ext::StubExt st;
+    st.set_lamda(&FullTextSearcherPrivate::indexFiles, [&] { __DBG_STUB_INVOKE__ called = true; });
+
     FullTextSearcher searcher(QUrl::fromLocalFile("/home"), "test");
 
-    searcher.d->doIndexTask(nullptr, nullptr, "/home", FullTextSearcherPrivate::kCreate);
+    searcher.d->doIndexTask(nullptr, "/home", FullTextSearcherPrivate::kCreate);
     EXPECT_NE(searcher.d->status.loadAcquire(), AbstractSearcher::kRuning);
+    EXPECT_FALSE(called);
 }
 
 TEST_F(FullTextSearcherPrivateTest, ut_doIndexTask_2)
 {
+    bool called = false;
     stub_ext::StubExt st;
     st.set_lamda(&DeviceUtils::fstabBindInfo, [] {
         __DBG_STUB_INVOKE__
         QMap<QString, QString> info { { "/data/home", "/home" } };
         return info;
     });
+    st.set_lamda(&FullTextSearcherPrivate::indexFiles, [&] { __DBG_STUB_INVOKE__ called = true; });
 
     FullTextSearcher searcher(QUrl::fromLocalFile("/home"), "test");
     searcher.d->status.storeRelease(AbstractSearcher::kRuning);
 
-    searcher.d->doIndexTask(nullptr, nullptr, "/data/home", FullTextSearcherPrivate::kCreate);
+    searcher.d->doIndexTask(nullptr, "/data/home", FullTextSearcherPrivate::kCreate);
     EXPECT_TRUE(searcher.d->bindPathTable.contains("/data/home"));
+    EXPECT_FALSE(called);
 }
 
 TEST_F(FullTextSearcherPrivateTest, ut_doIndexTask_3)
 {
-    stub_ext::StubExt st;
-    st.set_lamda(&DeviceUtils::fstabBindInfo, [] {
-        __DBG_STUB_INVOKE__
-        QMap<QString, QString> info { { "/data/home", "/home" } };
-        return info;
-    });
-
-    // stub readdir
-    struct dirent dent;
-    strcpy(dent.d_name, "test.txt");
-    bool isFirst = true;
-    st.set_lamda(readdir, [&] {
-        __DBG_STUB_INVOKE__
-        if (isFirst) {
-            isFirst = false;
-            return &dent;
-        }
-        return (dirent *)nullptr;
-    });
-
-    // stub lstat
-    struct stat sta;
-    sta.st_mode = __S_IFREG;
-    typedef int (*LstatFunc)(const char *, struct stat *);
-    auto lstatFunc = static_cast<LstatFunc>(lstat);
-    st.set_lamda(lstatFunc, [&](const char *, struct stat *buf) {
-        __DBG_STUB_INVOKE__
-        buf = &sta;
-        return 0;
-    });
+    QTemporaryDir dir;
+    QDir(dir.path()).mkpath("sub");
+    for (const QString &name : { "a.txt", "b.png", "sub/c.md" }) {
+        QFile file(dir.filePath(name));
+        file.open(QIODevice::WriteOnly);
+        file.write("test");
+    }
 
-    st.set_lamda(&FullTextSearcherPrivate::indexDocs, [] { __DBG_STUB_INVOKE__ });
+    QList<FullTextSearcherPrivate::IndexTask> tasks;
+    stub_ext::StubExt st;
+    st.set_lamda(&FullTextSearcherPrivate::indexFiles,
+                 [&](FullTextSearcherPrivate *, const IndexWriterPtr &, const QList<FullTextSearcherPrivate::IndexTask> &list) {
+                     __DBG_STUB_INVOKE__
+                     tasks = list;
+                 });
 
     FullTextSearcher searcher(QUrl::fromLocalFile("/home"), "test");
     searcher.d->status.storeRelease(AbstractSearcher::kRuning);
 
-    searcher.d->doIndexTask(nullptr, nullptr, QDir::currentPath(), FullTextSearcherPrivate::kCreate);
-    EXPECT_STREQ(dent.d_name, "test.txt");
+    searcher.d->doIndexTask(nullptr, dir.path(), FullTextSearcherPrivate::kCreate);
+
+    QStringList paths;
+    for (const auto &task : tasks) {
+        EXPECT_EQ(task.type, FullTextSearcherPrivate::kAddIndex);
+        EXPECT_EQ(task.stamp.size, 4);
+        paths << task.path;
+    }
+    paths.sort();
+    EXPECT_EQ(paths, QStringList({ dir.filePath("a.txt"), dir.filePath("sub/c.md") }));
 }
 
 TEST_F(FullTextSearcherPrivateTest, ut_doIndexTask_4)
 {
-    stub_ext::StubExt st;
-    st.set_lamda(&DeviceUtils::fstabBindInfo, [] {
-        __DBG_STUB_INVOKE__
-        QMap<QString, QString> info { { "/data/home", "/home" } };
-        return info;
-    });
-
-    // stub readdir
-    struct dirent dent;
-    strcpy(dent.d_name, "test.txt");
-    bool isFirst = true;
-    st.set_lamda(readdir, [&] {
-        __DBG_STUB_INVOKE__
-        if (isFirst) {
-            isFirst = false;
-            return &dent;
-        }
-        return (dirent *)nullptr;
-    });
+    QTemporaryDir dir;
+    const QString &same = dir.filePath("same.txt");
+    const QString &changed = dir.filePath("changed.txt");
+    const QString &removed = dir.filePath("removed.txt");
+    for (const QString &path : { same, changed }) {
+        QFile file(path);
+        file.open(QIODevice::WriteOnly);
+        file.write("test");
+    }
 
-    // stub lstat
-    struct stat sta;
-    sta.st_mode = __S_IFREG;
-    typedef int (*LstatFunc)(const char *, struct stat *);
-    auto lstatFunc = static_cast<LstatFunc>(lstat);
-    st.set_lamda(lstatFunc, [&](const char *, struct stat *buf) {
-        __DBG_STUB_INVOKE__
-        buf = &sta;
-        return 0;
-    });
+    QTemporaryDir journalDir;
+    IndexJournal journal(journalDir.filePath("journal"));
+    const QFileInfo info(same);
+    journal.update(same, { info.lastModified().toSecsSinceEpoch(), info.size() });
+    journal.update(changed, { info.lastModified().toSecsSinceEpoch(), 1 });
+    journal.update(removed, { info.lastModified().toSecsSinceEpoch(), 4 });
 
-    st.set_lamda(&FullTextSearcherPrivate::checkUpdate, [] { __DBG_STUB_INVOKE__ return true; });
-    st.set_lamda(&FullTextSearcherPrivate::indexDocs, [] { __DBG_STUB_INVOKE__ });
-    st.set_lamda(VADDR(SyncFileInfo, nameOf), [] { __DBG_STUB_INVOKE__ return "txt"; });
+    QList<FullTextSearcherPrivate::IndexTask> tasks;
+    stub_ext::StubExt st;
+    st.set_lamda(&FullTextSearcherPrivate::indexFiles,
+                 [&](FullTextSearcherPrivate *, const IndexWriterPtr &, const QList<FullTextSearcherPrivate::IndexTask> &list) {
+                     __DBG_STUB_INVOKE__
+                     tasks = list;
+                 });
 
     FullTextSearcher searcher(QUrl::fromLocalFile("/home"), "test");
+    searcher.d->journal = &journal;
     searcher.d->status.storeRelease(AbstractSearcher::kRuning);
 
-    searcher.d->doIndexTask(nullptr, nullptr, QDir::currentPath(), FullTextSearcherPrivate::kUpdate);
-    EXPECT_TRUE(searcher.d->isUpdated);
+    searcher.d->doIndexTask(nullptr, dir.path(), FullTextSearcherPrivate::kUpdate);
+
+    ASSERT_EQ(tasks.count(), 2);
+    EXPECT_EQ(tasks.at(0).path, changed);
+    EXPECT_EQ(tasks.at(0).type, FullTextSearcherPrivate::kUpdateIndex);
+    EXPECT_EQ(tasks.at(1).path, removed);
+    EXPECT_EQ(tasks.at(1).type, FullTextSearcherPrivate::kDeleteIndex);
+}
+
+TEST_F(FullTextSearcherPrivateTest, ut_isSupportFile)
+{
+    EXPECT_TRUE(FullTextSearcherPrivate::isSupportFile("/home/test.txt"));
+    EXPECT_TRUE(FullTextSearcherPrivate::isSupportFile("/home/test.docx"));
+    EXPECT_FALSE(FullTextSearcherPrivate::isSupportFile("/home/test.png"));
+    EXPECT_FALSE(FullTextSearcherPrivate::isSupportFile("/home/test"));
 }
 
 TEST_F(FullTextSearcherPrivateTest, ut_indexDocs_1)
@@ -283,11 +286,6 @@ TEST_F(FullTextSearcherPrivateTest, ut_indexDocs_1)
     stub_ext::StubExt st;
     st.set_lamda(&FullTextSearcherPrivate::indexStorePath, [] { __DBG_STUB_INVOKE__ return "/index"; });
     st.set_lamda(VADDR(IndexWriter, initialize), [] { __DBG_STUB_INVOKE__ });
-    st.set_lamda(&FullTextSearcherPrivate::fileDocument, [] {
-        __DBG_STUB_INVOKE__
-        DocumentPtr doc = newLucene<Document>();
-        return doc;
-    });
 
     typedef void (*AddDoc)(IndexWriter *, const DocumentPtr &);
     auto add = (AddDoc)((void (IndexWriter::*)(const DocumentPtr &)) & IndexWriter::addDocument);
@@ -298,7 +296,7 @@ TEST_F(FullTextSearcherPrivateTest, ut_indexDocs_1)
     FullTextSearcher searcher(QUrl::fromLocalFile("/home"), "test");
     auto writer = searcher.d->newIndexWriter();
 
-    searcher.d->indexDocs(writer, "/home/test.txt", FullTextSearcherPrivate::kAddIndex);
+    EXPECT_TRUE(searcher.d->indexDocs(writer, "/home/test.txt", FullTextSearcherPrivate::kAddIndex, newLucene<Document>()));
     EXPECT_TRUE(success);
 }
 
@@ -307,11 +305,6 @@ TEST_F(FullTextSearcherPrivateTest, ut_indexDocs_2)
     stub_ext::StubExt st;
     st.set_lamda(&FullTextSearcherPrivate::indexStorePath, [] { __DBG_STUB_INVOKE__ return "/index"; });
     st.set_lamda(VADDR(IndexWriter, initialize), [] { __DBG_STUB_INVOKE__ });
-    st.set_lamda(&FullTextSearcherPrivate::fileDocument, [] {
-        __DBG_STUB_INVOKE__
-        DocumentPtr doc = newLucene<Document>();
-        return doc;
-    });
 
     typedef void (*UpdateDoc)(IndexWriter *, const TermPtr &, const DocumentPtr &);
     auto update = (UpdateDoc)((void (IndexWriter::*)(const TermPtr &, const DocumentPtr &)) & IndexWriter::updateDocument);
@@ -322,7 +315,7 @@ TEST_F(FullTextSearcherPrivateTest, ut_indexDocs_2)
     FullTextSearcher searcher(QUrl::fromLocalFile("/home"), "test");
     auto writer = searcher.d->newIndexWriter();
 
-    searcher.d->indexDocs(writer, "/home/test.txt", FullTextSearcherPrivate::kUpdateIndex);
+    EXPECT_TRUE(searcher.d->indexDocs(writer, "/home/test.txt", FullTextSearcherPrivate::kUpdateIndex, newLucene<Document>()));
     EXPECT_TRUE(success);
 }
 
@@ -424,10 +417,9 @@ TEST_F(FullTextSearcherPrivateTest, ut_fileDocument)
 {
     stub_ext::StubExt st;
     st.set_lamda(DocParser::convertFile, [] { __DBG_STUB_INVOKE__ return std::string("test"); });
-    st.set_lamda(&QFileInfo::lastModified, [] { __DBG_STUB_INVOKE__ return QDateTime::currentDateTime(); });
 
     FullTextSearcher searcher(QUrl::fromLocalFile("/home"), "test");
-    auto doc = searcher.d->fileDocument("/home/test.txt");
+    auto doc = searcher.d->fileDocument("/home/test.txt", FileStamp { QDateTime::currentSecsSinceEpoch(), 4 });
 
     auto value = doc->get(L"contents");
     EXPECT_EQ(value, L"test");
@@ -483,6 +475,55 @@ TEST_F(FullTextSearcherPrivateTest, ut_createIndex_3)
     EXPECT_EQ(searcher.d->status.loadAcquire(), AbstractSearcher::kCompleted);
 }
 
+TEST_F(FullTextSearcherPrivateTest, ut_updateIndex_walkUnwatched)
+{
+    QTemporaryDir journalDir;
+    IndexJournal journal(journalDir.filePath("journal"));
+    journal.update("/tst/a.txt", { 10, 4 });
+    journal.markChanged({ "/tst/b.txt" });
+
+    int walks = 0;
+    qint64 watchedSince = QDateTime::currentSecsSinceEpoch();
+    QStringList changes;
+    stub_ext::StubExt st;
+    st.set_lamda(FileUtils::bindPathTransform, [] { __DBG_STUB_INVOKE__ return "/tst"; });
+    st.set_lamda(&FullTextSearcherPrivate::indexStorePath, [] { __DBG_STUB_INVOKE__ return "/index"; });
+    st.set_lamda(VADDR(IndexWriter, initialize), [] { __DBG_STUB_INVOKE__ });
+    typedef void (*WriterClose)(IndexWriter *);
+    auto writerClose = (WriterClose)((void (IndexWriter::*)()) & IndexWriter::close);
+    st.set_lamda(writerClose, [] { __DBG_STUB_INVOKE__ });
+    st.set_lamda(&IndexWatcher::watch, [&watchedSince] { __DBG_STUB_INVOKE__ return watchedSince; });
+    st.set_lamda(&FullTextSearcherPrivate::doIndexTask, [&walks] { __DBG_STUB_INVOKE__ ++walks; });
+    st.set_lamda(&FullTextSearcherPrivate::indexChangedFiles,
+                 [&changes](FullTextSearcherPrivate *, const IndexWriterPtr &, const QStringList &paths) {
+                     __DBG_STUB_INVOKE__
+                     changes.append(paths);
+                 });
+
+    FullTextSearcher searcher(QUrl::fromLocalFile("/tst"), "test");
+    searcher.d->journal = &journal;
+    searcher.d->status.storeRelease(AbstractSearcher::kRuning);
+
+    // walked once after the watcher started, then only the recorded changes are indexed
+    EXPECT_TRUE(searcher.d->updateIndex("/tst"));
+    EXPECT_TRUE(searcher.d->updateIndex("/tst"));
+    EXPECT_EQ(1, walks);
+    EXPECT_EQ(QStringList { "/tst/b.txt" }, changes);
+
+    // a new watcher, the changes made before it are not recorded
+    watchedSince = QDateTime::currentSecsSinceEpoch() + 1;
+    EXPECT_TRUE(searcher.d->updateIndex("/tst"));
+    EXPECT_EQ(2, walks);
+
+    // the location can not be watched, walked again after the rescan interval
+    watchedSince = -1;
+    EXPECT_TRUE(searcher.d->updateIndex("/tst"));
+    EXPECT_EQ(2, walks);
+    journal.setLastScanTime("/tst", QDateTime::currentSecsSinceEpoch() - 24 * 60 * 60);
+    EXPECT_TRUE(searcher.d->updateIndex("/tst"));
+    EXPECT_EQ(3, walks);
+}
+
 //TEST_F(FullTextSearcherPrivateTest, ut_updateIndex)
 //{
 //    stub_ext::StubExt st;
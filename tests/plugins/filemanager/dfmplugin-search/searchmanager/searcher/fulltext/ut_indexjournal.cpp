@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchmanager/searcher/fulltext/indexjournal.h"
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+
+DPSEARCH_USE_NAMESPACE
+
+class IndexJournalTest : public testing::Test
+{
+protected:
+    QTemporaryDir dir;
+};
+
+TEST_F(IndexJournalTest, ut_isUnder)
+{
+    EXPECT_TRUE(IndexJournal::isUnder("/home/a.txt", "/"));
+    EXPECT_TRUE(IndexJournal::isUnder("/home", "/home"));
+    EXPECT_TRUE(IndexJournal::isUnder("/home/a.txt", "/home"));
+    EXPECT_TRUE(IndexJournal::isUnder("/home/a.txt", "/home/"));
+    EXPECT_FALSE(IndexJournal::isUnder("/homework/a.txt", "/home"));
+    EXPECT_FALSE(IndexJournal::isUnder("/home", "/home/a"));
+}
+
+TEST_F(IndexJournalTest, ut_isChanged)
+{
+    IndexJournal journal(dir.filePath("journal"));
+    EXPECT_TRUE(journal.isChanged("/home/a.txt", { 10, 4 }));
+
+    journal.update("/home/a.txt", { 10, 4 });
+    EXPECT_FALSE(journal.isChanged("/home/a.txt", { 10, 4 }));
+    EXPECT_TRUE(journal.isChanged("/home/a.txt", { 11, 4 }));
+    EXPECT_TRUE(journal.isChanged("/home/a.txt", { 10, 5 }));
+
+    // the size is not compared for the imported records
+    journal.update("/home/b.txt", { 10, -1 });
+    EXPECT_FALSE(journal.isChanged("/home/b.txt", { 10, 5 }));
+
+    journal.remove("/home/a.txt");
+    EXPECT_TRUE(journal.isChanged("/home/a.txt", { 10, 4 }));
+}
+
+TEST_F(IndexJournalTest, ut_changes)
+{
+    IndexJournal journal(dir.filePath("journal"));
+    journal.markChanged({ "/home/a.txt", "/data/b.txt", "/homework/c.txt" });
+
+    EXPECT_EQ(journal.takeChanges("/home"), QStringList { "/home/a.txt" });
+    EXPECT_TRUE(journal.takeChanges("/home").isEmpty());
+    EXPECT_EQ(journal.takeChanges("/").count(), 2);
+}
+
+TEST_F(IndexJournalTest, ut_lastScanTime)
+{
+    IndexJournal journal(dir.filePath("journal"));
+    EXPECT_EQ(journal.lastScanTime("/home/a"), 0);
+
+    journal.setLastScanTime("/home/a", 10);
+    journal.setLastScanTime("/home", 5);
+    EXPECT_EQ(journal.lastScanTime("/home/a/b"), 5);
+    EXPECT_EQ(journal.lastScanTime("/data"), 0);
+
+    journal.setLastScanTime("/home/a", 20);
+    EXPECT_EQ(journal.lastScanTime("/home/a/b"), 20);
+    EXPECT_EQ(journal.lastScanTime("/home/b"), 5);
+}
+
+TEST_F(IndexJournalTest, ut_saveAndLoad)
+{
+    const QString &path = dir.filePath("journal");
+    {
+        IndexJournal journal(path);
+        journal.update("/home/a.txt", { 10, 4 });
+        journal.markChanged({ "/home/b.txt" });
+        journal.setLastScanTime("/home", 100);
+        EXPECT_TRUE(journal.save());
+    }
+
+    IndexJournal journal(path);
+    EXPECT_FALSE(journal.isEmpty());
+    EXPECT_FALSE(journal.isChanged("/home/a.txt", { 10, 4 }));
+    EXPECT_EQ(journal.indexedFiles("/home"), QStringList { "/home/a.txt" });
+    EXPECT_EQ(journal.takeChanges("/home"), QStringList { "/home/b.txt" });
+    EXPECT_EQ(journal.lastScanTime("/home"), 100);
+
+    journal.clear();
+    EXPECT_TRUE(journal.isEmpty());
+}
+
+TEST_F(IndexJournalTest, ut_loadBroken)
+{
+    const QString &path = dir.filePath("journal");
+    QFile file(path);
+    file.open(QIODevice::WriteOnly);
+    file.write("broken");
+    file.close();
+
+    IndexJournal journal(path);
+    EXPECT_TRUE(journal.isEmpty());
+    EXPECT_FALSE(journal.load());
+}
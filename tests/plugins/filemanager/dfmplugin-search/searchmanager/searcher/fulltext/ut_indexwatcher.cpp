@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2023 UnionTech Software Technology Co., Ltd.
+//
+// SPDX-License-Identifier: GPL-3.0-or-later
+
+#include "searchmanager/searcher/fulltext/indexwatcher.h"
+#include "searchmanager/searcher/fulltext/indexjournal.h"
+
+#include <gtest/gtest.h>
+
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QThread>
+#include <QDir>
+#include <QFile>
+
+DPSEARCH_USE_NAMESPACE
+
+class IndexWatcherTest : public testing::Test
+{
+protected:
+    void SetUp() override
+    {
+        QDir(source.path()).mkpath("sub");
+    }
+
+    // the changes under the location are taken until `path` is found
+    bool waitFor(const QString &path)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        while (!timer.hasExpired(3000)) {
+            changes.append(journal.takeChanges(source.path()));
+            if (changes.contains(path))
+                return true;
+            QThread::msleep(20);
+        }
+        return false;
+    }
+
+    QTemporaryDir source;
+    QTemporaryDir journalDir;
+    IndexJournal journal { journalDir.filePath("journal") };
+    QStringList changes;
+};
+
+TEST_F(IndexWatcherTest, ut_recordChanges)
+{
+    const qint64 watchedSince = IndexWatcher::watch(source.path(), &journal, {});
+    ASSERT_LT(0, watchedSince);
+    EXPECT_EQ(watchedSince, IndexWatcher::watch(source.filePath("sub"), &journal, {}));
+
+    QFile(source.filePath("sub/new.txt")).open(QIODevice::WriteOnly);
+    EXPECT_TRUE(waitFor(source.filePath("sub/new.txt")));
+
+    // the new directory is recorded to be walked, and its sub directories are watched
+    QDir(source.path()).mkpath("sub/dir/inner");
+    EXPECT_TRUE(waitFor(source.filePath("sub/dir")));
+    QThread::msleep(100);
+    QFile(source.filePath("sub/dir/inner/a.txt")).open(QIODevice::WriteOnly);
+    EXPECT_TRUE(waitFor(source.filePath("sub/dir/inner/a.txt")));
+
+    EXPECT_TRUE(QDir(source.path()).rename("sub", "moved"));
+    EXPECT_TRUE(waitFor(source.filePath("sub")));
+    EXPECT_TRUE(waitFor(source.filePath("moved")));
+
+    // the watches follow the moved directory, the unsupported and hidden files are ignored
+    QFile(source.filePath("moved/dir/b.bin")).open(QIODevice::WriteOnly);
+    QFile(source.filePath("moved/dir/.hidden.txt")).open(QIODevice::WriteOnly);
+    QFile(source.filePath("moved/dir/b.txt")).open(QIODevice::WriteOnly);
+    EXPECT_TRUE(waitFor(source.filePath("moved/dir/b.txt")));
+    EXPECT_FALSE(changes.contains(source.filePath("moved/dir/b.bin")));
+    EXPECT_FALSE(changes.contains(source.filePath("moved/dir/.hidden.txt")));
+}